@@ -20,6 +20,7 @@
 // THE SOFTWARE.
 //===----------------------------------------------------------------------===//
 
+#include <cstring>
 #include <iterator>
 #include <memory>
 #include <string>
@@ -113,7 +114,54 @@ auto Binder::BindCreate(duckdb_libpgquery::PGCreateStmt *pg_stmt) -> std::unique
     throw bustub::Exception("should have at least 1 column");
   }
 
-  return std::make_unique<CreateStatement>(std::move(table), std::move(columns));
+  // CREATE TABLE ... WITH (layout = row | pax, engine = heap | columnar)
+  auto layout = TableLayout::ROW;
+  auto engine = TableEngine::HEAP;
+  if (pg_stmt->options != nullptr) {
+    for (auto node = pg_stmt->options->head; node != nullptr; node = lnext(node)) {
+      auto option = reinterpret_cast<duckdb_libpgquery::PGDefElem *>(node->data.ptr_value);
+      const bool is_layout = strcmp(option->defname, "layout") == 0;
+      if (!is_layout && strcmp(option->defname, "engine") != 0) {
+        throw NotImplementedException(fmt::format("unsupported table option: {}", option->defname));
+      }
+      // an identifier is parsed as a type name, a quoted value as a string
+      std::string value;
+      if (option->arg != nullptr && option->arg->type == duckdb_libpgquery::T_PGTypeName) {
+        auto type_name = reinterpret_cast<duckdb_libpgquery::PGTypeName *>(option->arg);
+        value = reinterpret_cast<duckdb_libpgquery::PGValue *>(type_name->names->tail->data.ptr_value)->val.str;
+      } else if (option->arg != nullptr && option->arg->type == duckdb_libpgquery::T_PGString) {
+        value = reinterpret_cast<duckdb_libpgquery::PGValue *>(option->arg)->val.str;
+      }
+      value = StringUtil::Lower(value);
+      if (!is_layout) {
+        if (value == "heap") {
+          engine = TableEngine::HEAP;
+        } else if (value == "columnar") {
+          engine = TableEngine::COLUMNAR;
+        } else {
+          throw NotImplementedException(fmt::format("unsupported table engine: {}", value));
+        }
+      } else if (value == "row") {
+        layout = TableLayout::ROW;
+      } else if (value == "pax") {
+        layout = TableLayout::PAX;
+      } else {
+        throw NotImplementedException(fmt::format("unsupported table layout: {}", value));
+      }
+    }
+  }
+  if (layout == TableLayout::PAX && engine == TableEngine::COLUMNAR) {
+    throw NotImplementedException("a columnar table has no pax layout");
+  }
+  if (layout == TableLayout::PAX) {
+    for (const auto &column : columns) {
+      if (!column.IsInlined()) {
+        throw NotImplementedException("the pax layout only supports fixed-width columns");
+      }
+    }
+  }
+
+  return std::make_unique<CreateStatement>(std::move(table), std::move(columns), layout, engine);
 }
 
 auto Binder::BindIndex(duckdb_libpgquery::PGIndexStmt *stmt) -> std::unique_ptr<IndexStatement> {
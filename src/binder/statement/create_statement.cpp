@@ -5,11 +5,18 @@
 
 namespace bustub {
 
-CreateStatement::CreateStatement(std::string table, std::vector<Column> columns)
-    : BoundStatement(StatementType::CREATE_STATEMENT), table_(std::move(table)), columns_(std::move(columns)) {}
+CreateStatement::CreateStatement(std::string table, std::vector<Column> columns, TableLayout layout,
+                                 TableEngine engine)
+    : BoundStatement(StatementType::CREATE_STATEMENT),
+      table_(std::move(table)),
+      columns_(std::move(columns)),
+      layout_(layout),
+      engine_(engine) {}
 
 auto CreateStatement::ToString() const -> std::string {
-  return fmt::format("BoundCreate {{\n  table={}\n  columns={}\n}}", table_, columns_);
+  return fmt::format("BoundCreate {{\n  table={}\n  columns={}\n  layout={}\n  engine={}\n}}", table_, columns_,
+                     layout_ == TableLayout::PAX ? "pax" : "row",
+                     engine_ == TableEngine::COLUMNAR ? "columnar" : "heap");
 }
 
 }  // namespace bustub
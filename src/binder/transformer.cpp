@@ -32,6 +32,7 @@
 #include "binder/statement/insert_statement.h"
 #include "binder/statement/select_statement.h"
 #include "binder/statement/update_statement.h"
+#include "binder/statement/vacuum_statement.h"
 #include "binder/table_ref/bound_base_table_ref.h"
 #include "common/exception.h"
 #include "common/logger.h"
@@ -71,6 +72,8 @@ auto Binder::BindStatement(duckdb_libpgquery::PGNode *stmt) -> std::unique_ptr<B
       return BindVariableSet(reinterpret_cast<duckdb_libpgquery::PGVariableSetStmt *>(stmt));
     case duckdb_libpgquery::T_PGVariableShowStmt:
       return BindVariableShow(reinterpret_cast<duckdb_libpgquery::PGVariableShowStmt *>(stmt));
+    case duckdb_libpgquery::T_PGVacuumStmt:
+      return BindVacuum(reinterpret_cast<duckdb_libpgquery::PGVacuumStmt *>(stmt));
     default:
       throw NotImplementedException(NodeTagToString(stmt->type));
   }
@@ -0,0 +1,25 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// buffer_access_strategy.cpp
+//
+// Identification: src/buffer/buffer_access_strategy.cpp
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/buffer_access_strategy.h"
+
+#include "buffer/buffer_pool_manager.h"
+
+namespace bustub {
+
+BufferAccessStrategy::~BufferAccessStrategy() {
+  if (prefetcher_ != nullptr) {
+    prefetcher_->CancelPrefetch(this);
+  }
+}
+
+}  // namespace bustub
@@ -12,92 +12,252 @@
 
 #include "buffer/buffer_pool_manager_instance.h"
 
+#include <algorithm>
+#include <future>  // NOLINT
+#include <utility>
+#include <vector>
+
 #include "common/exception.h"
 #include "common/macros.h"
  
 namespace bustub {
 
 BufferPoolManagerInstance::BufferPoolManagerInstance(size_t pool_size, DiskManager *disk_manager, size_t replacer_k,
-                                                     LogManager *log_manager)
-    : pool_size_(pool_size), disk_manager_(disk_manager), log_manager_(log_manager) {
-  // we allocate a consecutive memory space for the buffer pool
+                                                     LogManager *log_manager, ReplacerPolicy policy)
+    : BufferPoolManagerInstance(pool_size, 1, 0, disk_manager, replacer_k, log_manager, policy) {}
+
+BufferPoolManagerInstance::BufferPoolManagerInstance(size_t pool_size, uint32_t num_instances, uint32_t instance_index,
+                                                     DiskManager *disk_manager, size_t replacer_k,
+                                                     LogManager *log_manager, ReplacerPolicy policy)
+    : pool_size_(pool_size),
+      num_instances_(num_instances),
+      instance_index_(instance_index),
+      disk_manager_(disk_manager),
+      log_manager_(log_manager) {
+  BUSTUB_ASSERT(num_instances > 0, "If BPI is not part of a pool, then the pool size should just be 1");
+  BUSTUB_ASSERT(instance_index < num_instances,
+                "BPI index cannot be greater than the number of BPIs in the pool. In non-parallel case, index should "
+                "just be 0.");
+  // we allocate a consecutive memory space for the buffer pool, and keep the page descriptors apart from it
+  frames_ = new FrameArena(pool_size_, buffer_pool_huge_pages);
   pages_ = new Page[pool_size_];
-  page_table_ = new ExtendibleHashTable<page_id_t, frame_id_t>(bucket_size_);
-  replacer_ = new LRUKReplacer(pool_size, replacer_k);
+  page_table_ = new PageTable(pool_size_);
+  if (policy == ReplacerPolicy::CLOCK) {
+    replacer_ = new ClockReplacer(pool_size);
+  } else {
+    replacer_ = new LRUKReplacer(pool_size, replacer_k);
+  }
+  frame_states_ = new std::atomic<FrameState>[pool_size_];
+  frame_io_cv_ = new std::condition_variable[pool_size_];
 
   // Initially, every page is in the free list.
   for (size_t i = 0; i < pool_size_; ++i) {
     free_list_.emplace_back(static_cast<int>(i));
-    pages_[i].ResetMemory();
+    // the arena is mapped zeroed, and clearing it here would fault in every page of a pool that is never filled
+    pages_[i].data_ = frames_->GetFrame(static_cast<frame_id_t>(i));
     pages_[i].page_id_ = INVALID_PAGE_ID;
     pages_[i].is_dirty_ = false;
     pages_[i].pin_count_ = 0;
+    frame_states_[i] = FrameState::READY;
   }
 }
 
 BufferPoolManagerInstance::~BufferPoolManagerInstance() {
+  read_ahead_.reset();
+  StopBackgroundWriter();
   delete[] pages_;
+  delete frames_;
+  delete[] frame_io_cv_;
+  delete[] frame_states_;
   delete page_table_;
   delete replacer_;
 }
 
-auto BufferPoolManagerInstance::NewPgImp(page_id_t *page_id) -> Page * {
-  std::lock_guard<std::mutex> lock(latch_);
-  // find a fresh frame id
+void BufferPoolManagerInstance::SetFrameState(frame_id_t frame_id, FrameState state) {
+  frame_states_[frame_id] = state;
+  frame_io_cv_[frame_id].notify_all();
+}
+
+auto BufferPoolManagerInstance::PinResidentPage(page_id_t page_id) -> Page * {
   frame_id_t frame_id;
-  if (free_list_.empty()) {
-    if (!replacer_->Evict(&frame_id)) {
-      return nullptr;
+  if (!page_table_->Find(page_id, &frame_id)) {
+    return nullptr;
+  }
+  Page *page = &pages_[frame_id];
+  const int pin_count = page->pin_count_.fetch_add(1);
+  if (page->page_id_ == page_id && frame_states_[frame_id] == FrameState::READY) {
+    if (pin_count == 0) {
+      replacer_->SetEvictable(frame_id, false);
     }
-    FlushPgInternal(pages_[frame_id].GetPageId());
+    replacer_->RecordHit(frame_id);
+    return page;
   }
-  frame_id = free_list_.front();
-  free_list_.pop_front();
 
-  // initialize the page
-  pages_[frame_id].page_id_ = AllocatePage();
-  pages_[frame_id].ResetMemory();
-  pages_[frame_id].is_dirty_ = false;
-  pages_[frame_id].pin_count_ = 1;
+  // the frame changed hands between the lookup and the pin; this may be the last pin, so drop it like UnpinPgImp does
+  std::lock_guard<std::mutex> lock(latch_);
+  if (--page->pin_count_ == 0) {
+    replacer_->SetEvictable(frame_id, true);
+  }
+  return nullptr;
+}
+
+auto BufferPoolManagerInstance::DetachFrame(frame_id_t frame_id) -> bool {
+  frame_states_[frame_id] = FrameState::WRITING;
+  if (pages_[frame_id].pin_count_ == 0) {
+    return true;
+  }
+  frame_states_[frame_id] = FrameState::READY;
+  return false;
+}
 
-  *page_id = pages_[frame_id].page_id_;
+auto BufferPoolManagerInstance::FindReadyFrame(page_id_t page_id, frame_id_t *frame_id,
+                                               std::unique_lock<std::mutex> *lock) -> bool {
+  // the frame may hold another page by the time we wake up, so look the page up again after every wait
+  while (page_table_->Find(page_id, frame_id)) {
+    if (frame_states_[*frame_id] == FrameState::READY) {
+      return true;
+    }
+    frame_io_cv_[*frame_id].wait(*lock);
+  }
+  return false;
+}
 
-  page_table_->Insert(*page_id, frame_id);
-  replacer_->RecordAccess(frame_id);
-  replacer_->SetEvictable(frame_id, false);
+auto BufferPoolManagerInstance::RecycleRingFrame(BufferAccessStrategy *strategy, frame_id_t *frame_id) -> bool {
+  const auto &slot = strategy->ring_[strategy->next_slot_];
+  if (slot.owner_ != this) {
+    return false;
+  }
+  // the page may have been evicted since the scan loaded it, or somebody else may be using it now
+  Page *page = &pages_[slot.frame_id_];
+  if (page->page_id_ != slot.page_id_ || frame_states_[slot.frame_id_] != FrameState::READY || page->pin_count_ > 0 ||
+      !DetachFrame(slot.frame_id_)) {
+    return false;
+  }
+  replacer_->Remove(slot.frame_id_);
+  *frame_id = slot.frame_id_;
+  return true;
+}
 
+auto BufferPoolManagerInstance::ReserveFrame(page_id_t page_id, frame_id_t *frame_id,
+                                             std::unique_lock<std::mutex> *lock, BufferAccessStrategy *strategy)
+    -> bool {
+  const bool use_ring = strategy != nullptr && strategy->GetRingSize() > 0;
+  // the scan and its read-ahead share the ring; the latch of the ring is only taken under the latch of the pool
+  std::unique_lock<std::mutex> ring_lock;
+  if (use_ring) {
+    ring_lock = std::unique_lock<std::mutex>(strategy->latch_);
+  }
+  if (use_ring && RecycleRingFrame(strategy, frame_id)) {
+    // the scan replaces its own page and leaves the rest of the pool alone
+  } else if (!free_list_.empty()) {
+    *frame_id = free_list_.front();
+    free_list_.pop_front();
+    // not READY before the frame gets its page id, so that lock-free pins of that page fail until it is loaded
+    frame_states_[*frame_id] = FrameState::WRITING;
+  } else {
+    while (true) {
+      if (!replacer_->Evict(frame_id)) {
+        return false;
+      }
+      if (DetachFrame(*frame_id)) {
+        break;
+      }
+      // A lock-free pin got in after the last unpin made the frame evictable. The pin count is not zero any more, so
+      // track the frame again and let its last unpin make it evictable.
+      replacer_->RecordAccess(*frame_id);
+    }
+    // every dirty page may be among the frames that are evicted next, so fewer clean ones than this may be left
+    if (bg_writer_running_ && replacer_->Size() < bg_writer_low_watermark_ + num_dirty_frames_) {
+      bg_writer_cv_.notify_one();
+    }
+  }
+  if (use_ring) {
+    strategy->ring_[strategy->next_slot_] = {this, *frame_id, page_id};
+    strategy->next_slot_ = (strategy->next_slot_ + 1) % strategy->GetRingSize();
+    ring_lock.unlock();
+  }
+
+  // Add to the pin count instead of setting it: a failed lock-free pin may still have to take its pin back.
+  Page *page = &pages_[*frame_id];
+  const page_id_t old_page_id = page->page_id_;
+  page->pin_count_++;
+  page_table_->Insert(page_id, *frame_id);
+  replacer_->RecordAccess(*frame_id);
+  replacer_->SetEvictable(*frame_id, false);
+
+  if (old_page_id != INVALID_PAGE_ID && page->IsDirty()) {
+    foreground_writes_++;
+    lock->unlock();
+    disk_manager_->WritePage(old_page_id, page->GetData());
+    lock->lock();
+  }
+  if (old_page_id != INVALID_PAGE_ID) {
+    page_table_->Remove(old_page_id);
+  }
+  page->page_id_ = page_id;
+  SetDirty(*frame_id, false);
+  return true;
+}
+
+auto BufferPoolManagerInstance::NewPgImp(page_id_t *page_id) -> Page * {
+  return CreatePage(page_id, false, INVALID_PAGE_ID);
+}
+
+auto BufferPoolManagerInstance::NewPgImp(page_id_t *page_id, page_id_t near_page_id) -> Page * {
+  return CreatePage(page_id, true, near_page_id);
+}
+
+auto BufferPoolManagerInstance::CreatePage(page_id_t *page_id, bool near, page_id_t near_page_id) -> Page * {
+  std::unique_lock<std::mutex> lock(latch_);
+  // only allocate a page id once we know that a frame is available
+  if (free_list_.empty() && replacer_->Size() == 0) {
+    return nullptr;
+  }
+  // nobody else knows the new page id yet, so there is no one to wait for
+  const page_id_t new_page_id = near ? AllocatePageNear(near_page_id) : AllocatePage();
+  frame_id_t frame_id;
+  if (!ReserveFrame(new_page_id, &frame_id, &lock)) {
+    DeallocatePage(new_page_id);
+    return nullptr;
+  }
+  pages_[frame_id].ResetMemory();
+  // the id may have been freed and reused, so the zeroed page has to replace the old one on disk
+  SetDirty(frame_id, true);
+  SetFrameState(frame_id, FrameState::READY);
+
+  *page_id = new_page_id;
   return &pages_[frame_id];
 }
 
-auto BufferPoolManagerInstance::FetchPgImp(page_id_t page_id) -> Page * {
-  std::lock_guard<std::mutex> lock(latch_);
+auto BufferPoolManagerInstance::FetchPgImp(page_id_t page_id) -> Page * { return FetchPgImp(page_id, nullptr); }
+
+auto BufferPoolManagerInstance::FetchPgImp(page_id_t page_id, BufferAccessStrategy *strategy) -> Page * {
+  Page *resident_page = PinResidentPage(page_id);
+  if (resident_page != nullptr) {
+    return resident_page;
+  }
+
+  std::unique_lock<std::mutex> lock(latch_);
   // return if found in buffer pool
   frame_id_t frame_id;
-  if (page_table_->Find(page_id, frame_id)) {
+  if (FindReadyFrame(page_id, &frame_id, &lock)) {
     pages_[frame_id].pin_count_++;
     replacer_->SetEvictable(frame_id, false);
+    replacer_->RecordHit(frame_id);
     return &pages_[frame_id];
   }
 
   // try to vacate for the new disk fetched page
-  if (free_list_.empty()) {
-    if (!replacer_->Evict(&frame_id)) {
-      return nullptr;
-    }
-    FlushPgInternal(pages_[frame_id].GetPageId());
+  if (!ReserveFrame(page_id, &frame_id, &lock, strategy)) {
+    return nullptr;
   }
-  frame_id = free_list_.front();
-  free_list_.pop_front();
 
-  // fetch page from disk
-  pages_[frame_id].page_id_ = page_id;
-  pages_[frame_id].is_dirty_ = false;
-  pages_[frame_id].pin_count_ = 1;
+  // fetch page from disk; concurrent fetches of this page wait on the frame instead of reading it a second time
+  SetFrameState(frame_id, FrameState::READING);
+  lock.unlock();
   disk_manager_->ReadPage(page_id, pages_[frame_id].GetData());
-
-  page_table_->Insert(page_id, frame_id);
-  replacer_->RecordAccess(frame_id);
-  replacer_->SetEvictable(frame_id, false);
+  lock.lock();
+  SetFrameState(frame_id, FrameState::READY);
 
   return &pages_[frame_id];
 }
@@ -106,17 +266,17 @@ auto BufferPoolManagerInstance::UnpinPgImp(page_id_t page_id, bool is_dirty) ->
   std::lock_guard<std::mutex> lock(latch_);
   // find page from buffer pool
   frame_id_t frame_id;
-  if (!page_table_->Find(page_id, frame_id)) {
+  if (!page_table_->Find(page_id, &frame_id)) {
     return false;
   }
 
-  // return false if pin_count_ > 0
-  if (pages_[frame_id].pin_count_ <= 0) {
+  // a frame under I/O is only pinned by the thread loading it, which has not handed out the page yet
+  if (frame_states_[frame_id] != FrameState::READY || pages_[frame_id].pin_count_ <= 0) {
     return false;
   }
 
   if (is_dirty) {
-    pages_[frame_id].is_dirty_ = true;
+    SetDirty(frame_id, true);
   }
 
   if (--pages_[frame_id].pin_count_ == 0) {
@@ -127,54 +287,250 @@ auto BufferPoolManagerInstance::UnpinPgImp(page_id_t page_id, bool is_dirty) ->
 }
 
 auto BufferPoolManagerInstance::FlushPgImp(page_id_t page_id) -> bool {
-  std::lock_guard<std::mutex> lock(latch_);
-  return FlushPgInternal(page_id);
+  std::unique_lock<std::mutex> lock(latch_);
+  return FlushPgInternal(page_id, &lock);
 }
 
-auto BufferPoolManagerInstance::FlushPgInternal(page_id_t page_id) -> bool {
+auto BufferPoolManagerInstance::FlushPgInternal(page_id_t page_id, std::unique_lock<std::mutex> *lock) -> bool {
   // find page from buffer pool
   frame_id_t frame_id;
-  if (!page_table_->Find(page_id, frame_id)) {
+  if (!FindReadyFrame(page_id, &frame_id, lock)) {
     return false;
   }
 
-  if (pages_[frame_id].IsDirty()) {
-    disk_manager_->WritePage(page_id, pages_[frame_id].GetData());
+  Page *page = &pages_[frame_id];
+  if (page->IsDirty()) {
+    WriteBackFrames({frame_id}, lock);
   }
 
-  if (pages_[frame_id].pin_count_ > 0) {
-    pages_[frame_id].is_dirty_ = false;
+  if (page->pin_count_ > 0 || page->IsDirty() || !DetachFrame(frame_id)) {
     return true;
   }
 
   // clean up in-mem page if pin_count_ == 0
-  pages_[frame_id].ResetMemory();
-  pages_[frame_id].page_id_ = INVALID_PAGE_ID;
-  pages_[frame_id].is_dirty_ = false;
-  pages_[frame_id].pin_count_ = 0;
+  page->ResetMemory();
+  page->page_id_ = INVALID_PAGE_ID;
+  SetDirty(frame_id, false);
 
   free_list_.emplace_back(frame_id);
   replacer_->Remove(frame_id);
   page_table_->Remove(page_id);
+  SetFrameState(frame_id, FrameState::READY);
   return true;
 }
 
+void BufferPoolManagerInstance::WriteBackFrames(const std::vector<frame_id_t> &frame_ids,
+                                                std::unique_lock<std::mutex> *lock, bool vectored) {
+  std::vector<std::pair<page_id_t, const char *>> pages;
+  for (auto frame_id : frame_ids) {
+    Page *page = &pages_[frame_id];
+    pages.emplace_back(page->page_id_, page->GetData());
+    page->pin_count_++;
+    replacer_->SetEvictable(frame_id, false);
+    SetDirty(frame_id, false);
+  }
+  lock->unlock();
+  if (vectored) {
+    disk_manager_->WritePages(std::move(pages));
+  } else {
+    std::vector<std::future<void>> writes;
+    for (const auto &[page_id, data] : pages) {
+      writes.push_back(disk_manager_->WritePageAsync(page_id, data));
+    }
+    disk_manager_->SubmitIO();
+    for (auto &write : writes) {
+      write.wait();
+    }
+  }
+  lock->lock();
+  for (auto frame_id : frame_ids) {
+    if (--pages_[frame_id].pin_count_ == 0) {
+      replacer_->SetEvictable(frame_id, true);
+    }
+  }
+}
+
+void BufferPoolManagerInstance::RunBackgroundWriter(size_t low_watermark, size_t high_watermark) {
+  std::unique_lock<std::mutex> lock(latch_);
+  if (bg_writer_thread_ != nullptr) {
+    return;
+  }
+  bg_writer_low_watermark_ = low_watermark;
+  bg_writer_high_watermark_ = std::max(low_watermark, high_watermark);
+  bg_writer_running_ = true;
+  bg_writer_thread_ = new std::thread(&BufferPoolManagerInstance::BackgroundWriterLoop, this);
+}
+
+void BufferPoolManagerInstance::StopBackgroundWriter() {
+  {
+    std::unique_lock<std::mutex> lock(latch_);
+    if (bg_writer_thread_ == nullptr) {
+      return;
+    }
+    bg_writer_running_ = false;
+    bg_writer_cv_.notify_one();
+  }
+  bg_writer_thread_->join();
+  delete bg_writer_thread_;
+  bg_writer_thread_ = nullptr;
+}
+
+void BufferPoolManagerInstance::SetDirty(frame_id_t frame_id, bool is_dirty) {
+  if (pages_[frame_id].is_dirty_ != is_dirty) {
+    num_dirty_frames_ = is_dirty ? num_dirty_frames_ + 1 : num_dirty_frames_ - 1;
+    pages_[frame_id].is_dirty_ = is_dirty;
+  }
+}
+
+void BufferPoolManagerInstance::BackgroundWriterLoop() {
+  std::unique_lock<std::mutex> lock(latch_);
+  while (bg_writer_running_) {
+    bg_writer_cv_.wait_for(lock, bgwriter_interval);
+
+    // free frames are handed out before anything is evicted, so they count as clean frames at the head of the order
+    if (free_list_.size() >= bg_writer_high_watermark_) {
+      continue;
+    }
+    std::vector<frame_id_t> frame_ids;
+    for (auto frame_id : replacer_->EvictionCandidates(bg_writer_high_watermark_ - free_list_.size())) {
+      Page *page = &pages_[frame_id];
+      if (page->IsDirty() && page->pin_count_ == 0 && frame_states_[frame_id] == FrameState::READY) {
+        frame_ids.push_back(frame_id);
+      }
+    }
+    WriteBackFrames(frame_ids, &lock);
+    background_writes_ += frame_ids.size();
+  }
+}
+
+void BufferPoolManagerInstance::PrefetchPages(const std::vector<page_id_t> &page_ids,
+                                              BufferAccessStrategy *strategy) {
+  std::call_once(read_ahead_started_, [this] { read_ahead_ = std::make_unique<ReadAhead>(this, disk_manager_); });
+  if (strategy != nullptr) {
+    strategy->SetPrefetcher(this);
+  }
+  read_ahead_->Prefetch(page_ids, strategy);
+}
+
+void BufferPoolManagerInstance::PrefetchChain(page_id_t page_id, size_t depth, NextPageIdFn next,
+                                              BufferAccessStrategy *strategy) {
+  std::call_once(read_ahead_started_, [this] { read_ahead_ = std::make_unique<ReadAhead>(this, disk_manager_); });
+  if (strategy != nullptr) {
+    strategy->SetPrefetcher(this);
+  }
+  read_ahead_->PrefetchChain(page_id, depth, next, strategy);
+}
+
+void BufferPoolManagerInstance::CancelPrefetch(const BufferAccessStrategy *strategy) {
+  // the read-ahead is only started by a hint, and a strategy is only ever handed over with a hint
+  if (read_ahead_ != nullptr) {
+    read_ahead_->Cancel(strategy);
+  }
+}
+
+auto BufferPoolManagerInstance::LoadPages(const std::vector<page_id_t> &page_ids, BufferAccessStrategy *strategy)
+    -> size_t {
+  std::unique_lock<std::mutex> lock(latch_);
+  std::vector<std::pair<page_id_t, frame_id_t>> reads;
+  size_t resident = 0;
+  for (auto page_id : page_ids) {
+    frame_id_t frame_id;
+    if (page_table_->Find(page_id, &frame_id)) {
+      // resident already, or on its way in
+      resident++;
+      continue;
+    }
+    if (!ReserveFrame(page_id, &frame_id, &lock, strategy)) {
+      break;
+    }
+    SetFrameState(frame_id, FrameState::READING);
+    reads.emplace_back(page_id, frame_id);
+  }
+  if (reads.empty()) {
+    return resident;
+  }
+
+  lock.unlock();
+  std::vector<std::future<void>> futures;
+  for (const auto &[page_id, frame_id] : reads) {
+    futures.push_back(disk_manager_->ReadPageAsync(page_id, pages_[frame_id].GetData()));
+  }
+  disk_manager_->SubmitIO();
+  for (auto &future : futures) {
+    future.wait();
+  }
+  lock.lock();
+
+  for (const auto &[page_id, frame_id] : reads) {
+    SetFrameState(frame_id, FrameState::READY);
+    if (--pages_[frame_id].pin_count_ == 0) {
+      replacer_->SetEvictable(frame_id, true);
+    }
+  }
+  return resident + reads.size();
+}
+
 void BufferPoolManagerInstance::FlushAllPgsImp() {
-  for (frame_id_t i = 0; i < static_cast<int>(pool_size_); i++) {
-    FlushPgImp(pages_[i].GetPageId());
+  WriteBackAllPages();
+  disk_manager_->Sync();
+}
+
+void BufferPoolManagerInstance::WriteBackAllPages() {
+  std::unique_lock<std::mutex> lock(latch_);
+  // snapshot the dirty pages in the order of their place in the file
+  std::vector<std::pair<page_id_t, frame_id_t>> dirty;
+  std::vector<page_id_t> under_io;
+  for (size_t i = 0; i < pool_size_; i++) {
+    const page_id_t page_id = pages_[i].page_id_;
+    if (page_id == INVALID_PAGE_ID) {
+      continue;
+    }
+    if (frame_states_[i] != FrameState::READY) {
+      under_io.push_back(page_id);
+    } else if (pages_[i].IsDirty()) {
+      dirty.emplace_back(page_id, static_cast<frame_id_t>(i));
+    }
+  }
+  std::sort(dirty.begin(), dirty.end());
+
+  // only the pages of one batch are pinned at a time, so the rest of the pool stays available for fetches and evictions
+  for (size_t begin = 0; begin < dirty.size(); begin += FLUSH_BATCH_SIZE) {
+    std::vector<frame_id_t> frame_ids;
+    for (size_t i = begin; i < std::min(begin + FLUSH_BATCH_SIZE, dirty.size()); i++) {
+      const auto [page_id, frame_id] = dirty[i];
+      // the page may have been written back or evicted while the latch was released for an earlier batch
+      if (pages_[frame_id].page_id_ != page_id || !pages_[frame_id].IsDirty()) {
+        continue;
+      }
+      if (frame_states_[frame_id] == FrameState::READY) {
+        frame_ids.push_back(frame_id);
+      } else {
+        under_io.push_back(page_id);
+      }
+    }
+    WriteBackFrames(frame_ids, &lock, true);
+  }
+
+  // pages that were being read or evicted: wait for the I/O, so that an eviction's write is covered by the next sync
+  for (auto page_id : under_io) {
+    frame_id_t frame_id;
+    if (FindReadyFrame(page_id, &frame_id, &lock) && pages_[frame_id].IsDirty()) {
+      WriteBackFrames({frame_id}, &lock);
+    }
   }
 }
 
 auto BufferPoolManagerInstance::DeletePgImp(page_id_t page_id) -> bool {
-  std::lock_guard<std::mutex> lock(latch_);
+  std::unique_lock<std::mutex> lock(latch_);
   // find page from buffer pool
   frame_id_t frame_id;
-  if (!page_table_->Find(page_id, frame_id)) {
+  if (!FindReadyFrame(page_id, &frame_id, &lock)) {
+    DeallocatePage(page_id);
     return true;
   }
 
   // return false if pin_count_ > 0
-  if (pages_[frame_id].pin_count_ > 0) {
+  if (pages_[frame_id].pin_count_ > 0 || !DetachFrame(frame_id)) {
     return false;
   }
 
@@ -184,8 +540,8 @@ auto BufferPoolManagerInstance::DeletePgImp(page_id_t page_id) -> bool {
 
   pages_[frame_id].ResetMemory();
   pages_[frame_id].page_id_ = INVALID_PAGE_ID;
-  pages_[frame_id].is_dirty_ = false;
-  pages_[frame_id].pin_count_ = 0;
+  SetDirty(frame_id, false);
+  SetFrameState(frame_id, FrameState::READY);
 
   DeallocatePage(page_id);
   return true;
@@ -198,8 +554,22 @@ int BufferPoolManagerInstance::GetFreeEvictableSize() {
   return  replacer_->Size();
 }
 auto BufferPoolManagerInstance::AllocatePage() -> page_id_t {
-     
-      return next_page_id_++; 
-   }
+  const page_id_t next_page_id = disk_manager_->AllocatePage(instance_index_, num_instances_);
+  ValidatePageId(next_page_id);
+  return next_page_id;
+}
+
+auto BufferPoolManagerInstance::AllocatePageNear(page_id_t near_page_id) -> page_id_t {
+  const page_id_t next_page_id = disk_manager_->AllocatePageNear(near_page_id, instance_index_, num_instances_);
+  ValidatePageId(next_page_id);
+  return next_page_id;
+}
+
+void BufferPoolManagerInstance::DeallocatePage(page_id_t page_id) { disk_manager_->DeallocatePage(page_id); }
+
+void BufferPoolManagerInstance::ValidatePageId(const page_id_t page_id) const {
+  // allocated pages mod back to this BPI
+  BUSTUB_ASSERT(page_id % num_instances_ == instance_index_, "page id does not belong to this instance");
+}
 
-}  // namespace bustub
\ No newline at end of file
+}  // namespace bustub
\ No newline at end of file
@@ -12,18 +12,109 @@
 
 #include "buffer/clock_replacer.h"
 
+#include <algorithm>
+#include <tuple>
+
 namespace bustub {
 
-ClockReplacer::ClockReplacer(size_t num_pages) {}
+ClockReplacer::ClockReplacer(size_t num_frames) : num_frames_(num_frames), status_(num_frames), usage_(num_frames) {
+  for (size_t i = 0; i < num_frames_; i++) {
+    status_[i] = FrameStatus::UNTRACKED;
+    usage_[i] = 0;
+  }
+}
+
+auto ClockReplacer::Evict(frame_id_t *frame_id) -> bool {
+  // Every turn of the hand decrements the usage count of every evictable frame, so an undisturbed sweep finds a victim
+  // within MAX_USAGE_COUNT + 1 turns. Concurrent hits add turns, but the buffer pool pins a
+  // frame on every hit, which takes it out of the sweep, so the sweep goes on for as long as some frame is evictable.
+  while (curr_size_ > 0) {
+    const auto candidate = static_cast<frame_id_t>(hand_.fetch_add(1, std::memory_order_relaxed) % num_frames_);
+    if (status_[candidate] != FrameStatus::EVICTABLE) {
+      continue;
+    }
+    uint32_t usage = usage_[candidate].load(std::memory_order_relaxed);
+    if (usage > 0) {
+      // a hit that comes in between wins, and the frame gets another turn
+      usage_[candidate].compare_exchange_strong(usage, usage - 1, std::memory_order_relaxed);
+      continue;
+    }
+    auto expected = FrameStatus::EVICTABLE;
+    if (status_[candidate].compare_exchange_strong(expected, FrameStatus::UNTRACKED)) {
+      curr_size_--;
+      *frame_id = candidate;
+      return true;
+    }
+  }
+  return false;
+}
+
+auto ClockReplacer::EvictionCandidates(size_t max_count) -> std::vector<frame_id_t> {
+  const size_t hand = hand_.load(std::memory_order_relaxed);
+  std::vector<std::tuple<uint32_t, size_t, frame_id_t>> evictable;
+  for (size_t distance = 0; distance < num_frames_; distance++) {
+    const auto frame_id = static_cast<frame_id_t>((hand + distance) % num_frames_);
+    if (status_[frame_id] == FrameStatus::EVICTABLE) {
+      evictable.emplace_back(usage_[frame_id].load(std::memory_order_relaxed), distance, frame_id);
+    }
+  }
+  std::sort(evictable.begin(), evictable.end());
+
+  std::vector<frame_id_t> candidates;
+  for (size_t i = 0; i < evictable.size() && candidates.size() < max_count; i++) {
+    candidates.push_back(std::get<2>(evictable[i]));
+  }
+  return candidates;
+}
 
-ClockReplacer::~ClockReplacer() = default;
+void ClockReplacer::RecordAccess(frame_id_t frame_id) {
+  if (!IsValid(frame_id)) {
+    return;
+  }
+  auto expected = FrameStatus::UNTRACKED;
+  if (status_[frame_id].compare_exchange_strong(expected, FrameStatus::PINNED)) {
+    usage_[frame_id].store(1, std::memory_order_relaxed);
+    return;
+  }
+  RecordHit(frame_id);
+}
 
-auto ClockReplacer::Victim(frame_id_t *frame_id) -> bool { return false; }
+void ClockReplacer::RecordHit(frame_id_t frame_id) {
+  if (!IsValid(frame_id)) {
+    return;
+  }
+  // Concurrent hits may push the count a little past the maximum, which only costs the frame a few extra turns.
+  if (usage_[frame_id].load(std::memory_order_relaxed) < MAX_USAGE_COUNT) {
+    usage_[frame_id].fetch_add(1, std::memory_order_relaxed);
+  }
+}
 
-void ClockReplacer::Pin(frame_id_t frame_id) {}
+void ClockReplacer::SetEvictable(frame_id_t frame_id, bool set_evictable) {
+  if (!IsValid(frame_id)) {
+    return;
+  }
+  auto expected = set_evictable ? FrameStatus::PINNED : FrameStatus::EVICTABLE;
+  const auto desired = set_evictable ? FrameStatus::EVICTABLE : FrameStatus::PINNED;
+  if (!status_[frame_id].compare_exchange_strong(expected, desired)) {
+    return;
+  }
+  if (set_evictable) {
+    curr_size_++;
+  } else {
+    curr_size_--;
+  }
+}
 
-void ClockReplacer::Unpin(frame_id_t frame_id) {}
+void ClockReplacer::Remove(frame_id_t frame_id) {
+  if (!IsValid(frame_id)) {
+    return;
+  }
+  if (status_[frame_id].exchange(FrameStatus::UNTRACKED) == FrameStatus::EVICTABLE) {
+    curr_size_--;
+  }
+  usage_[frame_id].store(0, std::memory_order_relaxed);
+}
 
-auto ClockReplacer::Size() -> size_t { return 0; }
+auto ClockReplacer::Size() -> size_t { return curr_size_; }
 
 }  // namespace bustub
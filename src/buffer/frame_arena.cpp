@@ -0,0 +1,58 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// frame_arena.cpp
+//
+// Identification: src/buffer/frame_arena.cpp
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/frame_arena.h"
+
+#include <sys/mman.h>
+
+#include <cstdint>
+#include <new>
+
+namespace bustub {
+
+FrameArena::FrameArena(size_t num_frames, bool huge_pages) : length_(num_frames * BUSTUB_PAGE_SIZE) {
+  if (length_ == 0) {
+    length_ = BUSTUB_PAGE_SIZE;
+  }
+  huge_pages = huge_pages && length_ >= HUGE_PAGE_SIZE;
+  if (huge_pages) {
+    // whole huge pages only, or the tail of the arena ends up in small pages
+    length_ = (length_ + HUGE_PAGE_SIZE - 1) / HUGE_PAGE_SIZE * HUGE_PAGE_SIZE;
+  }
+
+  // mmap only guarantees alignment to the base page size, so map one extra huge page and trim it off
+  const size_t slack = huge_pages ? HUGE_PAGE_SIZE : 0;
+  void *mapping = mmap(nullptr, length_ + slack, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if (mapping == MAP_FAILED) {
+    throw std::bad_alloc();
+  }
+  auto *base = static_cast<char *>(mapping);
+  data_ = base;
+  if (huge_pages) {
+    const auto address = reinterpret_cast<uintptr_t>(base);
+    data_ = base + (HUGE_PAGE_SIZE - address % HUGE_PAGE_SIZE) % HUGE_PAGE_SIZE;
+    if (data_ != base) {
+      munmap(base, data_ - base);
+    }
+    const size_t tail = slack - (data_ - base);
+    if (tail > 0) {
+      munmap(data_ + length_, tail);
+    }
+#ifdef MADV_HUGEPAGE
+    huge_page_backed_ = madvise(data_, length_, MADV_HUGEPAGE) == 0;
+#endif
+  }
+}
+
+FrameArena::~FrameArena() { munmap(data_, length_); }
+
+}  // namespace bustub
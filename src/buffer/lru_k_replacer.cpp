@@ -12,114 +12,120 @@
 
 #include "buffer/lru_k_replacer.h"
 
-namespace bustub {
+#include "common/exception.h"
 
-  LRUKReplacer::LRUKReplacer(size_t num_frames, size_t k): replacer_size_(num_frames), k_(k) {
-    historyQueue = std::unordered_map < frame_id_t, std::list < size_t >> ();
-    lastAccesedQueue = std::unordered_map < frame_id_t, size_t > ();
+namespace bustub {
 
+LRUKReplacer::LRUKReplacer(size_t num_frames, size_t k)
+    : replacer_size_(num_frames), k_(k), frames_(num_frames), history_(num_frames * k) {
+  BUSTUB_ASSERT(k > 0, "LRU-K needs at least one access per frame");
+}
+
+auto LRUKReplacer::IndexKeyOf(frame_id_t frame_id) const -> IndexKey {
+  const auto &entry = frames_[frame_id];
+  // Until the ring wraps around, slot 0 holds the earliest access. Once it is full, the slot that is overwritten
+  // next holds the kth most recent access.
+  const size_t slot = HasInfDistance(entry) ? 0 : entry.next_;
+  return {history_[frame_id * k_ + slot], frame_id};
+}
+
+auto LRUKReplacer::IndexOf(const FrameEntry &entry) -> std::set<IndexKey> & {
+  return HasInfDistance(entry) ? inf_index_ : k_index_;
+}
+
+void LRUKReplacer::CheckFrameId(frame_id_t frame_id) const {
+  if (frame_id < 0 || frame_id >= static_cast<frame_id_t>(replacer_size_)) {
+    throw Exception(ExceptionType::OUT_OF_RANGE, "invalid frame id");
   }
+}
 
-  auto LRUKReplacer::Evict(frame_id_t * frame_id) -> bool {
-    std::scoped_lock < std::mutex > lock(latch_);
-    // initialize frame_id with an invalid value
-    * frame_id = -1;
-       IncrementTimeStamp();
-    if (historyQueue.empty() && lastAccesedQueue.empty()) {
-      return false;
-    }
-    size_t lastRecentlyUsedts = current_timestamp_;
-    if (!historyQueue.empty()) {
-        //This means we do have infinity time stamp in our queues shoud LRU is used!!
-      for (auto kv_pair: historyQueue) {
-        //Bring The one the LRU frame
-        if (IsEvictable.find(kv_pair.first) != IsEvictable.end() && kv_pair.second.front() < lastRecentlyUsedts) {
-          * frame_id = kv_pair.first;
-            lastRecentlyUsedts = kv_pair.second.front();
-        }
-      }
-     
-    }
-
-      if (historyQueue.find(*frame_id) != historyQueue.end()) {
-      historyQueue.erase( * frame_id);
-      IsEvictable.erase( * frame_id);
-      return true;
+void LRUKReplacer::ResetFrame(frame_id_t frame_id) {
+  auto &entry = frames_[frame_id];
+  if (entry.evictable_) {
+    curr_size_--;
   }
-
-        //HERE WE DON'T HAVE INFINITY SO USE LRU-K
-    for (auto kv_pair: lastAccesedQueue) {
-      if (IsEvictable.find(kv_pair.first) != IsEvictable.end() && kv_pair.second  < lastRecentlyUsedts) {
-        * frame_id = kv_pair.first;
-        lastRecentlyUsedts = kv_pair.second;
-      }
-    }
-    if ( * frame_id == -1) {
-      return false;
-    }
-    lastAccesedQueue.erase( * frame_id);
-    IsEvictable.erase( * frame_id);
-    return true;
-
+  entry = FrameEntry{};
+}
+
+auto LRUKReplacer::Evict(frame_id_t *frame_id) -> bool {
+  std::scoped_lock<std::mutex> lock(latch_);
+  // frames with +inf backward k-distance always go first, in LRU order
+  auto &index = inf_index_.empty() ? k_index_ : inf_index_;
+  if (index.empty()) {
+    return false;
   }
-
-  void LRUKReplacer::RecordAccess(frame_id_t frame_id) {
-    std::scoped_lock < std::mutex > lock(latch_);
-    IncrementTimeStamp();
-    if (frame_id >= static_cast < int > (replacer_size_)) {
-      return;
-    }
-    if (lastAccesedQueue.find(frame_id) != lastAccesedQueue.end()) {
-      lastAccesedQueue[frame_id] = current_timestamp_;
-      return;
-    }
-    if (historyQueue.find(frame_id) == historyQueue.end()) {
-      historyQueue[frame_id] = std::list < size_t > ();
-    }
-
-    // insert into history queue
-    historyQueue[frame_id].push_back(current_timestamp_);
-
-    // move it to cache queue if accessed more than k times
-    if (historyQueue[frame_id].size() >= k_) {
-      lastAccesedQueue[frame_id] = current_timestamp_;
-      historyQueue.erase(frame_id);
+  *frame_id = index.begin()->second;
+  index.erase(index.begin());
+  ResetFrame(*frame_id);
+  return true;
+}
+
+auto LRUKReplacer::EvictionCandidates(size_t max_count) -> std::vector<frame_id_t> {
+  std::scoped_lock<std::mutex> lock(latch_);
+  std::vector<frame_id_t> candidates;
+  for (const auto *index : {&inf_index_, &k_index_}) {
+    for (auto it = index->begin(); it != index->end() && candidates.size() < max_count; ++it) {
+      candidates.push_back(it->second);
     }
   }
-
-  void LRUKReplacer::SetEvictable(frame_id_t frame_id, bool set_evictable) {
-    //This is sth like Pin, and UnPin in the ClockReplacer policy
-    std::scoped_lock < std::mutex > lock(latch_);
-    IncrementTimeStamp();
-    if (set_evictable && historyQueue.find(frame_id) == historyQueue.end() &&
-      lastAccesedQueue.find(frame_id) == lastAccesedQueue.end()) {
-      return;
-    }
-    if (set_evictable) {
-      IsEvictable[frame_id] = true;
-    } else {
-      IsEvictable.erase(frame_id);
-    }
+  return candidates;
+}
+
+void LRUKReplacer::RecordAccess(frame_id_t frame_id) {
+  CheckFrameId(frame_id);
+  std::scoped_lock<std::mutex> lock(latch_);
+  auto &entry = frames_[frame_id];
+  // the key changes with this access, so an evictable frame has to be re-indexed
+  if (entry.evictable_) {
+    IndexOf(entry).erase(IndexKeyOf(frame_id));
   }
 
-  void LRUKReplacer::Remove(frame_id_t frame_id) {
-    std::scoped_lock < std::mutex > lock(latch_);
-    current_timestamp_++;
-    historyQueue.erase(frame_id);
-    lastAccesedQueue.erase(frame_id);
-    IsEvictable.erase(frame_id);
-
+  history_[frame_id * k_ + entry.next_] = ++current_timestamp_;
+  entry.next_ = (entry.next_ + 1) % k_;
+  if (entry.count_ < k_) {
+    entry.count_++;
   }
 
-  auto LRUKReplacer::Size() -> size_t {
-    std::scoped_lock < std::mutex > lock(latch_);
-    return IsEvictable.size();
+  if (entry.evictable_) {
+    IndexOf(entry).insert(IndexKeyOf(frame_id));
+  }
+}
+
+void LRUKReplacer::SetEvictable(frame_id_t frame_id, bool set_evictable) {
+  // This is sth like Pin, and UnPin in the ClockReplacer policy
+  CheckFrameId(frame_id);
+  std::scoped_lock<std::mutex> lock(latch_);
+  auto &entry = frames_[frame_id];
+  if (entry.count_ == 0 || entry.evictable_ == set_evictable) {
+    return;
+  }
 
+  entry.evictable_ = set_evictable;
+  if (set_evictable) {
+    IndexOf(entry).insert(IndexKeyOf(frame_id));
+    curr_size_++;
+  } else {
+    IndexOf(entry).erase(IndexKeyOf(frame_id));
+    curr_size_--;
+  }
+}
+
+void LRUKReplacer::Remove(frame_id_t frame_id) {
+  CheckFrameId(frame_id);
+  std::scoped_lock<std::mutex> lock(latch_);
+  auto &entry = frames_[frame_id];
+  if (entry.count_ == 0) {
+    return;
   }
-  void LRUKReplacer::IncrementTimeStamp() {
-    current_timestamp_++;
+  if (entry.evictable_) {
+    IndexOf(entry).erase(IndexKeyOf(frame_id));
   }
+  ResetFrame(frame_id);
+}
 
-} // namespace bustub
+auto LRUKReplacer::Size() -> size_t {
+  std::scoped_lock<std::mutex> lock(latch_);
+  return curr_size_;
+}
 
- 
\ No newline at end of file
+}  // namespace bustub
\ No newline at end of file
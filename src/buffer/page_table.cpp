@@ -0,0 +1,99 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// page_table.cpp
+//
+// Identification: src/buffer/page_table.cpp
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/page_table.h"
+
+namespace bustub {
+
+PageTable::PageTable(size_t num_frames) {
+  size_t capacity = 4;
+  shift_ = 62;
+  while (capacity < 4 * num_frames) {
+    capacity <<= 1;
+    shift_--;
+  }
+  mask_ = capacity - 1;
+  slots_ = std::make_unique<std::atomic<uint64_t>[]>(capacity);
+  for (size_t i = 0; i < capacity; i++) {
+    slots_[i].store(EMPTY_SLOT, std::memory_order_relaxed);
+  }
+}
+
+auto PageTable::HomeSlot(page_id_t page_id) const -> size_t {
+  // Fibonacci hashing spreads the strided page ids of a parallel buffer pool instance evenly
+  return static_cast<size_t>((static_cast<uint64_t>(static_cast<uint32_t>(page_id)) * 0x9E3779B97F4A7C15ULL) >> shift_);
+}
+
+auto PageTable::Find(page_id_t page_id, frame_id_t *frame_id) const -> bool {
+  size_t idx = HomeSlot(page_id);
+  for (size_t probes = 0; probes <= mask_; probes++) {
+    const uint64_t slot = slots_[idx].load(std::memory_order_acquire);
+    if (slot == EMPTY_SLOT) {
+      return false;
+    }
+    if (PageIdOf(slot) == page_id) {
+      *frame_id = FrameIdOf(slot);
+      return true;
+    }
+    idx = (idx + 1) & mask_;
+  }
+  return false;
+}
+
+void PageTable::Insert(page_id_t page_id, frame_id_t frame_id) {
+  BUSTUB_ASSERT(page_id != INVALID_PAGE_ID, "cannot map the invalid page id");
+  size_t idx = HomeSlot(page_id);
+  for (size_t probes = 0; probes <= mask_; probes++) {
+    const uint64_t slot = slots_[idx].load(std::memory_order_relaxed);
+    if (slot == EMPTY_SLOT || PageIdOf(slot) == page_id) {
+      slots_[idx].store(Pack(page_id, frame_id), std::memory_order_release);
+      return;
+    }
+    idx = (idx + 1) & mask_;
+  }
+  UNREACHABLE("page table is full");
+}
+
+auto PageTable::Remove(page_id_t page_id) -> bool {
+  size_t hole = HomeSlot(page_id);
+  for (size_t probes = 0;; probes++) {
+    const uint64_t slot = slots_[hole].load(std::memory_order_relaxed);
+    if (slot == EMPTY_SLOT || probes > mask_) {
+      return false;
+    }
+    if (PageIdOf(slot) == page_id) {
+      break;
+    }
+    hole = (hole + 1) & mask_;
+  }
+
+  // Close the hole by moving back every later entry of the cluster whose home slot does not lie cyclically in
+  // (hole, idx]; otherwise a lookup for it would stop at the hole.
+  size_t idx = hole;
+  while (true) {
+    idx = (idx + 1) & mask_;
+    const uint64_t slot = slots_[idx].load(std::memory_order_relaxed);
+    if (slot == EMPTY_SLOT) {
+      break;
+    }
+    const size_t home = HomeSlot(PageIdOf(slot));
+    const bool stays = hole < idx ? (hole < home && home <= idx) : (hole < home || home <= idx);
+    if (!stays) {
+      slots_[hole].store(slot, std::memory_order_release);
+      hole = idx;
+    }
+  }
+  slots_[hole].store(EMPTY_SLOT, std::memory_order_release);
+  return true;
+}
+
+}  // namespace bustub
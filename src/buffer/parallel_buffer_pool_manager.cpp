@@ -0,0 +1,204 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// parallel_buffer_pool_manager.cpp
+//
+// Identification: src/buffer/parallel_buffer_pool_manager.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/parallel_buffer_pool_manager.h"
+
+#include "common/macros.h"
+
+namespace bustub {
+
+ParallelBufferPoolManager::ParallelBufferPoolManager(size_t num_instances, size_t pool_size, DiskManager *disk_manager,
+                                                     size_t replacer_k, LogManager *log_manager, ReplacerPolicy policy)
+    : disk_manager_(disk_manager) {
+  BUSTUB_ASSERT(num_instances > 0, "A parallel buffer pool needs at least one instance");
+  instances_.reserve(num_instances);
+  for (size_t i = 0; i < num_instances; ++i) {
+    instances_.emplace_back(std::make_unique<BufferPoolManagerInstance>(
+        pool_size, static_cast<uint32_t>(num_instances), static_cast<uint32_t>(i), disk_manager, replacer_k,
+        log_manager, policy));
+  }
+}
+
+ParallelBufferPoolManager::~ParallelBufferPoolManager() {
+  // the read-ahead worker fetches through the instances, so it has to stop before they go away
+  read_ahead_.reset();
+}
+
+auto ParallelBufferPoolManager::GetPoolSize() -> size_t {
+  size_t pool_size = 0;
+  for (auto &instance : instances_) {
+    pool_size += instance->GetPoolSize();
+  }
+  return pool_size;
+}
+
+auto ParallelBufferPoolManager::GetFreeListSize() -> int {
+  int free_list_size = 0;
+  for (auto &instance : instances_) {
+    free_list_size += instance->GetFreeListSize();
+  }
+  return free_list_size;
+}
+
+auto ParallelBufferPoolManager::GetFreeEvictableSize() -> int {
+  int evictable_size = 0;
+  for (auto &instance : instances_) {
+    evictable_size += instance->GetFreeEvictableSize();
+  }
+  return evictable_size;
+}
+
+void ParallelBufferPoolManager::RunBackgroundWriter(size_t low_watermark, size_t high_watermark) {
+  for (auto &instance : instances_) {
+    instance->RunBackgroundWriter(low_watermark, high_watermark);
+  }
+}
+
+void ParallelBufferPoolManager::StopBackgroundWriter() {
+  for (auto &instance : instances_) {
+    instance->StopBackgroundWriter();
+  }
+}
+
+auto ParallelBufferPoolManager::GetForegroundWriteCount() const -> uint64_t {
+  uint64_t writes = 0;
+  for (const auto &instance : instances_) {
+    writes += instance->GetForegroundWriteCount();
+  }
+  return writes;
+}
+
+auto ParallelBufferPoolManager::GetBackgroundWriteCount() const -> uint64_t {
+  uint64_t writes = 0;
+  for (const auto &instance : instances_) {
+    writes += instance->GetBackgroundWriteCount();
+  }
+  return writes;
+}
+
+void ParallelBufferPoolManager::PrefetchPages(const std::vector<page_id_t> &page_ids,
+                                              BufferAccessStrategy *strategy) {
+  std::call_once(read_ahead_started_, [this] { read_ahead_ = std::make_unique<ReadAhead>(this, disk_manager_); });
+  if (strategy != nullptr) {
+    strategy->SetPrefetcher(this);
+  }
+  read_ahead_->Prefetch(page_ids, strategy);
+}
+
+void ParallelBufferPoolManager::PrefetchChain(page_id_t page_id, size_t depth, NextPageIdFn next,
+                                              BufferAccessStrategy *strategy) {
+  std::call_once(read_ahead_started_, [this] { read_ahead_ = std::make_unique<ReadAhead>(this, disk_manager_); });
+  if (strategy != nullptr) {
+    strategy->SetPrefetcher(this);
+  }
+  read_ahead_->PrefetchChain(page_id, depth, next, strategy);
+}
+
+void ParallelBufferPoolManager::CancelPrefetch(const BufferAccessStrategy *strategy) {
+  // the read-ahead is only started by a hint, and a strategy is only ever handed over with a hint
+  if (read_ahead_ != nullptr) {
+    read_ahead_->Cancel(strategy);
+  }
+}
+
+auto ParallelBufferPoolManager::LoadPages(const std::vector<page_id_t> &page_ids, BufferAccessStrategy *strategy)
+    -> size_t {
+  std::vector<std::vector<page_id_t>> instance_page_ids(instances_.size());
+  for (auto page_id : page_ids) {
+    if (page_id != INVALID_PAGE_ID) {
+      instance_page_ids[static_cast<size_t>(page_id) % instances_.size()].push_back(page_id);
+    }
+  }
+  size_t loaded = 0;
+  for (size_t i = 0; i < instances_.size(); i++) {
+    if (!instance_page_ids[i].empty()) {
+      loaded += instances_[i]->LoadPages(instance_page_ids[i], strategy);
+    }
+  }
+  return loaded;
+}
+
+auto ParallelBufferPoolManager::GetBufferPoolManager(page_id_t page_id) -> BufferPoolManagerInstance * {
+  BUSTUB_ASSERT(page_id >= 0, "Cannot route an invalid page id to an instance");
+  return instances_[static_cast<size_t>(page_id) % instances_.size()].get();
+}
+
+auto ParallelBufferPoolManager::FetchPgImp(page_id_t page_id) -> Page * {
+  if (page_id == INVALID_PAGE_ID) {
+    return nullptr;
+  }
+  return GetBufferPoolManager(page_id)->FetchPage(page_id);
+}
+
+auto ParallelBufferPoolManager::FetchPgImp(page_id_t page_id, BufferAccessStrategy *strategy) -> Page * {
+  if (page_id == INVALID_PAGE_ID) {
+    return nullptr;
+  }
+  return GetBufferPoolManager(page_id)->FetchPage(page_id, strategy);
+}
+
+auto ParallelBufferPoolManager::UnpinPgImp(page_id_t page_id, bool is_dirty) -> bool {
+  if (page_id == INVALID_PAGE_ID) {
+    return false;
+  }
+  return GetBufferPoolManager(page_id)->UnpinPage(page_id, is_dirty);
+}
+
+auto ParallelBufferPoolManager::FlushPgImp(page_id_t page_id) -> bool {
+  if (page_id == INVALID_PAGE_ID) {
+    return false;
+  }
+  return GetBufferPoolManager(page_id)->FlushPage(page_id);
+}
+
+auto ParallelBufferPoolManager::NewPgImp(page_id_t *page_id) -> Page * {
+  // Each call starts at a different instance so that new pages (and the latch traffic that comes with them) spread
+  // evenly over the shards. A full sweep that finds no free frame anywhere means the whole pool is pinned.
+  const size_t num_instances = instances_.size();
+  const size_t start = next_instance_.fetch_add(1) % num_instances;
+  for (size_t i = 0; i < num_instances; ++i) {
+    Page *page = instances_[(start + i) % num_instances]->NewPage(page_id);
+    if (page != nullptr) {
+      return page;
+    }
+  }
+  return nullptr;
+}
+
+auto ParallelBufferPoolManager::NewPgImp(page_id_t *page_id, page_id_t near_page_id) -> Page * {
+  const size_t num_instances = instances_.size();
+  const size_t start = next_instance_.fetch_add(1) % num_instances;
+  for (size_t i = 0; i < num_instances; ++i) {
+    Page *page = instances_[(start + i) % num_instances]->NewPage(page_id, near_page_id);
+    if (page != nullptr) {
+      return page;
+    }
+  }
+  return nullptr;
+}
+
+auto ParallelBufferPoolManager::DeletePgImp(page_id_t page_id) -> bool {
+  if (page_id == INVALID_PAGE_ID) {
+    return true;
+  }
+  return GetBufferPoolManager(page_id)->DeletePage(page_id);
+}
+
+void ParallelBufferPoolManager::FlushAllPgsImp() {
+  // the instances share one file, so a single sync after all of them covers every write
+  for (auto &instance : instances_) {
+    instance->WriteBackAllPages();
+  }
+  disk_manager_->Sync();
+}
+
+}  // namespace bustub
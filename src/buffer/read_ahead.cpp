@@ -0,0 +1,142 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// read_ahead.cpp
+//
+// Identification: src/buffer/read_ahead.cpp
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/read_ahead.h"
+
+#include <algorithm>
+
+namespace bustub {
+
+ReadAhead::ReadAhead(BufferPoolManager *bpm, DiskManager *disk_manager)
+    : bpm_(bpm), disk_manager_(disk_manager), worker_(&ReadAhead::WorkerLoop, this) {
+  if (disk_manager != nullptr) {
+    shutdown_hook_id_ = disk_manager->AddShutdownHook([this] {
+      Stop();
+      disk_manager_ = nullptr;
+    });
+  }
+}
+
+ReadAhead::~ReadAhead() {
+  Stop();
+  if (DiskManager *disk_manager = disk_manager_; disk_manager != nullptr) {
+    disk_manager->RemoveShutdownHook(shutdown_hook_id_);
+  }
+}
+
+void ReadAhead::Stop() {
+  {
+    std::scoped_lock<std::mutex> lock(latch_);
+    if (!running_) {
+      return;
+    }
+    running_ = false;
+  }
+  cv_.notify_one();
+  worker_.join();
+}
+
+void ReadAhead::Prefetch(const std::vector<page_id_t> &page_ids, BufferAccessStrategy *strategy) {
+  {
+    std::scoped_lock<std::mutex> lock(latch_);
+    if (!running_) {
+      return;
+    }
+    for (auto page_id : page_ids) {
+      if (page_id == INVALID_PAGE_ID || queue_.size() >= MAX_QUEUED_REQUESTS) {
+        continue;
+      }
+      queue_.push_back({page_id, 0, nullptr, strategy});
+    }
+  }
+  cv_.notify_one();
+}
+
+void ReadAhead::PrefetchChain(page_id_t page_id, size_t depth, BufferPoolManager::NextPageIdFn next,
+                              BufferAccessStrategy *strategy) {
+  if (page_id == INVALID_PAGE_ID || depth == 0) {
+    return;
+  }
+  {
+    std::scoped_lock<std::mutex> lock(latch_);
+    if (!running_ || queue_.size() >= MAX_QUEUED_REQUESTS) {
+      return;
+    }
+    queue_.push_back({page_id, depth, next, strategy});
+  }
+  cv_.notify_one();
+}
+
+void ReadAhead::Cancel(const BufferAccessStrategy *strategy) {
+  std::unique_lock<std::mutex> lock(latch_);
+  // the request that is being served may queue the next page of its chain, so it has to finish first
+  served_cv_.wait(lock, [&] { return serving_ != strategy; });
+  queue_.erase(std::remove_if(queue_.begin(), queue_.end(),
+                              [&](const Request &request) { return request.strategy_ == strategy; }),
+               queue_.end());
+}
+
+void ReadAhead::WorkerLoop() {
+  std::unique_lock<std::mutex> lock(latch_);
+  while (true) {
+    cv_.wait(lock, [this] { return !running_ || !queue_.empty(); });
+    if (!running_) {
+      return;
+    }
+    if (queue_.front().next_ == nullptr) {
+      // plain hints do not depend on each other, so read them in one batch
+      BufferAccessStrategy *strategy = queue_.front().strategy_;
+      std::vector<page_id_t> page_ids;
+      while (!queue_.empty() && queue_.front().next_ == nullptr && queue_.front().strategy_ == strategy &&
+             page_ids.size() < MAX_BATCHED_READS) {
+        page_ids.push_back(queue_.front().page_id_);
+        queue_.pop_front();
+      }
+      serving_ = strategy;
+      lock.unlock();
+      prefetch_count_ += bpm_->LoadPages(page_ids, strategy);
+      lock.lock();
+      serving_ = nullptr;
+      served_cv_.notify_all();
+      continue;
+    }
+
+    Request request = queue_.front();
+    queue_.pop_front();
+    serving_ = request.strategy_;
+    lock.unlock();
+
+    Page *page = bpm_->FetchPage(request.page_id_, request.strategy_);
+    if (page != nullptr) {
+      prefetch_count_++;
+      page_id_t next_page_id = INVALID_PAGE_ID;
+      if (request.chain_depth_ > 0) {
+        page->RLatch();
+        next_page_id = request.next_(page);
+        page->RUnlatch();
+      }
+      bpm_->UnpinPage(request.page_id_, false);
+
+      lock.lock();
+      // follow the chain before anything else, it is what the scan is going to read next
+      if (next_page_id != INVALID_PAGE_ID) {
+        queue_.push_front({next_page_id, request.chain_depth_ - 1, request.next_, request.strategy_});
+      }
+    } else {
+      lock.lock();
+    }
+    serving_ = nullptr;
+    served_cv_.notify_all();
+  }
+}
+
+}  // namespace bustub
@@ -1,6 +1,7 @@
 #include "catalog/table_generator.h"
 
 #include <algorithm>
+#include <memory>
 #include <random>
 #include <vector>
 
@@ -70,17 +71,21 @@ void TableGenerator::FillTable(TableInfo *info, TableInsertMeta *table_meta) {
     for (auto &col_meta : table_meta->col_meta_) {
       values.emplace_back(MakeValues(&col_meta, num_values));
     }
+    std::vector<std::unique_ptr<TupleRecord>> tuples;
+    std::vector<const TupleRecord *> batch;
     for (uint32_t i = 0; i < num_values; i++) {
       std::vector<Value> entry;
       entry.reserve(values.size());
       for (const auto &col : values) {
         entry.emplace_back(col[i]);
       }
-      RID rid;
-      bool inserted = info->table_->InsertTuple(TupleRecord(entry, &info->schema_), &rid, exec_ctx_->GetTransaction());
-      BUSTUB_ENSURE(inserted, "Sequential insertion cannot fail");
-      num_inserted++;
+      tuples.emplace_back(std::make_unique<TupleRecord>(entry, &info->schema_));
+      batch.push_back(tuples.back().get());
     }
+    std::vector<RID> rids;
+    bool inserted = info->table_->InsertTuples(batch, &rids, exec_ctx_->GetTransaction());
+    BUSTUB_ENSURE(inserted, "Sequential insertion cannot fail");
+    num_inserted += num_values;
   }
 }
 
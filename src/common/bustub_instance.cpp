@@ -1,3 +1,4 @@
+#include <algorithm>
 #include <optional>
 #include <shared_mutex>
 #include <string>
@@ -11,7 +12,9 @@
 #include "binder/statement/index_statement.h"
 #include "binder/statement/select_statement.h"
 #include "binder/statement/set_show_statement.h"
+#include "binder/statement/vacuum_statement.h"
 #include "buffer/buffer_pool_manager_instance.h"
+#include "buffer/parallel_buffer_pool_manager.h"
 #include "catalog/schema.h"
 #include "catalog/table_generator.h"
 #include "common/bustub_instance.h"
@@ -42,11 +45,33 @@ auto BustubInstance::MakeExecutorContext(Transaction *txn) -> std::unique_ptr<Ex
   return std::make_unique<ExecutorContext>(txn, catalog_, buffer_pool_manager_, txn_manager_, lock_manager_);
 }
 
-BustubInstance::BustubInstance(const std::string &db_file_name) {
+auto BustubInstance::MakeBufferPoolManager(size_t pool_size, size_t bpm_instances) -> BufferPoolManager * {
+  // The background writer keeps the next eighth of every shard clean, and is woken up early once less than half of
+  // that is left.
+  if (bpm_instances <= 1) {
+    auto *bpm = new BufferPoolManagerInstance(pool_size, disk_manager_, LRUK_REPLACER_K, log_manager_);
+    if (enable_bgwriter) {
+      const size_t high_watermark = std::max<size_t>(pool_size / 8, 1);
+      bpm->RunBackgroundWriter(high_watermark / 2, high_watermark);
+    }
+    return bpm;
+  }
+  // Split the frames evenly across the shards, but give every shard at least one frame.
+  const size_t frames_per_instance = std::max<size_t>(pool_size / bpm_instances, 1);
+  auto *bpm =
+      new ParallelBufferPoolManager(bpm_instances, frames_per_instance, disk_manager_, LRUK_REPLACER_K, log_manager_);
+  if (enable_bgwriter) {
+    const size_t high_watermark = std::max<size_t>(frames_per_instance / 8, 1);
+    bpm->RunBackgroundWriter(high_watermark / 2, high_watermark);
+  }
+  return bpm;
+}
+
+BustubInstance::BustubInstance(const std::string &db_file_name, size_t bpm_instances) {
   enable_logging = false;
 
   // Storage related.
-  disk_manager_ = new DiskManager(db_file_name);
+  disk_manager_ = new DiskManager(db_file_name, database_direct_io);
 
   // Log related.
   log_manager_ = new LogManager(disk_manager_);
@@ -54,7 +79,7 @@ BustubInstance::BustubInstance(const std::string &db_file_name) {
   // We need more frames for GenerateTestTable to work. Therefore, we use 128 instead of the default
   // buffer pool size specified in `config.h`.
   try {
-    buffer_pool_manager_ = new BufferPoolManagerInstance(128, disk_manager_, LRUK_REPLACER_K, log_manager_);
+    buffer_pool_manager_ = MakeBufferPoolManager(128, bpm_instances);
   } catch (NotImplementedException &e) {
     std::cerr << "BufferPoolManager is not implemented, only mock tables are supported." << std::endl;
     buffer_pool_manager_ = nullptr;
@@ -74,7 +99,7 @@ BustubInstance::BustubInstance(const std::string &db_file_name) {
   execution_engine_ = new ExecutionEngine(buffer_pool_manager_, txn_manager_, catalog_);
 }
 
-BustubInstance::BustubInstance() {
+BustubInstance::BustubInstance(size_t bpm_instances) {
   enable_logging = false;
 
   // Storage related.
@@ -86,7 +111,7 @@ BustubInstance::BustubInstance() {
   // We need more frames for GenerateTestTable to work. Therefore, we use 128 instead of the default
   // buffer pool size specified in `config.h`.
   try {
-    buffer_pool_manager_ = new BufferPoolManagerInstance(128, disk_manager_, LRUK_REPLACER_K, log_manager_);
+    buffer_pool_manager_ = MakeBufferPoolManager(128, bpm_instances);
   } catch (NotImplementedException &e) {
     std::cerr << "BufferPoolManager is not implemented, only mock tables are supported." << std::endl;
     buffer_pool_manager_ = nullptr;
@@ -213,7 +238,8 @@ auto BustubInstance::ExecuteSqlTxn(const std::string &sql, ResultWriter &writer,
         const auto &create_stmt = dynamic_cast<const CreateStatement &>(*statement);
 
         std::unique_lock<std::shared_mutex> l(catalog_lock_);
-        auto info = catalog_->CreateTable(txn, create_stmt.table_, Schema(create_stmt.columns_));
+        auto info = catalog_->CreateTable(txn, create_stmt.table_, Schema(create_stmt.columns_), true,
+                                           create_stmt.layout_, create_stmt.engine_);
         l.unlock();
 
         if (info == nullptr) {
@@ -240,6 +266,9 @@ auto BustubInstance::ExecuteSqlTxn(const std::string &sql, ResultWriter &writer,
         auto key_schema = Schema::CopySchema(&index_stmt.table_->schema_, col_ids);
 
         std::unique_lock<std::shared_mutex> l(catalog_lock_);
+        if (catalog_->GetTable(index_stmt.table_->table_)->column_table_ != nullptr) {
+          throw NotImplementedException("columnar tables do not support indexes");
+        }
         auto info = catalog_->CreateIndex<IntegerKeyType, IntegerValueType, IntegerComparatorType>(
             txn, index_stmt.index_name_, index_stmt.table_->table_, index_stmt.table_->schema_, key_schema, col_ids,
             INTEGER_SIZE, IntegerHashFunctionType{});
@@ -253,15 +282,44 @@ auto BustubInstance::ExecuteSqlTxn(const std::string &sql, ResultWriter &writer,
       }
       case StatementType::VARIABLE_SHOW_STATEMENT: {
         const auto &show_stmt = dynamic_cast<const VariableShowStatement &>(*statement);
-        auto content = GetSessionVariable(show_stmt.variable_);
+        auto content = show_stmt.variable_ == "read_ahead_depth" ? std::to_string(read_ahead_depth.load())
+                                                                 : GetSessionVariable(show_stmt.variable_);
         WriteOneCell(fmt::format("{}={}", show_stmt.variable_, content), writer);
         continue;
       }
       case StatementType::VARIABLE_SET_STATEMENT: {
         const auto &set_stmt = dynamic_cast<const VariableSetStatement &>(*statement);
+        // the read-ahead window is a knob of the buffer pool, which all sessions share
+        if (set_stmt.variable_ == "read_ahead_depth") {
+          const std::string &value = set_stmt.value_;
+          if (value.empty() || value.size() > 6 || value.find_first_not_of("0123456789") != std::string::npos) {
+            throw Exception(fmt::format("read_ahead_depth must be a number of pages, not {}", set_stmt.value_));
+          }
+          read_ahead_depth = std::stoul(value);
+          continue;
+        }
         session_variables_[set_stmt.variable_] = set_stmt.value_;
         continue;
       }
+      case StatementType::VACUUM_STATEMENT: {
+        const auto &vacuum_stmt = dynamic_cast<const VacuumStatement &>(*statement);
+
+        std::shared_lock<std::shared_mutex> l(catalog_lock_);
+        auto table_names = vacuum_stmt.table_ == nullptr ? catalog_->GetTableNames()
+                                                         : std::vector<std::string>{vacuum_stmt.table_->table_};
+        size_t num_reclaimed = 0;
+        for (const auto &name : table_names) {
+          // mock tables and columnar tables have no heap
+          auto *table = catalog_->GetTable(name)->table_.get();
+          if (table != nullptr) {
+            num_reclaimed += table->Vacuum();
+          }
+        }
+        l.unlock();
+
+        WriteOneCell(fmt::format("Vacuum reclaimed {} pages", num_reclaimed), writer);
+        continue;
+      }
       case StatementType::EXPLAIN_STATEMENT: {
         const auto &explain_stmt = dynamic_cast<const ExplainStatement &>(*statement);
         std::string output;
@@ -20,4 +20,24 @@ std::chrono::duration<int64_t> log_timeout = std::chrono::seconds(1);
 
 std::chrono::milliseconds cycle_detection_interval = std::chrono::milliseconds(50);
 
+std::chrono::milliseconds bgwriter_interval = std::chrono::milliseconds(50);
+
+bool enable_bgwriter = true;
+
+std::atomic<size_t> read_ahead_depth(8);
+
+size_t bulk_read_ring_size = 16;
+
+ReplacerPolicy replacer_policy = ReplacerPolicy::LRU_K;
+
+bool buffer_pool_huge_pages = true;
+
+bool database_direct_io = false;
+
+bool extent_allocation = true;
+
+bool auto_vacuum = true;
+
+bool enable_zone_maps = true;
+
 }  // namespace bustub
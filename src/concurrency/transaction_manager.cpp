@@ -18,6 +18,7 @@
 #include <unordered_set>
 
 #include "catalog/catalog.h"
+#include "storage/table/column_table.h"
 #include "storage/table/table_heap.h"
 namespace bustub {
 
@@ -52,7 +53,11 @@ void TransactionManager::Commit(Transaction *txn) {
   while (!write_set->empty()) {
     auto &item = write_set->back();
     auto *table = item.table_;
-    if (item.wtype_ == WType::DELETE) {
+    if (item.column_table_ != nullptr) {
+      if (item.wtype_ == WType::DELETE) {
+        item.column_table_->ApplyDelete(item.rid_, txn);
+      }
+    } else if (item.wtype_ == WType::DELETE) {
       // Note that this also releases the lock when holding the page latch.
       table->ApplyDelete(item.rid_, txn);
     }
@@ -73,7 +78,14 @@ void TransactionManager::Abort(Transaction *txn) {
   while (!table_write_set->empty()) {
     auto &item = table_write_set->back();
     auto *table = item.table_;
-    if (item.wtype_ == WType::DELETE) {
+    if (item.column_table_ != nullptr) {
+      // a columnar table only appends, so an insert is undone by deleting the row
+      if (item.wtype_ == WType::DELETE) {
+        item.column_table_->RollbackDelete(item.rid_, txn);
+      } else if (item.wtype_ == WType::INSERT) {
+        item.column_table_->ApplyDelete(item.rid_, txn);
+      }
+    } else if (item.wtype_ == WType::DELETE) {
       table->RollbackDelete(item.rid_, txn);
     } else if (item.wtype_ == WType::INSERT) {
       // Note that this also releases the lock when holding the page latch.
@@ -58,7 +58,11 @@ auto DeleteExecutor::Next([[maybe_unused]] Tuple **tuple, RID *rid) -> bool {
       throw ExecutionException("Delete Executor Get Row Lock Failed");
     }
 
-    table_heap->MarkDelete(*rid, tx);
+    if (table_info->column_table_ != nullptr) {
+      table_info->column_table_->MarkDelete(*rid, tx);
+    } else {
+      table_heap->MarkDelete(*rid, tx);
+    }
 
     for (auto &index_info : index_info_vector) {
       index_info->index_->DeleteEntry(
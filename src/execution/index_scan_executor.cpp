@@ -26,6 +26,7 @@ for (BPlusTreeIndexIteratorForOneIntegerColumn iterator = tree_->GetBeginIterato
         recordsIds.push_back((*iterator).second);
 }
 index = 0;
+prefetched_until_ = 0;
 
  }
 
@@ -33,6 +34,18 @@ auto IndexScanExecutor::Next(Tuple **tuple, RID *rid) -> bool {
  
     if ((size_t)index >= recordsIds.size()) return false;
     ExecutorContext *exec_ctx = this->GetExecutorContext();
+    // Hint the heap pages of the following tuples, read_ahead_depth distinct pages at a time. Tuples come in index
+    // order, so only consecutive duplicates are collapsed.
+    if (read_ahead_depth > 0 && static_cast<size_t>(index) >= prefetched_until_) {
+      std::vector<page_id_t> page_ids;
+      for (prefetched_until_ = index; prefetched_until_ < recordsIds.size() && page_ids.size() < read_ahead_depth;
+           prefetched_until_++) {
+        if (page_ids.empty() || page_ids.back() != recordsIds[prefetched_until_].GetPageId()) {
+          page_ids.push_back(recordsIds[prefetched_until_].GetPageId());
+        }
+      }
+      exec_ctx->GetBufferPoolManager()->PrefetchPages(page_ids, nullptr);
+    }
     Catalog *catalog = exec_ctx->GetCatalog();
     IndexInfo* indexInfo = catalog->GetIndex(plan_->GetIndexOid());
     TableInfo *table_info = exec_ctx_->GetCatalog()->GetTable(indexInfo->table_name_);
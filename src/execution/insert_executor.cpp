@@ -33,35 +33,50 @@ auto InsertExecutor::Next(Tuple **tuple, RID *rid) -> bool {
    Catalog *catalog = exec_ctx->GetCatalog();
    TableInfo*tableInfo = catalog->GetTable(tableId);
     TableHeap *tableHeap = tableInfo->table_.get();
-    Tuple **childTuple = new Tuple*[1];
-    *childTuple = nullptr;
+    Tuple *childTuple = nullptr;
     RID childRid;
     int size = 0;
         std::vector<IndexInfo *> indexInfos = catalog->GetTableIndexes(tableInfo->name_);
-     //Inserting The Tuples
-     while(child_executor_->Next( childTuple, &childRid)) {
-      //   LOG_DEBUG("5555555555The Size of Tuple is %d" , childTuple.GetLength());
-          TupleRecord * tupleRecord = dynamic_cast<TupleRecord *>(*childTuple);
+     //Inserting The Tuples, a batch at a time, so that every page of the table is latched once per batch
+     std::vector<std::unique_ptr<Tuple>> batch;
+     std::vector<const TupleRecord *> records;
+     std::vector<RID> rids;
+     bool more = true;
+     while (more) {
+       batch.clear();
+       records.clear();
+       while (batch.size() < BATCH_SIZE && (more = child_executor_->Next(&childTuple, &childRid))) {
+         batch.emplace_back(childTuple);
+         TupleRecord *tupleRecord = dynamic_cast<TupleRecord *>(childTuple);
          assert(tupleRecord != nullptr);
-        bool result =  tableHeap->InsertTuple(*tupleRecord,&childRid,exec_ctx->GetTransaction());
-          //Checking for available index and updating them
-         if (!result) {
-               continue;
+         records.push_back(tupleRecord);
+       }
+       if (records.empty()) {
+         break;
+       }
+       if (tableInfo->column_table_ != nullptr) {
+         tableInfo->column_table_->InsertTuples(records, &rids, exec_ctx->GetTransaction());
+       } else {
+         tableHeap->InsertTuples(records, &rids, exec_ctx->GetTransaction());
+       }
+       //Checking for available index and updating them
+       for (size_t j = 0; j < rids.size(); j++) {
+         for (size_t i = 0; i < indexInfos.size(); i++) {
+           Index *index = indexInfos[i]->index_.get();
+           index->InsertEntry(batch[j]->KeyFromTuple(tableInfo->schema_, indexInfos[i]->key_schema_,
+                                                     indexInfos[i]->index_->GetKeyAttrs()),
+                              rids[j], exec_ctx->GetTransaction());
          }
-              for (size_t i = 0; i < indexInfos.size(); i++) {
-                Index * index = indexInfos[i]->index_.get();
-                index->InsertEntry(( *childTuple)->KeyFromTuple(tableInfo->schema_, indexInfos[i]->key_schema_, indexInfos[i]->index_->GetKeyAttrs()), childRid, exec_ctx->GetTransaction());
-         }
-        size++;
+       }
+       size += static_cast<int>(rids.size());
+       if (rids.size() < records.size()) {
+         break;
+       }
      }
     
     std::vector<Value> values{};
     values.reserve(GetOutputSchema().GetColumnCount());  //1
     values.push_back(Value(INTEGER, size));
-    if (*childTuple != nullptr) {
-    delete *childTuple;
-    }
-    delete []childTuple;
     
     *tuple = new Tuple(values, &GetOutputSchema());
     noOfCalls++;
@@ -55,29 +55,161 @@
 
 #include "execution/executors/seq_scan_executor.h"
 
+#include "execution/expressions/column_value_expression.h"
+#include "execution/expressions/comparison_expression.h"
+#include "execution/expressions/constant_value_expression.h"
+#include "execution/expressions/logic_expression.h"
+
 namespace bustub {
 
+/** @return the comparison with its sides swapped, e.g. `column > constant` for `constant < column` */
+static auto MirrorComparison(ComparisonType comp_type) -> ComparisonType {
+  switch (comp_type) {
+    case ComparisonType::LessThan:
+      return ComparisonType::GreaterThan;
+    case ComparisonType::LessThanOrEqual:
+      return ComparisonType::GreaterThanOrEqual;
+    case ComparisonType::GreaterThan:
+      return ComparisonType::LessThan;
+    case ComparisonType::GreaterThanOrEqual:
+      return ComparisonType::LessThanOrEqual;
+    default:
+      return comp_type;
+  }
+}
+
+/**
+ * Collect the ranges that a predicate puts on the columns of the scanned table, from the comparisons of a column with
+ * a constant that the predicate ANDs together. Everything else, e.g. an OR, adds no range.
+ */
+static void CollectZoneRanges(const AbstractExpression &expr, std::vector<ZoneMap::Range> *ranges) {
+  if (const auto *logic = dynamic_cast<const LogicExpression *>(&expr); logic != nullptr) {
+    if (logic->logic_type_ == LogicType::And) {
+      CollectZoneRanges(*logic->GetChildAt(0), ranges);
+      CollectZoneRanges(*logic->GetChildAt(1), ranges);
+    }
+    return;
+  }
+  const auto *comparison = dynamic_cast<const ComparisonExpression *>(&expr);
+  if (comparison == nullptr) {
+    return;
+  }
+  ComparisonType comp_type = comparison->comp_type_;
+  const auto *column = dynamic_cast<const ColumnValueExpression *>(comparison->GetChildAt(0).get());
+  const auto *constant = dynamic_cast<const ConstantValueExpression *>(comparison->GetChildAt(1).get());
+  if (column == nullptr || constant == nullptr) {
+    column = dynamic_cast<const ColumnValueExpression *>(comparison->GetChildAt(1).get());
+    constant = dynamic_cast<const ConstantValueExpression *>(comparison->GetChildAt(0).get());
+    comp_type = MirrorComparison(comp_type);
+  }
+  if (column == nullptr || constant == nullptr) {
+    return;
+  }
+
+  ZoneMap::Range range;
+  range.column_idx_ = column->GetColIdx();
+  switch (comp_type) {
+    case ComparisonType::Equal:
+      range.lower_ = constant->val_;
+      range.upper_ = constant->val_;
+      break;
+    case ComparisonType::LessThan:
+      range.upper_ = constant->val_;
+      range.upper_inclusive_ = false;
+      break;
+    case ComparisonType::LessThanOrEqual:
+      range.upper_ = constant->val_;
+      break;
+    case ComparisonType::GreaterThan:
+      range.lower_ = constant->val_;
+      range.lower_inclusive_ = false;
+      break;
+    case ComparisonType::GreaterThanOrEqual:
+      range.lower_ = constant->val_;
+      break;
+    default:
+      return;
+  }
+  ranges->push_back(std::move(range));
+}
+
 SeqScanExecutor::SeqScanExecutor(ExecutorContext *exec_ctx, const SeqScanPlanNode *plan)
-    : AbstractExecutor(exec_ctx), plan_(plan), iter_({nullptr, RID(), nullptr}) {}
+    : AbstractExecutor(exec_ctx), plan_(plan), strategy_(bulk_read_ring_size), iter_({nullptr, RID(), nullptr}) {
+  if (plan_->filter_predicate_ != nullptr) {
+    CollectZoneRanges(*plan_->filter_predicate_, &zone_filter_);
+  }
+}
+
+SeqScanExecutor::~SeqScanExecutor() { EndScanHint(); }
 
 void SeqScanExecutor::Init() {
-  iter_ = GetExecutorContext()
-              ->GetCatalog()
-              ->GetTable(plan_->GetTableOid())
-              ->table_->Begin(GetExecutorContext()->GetTransaction());
+  // the disk may read ahead of the scan until it returned its last tuple
+  auto *bpm = GetExecutorContext()->GetBufferPoolManager();
+  if (!scan_hinted_ && bpm != nullptr) {
+    bpm->BeginSequentialScan();
+    scan_hinted_ = true;
+  }
+  TableInfo *table_info = GetExecutorContext()->GetCatalog()->GetTable(plan_->GetTableOid());
+  if (table_info->column_table_ != nullptr) {
+    std::vector<uint32_t> column_ids;
+    if (plan_->column_ids_.has_value()) {
+      column_ids = *plan_->column_ids_;
+    } else {
+      for (uint32_t i = 0; i < table_info->schema_.GetColumnCount(); i++) {
+        column_ids.push_back(i);
+      }
+    }
+    column_scanner_ = std::make_unique<ColumnTable::Scanner>(table_info->column_table_.get(), std::move(column_ids),
+                                                             zone_filter_, &strategy_);
+    return;
+  }
+  iter_ = table_info->table_->Begin(GetExecutorContext()->GetTransaction(), &strategy_, &zone_filter_);
 }
 
 auto SeqScanExecutor::Next(Tuple **tuple, RID *rid) -> bool {
-  if (iter_ == GetExecutorContext()->GetCatalog()->GetTable(plan_->GetTableOid())->table_->End()) {
+  const auto &filter_predicate = plan_->filter_predicate_;
+  if (column_scanner_ != nullptr) {
+    while (column_scanner_->Next(&column_values_, rid)) {
+      auto *tuple_record = new TupleRecord(column_values_, &GetOutputSchema());
+      if (filter_predicate != nullptr) {
+        const Value value = filter_predicate->Evaluate(tuple_record, GetOutputSchema());
+        if (value.IsNull() || !value.GetAs<bool>()) {
+          delete tuple_record;
+          continue;
+        }
+      }
+      *tuple = tuple_record;
+      return true;
+    }
+    EndScanHint();
     return false;
   }
-  TupleRecord *tupleRecord = new TupleRecord();
-  *tupleRecord = *iter_;
- 
-  *tuple = tupleRecord;
-  *rid = iter_->GetRid();
-  iter_++;
-  return true;
+  for (; !iter_.IsEnd(); ++iter_) {
+    // the predicate reads the tuple in place, so only the tuples that pass it are copied
+    if (filter_predicate != nullptr) {
+      const Value value = filter_predicate->Evaluate(&*iter_, GetOutputSchema());
+      if (value.IsNull() || !value.GetAs<bool>()) {
+        continue;
+      }
+    }
+    // the iterator's tuple points into its copy of the page, which it reuses for the next page
+    auto *tuple_record = new TupleRecord(*iter_);
+    tuple_record->Materialize();
+
+    *tuple = tuple_record;
+    *rid = iter_->GetRid();
+    ++iter_;
+    return true;
+  }
+  EndScanHint();
+  return false;
+}
+
+void SeqScanExecutor::EndScanHint() {
+  if (scan_hinted_) {
+    GetExecutorContext()->GetBufferPoolManager()->EndSequentialScan();
+    scan_hinted_ = false;
+  }
 }
 
 }  // namespace bustub
\ No newline at end of file
@@ -63,7 +63,10 @@ auto UpdateExecutor::Next([[maybe_unused]] Tuple **tuple, RID *rid) -> bool {
 
     auto to_update_tuple = TupleRecord{values, &child_executor_->GetOutputSchema()};
 
-    bool updated = table_info_->table_->UpdateTuple(to_update_tuple, old_rid, exec_ctx_->GetTransaction());
+    // a columnar table appends the new row; the scan below does not see it, as it only reads the rows it started with
+    bool updated = table_info_->column_table_ != nullptr
+                       ? table_info_->column_table_->UpdateTuple(to_update_tuple, old_rid, exec_ctx_->GetTransaction())
+                       : table_info_->table_->UpdateTuple(to_update_tuple, old_rid, exec_ctx_->GetTransaction());
 
     if (updated) {
       update_count++;
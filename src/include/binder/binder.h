@@ -81,6 +81,7 @@ class ExplainStatement;
 class IndexStatement;
 class DeleteStatement;
 class UpdateStatement;
+class VacuumStatement;
 
 /**
  * The binder is responsible for transforming the Postgres parse tree to a binder tree
@@ -204,6 +205,8 @@ class Binder {
 
   auto BindVariableShow(duckdb_libpgquery::PGVariableShowStmt *stmt) -> std::unique_ptr<VariableShowStatement>;
 
+  auto BindVacuum(duckdb_libpgquery::PGVacuumStmt *stmt) -> std::unique_ptr<VacuumStatement>;
+
   class ContextGuard {
    public:
     explicit ContextGuard(const BoundTableRef **scope, const CTEList **cte_scope) {
@@ -12,6 +12,7 @@
 
 #include "binder/bound_statement.h"
 #include "catalog/column.h"
+#include "common/config.h"
 
 namespace duckdb_libpgquery {
 struct PGCreateStmt;
@@ -21,10 +22,15 @@ namespace bustub {
 
 class CreateStatement : public BoundStatement {
  public:
-  explicit CreateStatement(std::string table, std::vector<Column> columns);
+  explicit CreateStatement(std::string table, std::vector<Column> columns, TableLayout layout = TableLayout::ROW,
+                           TableEngine engine = TableEngine::HEAP);
 
   std::string table_;
   std::vector<Column> columns_;
+  /** How the table stores its tuples, from CREATE TABLE ... WITH (layout = ...). */
+  TableLayout layout_;
+  /** What stores the tuples of the table, from CREATE TABLE ... WITH (engine = ...). */
+  TableEngine engine_;
 
   auto ToString() const -> std::string override;
 };
@@ -0,0 +1,75 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// buffer_access_strategy.h
+//
+// Identification: src/include/buffer/buffer_access_strategy.h
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <mutex>  // NOLINT
+#include <vector>
+
+#include "common/config.h"
+#include "common/macros.h"
+
+namespace bustub {
+
+class BufferPoolManager;
+class BufferPoolManagerInstance;
+
+/**
+ * BufferAccessStrategy keeps a bulk read, such as a full table scan, from flushing the buffer pool.
+ *
+ * A scan that passes a strategy to FetchPage() loads the pages it misses into a small ring of frames and recycles
+ * them: once the ring is full, the frame that was used ring_size misses ago is taken again, as long as its page is
+ * unpinned and still there. Only when it is not does the buffer pool evict a page of the shared pool as usual, and
+ * that frame replaces the old one in the ring. Pages the scan finds in the pool are used in place.
+ *
+ * A strategy belongs to a single scan. The read-ahead of the scan loads pages into the same ring, see
+ * BufferPoolManager::PrefetchChain(), so that the pages it reads ahead do not flush the pool either.
+ */
+class BufferAccessStrategy {
+ public:
+  /**
+   * @brief Create an empty ring.
+   * @param ring_size number of frames the scan recycles; 0 makes FetchPage() behave as if no strategy was passed
+   */
+  explicit BufferAccessStrategy(size_t ring_size) : ring_(ring_size) {}
+
+  DISALLOW_COPY_AND_MOVE(BufferAccessStrategy);
+
+  /** @brief Drop the read-ahead that is still queued for the ring, and wait for the one that is running. */
+  ~BufferAccessStrategy();
+
+  /** @return number of frames in the ring */
+  auto GetRingSize() const -> size_t { return ring_.size(); }
+
+  /** Remember a buffer pool that reads ahead into the ring, which the destructor then cancels. */
+  void SetPrefetcher(BufferPoolManager *bpm) { prefetcher_ = bpm; }
+
+ private:
+  friend class BufferPoolManagerInstance;
+
+  /** A frame that the scan loaded a page into. */
+  struct Slot {
+    /** Buffer pool the frame belongs to, nullptr while the slot is unused. */
+    const BufferPoolManagerInstance *owner_{nullptr};
+    frame_id_t frame_id_{-1};
+    page_id_t page_id_{INVALID_PAGE_ID};
+  };
+
+  /** Protects ring_ and next_slot_, which the scan and its read-ahead use from different threads. */
+  std::mutex latch_;
+  std::vector<Slot> ring_;
+  /** Slot that the next miss of the scan recycles. */
+  size_t next_slot_{0};
+  BufferPoolManager *prefetcher_{nullptr};
+};
+
+}  // namespace bustub
@@ -15,7 +15,9 @@
 #include <list>
 #include <mutex>  // NOLINT
 #include <unordered_map>
+#include <vector>
 
+#include "buffer/buffer_access_strategy.h"
 #include "buffer/lru_replacer.h"
 #include "recovery/log_manager.h"
 #include "storage/disk/disk_manager.h"
@@ -30,6 +32,8 @@ class BufferPoolManager {
  public:
   enum class CallbackType { BEFORE, AFTER };
   using bufferpool_callback_fn = void (*)(enum CallbackType, const page_id_t page_id);
+  /** Extracts the id of the following page from a (read-latched) page of a linked chain, e.g. a TableHeap. */
+  using NextPageIdFn = page_id_t (*)(Page *page);
 
   BufferPoolManager() = default;
   /**
@@ -45,6 +49,15 @@ class BufferPoolManager {
     return result;
   }
 
+  /**
+   * Fetch a page for a bulk read: pages that are not in the pool are loaded into the ring of frames of `strategy`
+   * instead of displacing the shared pool, see BufferAccessStrategy.
+   * @param page_id id of page to be fetched
+   * @param strategy ring of the scan
+   * @return the requested page, or nullptr if it cannot be fetched
+   */
+  auto FetchPage(page_id_t page_id, BufferAccessStrategy *strategy) -> Page * { return FetchPgImp(page_id, strategy); }
+
   /** Grading function. Do not modify! */
   auto UnpinPage(page_id_t page_id, bool is_dirty, bufferpool_callback_fn callback = nullptr) -> bool {
     GradingCallback(callback, CallbackType::BEFORE, page_id);
@@ -69,6 +82,15 @@ class BufferPoolManager {
     return result;
   }
 
+  /**
+   * Create a page of an object that grows page by page, such as a table heap or an index, next to another page of the
+   * object on disk, see DiskManager::AllocatePageNear().
+   * @param[out] page_id id of created page
+   * @param near_page_id a page of the object, or INVALID_PAGE_ID for the first page of a new object
+   * @return nullptr if no new pages could be created, otherwise pointer to new page
+   */
+  auto NewPage(page_id_t *page_id, page_id_t near_page_id) -> Page * { return NewPgImp(page_id, near_page_id); }
+
   /** Grading function. Do not modify! */
   auto DeletePage(page_id_t page_id, bufferpool_callback_fn callback = nullptr) -> bool {
     GradingCallback(callback, CallbackType::BEFORE, page_id);
@@ -88,6 +110,56 @@ class BufferPoolManager {
   virtual auto GetPoolSize() -> size_t = 0;
   virtual int GetFreeListSize() = 0;
   virtual int GetFreeEvictableSize() = 0;
+
+  /**
+   * Hint that the given pages are about to be fetched, in this order. A buffer pool that supports read-ahead reads
+   * them in the background; by default the hint is ignored.
+   * @param page_ids ids of the pages
+   * @param strategy the ring of the scan to read the pages into, or nullptr to read them into the pool
+   */
+  virtual void PrefetchPages(const std::vector<page_id_t> &page_ids, BufferAccessStrategy *strategy) {}
+
+  /**
+   * Hint that the pages following a page in a linked chain of pages are about to be fetched, e.g. by a sequential
+   * scan. By default the hint is ignored.
+   * @param page_id the page that is being read now
+   * @param depth number of pages after page_id to read ahead
+   * @param next extracts the link to the following page
+   * @param strategy the ring of the scan to read the pages into, or nullptr to read them into the pool; the pages the
+   * scan has not reached yet stay in the ring if depth is less than half its size
+   */
+  virtual void PrefetchChain(page_id_t page_id, size_t depth, NextPageIdFn next, BufferAccessStrategy *strategy) {}
+
+  /** Drop the chain hints that read into the ring of `strategy`, and wait for the one that is being served. */
+  virtual void CancelPrefetch(const BufferAccessStrategy *strategy) {}
+
+  /**
+   * Hint that a sequential scan starts, and hand it to the disk, see DiskManager::BeginSequentialScan(). Every call has
+   * to be matched by an EndSequentialScan(). By default the hint is ignored.
+   */
+  virtual void BeginSequentialScan() {}
+
+  /** Hint that a sequential scan ended, see BeginSequentialScan(). */
+  virtual void EndSequentialScan() {}
+
+  /**
+   * Bring the given pages into the buffer pool and leave them unpinned. Used by read-ahead; a buffer pool that can
+   * overlap the reads does so, by default the pages are fetched one after the other.
+   * @param page_ids ids of the pages
+   * @param strategy the ring to load the pages into, or nullptr
+   * @return number of the pages that are in the buffer pool now, or on their way in; pages that find no free frame are
+   * skipped
+   */
+  virtual auto LoadPages(const std::vector<page_id_t> &page_ids, BufferAccessStrategy *strategy) -> size_t {
+    size_t loaded = 0;
+    for (auto page_id : page_ids) {
+      if (FetchPage(page_id, strategy) != nullptr) {
+        UnpinPage(page_id, false);
+        loaded++;
+      }
+    }
+    return loaded;
+  }
  protected:
   /**
    * Grading function. Do not modify!
@@ -109,6 +181,14 @@ class BufferPoolManager {
    */
   virtual auto FetchPgImp(page_id_t page_id) -> Page * = 0;
 
+  /**
+   * Fetch the requested page on behalf of a bulk read. By default the strategy is ignored.
+   * @param page_id id of page to be fetched
+   * @param strategy ring of frames the scan recycles
+   * @return the requested page
+   */
+  virtual auto FetchPgImp(page_id_t page_id, BufferAccessStrategy *strategy) -> Page * { return FetchPgImp(page_id); }
+
   /**
    * Unpin the target page from the buffer pool.
    * @param page_id id of page to be unpinned
@@ -131,6 +211,14 @@ class BufferPoolManager {
    */
   virtual auto NewPgImp(page_id_t *page_id) -> Page * = 0;
 
+  /**
+   * Creates a new page next to a page of the same object. By default the placement hint is ignored.
+   * @param[out] page_id id of created page
+   * @param near_page_id a page of the object, or INVALID_PAGE_ID for the first page of a new object
+   * @return nullptr if no new pages could be created, otherwise pointer to new page
+   */
+  virtual auto NewPgImp(page_id_t *page_id, page_id_t near_page_id) -> Page * { return NewPgImp(page_id); }
+
   /**
    * Deletes a page from the buffer pool.
    * @param page_id id of page to be deleted
@@ -12,14 +12,22 @@
 
 #pragma once
 
+#include <atomic>
+#include <condition_variable>  // NOLINT
 #include <list>
-#include <mutex>  // NOLINT
+#include <memory>
+#include <mutex>   // NOLINT
+#include <thread>  // NOLINT
 #include <unordered_map>
+#include <vector>
 
 #include "buffer/buffer_pool_manager.h"
+#include "buffer/clock_replacer.h"
+#include "buffer/frame_arena.h"
 #include "buffer/lru_k_replacer.h"
+#include "buffer/page_table.h"
+#include "buffer/read_ahead.h"
 #include "common/config.h"
-#include "container/hash/extendible_hash_table.h"
 #include "recovery/log_manager.h"
 #include "storage/disk/disk_manager.h"
 #include "storage/page/page.h"
@@ -37,9 +45,24 @@ class BufferPoolManagerInstance : public BufferPoolManager {
    * @param disk_manager the disk manager
    * @param replacer_k the lookback constant k for the LRU-K replacer
    * @param log_manager the log manager (for testing only: nullptr = disable logging). Please ignore this for P1.
+   * @param policy the replacement policy
    */
   BufferPoolManagerInstance(size_t pool_size, DiskManager *disk_manager, size_t replacer_k = LRUK_REPLACER_K,
-                            LogManager *log_manager = nullptr);
+                            LogManager *log_manager = nullptr, ReplacerPolicy policy = replacer_policy);
+
+  /**
+   * @brief Creates a new BufferPoolManagerInstance that is one shard of a ParallelBufferPoolManager.
+   * @param pool_size the size of this shard
+   * @param num_instances total number of shards in the parallel buffer pool
+   * @param instance_index index of this shard in the parallel buffer pool
+   * @param disk_manager the disk manager
+   * @param replacer_k the lookback constant k for the LRU-K replacer
+   * @param log_manager the log manager (for testing only: nullptr = disable logging)
+   * @param policy the replacement policy
+   */
+  BufferPoolManagerInstance(size_t pool_size, uint32_t num_instances, uint32_t instance_index,
+                            DiskManager *disk_manager, size_t replacer_k = LRUK_REPLACER_K,
+                            LogManager *log_manager = nullptr, ReplacerPolicy policy = replacer_policy);
 
   /**
    * @brief Destroy an existing BufferPoolManagerInstance.
@@ -51,8 +74,60 @@ class BufferPoolManagerInstance : public BufferPoolManager {
 
   /** @brief Return the pointer to all the pages in the buffer pool. */
   auto GetPages() -> Page * { return pages_; }
+
+  /** @brief Return true if the data of the frames is backed by transparent huge pages. */
+  auto IsHugePageBacked() const -> bool { return frames_->IsHugePageBacked(); }
   int  GetFreeListSize();
     int  GetFreeEvictableSize();
+
+  /**
+   * @brief Start the background writer thread. It wakes up every bgwriter_interval, and whenever an eviction may leave
+   * fewer than `low_watermark` clean evictable frames, i.e. when the evictable frames do not outnumber the dirty pages
+   * by that much; the pool counts its dirty pages as they change, so the check costs an eviction nothing. The writer
+   * then writes back dirty, unpinned pages until the next `high_watermark` frames that the replacer would evict are
+   * clean, so that foreground evictions rarely have to write.
+   *
+   * BustubInstance starts it for its buffer pool if enable_bgwriter is set.
+   * @param low_watermark wake up the writer early when fewer clean frames are about to be evicted
+   * @param high_watermark number of frames at the head of the eviction order that the writer keeps clean
+   */
+  void RunBackgroundWriter(size_t low_watermark, size_t high_watermark);
+
+  /** @brief Stop the background writer thread, if it runs, after its current write. */
+  void StopBackgroundWriter();
+
+  /** @return number of dirty victims that were written back by the thread that evicted them */
+  auto GetForegroundWriteCount() const -> uint64_t { return foreground_writes_; }
+
+  /** @return number of dirty pages that the background writer wrote back ahead of their eviction */
+  auto GetBackgroundWriteCount() const -> uint64_t { return background_writes_; }
+
+  /** @brief Read the pages in the background, see ReadAhead::Prefetch(). */
+  void PrefetchPages(const std::vector<page_id_t> &page_ids, BufferAccessStrategy *strategy) override;
+
+  /** @brief Read the chain after page_id in the background, see ReadAhead::PrefetchChain(). */
+  void PrefetchChain(page_id_t page_id, size_t depth, NextPageIdFn next, BufferAccessStrategy *strategy) override;
+
+  /** @brief Cancel the read-ahead into a ring, see ReadAhead::Cancel(). */
+  void CancelPrefetch(const BufferAccessStrategy *strategy) override;
+
+  void BeginSequentialScan() override { disk_manager_->BeginSequentialScan(); }
+
+  void EndSequentialScan() override { disk_manager_->EndSequentialScan(); }
+
+  /**
+   * @brief Load the pages that are not resident with one batch of asynchronous reads, see
+   * DiskManager::ReadPageAsync(). Frames are reserved for all of them first, and the pages become visible to fetches
+   * once the whole batch is read.
+   */
+  auto LoadPages(const std::vector<page_id_t> &page_ids, BufferAccessStrategy *strategy) -> size_t override;
+
+  /**
+   * @brief Write back every dirty page of the pool, like FlushAllPgsImp(), but without syncing the disk. A parallel
+   * buffer pool writes back all of its instances this way and then syncs once.
+   */
+  void WriteBackAllPages();
+
  protected:
   /**
    * TODO(P1): Add implementation
@@ -73,6 +148,12 @@ class BufferPoolManagerInstance : public BufferPoolManager {
    */
   auto NewPgImp(page_id_t *page_id) -> Page * override;
 
+  /**
+   * @brief Create a new page like NewPgImp(page_id), with a page id that the disk manager allocates next to
+   * near_page_id.
+   */
+  auto NewPgImp(page_id_t *page_id, page_id_t near_page_id) -> Page * override;
+
   /**
    * TODO(P1): Add implementation
    *
@@ -91,6 +172,14 @@ class BufferPoolManagerInstance : public BufferPoolManager {
    */
   auto FetchPgImp(page_id_t page_id) -> Page * override;
 
+  /**
+   * @brief Fetch the requested page like FetchPgImp(page_id), but load it into the ring of `strategy` on a miss.
+   * @param page_id id of page to be fetched
+   * @param strategy ring of frames the scan recycles
+   * @return nullptr if page_id cannot be fetched, otherwise pointer to the requested page
+   */
+  auto FetchPgImp(page_id_t page_id, BufferAccessStrategy *strategy) -> Page * override;
+
   /**
    * TODO(P1): Add implementation
    *
@@ -119,20 +208,30 @@ class BufferPoolManagerInstance : public BufferPoolManager {
    */
   auto FlushPgImp(page_id_t page_id) -> bool override;
 
-  auto FlushPgInternal(page_id_t page_id) -> bool;
+  /**
+   * @brief Flush the target page with latch_ held by `lock`. The latch is released while the page is written, the page
+   * stays pinned for that time so that it cannot be evicted. An unpinned page that is still clean afterwards is dropped
+   * from the pool.
+   */
+  auto FlushPgInternal(page_id_t page_id, std::unique_lock<std::mutex> *lock) -> bool;
 
   /**
    * TODO(P1): Add implementation
    *
-   * @brief Flush all the pages in the buffer pool to disk.
+   * @brief Flush all the pages in the buffer pool to disk, and wait until they are durable.
+   *
+   * The dirty pages are sorted by page id and written in batches of FLUSH_BATCH_SIZE with
+   * DiskManager::WritePages(), which coalesces adjacent pages into one write, see WriteBackAllPages(); the disk is
+   * synced once at the end.
+   * Unlike FlushPgImp(), the pages stay in the pool, and fetches keep hitting them while they are written.
    */
   void FlushAllPgsImp() override;
 
   /**
    * TODO(P1): Add implementation
    *
-   * @brief Delete a page from the buffer pool. If page_id is not in the buffer pool, do nothing and return true. If the
-   * page is pinned and cannot be deleted, return false immediately.
+   * @brief Delete a page from the buffer pool. If page_id is not in the buffer pool, only deallocate it on disk and
+   * return true. If the page is pinned and cannot be deleted, return false immediately.
    *
    * After deleting the page from the page table, stop tracking the frame in the replacer and add the frame
    * back to the free list. Also, reset the page's memory and metadata. Finally, you should call DeallocatePage() to
@@ -143,42 +242,164 @@ class BufferPoolManagerInstance : public BufferPoolManager {
    */
   auto DeletePgImp(page_id_t page_id) -> bool override;
 
+  /** Number of dirty pages that FlushAllPgsImp() pins and writes at a time. */
+  static constexpr size_t FLUSH_BATCH_SIZE = 1024;
+
   /** Number of pages in the buffer pool. */
   const size_t pool_size_;
-  /** The next page id to be allocated  */
-  std::atomic<page_id_t> next_page_id_ = 0;
-  /** Bucket size for the extendible hash table */
-  const size_t bucket_size_ = 4;
+  /** How many instances are in the parallel BPM (if present, otherwise just 1 BPI) */
+  const uint32_t num_instances_ = 1;
+  /** Index of this BPI in the parallel BPM (if present, otherwise just 0) */
+  const uint32_t instance_index_ = 0;
 
-  /** Array of buffer pool pages. */
+  /** Data of every frame of the buffer pool. */
+  FrameArena *frames_;
+  /** Array of buffer pool pages, the descriptor of every frame. */
   Page *pages_;
   /** Pointer to the disk manager. */
   DiskManager *disk_manager_ __attribute__((__unused__));
   /** Pointer to the log manager. Please ignore this for P1. */
   LogManager *log_manager_ __attribute__((__unused__));
-  /** Page table for keeping track of buffer pool pages. */
-  ExtendibleHashTable<page_id_t, frame_id_t> *page_table_;
+  /** Page table for keeping track of buffer pool pages. Modified only with latch_ held, looked up without it. */
+  PageTable *page_table_;
   /** Replacer to find unpinned pages for replacement. */
-  LRUKReplacer *replacer_;
+  FrameReplacer *replacer_;
   /** List of free frames that don't have any pages on them. */
   std::list<frame_id_t> free_list_;
-  /** This latch protects shared data structures. We recommend updating this comment to describe what it protects. */
+  /**
+   * This latch protects the page table, the free list, the replacer calls and the metadata of every frame. It is never
+   * held across disk I/O: a frame that is being read or written back is marked in frame_states_ instead.
+   *
+   * The one exception is pinning a page that is already resident, which PinResidentPage() does without the latch. To
+   * make that safe, a pin count only drops to zero with the latch held, and a frame is only taken away from its page
+   * after it was marked as not READY and its pin count was then seen to be zero (see DetachFrame()).
+   */
   std::mutex latch_;
 
+  /** I/O state of a frame. Only READY frames may be pinned by a fetch. */
+  enum class FrameState { READY, READING, WRITING };
+  /** I/O state of every frame. Written with latch_ held, read by lock-free pins. */
+  std::atomic<FrameState> *frame_states_;
+  /** One condition per frame, signalled (with latch_) whenever the frame leaves the READING or WRITING state. */
+  std::condition_variable *frame_io_cv_;
+
+  /**
+   * @brief Wait until the page is not under I/O, or no longer in the buffer pool.
+   * @param page_id id of the page to look up
+   * @param[out] frame_id frame that holds the page
+   * @param lock holds latch_, released while waiting
+   * @return false if the page is not in the page table
+   */
+  auto FindReadyFrame(page_id_t page_id, frame_id_t *frame_id, std::unique_lock<std::mutex> *lock) -> bool;
+
+  /**
+   * @brief Take a frame from the free list or the replacer and map `page_id` to it, pinned once. If the victim page is
+   * dirty it is written back with latch_ released; until then the frame stays WRITING and the victim stays in the page
+   * table, so that nobody re-reads a stale copy of it from disk. The caller sets the final frame state.
+   * @param page_id id of the page the frame is reserved for
+   * @param[out] frame_id the reserved frame
+   * @param lock holds latch_
+   * @param strategy if not null, recycle a frame of its ring if possible and record the reserved frame in the ring
+   * @return false if all frames are pinned
+   */
+  auto ReserveFrame(page_id_t page_id, frame_id_t *frame_id, std::unique_lock<std::mutex> *lock,
+                    BufferAccessStrategy *strategy = nullptr) -> bool;
+
+  /**
+   * @brief Take back the frame of the ring slot that the next miss of a bulk read recycles. Caller must hold latch_.
+   * @param strategy ring of the scan
+   * @param[out] frame_id the frame, detached from its page and removed from the replacer
+   * @return false if the slot is unused, belongs to another instance, or its page was evicted or is pinned
+   */
+  auto RecycleRingFrame(BufferAccessStrategy *strategy, frame_id_t *frame_id) -> bool;
+
+  /** The background writer thread, nullptr unless RunBackgroundWriter() was called. */
+  std::thread *bg_writer_thread_{nullptr};
+  /** Set to false (with latch_) to stop the background writer. */
+  bool bg_writer_running_{false};
+  /** Watermarks of the background writer, see RunBackgroundWriter(). */
+  size_t bg_writer_low_watermark_{0};
+  size_t bg_writer_high_watermark_{0};
+  /** Wakes up the background writer, used with latch_. */
+  std::condition_variable bg_writer_cv_;
+  /** Number of frames whose page is dirty, pinned or not. Changed with latch_, see SetDirty(). */
+  size_t num_dirty_frames_{0};
+  std::atomic<uint64_t> foreground_writes_{0};
+  std::atomic<uint64_t> background_writes_{0};
+
+  /** Read-ahead worker, started by the first hint. */
+  std::unique_ptr<ReadAhead> read_ahead_;
+  std::once_flag read_ahead_started_;
+
+  /** @brief Body of the background writer thread. */
+  void BackgroundWriterLoop();
+
+  /** @brief Mark the page of a frame dirty or clean, keeping num_dirty_frames_ up to date. Caller must hold latch_. */
+  void SetDirty(frame_id_t frame_id, bool is_dirty);
+
   /**
-   * @brief Allocate a page on disk. Caller should acquire the latch before calling this function.
+   * @brief Write resident, READY pages back to disk with latch_ released, as one batch of asynchronous writes. The
+   * pages stay pinned during the writes so that they cannot be evicted; fetches keep hitting them, and whoever dirties
+   * one meanwhile marks it dirty again when unpinning.
+   * @param frame_ids frames that hold the pages
+   * @param lock holds latch_
+   * @param vectored true to write the pages with DiskManager::WritePages(), which coalesces pages that are adjacent in
+   * the file, instead of as asynchronous requests
+   */
+  void WriteBackFrames(const std::vector<frame_id_t> &frame_ids, std::unique_lock<std::mutex> *lock,
+                       bool vectored = false);
+
+  /** @brief Move a frame to a new I/O state and wake up everyone waiting on it. Caller must hold latch_. */
+  void SetFrameState(frame_id_t frame_id, FrameState state);
+
+  /**
+   * @brief Pin a resident, READY page without taking latch_. The pin is taken first and then validated against the
+   * frame's page id and state; it is dropped again if the frame was handed to another page or is under I/O.
+   * @param page_id id of the page to pin
+   * @return the pinned page, or nullptr if the caller has to take the latched path
+   */
+  auto PinResidentPage(page_id_t page_id) -> Page *;
+
+  /**
+   * @brief Take a READY frame away from its page, e.g. to evict or delete the page. The frame is marked as WRITING
+   * before the pin count is checked, so that a concurrent PinResidentPage() either sees the new state or leaves its pin
+   * for us to see. Caller must hold latch_.
+   * @return true if the frame was unpinned and is now WRITING, false if it was pinned and is left READY
+   */
+  auto DetachFrame(frame_id_t frame_id) -> bool;
+
+  /**
+   * @brief Allocate a page on disk, reusing a deallocated page id if there is one. Caller should acquire the latch
+   * before calling this function.
    * @return the id of the allocated page
    */
   auto AllocatePage() -> page_id_t;
 
   /**
-   * @brief Deallocate a page on disk. Caller should acquire the latch before calling this function.
+   * @brief Allocate a page on disk next to a page of the same object. Caller should acquire the latch before calling
+   * this function.
+   * @param near_page_id a page of the object, or INVALID_PAGE_ID for the first page of a new object
+   * @return the id of the allocated page
+   */
+  auto AllocatePageNear(page_id_t near_page_id) -> page_id_t;
+
+  /** @brief The body of both NewPgImp() overloads; the page id comes from AllocatePageNear() if `near` is set. */
+  auto CreatePage(page_id_t *page_id, bool near, page_id_t near_page_id) -> Page *;
+
+  /**
+   * @brief Validate that the page_id being used is accessible to this BPI. Page ids are striped across the
+   * instances of a parallel BPM, so this instance owns exactly the ids with page_id % num_instances_ == instance_index_.
+   * @param page_id the page id to validate
+   */
+  void ValidatePageId(page_id_t page_id) const;
+
+  /**
+   * @brief Deallocate a page on disk, so that its id can be allocated again. Caller should acquire the latch before
+   * calling this function.
    * @param page_id id of the page to deallocate
    */
-  void DeallocatePage(__attribute__((unused)) page_id_t page_id) {
-    // This is a no-nop right now without a more complex data structure to track deallocated pages
-  }
+  void DeallocatePage(page_id_t page_id);
 
   // TODO(student): You may add additional private members and helper functions
 };
-}  // namespace bustub
\ No newline at end of file
+}  // namespace bustub
\ No newline at end of file
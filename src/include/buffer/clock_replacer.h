@@ -12,41 +12,82 @@
 
 #pragma once
 
-#include <list>
-#include <mutex>  // NOLINT
+#include <atomic>
 #include <vector>
 
-#include "buffer/replacer.h"
+#include "buffer/frame_replacer.h"
 #include "common/config.h"
+#include "common/macros.h"
 
 namespace bustub {
 
 /**
- * ClockReplacer implements the clock replacement policy, which approximates the Least Recently Used policy.
+ * ClockReplacer implements the GCLOCK replacement policy, which approximates the Least Recently Used policy.
+ *
+ * Every frame has a usage count that is set to 1 when a page is loaded into it and incremented, up to
+ * MAX_USAGE_COUNT, on every hit. A clock hand sweeps over the frames: an evictable frame with a usage count of zero
+ * is the victim, any other evictable frame gets its usage count decremented and is passed over.
+ *
+ * All state is kept in per-frame atomics and an atomic hand, so no operation takes a lock: recording a hit is a single
+ * relaxed increment, and concurrent sweeps each advance the hand past different frames. A frame changes between
+ * untracked, pinned and evictable only by compare-and-swap, so exactly one of several racing Evict()/Remove() calls
+ * takes an evictable frame.
  */
-class ClockReplacer : public Replacer {
+class ClockReplacer : public FrameReplacer {
  public:
   /**
    * Create a new ClockReplacer.
-   * @param num_pages the maximum number of pages the ClockReplacer will be required to store
+   * @param num_frames the maximum number of frames the ClockReplacer will be required to store
    */
-  explicit ClockReplacer(size_t num_pages);
+  explicit ClockReplacer(size_t num_frames);
+
+  DISALLOW_COPY_AND_MOVE(ClockReplacer);
 
   /**
    * Destroys the ClockReplacer.
    */
-  ~ClockReplacer() override;
+  ~ClockReplacer() override = default;
+
+  /**
+   * @brief Sweep the clock hand until it finds an evictable frame with a usage count of zero.
+   * @param[out] frame_id the victim
+   * @return false only if no frame is evictable
+   */
+  auto Evict(frame_id_t *frame_id) -> bool override;
 
-  auto Victim(frame_id_t *frame_id) -> bool override;
+  /**
+   * @brief Evictable frames ordered by usage count, then by distance from the hand. The first one is the frame that
+   * an undisturbed sweep evicts next; the others are only roughly in the order of later evictions.
+   */
+  auto EvictionCandidates(size_t max_count) -> std::vector<frame_id_t> override;
 
-  void Pin(frame_id_t frame_id) override;
+  void RecordAccess(frame_id_t frame_id) override;
 
-  void Unpin(frame_id_t frame_id) override;
+  void RecordHit(frame_id_t frame_id) override;
+
+  void SetEvictable(frame_id_t frame_id, bool set_evictable) override;
+
+  void Remove(frame_id_t frame_id) override;
 
   auto Size() -> size_t override;
 
+  /** Usage count at which hits stop counting, so that a formerly hot page cools down in a bounded number of turns. */
+  static constexpr uint32_t MAX_USAGE_COUNT = 5;
+
  private:
-  // TODO(student): implement me!
+  enum class FrameStatus : uint8_t { UNTRACKED, PINNED, EVICTABLE };
+
+  /** @return true if the frame id is in range */
+  auto IsValid(frame_id_t frame_id) const -> bool {
+    return frame_id >= 0 && frame_id < static_cast<frame_id_t>(num_frames_);
+  }
+
+  size_t num_frames_;
+  std::vector<std::atomic<FrameStatus>> status_;
+  std::vector<std::atomic<uint32_t>> usage_;
+  /** Ever-increasing position of the hand; the frame under it is hand_ % num_frames_. */
+  std::atomic<size_t> hand_{0};
+  std::atomic<size_t> curr_size_{0};
 };
 
 }  // namespace bustub
@@ -0,0 +1,65 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// frame_arena.h
+//
+// Identification: src/include/buffer/frame_arena.h
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cstddef>
+
+#include "common/config.h"
+#include "common/macros.h"
+
+namespace bustub {
+
+/**
+ * FrameArena holds the data of every frame of a buffer pool in one anonymous memory mapping.
+ *
+ * Frame i starts at byte i * BUSTUB_PAGE_SIZE, so every frame is aligned to the page size, as direct I/O requires. The
+ * metadata of a frame lives in its Page descriptor, away from the data, so pinning and latching a page does not pull
+ * its data into the cache and scanning the data does not contend with pins of neighbouring frames.
+ *
+ * Arenas of at least one huge page are aligned to the huge page size and advised to be backed by transparent huge
+ * pages, which cuts the TLB misses of random accesses to a large pool. The kernel is free to ignore the advice.
+ */
+class FrameArena {
+ public:
+  /**
+   * @brief Map zeroed memory for num_frames frames.
+   * @param num_frames number of frames
+   * @param huge_pages whether to ask for transparent huge pages
+   * @throws std::bad_alloc if the memory cannot be mapped
+   */
+  FrameArena(size_t num_frames, bool huge_pages);
+
+  DISALLOW_COPY_AND_MOVE(FrameArena);
+
+  /** @brief Unmap the arena. */
+  ~FrameArena();
+
+  /** @return the data of a frame */
+  auto GetFrame(frame_id_t frame_id) const -> char * {
+    return data_ + static_cast<size_t>(frame_id) * BUSTUB_PAGE_SIZE;
+  }
+
+  /** @return true if the kernel accepted the advice to back the arena with huge pages */
+  auto IsHugePageBacked() const -> bool { return huge_page_backed_; }
+
+  /** Size of a transparent huge page on x86-64 and of the default one on arm64. */
+  static constexpr size_t HUGE_PAGE_SIZE = 2 * 1024 * 1024;
+
+ private:
+  char *data_;
+  /** Length of the mapping, at least num_frames * BUSTUB_PAGE_SIZE. */
+  size_t length_;
+  bool huge_page_backed_{false};
+};
+
+}  // namespace bustub
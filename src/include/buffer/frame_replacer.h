@@ -0,0 +1,77 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// frame_replacer.h
+//
+// Identification: src/include/buffer/frame_replacer.h
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <vector>
+
+#include "common/config.h"
+
+namespace bustub {
+
+/**
+ * FrameReplacer is the replacement policy of a BufferPoolManagerInstance, see ReplacerPolicy.
+ *
+ * The buffer pool records an access whenever it loads a page into a frame, and marks the frame evictable whenever its
+ * pin count drops to zero. Only evictable frames are handed out by Evict(). A frame that is evicted or removed is no
+ * longer tracked until its next access is recorded.
+ */
+class FrameReplacer {
+ public:
+  FrameReplacer() = default;
+  virtual ~FrameReplacer() = default;
+
+  /**
+   * @brief Pick an evictable frame, stop tracking it and return it.
+   * @param[out] frame_id the victim
+   * @return false if no frame is evictable
+   */
+  virtual auto Evict(frame_id_t *frame_id) -> bool = 0;
+
+  /**
+   * @brief List the frames that would be evicted next, without evicting them.
+   * @param max_count the maximum number of frames to return
+   * @return up to max_count evictable frames, in the order in which Evict() would pick them
+   */
+  virtual auto EvictionCandidates(size_t max_count) -> std::vector<frame_id_t> = 0;
+
+  /**
+   * @brief Record an access to a frame that a page was just loaded into; starts tracking the frame as non-evictable.
+   * @param frame_id id of the frame
+   */
+  virtual void RecordAccess(frame_id_t frame_id) = 0;
+
+  /**
+   * @brief Record a buffer pool hit on a tracked frame. The buffer pool calls this without holding its latch, on the
+   * lock-free hit path, so policies that cannot do it cheaply leave it out.
+   * @param frame_id id of the frame
+   */
+  virtual void RecordHit(frame_id_t frame_id) = 0;
+
+  /**
+   * @brief Make a tracked frame evictable or not. Does nothing for frames that are not tracked.
+   * @param frame_id id of the frame
+   * @param set_evictable whether the frame may be evicted
+   */
+  virtual void SetEvictable(frame_id_t frame_id, bool set_evictable) = 0;
+
+  /**
+   * @brief Stop tracking a frame, no matter where it is in the eviction order.
+   * @param frame_id id of the frame
+   */
+  virtual void Remove(frame_id_t frame_id) = 0;
+
+  /** @return the number of evictable frames */
+  virtual auto Size() -> size_t = 0;
+};
+
+}  // namespace bustub
@@ -13,11 +13,12 @@
 #pragma once
 
 #include <limits>
-#include <list>
 #include <mutex>  // NOLINT
-#include <unordered_map>
+#include <set>
+#include <utility>
 #include <vector>
 
+#include "buffer/frame_replacer.h"
 #include "common/config.h"
 #include "common/macros.h"
 
@@ -33,13 +34,16 @@ namespace bustub {
  * A frame with less than k historical references is given
  * +inf as its backward k-distance. When multiple frames have +inf backward k-distance,
  * classical LRU algorithm is used to choose victim.
+ *
+ * Every frame owns a fixed slot in `frames_` and a ring of its last k timestamps in `history_`, so recording an
+ * access never allocates. Evictable frames are additionally kept in one of two ordered indexes: frames with +inf
+ * backward k-distance keyed by their earliest access, and all other frames keyed by their kth most recent access.
+ * The victim is always the first element of one of the two indexes, which makes every operation O(log n) in the
+ * number of evictable frames.
  */
-class LRUKReplacer {
+class LRUKReplacer : public FrameReplacer {
  public:
   /**
-   *
-   * TODO(P1): Add implementation
-   *
    * @brief a new LRUKReplacer.
    * @param num_frames the maximum number of frames the LRUReplacer will be required to store
    */
@@ -48,15 +52,11 @@ class LRUKReplacer {
   DISALLOW_COPY_AND_MOVE(LRUKReplacer);
 
   /**
-   * TODO(P1): Add implementation
-   *
    * @brief Destroys the LRUReplacer.
    */
-  ~LRUKReplacer() = default;
+  ~LRUKReplacer() override = default;
 
   /**
-   * TODO(P1): Add implementation
-   *
    * @brief Find the frame with largest backward k-distance and evict that frame. Only frames
    * that are marked as 'evictable' are candidates for eviction.
    *
@@ -70,24 +70,31 @@ class LRUKReplacer {
    * @param[out] frame_id id of frame that is evicted.
    * @return true if a frame is evicted successfully, false if no frames can be evicted.
    */
-  auto Evict(frame_id_t *frame_id) -> bool;
+  auto Evict(frame_id_t *frame_id) -> bool override;
+
+  /**
+   * @brief List the frames that would be evicted next, without evicting them.
+   * @param max_count the maximum number of frames to return
+   * @return up to max_count evictable frames, in the order in which Evict() would pick them
+   */
+  auto EvictionCandidates(size_t max_count) -> std::vector<frame_id_t> override;
 
   /**
-   * TODO(P1): Add implementation
-   *
    * @brief Record the event that the given frame id is accessed at current timestamp.
    * Create a new entry for access history if frame id has not been seen before.
    *
-   * If frame id is invalid (ie. larger than replacer_size_), throw an exception. You can
-   * also use BUSTUB_ASSERT to abort the process if frame id is invalid.
-   *
    * @param frame_id id of frame that received a new access.
+   * @throws Exception if the frame id is invalid, i.e. negative or not smaller than replacer_size_
    */
-  void RecordAccess(frame_id_t frame_id);
+  void RecordAccess(frame_id_t frame_id) override;
+
+  /**
+   * @brief Hits are not recorded: LRU-K only counts the loads of a page, since recording an access takes latch_ and
+   * would serialize the lock-free hit path of the buffer pool.
+   */
+  void RecordHit(frame_id_t frame_id) override {}
 
   /**
-   * TODO(P1): Add implementation
-   *
    * @brief Toggle whether a frame is evictable or non-evictable. This function also
    * controls replacer's size. Note that size is equal to number of evictable entries.
    *
@@ -95,18 +102,15 @@ class LRUKReplacer {
    * decrement. If a frame was previously non-evictable and is to be set to evictable,
    * then size should increment.
    *
-   * If frame id is invalid, throw an exception or abort the process.
-   *
    * For other scenarios, this function should terminate without modifying anything.
    *
    * @param frame_id id of frame whose 'evictable' status will be modified
    * @param set_evictable whether the given frame is evictable or not
+   * @throws Exception if the frame id is invalid
    */
-  void SetEvictable(frame_id_t frame_id, bool set_evictable);
+  void SetEvictable(frame_id_t frame_id, bool set_evictable) override;
 
   /**
-   * TODO(P1): Add implementation
-   *
    * @brief Remove an evictable frame from replacer, along with its access history.
    * This function should also decrement replacer's size if removal is successful.
    *
@@ -114,34 +118,63 @@ class LRUKReplacer {
    * with largest backward k-distance. This function removes specified frame id,
    * no matter what its backward k-distance is.
    *
-   * If Remove is called on a non-evictable frame, throw an exception or abort the
-   * process.
+   * A frame that is tracked but not evictable is removed as well; the buffer pool only removes frames that nobody
+   * has pinned.
    *
    * If specified frame is not found, directly return from this function.
    *
    * @param frame_id id of frame to be removed
+   * @throws Exception if the frame id is invalid
    */
-  void Remove(frame_id_t frame_id);
+  void Remove(frame_id_t frame_id) override;
 
   /**
-   * TODO(P1): Add implementation
-   *
    * @brief Return replacer's size, which tracks the number of evictable frames.
    *
    * @return size_t
    */
-  auto Size() -> size_t;
-  auto IncrementTimeStamp() -> void;
+  auto Size() -> size_t override;
+
  private:
-  // TODO(student): implement me! You can replace these member variables as you like.
-  // Remove maybe_unused if you start using them.
-  [[maybe_unused]] size_t current_timestamp_{0};
-  [[maybe_unused]] size_t curr_size_{0};
-  [[maybe_unused]] size_t replacer_size_;
-  [[maybe_unused]] size_t k_;
-  std::unordered_map<frame_id_t, std::list<size_t>> historyQueue;
-  std::unordered_map<frame_id_t, size_t> lastAccesedQueue;
-  std::unordered_map<frame_id_t, bool> IsEvictable;
+  /** Per-frame bookkeeping. The timestamps themselves live in the frame's ring in `history_`. */
+  struct FrameEntry {
+    /** Number of timestamps recorded in the ring, saturates at k. 0 means the frame is not tracked. */
+    size_t count_{0};
+    /** Ring position that the next access will be written to; once the ring is full it holds the oldest access. */
+    size_t next_{0};
+    bool evictable_{false};
+  };
+
+  /** (timestamp, frame) key of an evictable frame in `inf_index_` or `k_index_`. */
+  using IndexKey = std::pair<size_t, frame_id_t>;
+
+  /** @return true if the frame has been accessed fewer than k times, i.e. has +inf backward k-distance */
+  auto HasInfDistance(const FrameEntry &entry) const -> bool { return entry.count_ < k_; }
+
+  /** @return the key that orders the frame inside its index */
+  auto IndexKeyOf(frame_id_t frame_id) const -> IndexKey;
+
+  /** @return the index the frame belongs to while it is evictable */
+  auto IndexOf(const FrameEntry &entry) -> std::set<IndexKey> &;
+
+  /** @throws Exception if the frame id is not the id of one of the frames of the replacer */
+  void CheckFrameId(frame_id_t frame_id) const;
+
+  /** Forget everything about a frame, which must already be unlinked from the indexes. */
+  void ResetFrame(frame_id_t frame_id);
+
+  size_t current_timestamp_{0};
+  size_t curr_size_{0};
+  size_t replacer_size_;
+  size_t k_;
+  /** One entry per frame, indexed by frame id. */
+  std::vector<FrameEntry> frames_;
+  /** k timestamps per frame, frame f owns [f * k, (f + 1) * k). */
+  std::vector<size_t> history_;
+  /** Evictable frames with +inf backward k-distance, ordered by earliest access. */
+  std::set<IndexKey> inf_index_;
+  /** Evictable frames with k accesses, ordered by kth most recent access (largest k-distance first). */
+  std::set<IndexKey> k_index_;
 
   std::mutex latch_;
 };
@@ -0,0 +1,93 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// page_table.h
+//
+// Identification: src/include/buffer/page_table.h
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+
+#include "common/config.h"
+#include "common/macros.h"
+
+namespace bustub {
+
+/**
+ * PageTable maps the ids of the pages that are resident in a buffer pool to their frames.
+ *
+ * It is an open-addressing table with linear probing whose capacity is fixed to a power of two of at least four times
+ * the number of frames, so it never has to grow: while a dirty victim is written back, its frame is mapped under both
+ * the old and the new page, which still keeps the table at most half full. Every slot is one atomic 64-bit word holding
+ * a (page id, frame id) pair, which lets Find() run without any lock while another thread modifies the table.
+ *
+ * Insert() and Remove() must be serialized by the caller (the buffer pool does so with its latch). Remove() shifts the
+ * following entries of the probe sequence back instead of leaving tombstones, so a concurrent Find() can miss an entry
+ * that is being moved, and it can return a mapping that is removed right afterwards. Lock-free readers therefore have
+ * to validate the frame they found; readers that hold the writers' lock always get an exact answer.
+ */
+class PageTable {
+ public:
+  /**
+   * @brief Create a page table for a buffer pool with `num_frames` frames.
+   * @param num_frames the maximum number of pages that are mapped at the same time
+   */
+  explicit PageTable(size_t num_frames);
+
+  DISALLOW_COPY_AND_MOVE(PageTable);
+
+  /**
+   * @brief Look up the frame that holds a page. Safe to call concurrently with Insert() and Remove().
+   * @param page_id id of the page
+   * @param[out] frame_id frame that holds the page
+   * @return true if the page was found
+   */
+  auto Find(page_id_t page_id, frame_id_t *frame_id) const -> bool;
+
+  /**
+   * @brief Map a page to a frame, replacing an existing mapping of the same page.
+   * @param page_id id of the page, must not be INVALID_PAGE_ID
+   * @param frame_id frame that holds the page
+   */
+  void Insert(page_id_t page_id, frame_id_t frame_id);
+
+  /**
+   * @brief Remove the mapping of a page.
+   * @param page_id id of the page
+   * @return true if the page was mapped
+   */
+  auto Remove(page_id_t page_id) -> bool;
+
+  /** @return the number of slots in the table */
+  auto GetCapacity() const -> size_t { return mask_ + 1; }
+
+ private:
+  /** An empty slot; no valid page has the id INVALID_PAGE_ID. */
+  static constexpr uint64_t EMPTY_SLOT = ~static_cast<uint64_t>(0);
+
+  static auto Pack(page_id_t page_id, frame_id_t frame_id) -> uint64_t {
+    return (static_cast<uint64_t>(static_cast<uint32_t>(page_id)) << 32) | static_cast<uint32_t>(frame_id);
+  }
+  static auto PageIdOf(uint64_t slot) -> page_id_t { return static_cast<page_id_t>(slot >> 32); }
+  static auto FrameIdOf(uint64_t slot) -> frame_id_t { return static_cast<frame_id_t>(slot & 0xFFFFFFFF); }
+
+  /** @return the first slot of the probe sequence of a page */
+  auto HomeSlot(page_id_t page_id) const -> size_t;
+
+  /** Number of slots minus one; the number of slots is a power of two. */
+  size_t mask_;
+  /** 64 - log2(number of slots), used to take the high bits of the multiplicative hash. */
+  int shift_;
+  /** The slots, EMPTY_SLOT or a packed (page id, frame id) pair. */
+  std::unique_ptr<std::atomic<uint64_t>[]> slots_;
+};
+
+}  // namespace bustub
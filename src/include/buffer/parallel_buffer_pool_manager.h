@@ -0,0 +1,172 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// parallel_buffer_pool_manager.h
+//
+// Identification: src/include/buffer/parallel_buffer_pool_manager.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <mutex>  // NOLINT
+#include <vector>
+
+#include "buffer/buffer_pool_manager.h"
+#include "buffer/buffer_pool_manager_instance.h"
+#include "buffer/read_ahead.h"
+#include "recovery/log_manager.h"
+#include "storage/disk/disk_manager.h"
+#include "storage/page/page.h"
+
+namespace bustub {
+
+/**
+ * ParallelBufferPoolManager shards the buffer pool across several independent BufferPoolManagerInstances. Each
+ * instance has its own page table, replacer, free list and latch, so threads working on pages that live in different
+ * instances never contend with each other.
+ *
+ * A page always lives in instance (page_id % num_instances). New pages are handed out round-robin across the instances.
+ */
+class ParallelBufferPoolManager : public BufferPoolManager {
+ public:
+  /**
+   * Creates a new ParallelBufferPoolManager.
+   * @param num_instances the number of individual BufferPoolManagerInstances to store
+   * @param pool_size the pool size of each BufferPoolManagerInstance
+   * @param disk_manager the disk manager
+   * @param replacer_k the lookback constant k for the LRU-K replacer of each instance
+   * @param log_manager the log manager (for testing only: nullptr = disable logging)
+   * @param policy the replacement policy of each instance
+   */
+  ParallelBufferPoolManager(size_t num_instances, size_t pool_size, DiskManager *disk_manager,
+                            size_t replacer_k = LRUK_REPLACER_K, LogManager *log_manager = nullptr,
+                            ReplacerPolicy policy = replacer_policy);
+
+  /**
+   * Destroys an existing ParallelBufferPoolManager.
+   */
+  ~ParallelBufferPoolManager() override;
+
+  /** @return size of the buffer pool, summed over all instances */
+  auto GetPoolSize() -> size_t override;
+
+  /** @return number of free frames, summed over all instances */
+  auto GetFreeListSize() -> int override;
+
+  /** @return number of evictable frames, summed over all instances */
+  auto GetFreeEvictableSize() -> int override;
+
+  /** @return the number of instances the pool is sharded into */
+  auto GetNumInstances() const -> size_t { return instances_.size(); }
+
+  /** Start a background writer in every instance, with watermarks per instance (see BufferPoolManagerInstance). */
+  void RunBackgroundWriter(size_t low_watermark, size_t high_watermark);
+
+  /** Stop the background writers of all instances. */
+  void StopBackgroundWriter();
+
+  /** @return number of dirty victims written back by the evicting thread, summed over all instances */
+  auto GetForegroundWriteCount() const -> uint64_t;
+
+  /** @return number of dirty pages written back by the background writers, summed over all instances */
+  auto GetBackgroundWriteCount() const -> uint64_t;
+
+  /** Read the pages in the background. One worker serves all instances, since a chain crosses them. */
+  void PrefetchPages(const std::vector<page_id_t> &page_ids, BufferAccessStrategy *strategy) override;
+
+  /** Read the chain after page_id in the background, see ReadAhead::PrefetchChain(). */
+  void PrefetchChain(page_id_t page_id, size_t depth, NextPageIdFn next, BufferAccessStrategy *strategy) override;
+
+  /** Cancel the read-ahead into a ring, see ReadAhead::Cancel(). */
+  void CancelPrefetch(const BufferAccessStrategy *strategy) override;
+
+  /** Pass the hint on to the disk manager. All instances share it, so the first instance does that for all of them. */
+  void BeginSequentialScan() override { instances_[0]->BeginSequentialScan(); }
+
+  void EndSequentialScan() override { instances_[0]->EndSequentialScan(); }
+
+  /** Load the pages of every instance in one batch, see BufferPoolManagerInstance::LoadPages(). */
+  auto LoadPages(const std::vector<page_id_t> &page_ids, BufferAccessStrategy *strategy) -> size_t override;
+
+ protected:
+  /**
+   * @param page_id id of page
+   * @return pointer to the BufferPoolManagerInstance responsible for handling given page id
+   */
+  auto GetBufferPoolManager(page_id_t page_id) -> BufferPoolManagerInstance *;
+
+  /**
+   * Fetch the requested page from the responsible instance.
+   * @param page_id id of page to be fetched
+   * @return the requested page
+   */
+  auto FetchPgImp(page_id_t page_id) -> Page * override;
+
+  /**
+   * Fetch the requested page from the responsible instance on behalf of a bulk read.
+   * @param page_id id of page to be fetched
+   * @param strategy ring of frames the scan recycles
+   * @return the requested page
+   */
+  auto FetchPgImp(page_id_t page_id, BufferAccessStrategy *strategy) -> Page * override;
+
+  /**
+   * Unpin the target page from the responsible instance.
+   * @param page_id id of page to be unpinned
+   * @param is_dirty true if the page should be marked as dirty, false otherwise
+   * @return false if the page pin count is <= 0 before this call, true otherwise
+   */
+  auto UnpinPgImp(page_id_t page_id, bool is_dirty) -> bool override;
+
+  /**
+   * Flushes the target page to disk.
+   * @param page_id id of page to be flushed, cannot be INVALID_PAGE_ID
+   * @return false if the page could not be found in the page table, true otherwise
+   */
+  auto FlushPgImp(page_id_t page_id) -> bool override;
+
+  /**
+   * Creates a new page. Instances are tried round-robin, starting one past the instance that served the previous
+   * call, until one of them has a frame to spare.
+   * @param[out] page_id id of created page
+   * @return nullptr if no new pages could be created, otherwise pointer to new page
+   */
+  auto NewPgImp(page_id_t *page_id) -> Page * override;
+
+  /**
+   * Creates a new page next to a page of the same object, trying the instances like NewPgImp(page_id). Page ids are
+   * striped across the instances, so the page lands in the extent of near_page_id among the ids of its instance.
+   */
+  auto NewPgImp(page_id_t *page_id, page_id_t near_page_id) -> Page * override;
+
+  /**
+   * Deletes a page from the responsible instance.
+   * @param page_id id of page to be deleted
+   * @return false if the page exists but could not be deleted, true if the page didn't exist or deletion succeeded
+   */
+  auto DeletePgImp(page_id_t page_id) -> bool override;
+
+  /**
+   * Flushes all the pages of every instance to disk, and syncs the disk once after all of them are written.
+   */
+  void FlushAllPgsImp() override;
+
+ private:
+  /** The sharded instances; instance i owns every page with page_id % instances_.size() == i. */
+  std::vector<std::unique_ptr<BufferPoolManagerInstance>> instances_;
+  /** Instance that NewPgImp tries first on its next call. */
+  std::atomic<size_t> next_instance_{0};
+  /** The disk shared by the instances. */
+  DiskManager *disk_manager_;
+  /** Read-ahead worker, started by the first hint. */
+  std::unique_ptr<ReadAhead> read_ahead_;
+  std::once_flag read_ahead_started_;
+};
+
+}  // namespace bustub
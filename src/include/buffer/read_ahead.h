@@ -0,0 +1,115 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// read_ahead.h
+//
+// Identification: src/include/buffer/read_ahead.h
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>  // NOLINT
+#include <deque>
+#include <mutex>   // NOLINT
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "buffer/buffer_pool_manager.h"
+#include "common/config.h"
+#include "common/macros.h"
+#include "storage/disk/disk_manager.h"
+
+namespace bustub {
+
+/**
+ * ReadAhead reads pages into a buffer pool before they are fetched.
+ *
+ * Hints are queued and served by a single worker thread. Pages of a chain are fetched through the buffer pool one by
+ * one and unpinned right away, since every page names the next one; runs of plain hints are loaded with a single
+ * BufferPoolManager::LoadPages() call, so that their reads overlap. A scan that reaches a page while it is still being
+ * read waits for that read in FetchPage; pages that are already resident cost the worker one pin. Hints are dropped
+ * when the queue is full or when the pool has no frame to spare, since read-ahead must never make a query fail.
+ */
+class ReadAhead {
+ public:
+  /**
+   * @brief Start the worker thread.
+   * @param bpm the buffer pool to read pages into; must outlive the ReadAhead
+   * @param disk_manager the disk that bpm reads from, if not nullptr; the worker stops when it shuts down, and later
+   * hints are dropped, so it may go away before the buffer pool
+   */
+  explicit ReadAhead(BufferPoolManager *bpm, DiskManager *disk_manager = nullptr);
+
+  DISALLOW_COPY_AND_MOVE(ReadAhead);
+
+  /** @brief Stop the worker thread. Hints that are still queued are dropped. */
+  ~ReadAhead();
+
+  /**
+   * @brief Read the given pages in the background, in this order.
+   * @param page_ids ids of the pages that are about to be fetched
+   * @param strategy the ring to read the pages into, or nullptr; see Cancel()
+   */
+  void Prefetch(const std::vector<page_id_t> &page_ids, BufferAccessStrategy *strategy = nullptr);
+
+  /**
+   * @brief Read the pages that follow a page in a linked chain of pages in the background. The worker fetches `page_id`
+   * itself (usually resident already) to find the first link.
+   * @param page_id the page that is being read now
+   * @param depth number of pages after page_id to read
+   * @param next extracts the id of the following page from a fetched page of the chain
+   * @param strategy the ring to read the pages into, or nullptr; see Cancel()
+   */
+  void PrefetchChain(page_id_t page_id, size_t depth, BufferPoolManager::NextPageIdFn next,
+                     BufferAccessStrategy *strategy = nullptr);
+
+  /**
+   * @brief Drop the hints that read into a ring, and wait until the worker is done with the one it serves. Called
+   * before the strategy goes away.
+   */
+  void Cancel(const BufferAccessStrategy *strategy);
+
+  /** @return number of pages that the worker fetched on behalf of hints */
+  auto GetPrefetchCount() const -> uint64_t { return prefetch_count_; }
+
+ private:
+  /** A page to read, and how many pages of its chain to read after it (next_ is nullptr for a plain Prefetch()). */
+  struct Request {
+    page_id_t page_id_;
+    size_t chain_depth_;
+    BufferPoolManager::NextPageIdFn next_;
+    BufferAccessStrategy *strategy_;
+  };
+
+  /** Hints beyond this many queued requests are dropped. */
+  static constexpr size_t MAX_QUEUED_REQUESTS = 256;
+  /** Plain hints into the same ring are handed to BufferPoolManager::LoadPages() in batches of at most this many. */
+  static constexpr size_t MAX_BATCHED_READS = 32;
+
+  void WorkerLoop();
+
+  /** Stop the worker thread, if it is still running, and drop the hints from now on. */
+  void Stop();
+
+  BufferPoolManager *bpm_;
+  /** The disk with the shutdown hook that calls Stop(), nullptr once it was called. */
+  std::atomic<DiskManager *> disk_manager_;
+  size_t shutdown_hook_id_{0};
+  /** Protects queue_ and running_. */
+  std::mutex latch_;
+  std::condition_variable cv_;
+  std::deque<Request> queue_;
+  bool running_{true};
+  /** The ring of the request that the worker serves, nullptr if none; see Cancel(). */
+  const BufferAccessStrategy *serving_{nullptr};
+  std::condition_variable served_cv_;
+  std::atomic<uint64_t> prefetch_count_{0};
+  std::thread worker_;
+};
+
+}  // namespace bustub
@@ -24,6 +24,7 @@
 #include "storage/index/b_plus_tree_index.h"
 #include "storage/index/extendible_hash_table_index.h"
 #include "storage/index/index.h"
+#include "storage/table/column_table.h"
 #include "storage/table/table_heap.h"
 
 namespace bustub {
@@ -43,7 +44,7 @@ struct TableInfo {
    * Construct a new TableInfo instance.
    * @param schema The table schema
    * @param name The table name
-   * @param table An owning pointer to the table heap
+   * @param table An owning pointer to the table heap, nullptr for a columnar table
    * @param oid The unique OID for the table
    */
   TableInfo(Schema schema, std::string name, std::unique_ptr<TableHeap> &&table, table_oid_t oid)
@@ -54,6 +55,8 @@ struct TableInfo {
   const std::string name_;
   /** An owning pointer to the table heap */
   std::unique_ptr<TableHeap> table_;
+  /** An owning pointer to the column table of a columnar table, which has no table heap */
+  std::unique_ptr<ColumnTable> column_table_;
   /** The table OID */
   const table_oid_t oid_;
 };
@@ -121,22 +124,34 @@ class Catalog {
    * @param table_name The name of the new table, note that all tables beginning with `__` are reserved for the system.
    * @param schema The schema of the new table
    * @param create_table_heap whether to create a table heap for the new table
+   * @param layout how the pages of the table heap store its tuples
+   * @param engine what stores the tuples; a columnar table has a ColumnTable instead of a table heap, and no layout
    * @return A (non-owning) pointer to the metadata for the table
+   * @throw Exception if the layout is PAX and the schema does not fit it, see TableHeap::UsePaxLayout()
    */
-  auto CreateTable(Transaction *txn, const std::string &table_name, const Schema &schema, bool create_table_heap = true)
-      -> TableInfo * {
+  auto CreateTable(Transaction *txn, const std::string &table_name, const Schema &schema, bool create_table_heap = true,
+                   TableLayout layout = TableLayout::ROW, TableEngine engine = TableEngine::HEAP) -> TableInfo * {
     if (table_names_.count(table_name) != 0) {
       return NULL_TABLE_INFO;
     }
 
     // Construct the table heap
     std::unique_ptr<TableHeap> table = nullptr;
+    std::unique_ptr<ColumnTable> column_table = nullptr;
 
     // TODO(Wan,chi): This should be refactored into a private ctor for the binder tests, we shouldn't allow nullptr.
     // When create_table_heap == false, it means that we're running binder tests (where no txn will be provided) or
     // we are running shell without buffer pool. We don't need to create TableHeap in this case.
-    if (create_table_heap) {
+    if (create_table_heap && engine == TableEngine::COLUMNAR) {
+      column_table = std::make_unique<ColumnTable>(bpm_, schema);
+    } else if (create_table_heap) {
       table = std::make_unique<TableHeap>(bpm_, lock_manager_, log_manager_, txn);
+      if (layout == TableLayout::PAX) {
+        table->UsePaxLayout(schema);
+      }
+      if (enable_zone_maps) {
+        table->EnableZoneMap(schema);
+      }
     }
 
     // Fetch the table OID for the new table
@@ -144,6 +159,7 @@ class Catalog {
 
     // Construct the table information
     auto meta = std::make_unique<TableInfo>(schema, table_name, std::move(table), table_oid);
+    meta->column_table_ = std::move(column_table);
     auto *tmp = meta.get();
 
     // Update the internal tracking mechanisms
@@ -217,6 +233,11 @@ class Catalog {
       return NULL_INDEX_INFO;
     }
 
+    // Reject the creation request for a columnar table, whose rows move when they are updated
+    if (GetTable(table_name)->column_table_ != nullptr) {
+      return NULL_INDEX_INFO;
+    }
+
     // Construct index metdata
     auto meta = std::make_unique<IndexMetadata>(index_name, table_name, &schema, key_attrs);
 
@@ -231,8 +252,10 @@ class Catalog {
     // Populate the index with all tuples in table heap
     auto *table_meta = GetTable(table_name);
     auto *heap = table_meta->table_.get();
-    //Traverse all the table and insert its tuples in the index
-    for (auto tuple = heap->Begin(txn); tuple != heap->End(); ++tuple) {
+    //Traverse all the table and insert its tuples in the index; the scan recycles a ring of frames so that the
+    //backfill does not push the rest of the database out of the buffer pool
+    BufferAccessStrategy strategy(bulk_read_ring_size);
+    for (auto tuple = heap->Begin(txn, &strategy); tuple != heap->End(); ++tuple) {
       index->InsertEntry(tuple->KeyFromTuple(schema, key_schema, key_attrs), tuple->GetRid(), txn);
     }
 
@@ -210,10 +210,24 @@ class BustubInstance {
    */
   auto MakeExecutorContext(Transaction *txn) -> std::unique_ptr<ExecutorContext>;
 
+  /**
+   * Create the buffer pool. With more than one instance, the frames are split across the shards of a
+   * ParallelBufferPoolManager so that concurrent queries do not serialize on a single buffer pool latch.
+   */
+  auto MakeBufferPoolManager(size_t pool_size, size_t bpm_instances) -> BufferPoolManager *;
+
  public:
-  explicit BustubInstance(const std::string &db_file_name);
+  /**
+   * @param db_file_name the database file
+   * @param bpm_instances number of buffer pool shards (1 = a single BufferPoolManagerInstance)
+   */
+  explicit BustubInstance(const std::string &db_file_name, size_t bpm_instances = 1);
 
-  BustubInstance();
+  /**
+   * Create an in-memory BusTub instance.
+   * @param bpm_instances number of buffer pool shards (1 = a single BufferPoolManagerInstance)
+   */
+  explicit BustubInstance(size_t bpm_instances = 1);
 
   ~BustubInstance();
 
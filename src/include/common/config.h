@@ -14,6 +14,7 @@
 
 #include <atomic>
 #include <chrono>  // NOLINT
+#include <cstddef>
 #include <cstdint>
 
 namespace bustub {
@@ -27,11 +28,84 @@ extern std::atomic<bool> enable_logging;
 /** If ENABLE_LOGGING is true, the log should be flushed to disk every LOG_TIMEOUT. */
 extern std::chrono::duration<int64_t> log_timeout;
 
+/** A running background writer of the buffer pool looks for dirty pages at least every BGWRITER_INTERVAL. */
+extern std::chrono::milliseconds bgwriter_interval;
+
+/**
+ * True if BustubInstance runs the background writer of its buffer pool, which keeps the next frames to be evicted
+ * clean, see BufferPoolManagerInstance::RunBackgroundWriter().
+ */
+extern bool enable_bgwriter;
+
+/**
+ * Number of pages that sequential and index scans ask the buffer pool to read ahead, 0 disables read-ahead. Set from
+ * SQL with `SET read_ahead_depth = n`.
+ */
+extern std::atomic<size_t> read_ahead_depth;
+
+/** Number of frames that a full table scan or an index build recycles instead of using the whole pool, 0 = no limit. */
+extern size_t bulk_read_ring_size;
+
+/** Replacement policy of a buffer pool. */
+enum class ReplacerPolicy {
+  /** LRUKReplacer, which tracks the last k loads of every frame. */
+  LRU_K,
+  /** ClockReplacer, a lock-free GCLOCK sweep over per-frame usage counts. */
+  CLOCK,
+};
+
+/** Replacement policy of buffer pools that are not given one explicitly. */
+extern ReplacerPolicy replacer_policy;
+
+/** True if buffer pools should ask for transparent huge pages to back the data of their frames. */
+extern bool buffer_pool_huge_pages;
+
+/**
+ * True if BustubInstance opens its database file with O_DIRECT, so that pages are cached by the buffer pool only and
+ * not a second time by the OS page cache.
+ */
+extern bool database_direct_io;
+
+/**
+ * True if table heaps and indexes allocate their pages in extents of contiguous pages reserved for them, so that their
+ * pages stay together on disk even when several of them grow at the same time. False hands out the lowest free page.
+ */
+extern bool extent_allocation;
+
+/**
+ * True if a committed delete or a rolled back insert that leaves a table page without tuples unlinks the page from its
+ * heap right away, as VACUUM does. False leaves empty pages in the heap until the next VACUUM.
+ */
+extern bool auto_vacuum;
+
+/**
+ * True if the catalog gives new tables a zone map of their fixed-width columns, which scans with a range predicate
+ * use to pass over pages. A zone map costs every insert and update a write of its entry.
+ */
+extern bool enable_zone_maps;
+
+/** How the pages of a table heap store its tuples, chosen per table when the table is created. */
+enum class TableLayout {
+  /** Slotted pages, which store every tuple in one piece, see TablePage. */
+  ROW,
+  /** PAX pages, which store the tuples column by column in a minipage per column; fixed-width columns only. */
+  PAX,
+};
+
+/** What stores the tuples of a table, chosen per table when the table is created. */
+enum class TableEngine {
+  /** A TableHeap, in the layout of the table. */
+  HEAP,
+  /** A ColumnTable, which stores every column on pages of its own, for tables mostly appended to and scanned. */
+  COLUMNAR,
+};
+
 static constexpr int INVALID_PAGE_ID = -1;                                           // invalid page id
 static constexpr int INVALID_TXN_ID = -1;                                            // invalid transaction id
 static constexpr int INVALID_LSN = -1;                                               // invalid log sequence number
 static constexpr int HEADER_PAGE_ID = 0;                                             // the header page id
 static constexpr int BUSTUB_PAGE_SIZE = 4096;                                        // size of a data page in byte
+static constexpr int BUSTUB_CACHELINE_SIZE = 64;                                     // size of a cache line in byte
 static constexpr int BUFFER_POOL_SIZE = 10;                                          // size of buffer pool
 static constexpr int LOG_BUFFER_SIZE = ((BUFFER_POOL_SIZE + 1) * BUSTUB_PAGE_SIZE);  // size of a log buffer in byte
 static constexpr int BUCKET_SIZE = 50;                                               // size of extendible hash bucket
@@ -32,6 +32,7 @@ enum class StatementType : uint8_t {
   INDEX_STATEMENT,          // index statement type
   VARIABLE_SET_STATEMENT,   // set variable statement type
   VARIABLE_SHOW_STATEMENT,  // show variable statement type
+  VACUUM_STATEMENT,         // vacuum statement type
 };
 
 }  // namespace bustub
@@ -75,6 +76,9 @@ struct fmt::formatter<bustub::StatementType> : formatter<string_view> {
       case bustub::StatementType::VARIABLE_SET_STATEMENT:
         name = "VariableSet";
         break;
+      case bustub::StatementType::VACUUM_STATEMENT:
+        name = "Vacuum";
+        break;
     }
     return formatter<string_view>::format(name, ctx);
   }
@@ -49,6 +49,8 @@ enum class ExceptionType {
   NOT_IMPLEMENTED = 11,
   /** Execution exception. */
   EXECUTION = 12,
+  /** Write to a database that is open read-only. */
+  READ_ONLY = 13,
 };
 
 class Exception : public std::runtime_error {
@@ -104,6 +106,8 @@ class Exception : public std::runtime_error {
         return "Out of Memory";
       case ExceptionType::NOT_IMPLEMENTED:
         return "Not implemented";
+      case ExceptionType::READ_ONLY:
+        return "Read Only";
       default:
         return "Unknown";
     }
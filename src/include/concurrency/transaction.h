@@ -55,6 +55,7 @@ enum class IsolationLevel { READ_UNCOMMITTED, REPEATABLE_READ, READ_COMMITTED };
 enum class WType { INSERT = 0, DELETE, UPDATE };
 
 class TableHeap;
+class ColumnTable;
 class Catalog;
 using table_oid_t = uint32_t;
 using index_oid_t = uint32_t;
@@ -67,12 +68,18 @@ class TableWriteRecord {
   TableWriteRecord(RID rid, WType wtype, const TupleRecord &tuple, TableHeap *table)
       : rid_(rid), wtype_(wtype), tuple_(tuple), table_(table) {}
 
+  /** A write to a columnar table, which is an INSERT or a DELETE; an update is both. */
+  TableWriteRecord(RID rid, WType wtype, ColumnTable *column_table)
+      : rid_(rid), wtype_(wtype), table_(nullptr), column_table_(column_table) {}
+
   RID rid_;
   WType wtype_;
   /** The tuple is only used for the update operation. */
   TupleRecord tuple_;
   /** The table heap specifies which table this write record is for. */
   TableHeap *table_;
+  /** The columnar table that this write record is for instead, if table_ is nullptr. */
+  ColumnTable *column_table_{nullptr};
 };
 
 /**
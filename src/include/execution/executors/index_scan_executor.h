@@ -46,6 +46,8 @@ class IndexScanExecutor : public AbstractExecutor {
   const IndexScanPlanNode *plan_;
   std::vector<RID>recordsIds;  
   int index;
+  /** Position in recordsIds up to which the heap pages were handed to the buffer pool for read-ahead. */
+  size_t prefetched_until_{0};
 };
 }  // namespace bustub
  
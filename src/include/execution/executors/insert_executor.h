@@ -14,6 +14,7 @@
 
 #include <memory>
 #include <utility>
+#include <vector>
 
 #include "execution/executor_context.h"
 #include "execution/executors/abstract_executor.h"
@@ -60,6 +61,8 @@ class InsertExecutor : public AbstractExecutor {
   std::unique_ptr<AbstractExecutor> child_executor_;
   const InsertPlanNode *plan_;
   int noOfCalls;
+  /** Number of child tuples inserted into the table heap with one TableHeap::InsertTuples() call */
+  static constexpr size_t BATCH_SIZE = 256;
 };
 
 }  // namespace bustub
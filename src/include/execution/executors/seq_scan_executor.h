@@ -67,17 +67,24 @@
 
 #pragma once
 
+#include <memory>
 #include <vector>
 
+#include "buffer/buffer_access_strategy.h"
 #include "execution/executor_context.h"
 #include "execution/executors/abstract_executor.h"
 #include "execution/plans/seq_scan_plan.h"
+#include "storage/table/column_table.h"
 #include "storage/table/tuple.h"
 
 namespace bustub {
 
 /**
- * The SeqScanExecutor executor executes a sequential table scan.
+ * The SeqScanExecutor executor executes a sequential table scan. If the plan has a filter predicate, the scan only
+ * returns the tuples it is true for, and does not read the pages that the zone map of the table rules out for it.
+ *
+ * A columnar table is read by a ColumnTable::Scanner instead, which only decodes the columns that the plan names and
+ * passes over the row groups that the ranges of their segments rule out.
  */
 class SeqScanExecutor : public AbstractExecutor {
  public:
@@ -88,6 +95,9 @@ class SeqScanExecutor : public AbstractExecutor {
    */
   SeqScanExecutor(ExecutorContext *exec_ctx, const SeqScanPlanNode *plan);
 
+  /** Ends the hint of a scan that was not read to the end */
+  ~SeqScanExecutor() override;
+
   /** Initialize the sequential scan */
   void Init() override;
 
@@ -105,7 +115,20 @@ class SeqScanExecutor : public AbstractExecutor {
  private:
   /** The sequential scan plan node to be executed */
   const SeqScanPlanNode *plan_;
+  /** The ring of frames the scan reads the table into, so that it does not flush the buffer pool */
+  BufferAccessStrategy strategy_;
+  /** The ranges that the filter predicate puts on columns, which the iterator passes over pages with */
+  std::vector<ZoneMap::Range> zone_filter_;
   /** The table iterator for the target table */
   TableIterator iter_;
+  /** The scanner of the target table, if it is a columnar table */
+  std::unique_ptr<ColumnTable::Scanner> column_scanner_;
+  /** The values of the row that the scanner returned last */
+  std::vector<Value> column_values_;
+  /** True from Init() until the end of the scan, while the buffer pool is told that a sequential scan runs */
+  bool scan_hinted_{false};
+
+  /** Tell the buffer pool that the scan ended, if it was told that it started */
+  void EndScanHint();
 };
 }  // namespace bustub
\ No newline at end of file
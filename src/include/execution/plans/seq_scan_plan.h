@@ -13,8 +13,10 @@
 #pragma once
 
 #include <memory>
+#include <optional>
 #include <string>
 #include <utility>
+#include <vector>
 
 #include "binder/table_ref/bound_base_table_ref.h"
 #include "catalog/catalog.h"
@@ -57,17 +59,26 @@ class SeqScanPlanNode : public AbstractPlanNode {
   /** The table name */
   std::string table_name_;
 
-  /** The predicate to filter in seqscan. It will ALWAYS be nullptr until you enable the MergeFilterScan rule.
-      You don't need to handle it to get a perfect score as of in Fall 2022.
+  /** The predicate to filter in seqscan, set by the MergeFilterScan rule. The scan uses it to pass over pages with the
+      zone map of the table, too.
   */
   AbstractExpressionRef filter_predicate_;
 
+  /** The columns that the plan above the scan reads, set by the PruneScanColumns rule for a columnar table. The scan
+      only reads these from the table and returns nulls for the others; if unset, it reads all columns.
+  */
+  std::optional<std::vector<uint32_t>> column_ids_;
+
  protected:
   auto PlanNodeToString() const -> std::string override {
+    std::string columns;
+    if (column_ids_.has_value()) {
+      columns = fmt::format(", columns=[{}]", fmt::join(*column_ids_, ", "));
+    }
     if (filter_predicate_) {
-      return fmt::format("SeqScan {{ table={}, filter={} }}", table_name_, filter_predicate_);
+      return fmt::format("SeqScan {{ table={}, filter={}{} }}", table_name_, filter_predicate_, columns);
     }
-    return fmt::format("SeqScan {{ table={} }}", table_name_);
+    return fmt::format("SeqScan {{ table={}{} }}", table_name_, columns);
   }
 };
 
@@ -65,6 +65,18 @@ class Optimizer {
    */
   auto OptimizeMergeFilterScan(const AbstractPlanNodeRef &plan) -> AbstractPlanNodeRef;
 
+  /**
+   * @brief annotate the seq scans of columnar tables with the columns that the plan reads from them, so that the
+   * scans decode no other columns
+   */
+  auto OptimizePruneScanColumns(const AbstractPlanNodeRef &plan) -> AbstractPlanNodeRef;
+
+  /**
+   * @brief prune the scans below a plan node
+   * @param required per output column of the plan node, whether the plan above it reads the column
+   */
+  auto PruneScanColumns(const AbstractPlanNodeRef &plan, const std::vector<bool> &required) -> AbstractPlanNodeRef;
+
   /**
    * @brief rewrite expression to be used in nested loop joins. e.g., if we have `SELECT * FROM a, b WHERE a.x = b.y`,
    * we will have `#0.x = #0.y` in the filter plan node. We will need to figure out where does `0.x` and `0.y` belong
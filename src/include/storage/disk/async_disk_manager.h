@@ -0,0 +1,125 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// async_disk_manager.h
+//
+// Identification: src/include/storage/disk/async_disk_manager.h
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <condition_variable>  // NOLINT
+#include <cstdlib>
+#include <deque>
+#include <future>  // NOLINT
+#include <memory>
+#include <mutex>   // NOLINT
+#include <string>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "common/macros.h"
+#include "storage/disk/disk_manager.h"
+
+namespace bustub {
+
+/**
+ * AsyncDiskManager is a DiskManager whose ReadPageAsync() and WritePageAsync() do not block.
+ *
+ * Requests are collected until SubmitIO() is called, or until queue_depth of them are waiting, and then handed to the
+ * kernel in one io_uring_enter() call; a reaper thread completes the futures. Never more than queue_depth requests are
+ * in flight. If io_uring is not available (old kernel, seccomp, or disabled by the caller), a pool of queue_depth
+ * threads serves the requests with pread/pwrite instead, so callers see the same behaviour either way.
+ *
+ * The synchronous ReadPage() and WritePage() of DiskManager are unchanged. In direct I/O mode, requests on buffers that
+ * are not aligned go through an aligned copy.
+ */
+class AsyncDiskManager : public DiskManager {
+ public:
+  /**
+   * @brief Open the database file and set up io_uring or the fallback threads.
+   * @param db_file the file name of the database file
+   * @param queue_depth maximum number of requests in flight
+   * @param use_io_uring false to always use the fallback threads
+   * @param direct_io true to bypass the OS page cache, see DiskManager
+   */
+  explicit AsyncDiskManager(const std::string &db_file, size_t queue_depth = DEFAULT_QUEUE_DEPTH,
+                            bool use_io_uring = true, bool direct_io = false);
+
+  DISALLOW_COPY_AND_MOVE(AsyncDiskManager);
+
+  /** @brief Wait for every request, then stop the reaper or the fallback threads. */
+  ~AsyncDiskManager() override;
+
+  auto ReadPageAsync(page_id_t page_id, char *page_data) -> std::future<void> override;
+
+  auto WritePageAsync(page_id_t page_id, const char *page_data) -> std::future<void> override;
+
+  void SubmitIO() override;
+
+  /** @return true if requests go through io_uring, false if the fallback threads serve them */
+  auto IsUsingIoUring() const -> bool { return ring_fd_ >= 0; }
+
+  static constexpr size_t DEFAULT_QUEUE_DEPTH = 64;
+
+ private:
+  struct Request {
+    bool is_write_;
+    page_id_t page_id_;
+    char *data_;
+    std::promise<void> done_;
+    /** Aligned copy of data_ that io_uring transfers instead, if data_ is not aligned for direct I/O. */
+    std::unique_ptr<char, decltype(&free)> bounce_{nullptr, &free};
+  };
+
+  auto Enqueue(bool is_write, page_id_t page_id, char *data) -> std::future<void>;
+  /** @return false if the kernel does not support io_uring */
+  auto SetUpRing() -> bool;
+  void TearDownRing();
+  /** Put requests into the submission queue and enter the kernel, at most queue_depth_ in flight at a time. */
+  void SubmitToRing(const std::vector<Request *> &requests);
+  void ReaperLoop();
+  void WorkerLoop();
+
+  const size_t queue_depth_;
+
+  /** Requests that wait for SubmitIO(). */
+  std::vector<Request *> pending_;
+  std::mutex pending_latch_;
+
+  /** io_uring state, only set up if ring_fd_ >= 0. */
+  int ring_fd_{-1};
+  void *sq_ring_{nullptr};
+  size_t sq_ring_size_{0};
+  void *cq_ring_{nullptr};
+  size_t cq_ring_size_{0};
+  void *sqes_{nullptr};
+  size_t sqes_size_{0};
+  unsigned *sq_tail_{nullptr};
+  unsigned *sq_mask_{nullptr};
+  unsigned *sq_array_{nullptr};
+  unsigned *cq_head_{nullptr};
+  unsigned *cq_tail_{nullptr};
+  unsigned *cq_mask_{nullptr};
+  void *cqes_{nullptr};
+  /** Protects the submission queue, in_flight_ and stop_reaper_. */
+  std::mutex ring_latch_;
+  std::condition_variable ring_cv_;
+  size_t in_flight_{0};
+  /** Set if the request to stop the reaper could not be submitted; the reaper then stops once nothing is in flight. */
+  bool stop_reaper_{false};
+  std::thread reaper_;
+
+  /** Fallback thread pool. */
+  std::deque<Request *> work_queue_;
+  std::mutex work_latch_;
+  std::condition_variable work_cv_;
+  bool stopping_{false};
+  std::vector<std::thread> workers_;
+};
+
+}  // namespace bustub
@@ -12,32 +12,51 @@
 
 #pragma once
 
+#include <sys/types.h>
+
 #include <atomic>
+#include <cstdint>
 #include <fstream>
+#include <functional>
 #include <future>  // NOLINT
 #include <mutex>   // NOLINT
 #include <string>
+#include <utility>
+#include <vector>
 
 #include "common/config.h"
+#include "storage/disk/page_allocator.h"
 
 namespace bustub {
 
 /**
  * DiskManager takes care of the allocation and deallocation of pages within a database. It performs the reading and
  * writing of pages to and from disk, providing a logical file layer within the context of a database management system.
+ *
+ * The first page of the database file is a header, see FILE_FORMAT_VERSION. Which pages are allocated is tracked by a
+ * PageAllocator. In the database file, every group of PageAllocator::PAGES_PER_MAP pages is preceded by the space map
+ * page of the group, so page p is stored at file page p + p / PAGES_PER_MAP + 2. Space maps are loaded when the file
+ * is opened, and the changed ones are written by Sync(), before it makes the pages durable; so no page that was on
+ * disk at the last Sync() can be handed out again after a crash.
+ *
+ * In direct I/O mode the database file is opened with O_DIRECT and pages bypass the OS page cache. Every transfer then
+ * needs a buffer aligned to DIRECT_IO_ALIGNMENT; buffer pool frames are, other buffers are copied through an aligned
+ * one. Writes still become durable only at the next Sync(). The log file is not affected.
  */
 class DiskManager {
  public:
   /**
    * Creates a new disk manager that writes to the specified database file.
    * @param db_file the file name of the database file to write to
+   * @param direct_io true to bypass the OS page cache; ignored if the file system does not support O_DIRECT
    */
-  explicit DiskManager(const std::string &db_file);
+  explicit DiskManager(const std::string &db_file, bool direct_io = false);
 
   /** FOR TEST / LEADERBOARD ONLY, used by DiskManagerMemory */
   DiskManager() = default;
 
-  virtual ~DiskManager() = default;
+  /** Writes back the space maps if the database file is still open. */
+  virtual ~DiskManager();
 
   /**
    * Shut down the disk manager and close all the file resources.
@@ -45,19 +64,102 @@ class DiskManager {
   void ShutDown();
 
   /**
-   * Write a page to the database file.
+   * Register a function that stops a background reader of the database file, e.g. a ReadAhead. ShutDown() and the
+   * destructor call it, and forget it, before they close the file.
+   * @return the id to remove the hook with
+   */
+  auto AddShutdownHook(std::function<void()> hook) -> size_t;
+
+  /** Forget a hook of AddShutdownHook() that was not called yet. */
+  void RemoveShutdownHook(size_t hook_id);
+
+  /**
+   * Write a page to the database file. Writes of different pages may run concurrently. The write is not durable until
+   * the next Sync().
    * @param page_id id of the page
    * @param page_data raw page data
    */
   virtual void WritePage(page_id_t page_id, const char *page_data);
 
   /**
-   * Read a page from the database file.
+   * Read a page from the database file. Reads may run concurrently with each other and with writes of other pages.
    * @param page_id id of the page
    * @param[out] page_data output buffer
    */
   virtual void ReadPage(page_id_t page_id, char *page_data);
 
+  /**
+   * Write many pages at once. The pages are sorted by page id, and every run of pages that are adjacent in the file
+   * goes to disk with a single pwritev(). Like WritePage(), the writes are not durable until the next Sync().
+   * @param pages ids and raw data of the pages, in any order
+   */
+  virtual void WritePages(std::vector<std::pair<page_id_t, const char *>> pages);
+
+  /**
+   * Start reading a page. Requests may be held back until SubmitIO(), so that they reach the disk in one batch.
+   * The base implementation reads the page right away.
+   * @param page_id id of the page
+   * @param[out] page_data output buffer; must stay valid until the returned future is ready
+   * @return a future that is ready once the page has been read
+   */
+  virtual auto ReadPageAsync(page_id_t page_id, char *page_data) -> std::future<void>;
+
+  /**
+   * Start writing a page, see ReadPageAsync(). The base implementation writes the page right away.
+   * @param page_id id of the page
+   * @param page_data raw page data; must stay valid and unchanged until the returned future is ready
+   * @return a future that is ready once the page has been written
+   */
+  virtual auto WritePageAsync(page_id_t page_id, const char *page_data) -> std::future<void>;
+
+  /**
+   * Send every asynchronous request that is held back to the disk. Callers that wait for a batch of futures have to
+   * call this first.
+   */
+  virtual void SubmitIO() {}
+
+  /**
+   * Wait until every page written so far, and the space maps of the pages allocated so far, are on stable storage.
+   */
+  virtual void Sync();
+
+  /**
+   * Allocate a page in the database file, reusing the lowest free page id.
+   * @param instance_index index of the buffer pool instance that needs the page
+   * @param num_instances number of buffer pool instances; page ids are striped across them
+   * @return the id of the allocated page
+   */
+  virtual auto AllocatePage(uint32_t instance_index = 0, uint32_t num_instances = 1) -> page_id_t;
+
+  /**
+   * Allocate a page of an object that grows page by page, next to another page of the object, see
+   * PageAllocator::AllocateNear(). Like AllocatePage() if extent_allocation is off.
+   * @param near_page_id a page of the object, or INVALID_PAGE_ID for the first page of a new object
+   * @param instance_index index of the buffer pool instance that needs the page
+   * @param num_instances number of buffer pool instances; page ids are striped across them
+   * @return the id of the allocated page
+   */
+  virtual auto AllocatePageNear(page_id_t near_page_id, uint32_t instance_index = 0, uint32_t num_instances = 1)
+      -> page_id_t;
+
+  /**
+   * Free a page in the database file, so that its id can be allocated again.
+   * @param page_id id of the page
+   */
+  virtual void DeallocatePage(page_id_t page_id);
+
+  /** @return true if the page is allocated */
+  auto IsAllocated(page_id_t page_id) -> bool;
+
+  /**
+   * Hint that a sequential scan starts, so that the disk can read ahead of it. Scans may overlap; every call has to be
+   * matched by an EndSequentialScan(). The base implementation ignores the hint.
+   */
+  virtual void BeginSequentialScan() {}
+
+  /** Hint that a sequential scan ended, see BeginSequentialScan(). */
+  virtual void EndSequentialScan() {}
+
   /**
    * Flush the entire log buffer into disk.
    * @param log_data raw log data
@@ -74,6 +176,24 @@ class DiskManager {
    */
   auto ReadLog(char *log_data, int size, int offset) -> bool;
 
+  /** @return true if the database file was opened with O_DIRECT */
+  auto IsDirectIO() const -> bool { return direct_io_; }
+
+  /** Alignment of buffers, offsets and lengths that O_DIRECT transfers need. */
+  static constexpr size_t DIRECT_IO_ALIGNMENT = 4096;
+
+  /** Longest run of pages that WritePages() puts into one pwritev(). */
+  static constexpr size_t MAX_PAGES_PER_WRITE = 256;
+
+  /**
+   * Version of the layout of the database file. The header page holds "BusTubDB", the version and the page size, 4
+   * bytes each after the 8 bytes of the name. A file with another header is rejected when it is opened, e.g. one from
+   * before the space maps, which had no header.
+   * Version 1: a space map in front of every group of pages, see the class comment, and the 16 byte header of
+   * OverFlowPage, which got the Chain Size.
+   */
+  static constexpr uint32_t FILE_FORMAT_VERSION = 1;
+
   /** @return the number of disk flushes */
   auto GetNumFlushes() const -> int;
 
@@ -93,19 +213,50 @@ class DiskManager {
   inline auto HasFlushLogFuture() -> bool { return flush_log_f_ != nullptr; }
 
  protected:
-  auto GetFileSize(const std::string &file_name) -> int;
+  /** Call and forget the shutdown hooks. Subclasses call it first thing in their destructor. */
+  void RunShutdownHooks();
+  auto GetFileSize(const std::string &file_name) -> int64_t;
+  /** @return the offset of a page in the database file, behind the space maps of its group and the groups before */
+  static auto GetPageOffset(page_id_t page_id) -> size_t;
+  /** @return the offset of the space map of a group of pages in the database file */
+  static auto GetSpaceMapOffset(size_t map_index) -> size_t;
+  /** Read the space maps of an existing database file. Caller must hold allocator_latch_. */
+  void LoadSpaceMaps();
+  /** Write the space maps that changed. Caller must hold allocator_latch_. */
+  void FlushSpaceMaps();
+  /** Fill a page with the header of a database file of FILE_FORMAT_VERSION. */
+  static void MakeFileHeader(char *header);
+  /** @return true if a header page is that of a database file of FILE_FORMAT_VERSION with pages of this size */
+  static auto IsFileHeaderValid(const char *header) -> bool;
+  /** @return true if a buffer can take part in a transfer of the database file as it is */
+  auto IsIOAligned(const char *data) const -> bool {
+    return !direct_io_ || reinterpret_cast<uintptr_t>(data) % DIRECT_IO_ALIGNMENT == 0;
+  }
+  /** pread() one page at a file offset, through an aligned buffer if data is not aligned. @return bytes read */
+  auto ReadFilePage(char *data, size_t offset) -> ssize_t;
+  /** pwrite() one page at a file offset, through an aligned buffer if data is not aligned. @return bytes written */
+  auto WriteFilePage(const char *data, size_t offset) -> ssize_t;
+  /** pwritev() pages that are adjacent in the file, starting at a file offset. */
+  void WriteFileRun(const std::vector<const char *> &run, size_t offset);
   // stream to write log file
   std::fstream log_io_;
   std::string log_name_;
-  // stream to write db file
-  std::fstream db_io_;
+  // descriptor of the db file, accessed with pread/pwrite only
+  int db_fd_{-1};
+  bool direct_io_{false};
   std::string file_name_;
   int num_flushes_{0};
-  int num_writes_{0};
+  std::atomic<int> num_writes_{0};
   bool flush_log_{false};
   std::future<void> *flush_log_f_{nullptr};
-  // With multiple buffer pool instances, need to protect file access
-  std::mutex db_io_latch_;
+  // the free space of the database file, see PageAllocator
+  PageAllocator allocator_;
+  // protects allocator_
+  std::mutex allocator_latch_;
+  // the hooks of AddShutdownHook() by id, protected by hooks_latch_
+  std::vector<std::pair<size_t, std::function<void()>>> shutdown_hooks_;
+  size_t next_hook_id_{0};
+  std::mutex hooks_latch_;
 };
 
 }  // namespace bustub
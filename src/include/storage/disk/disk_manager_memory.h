@@ -36,7 +36,10 @@ class DiskManagerMemory : public DiskManager {
  public:
   explicit DiskManagerMemory(size_t pages);
 
-  ~DiskManagerMemory() override { delete[] memory_; }
+  ~DiskManagerMemory() override {
+    RunShutdownHooks();
+    delete[] memory_;
+  }
 
   /**
    * Write a page to the database file.
@@ -45,6 +48,9 @@ class DiskManagerMemory : public DiskManager {
    */
   void WritePage(page_id_t page_id, const char *page_data) override;
 
+  /** Write many pages, one at a time. */
+  void WritePages(std::vector<std::pair<page_id_t, const char *>> pages) override;
+
   /**
    * Read a page from the database file.
    * @param page_id id of the page
@@ -64,6 +70,8 @@ class DiskManagerUnlimitedMemory : public DiskManager {
  public:
   DiskManagerUnlimitedMemory() = default;
 
+  ~DiskManagerUnlimitedMemory() override { RunShutdownHooks(); }
+
   /**
    * Write a page to the database file.
    * @param page_id id of the page
@@ -84,6 +92,13 @@ class DiskManagerUnlimitedMemory : public DiskManager {
     memcpy(ptr->first.data(), page_data, BUSTUB_PAGE_SIZE);
   }
 
+  /** Write many pages, one at a time. */
+  void WritePages(std::vector<std::pair<page_id_t, const char *>> pages) override {
+    for (const auto &[page_id, page_data] : pages) {
+      WritePage(page_id, page_data);
+    }
+  }
+
   /**
    * Read a page from the database file.
    * @param page_id id of the page
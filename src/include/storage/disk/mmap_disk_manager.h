@@ -0,0 +1,88 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// mmap_disk_manager.h
+//
+// Identification: src/include/storage/disk/mmap_disk_manager.h
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <mutex>  // NOLINT
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "common/macros.h"
+#include "storage/disk/disk_manager.h"
+
+namespace bustub {
+
+/**
+ * MmapDiskManager opens an existing database file read-only, e.g. a copy that analytic jobs only scan.
+ *
+ * The whole file is mapped into memory when the disk manager is created, without reading it, so opening a file of
+ * any size is immediate. ReadPage() is a memcpy() from the mapping; pages come in through page faults, and threads
+ * reading concurrently take no latch and make no system call. While a sequential scan runs, the mapping is advised
+ * as MADV_SEQUENTIAL and MADV_WILLNEED, so that the kernel reads far ahead of the scan.
+ *
+ * Everything that would change the file (writing, allocating or freeing a page) throws an Exception of type READ_ONLY,
+ * and no log file is opened. A buffer pool on top must therefore not dirty pages: NewPage() throws, and a page that was
+ * modified anyway throws when it is written back.
+ */
+class MmapDiskManager : public DiskManager {
+ public:
+  /**
+   * @brief Map a database file read-only.
+   * @param db_file the file name of the database file; it must exist
+   */
+  explicit MmapDiskManager(const std::string &db_file);
+
+  DISALLOW_COPY_AND_MOVE(MmapDiskManager);
+
+  /** @brief Unmap the database file. */
+  ~MmapDiskManager() override;
+
+  void ReadPage(page_id_t page_id, char *page_data) override;
+
+  /** @throw Exception of type READ_ONLY */
+  void WritePage(page_id_t page_id, const char *page_data) override;
+
+  /** @throw Exception of type READ_ONLY */
+  void WritePages(std::vector<std::pair<page_id_t, const char *>> pages) override;
+
+  /** @throw Exception of type READ_ONLY */
+  auto AllocatePage(uint32_t instance_index = 0, uint32_t num_instances = 1) -> page_id_t override;
+
+  /** @throw Exception of type READ_ONLY */
+  auto AllocatePageNear(page_id_t near_page_id, uint32_t instance_index = 0, uint32_t num_instances = 1)
+      -> page_id_t override;
+
+  /** @throw Exception of type READ_ONLY */
+  void DeallocatePage(page_id_t page_id) override;
+
+  /** Nothing is ever written, so there is nothing to sync. */
+  void Sync() override {}
+
+  void BeginSequentialScan() override;
+
+  void EndSequentialScan() override;
+
+  /** @return number of sequential scans that are running, see BeginSequentialScan() */
+  auto GetSequentialScanCount() -> size_t;
+
+ private:
+  /** Start of the mapping, nullptr if the file is empty. */
+  char *mapping_{nullptr};
+  /** Size of the file, and of the mapping. */
+  size_t mapping_size_{0};
+  /** Protects sequential_scans_ and the advice of the mapping that depends on it. */
+  std::mutex advice_latch_;
+  size_t sequential_scans_{0};
+};
+
+}  // namespace bustub
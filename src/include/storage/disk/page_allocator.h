@@ -0,0 +1,121 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// page_allocator.h
+//
+// Identification: src/include/storage/disk/page_allocator.h
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "common/config.h"
+
+namespace bustub {
+
+/**
+ * PageAllocator keeps track of which page ids of a database file are in use, one bit per page.
+ *
+ * The bitmap is split into space maps of PAGES_PER_MAP pages each, and every space map fits into one page, so the
+ * disk manager can store map i in the file right before the pages it describes. Allocation is first fit: the lowest
+ * free id is handed out, so freed pages are reused before the file grows, and pages allocated in a row end up next to
+ * each other on disk as long as the free space is not fragmented.
+ *
+ * Objects that grow page by page, such as table heaps and indexes, allocate with AllocateNear() instead, which keeps
+ * the pages of one object together in extents of PAGES_PER_EXTENT pages: a page goes into the extent of a page of the
+ * same object as long as that has room, and otherwise starts a completely free extent that is then reserved for the
+ * object. First-fit allocation skips reserved extents, so other objects do not fill them up. Reservations live in
+ * memory only; after a restart, an object still fills up the extents it has pages in, and an extent that was reserved
+ * is open to everyone again.
+ *
+ * PageAllocator is not thread safe.
+ */
+class PageAllocator {
+ public:
+  /** Number of pages that a single space map describes. */
+  static constexpr size_t PAGES_PER_MAP = BUSTUB_PAGE_SIZE * 8;
+
+  /** Number of contiguous pages that AllocateNear() reserves for an object at a time, one word of the bitmap. */
+  static constexpr size_t PAGES_PER_EXTENT = 64;
+
+  /**
+   * @brief Allocate the lowest free page id that belongs to a buffer pool instance. The instances of a parallel buffer
+   * pool own the ids with page_id % num_instances == instance_index.
+   * @param instance_index index of the instance
+   * @param num_instances number of instances
+   * @return the allocated page id
+   */
+  auto Allocate(uint32_t instance_index, uint32_t num_instances) -> page_id_t;
+
+  /**
+   * @brief Allocate a page id of a buffer pool instance for an object, in the extent of another page of the object if
+   * that has a free id, preferably after that page, or else at the start of a new extent reserved for the object.
+   * @param near_page_id a page of the object, or INVALID_PAGE_ID for the first page of a new object
+   * @param instance_index index of the instance
+   * @param num_instances number of instances
+   * @return the allocated page id
+   */
+  auto AllocateNear(page_id_t near_page_id, uint32_t instance_index, uint32_t num_instances) -> page_id_t;
+
+  /**
+   * @brief Free a page id, so that it can be allocated again. Does nothing if the id is not allocated.
+   * @param page_id id of the page
+   */
+  void Free(page_id_t page_id);
+
+  /** @return true if the page id is allocated */
+  auto IsAllocated(page_id_t page_id) const -> bool;
+
+  /** @return number of space maps, i.e. number of groups of PAGES_PER_MAP pages that have ever been used */
+  auto GetNumMaps() const -> size_t { return words_.size() / WORDS_PER_MAP; }
+
+  /**
+   * @brief Replace a space map with its on-disk image. Maps that do not exist yet are added, empty.
+   * @param map_index index of the map
+   * @param data BUSTUB_PAGE_SIZE bytes written by StoreMap()
+   */
+  void LoadMap(size_t map_index, const char *data);
+
+  /** @return true if a space map changed since it was last loaded or stored */
+  auto IsMapDirty(size_t map_index) const -> bool { return dirty_maps_[map_index]; }
+
+  /**
+   * @brief Write the on-disk image of a space map and mark it clean.
+   * @param map_index index of the map
+   * @param[out] data BUSTUB_PAGE_SIZE bytes
+   */
+  void StoreMap(size_t map_index, char *data);
+
+ private:
+  static constexpr size_t BITS_PER_WORD = 64;
+  static constexpr size_t WORDS_PER_MAP = PAGES_PER_MAP / BITS_PER_WORD;
+  static_assert(PAGES_PER_EXTENT == BITS_PER_WORD, "an extent is one word of the bitmap");
+
+  /** Grow the bitmap to hold map_index, with every new page free. */
+  void EnsureMap(size_t map_index);
+
+  /** Mark the page of a bit allocated. @return its page id */
+  auto TakeBit(size_t word, size_t bit) -> page_id_t;
+
+  /** One bit per page, set if the page is allocated. */
+  std::vector<uint64_t> words_;
+  std::vector<bool> dirty_maps_;
+  /** One flag per word, set if its extent is reserved for an object by AllocateNear(). */
+  std::vector<bool> reserved_;
+  /**
+   * One hint per instance, for ids striped over num_instances_ instances: no word before the hint has a free page of
+   * the instance outside of a reserved extent.
+   */
+  std::vector<size_t> first_free_words_;
+  uint32_t num_instances_{0};
+  /** No word before this one is free and not reserved. */
+  size_t first_empty_word_{0};
+};
+
+}  // namespace bustub
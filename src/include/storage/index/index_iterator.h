@@ -38,9 +38,14 @@ class IndexIterator {
   auto operator!=(const IndexIterator &itr) const -> bool {  return this->currentPageId != itr.currentPageId || this->currentIndex != currentIndex; }
 
  private:
+  /** Link of a leaf page to its right sibling, for read-ahead along the leaf chain. */
+  static auto NextLeafPageId(Page *page) -> page_id_t;
+
   // add your own private member variables here
   int currentPageId;
   int currentIndex;
+  /** Copy of the current item: the leaf is unpinned once operator* returns, so it may be evicted at any time. */
+  MappingType currentItem;
   BufferPoolManager* buffer_pool_manager_;
 };
 
@@ -0,0 +1,64 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// column_segment_page.h
+//
+// Identification: src/include/storage/page/column_segment_page.h
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cstring>
+
+#include "common/config.h"
+#include "storage/page/page.h"
+
+namespace bustub {
+
+/**
+ * A page of the chain of pages that a ColumnTable stores one of its columns in. The segments of the column, one per
+ * row group and encoded by ColumnSegment, follow each other in the chain; a segment starts on a page of its own and
+ * fills as many pages as it needs.
+ *
+ * Page format (size in bytes):
+ *  --------------------------------------------------
+ *  | NextPageId (4) | DataSize (4) | Data ... |
+ *  --------------------------------------------------
+ */
+class ColumnSegmentPage : public Page {
+ public:
+  /** Initialize an empty page at the end of a chain. */
+  void Init() {
+    SetNextPageId(INVALID_PAGE_ID);
+    SetDataSize(0);
+  }
+
+  /** @return the page ID of the next page of the chain */
+  auto GetNextPageId() -> page_id_t { return *reinterpret_cast<page_id_t *>(GetData() + OFFSET_NEXT_PAGE_ID); }
+
+  /** Set the page id of the next page of the chain. */
+  void SetNextPageId(page_id_t next_page_id) {
+    memcpy(GetData() + OFFSET_NEXT_PAGE_ID, &next_page_id, sizeof(page_id_t));
+  }
+
+  /** @return the number of bytes of the segment on this page */
+  auto GetDataSize() -> uint32_t { return *reinterpret_cast<uint32_t *>(GetData() + OFFSET_DATA_SIZE); }
+
+  /** Set the number of bytes of the segment on this page. */
+  void SetDataSize(uint32_t data_size) { memcpy(GetData() + OFFSET_DATA_SIZE, &data_size, sizeof(uint32_t)); }
+
+  /** @return the bytes of the segment on this page */
+  auto GetSegmentData() -> char * { return GetData() + OFFSET_DATA; }
+
+  static constexpr size_t OFFSET_NEXT_PAGE_ID = 0;
+  static constexpr size_t OFFSET_DATA_SIZE = 4;
+  static constexpr size_t OFFSET_DATA = 8;
+  /** Number of bytes of a segment that fit into a page. */
+  static constexpr size_t DATA_CAPACITY = BUSTUB_PAGE_SIZE - OFFSET_DATA;
+};
+
+}  // namespace bustub
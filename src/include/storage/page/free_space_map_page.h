@@ -0,0 +1,109 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// free_space_map_page.h
+//
+// Identification: src/include/storage/page/free_space_map_page.h
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <algorithm>
+#include <cstring>
+
+#include "common/config.h"
+#include "storage/page/page.h"
+
+namespace bustub {
+
+/**
+ * A page of the free space map of a table heap: the ids of a run of heap pages, in the order of the page chain, and
+ * how much free space each of them has.
+ *
+ * Page format (size in bytes):
+ *  ---------------------------------------------------------------------------------------------------------
+ *  | NextPageId (4) | EntryCount (4) | HeapPageId_1 (4) | ... | HeapPageId_n (4) | Free_1 (1) | ... | Free_n (1) |
+ *  ---------------------------------------------------------------------------------------------------------
+ *
+ * Free space is kept in units of FREE_SPACE_UNIT bytes, rounded down, so an entry never claims more room than the
+ * page had when it was recorded.
+ */
+class FreeSpaceMapPage : public Page {
+ public:
+  /** Initialize an empty map page. */
+  void Init() {
+    SetNextPageId(INVALID_PAGE_ID);
+    SetEntryCount(0);
+  }
+
+  /** @return the page ID of the next page of the map */
+  auto GetNextPageId() -> page_id_t { return *reinterpret_cast<page_id_t *>(GetData() + OFFSET_NEXT_PAGE_ID); }
+
+  /** Set the page id of the next page of the map. */
+  void SetNextPageId(page_id_t next_page_id) {
+    memcpy(GetData() + OFFSET_NEXT_PAGE_ID, &next_page_id, sizeof(page_id_t));
+  }
+
+  /** @return the number of heap pages on this map page */
+  auto GetEntryCount() -> uint32_t { return *reinterpret_cast<uint32_t *>(GetData() + OFFSET_ENTRY_COUNT); }
+
+  /** @return the id of the heap page of an entry */
+  auto GetHeapPageId(uint32_t index) -> page_id_t {
+    return *reinterpret_cast<page_id_t *>(GetData() + OFFSET_HEAP_PAGE_IDS + index * sizeof(page_id_t));
+  }
+
+  /** Set the id of the heap page of an entry; INVALID_PAGE_ID marks a page that was unlinked from the heap. */
+  void SetHeapPageId(uint32_t index, page_id_t heap_page_id) {
+    memcpy(GetData() + OFFSET_HEAP_PAGE_IDS + index * sizeof(page_id_t), &heap_page_id, sizeof(page_id_t));
+  }
+
+  /** @return the free space of the heap page of an entry, in units of FREE_SPACE_UNIT */
+  auto GetFreeUnits(uint32_t index) -> uint8_t {
+    return *reinterpret_cast<uint8_t *>(GetData() + OFFSET_FREE_UNITS + index);
+  }
+
+  /** Set the free space of the heap page of an entry, in units of FREE_SPACE_UNIT. */
+  void SetFreeUnits(uint32_t index, uint8_t free_units) { GetData()[OFFSET_FREE_UNITS + index] = free_units; }
+
+  /**
+   * Add a heap page after the last entry.
+   * @return false if the page is full
+   */
+  auto Append(page_id_t heap_page_id, uint8_t free_units) -> bool {
+    const uint32_t index = GetEntryCount();
+    if (index == CAPACITY) {
+      return false;
+    }
+    memcpy(GetData() + OFFSET_HEAP_PAGE_IDS + index * sizeof(page_id_t), &heap_page_id, sizeof(page_id_t));
+    SetFreeUnits(index, free_units);
+    SetEntryCount(index + 1);
+    return true;
+  }
+
+  /** @return free space in bytes, in units of FREE_SPACE_UNIT rounded down */
+  static auto ToFreeUnits(uint32_t free_space) -> uint8_t {
+    return static_cast<uint8_t>(std::min<uint32_t>(free_space / FREE_SPACE_UNIT, UINT8_MAX));
+  }
+
+  /** Granularity of the recorded free space. */
+  static constexpr uint32_t FREE_SPACE_UNIT = 16;
+
+  static constexpr size_t OFFSET_NEXT_PAGE_ID = 0;
+  static constexpr size_t OFFSET_ENTRY_COUNT = 4;
+  static constexpr size_t OFFSET_HEAP_PAGE_IDS = 8;
+  /** Number of heap pages that one map page describes. */
+  static constexpr uint32_t CAPACITY = (BUSTUB_PAGE_SIZE - OFFSET_HEAP_PAGE_IDS) / (sizeof(page_id_t) + 1);
+  static constexpr size_t OFFSET_FREE_UNITS = OFFSET_HEAP_PAGE_IDS + CAPACITY * sizeof(page_id_t);
+
+ private:
+  void SetEntryCount(uint32_t entry_count) { memcpy(GetData() + OFFSET_ENTRY_COUNT, &entry_count, sizeof(uint32_t)); }
+};
+
+static_assert(BUSTUB_PAGE_SIZE / FreeSpaceMapPage::FREE_SPACE_UNIT <= UINT8_MAX + 1,
+              "the free space of a page has to fit into one byte");
+
+}  // namespace bustub
@@ -28,10 +28,15 @@ namespace bustub {
  * 
  *  
  *  Header format (size in bytes):
- *  -----------------------------------------
- *  | PageId (4)| NextPageId (4)|Tuple Size(4)|
- *  -------------------------------------------
+ *  ------------------------------------------------------------
+ *  | PageId (4)| NextPageId (4)|Tuple Size(4)| Chain Size (4) |
+ *  ------------------------------------------------------------
  *
+ *  Tuple Size is the number of bytes of the tuple stored in this page, Chain Size the number stored in this page and
+ *  the pages after it, so that a reader can size the buffer of the whole tuple from the first page of the chain.
+ *
+ *  The header is part of the layout of the database file: Chain Size came with DiskManager::FILE_FORMAT_VERSION 1,
+ *  and files of older versions, with the 12 byte header, are rejected when they are opened.
  */
 class OverFlowPage : public Page {
  public:
@@ -63,6 +68,12 @@ void Init(page_id_t page_id, uint32_t page_size, page_id_t nextPageId, LogManage
     memcpy(GetData() + OFFSET_TUPLE_SIZE, &size, sizeof(uint32_t));
   }
 
+  /** Set the number of bytes of the tuple stored in this page and the pages after it. */
+  void SetChainSize(uint32_t size) { memcpy(GetData() + OFFSET_CHAIN_SIZE, &size, sizeof(uint32_t)); }
+
+  /** @return the number of bytes of the tuple stored in this page and the pages after it */
+  auto GetChainSize() -> uint32_t { return *reinterpret_cast<uint32_t *>(GetData() + OFFSET_CHAIN_SIZE); }
+
   /**
    * Insert a tuple into the table.
    * @param tuple tuple to insert
@@ -72,7 +83,7 @@ void Init(page_id_t page_id, uint32_t page_size, page_id_t nextPageId, LogManage
    * @param log_manager the log manager
    * @return true if the insert is successful (i.e. there is enough space)
    */
-  auto InsertOverFlowedData(char*data,int size)
+  auto InsertOverFlowedData(const char *data, int size)
       -> bool;
 
   /**
@@ -128,12 +139,18 @@ void Init(page_id_t page_id, uint32_t page_size, page_id_t nextPageId, LogManage
  auto GetTupleData() -> char * {
     return   GetData() + SIZE_OVER_FLOW_HEADER ;
   }
+
+  static constexpr size_t SIZE_OVER_FLOW_HEADER = 16;
+  /** Number of bytes of a tuple that one overflow page holds. */
+  static constexpr size_t MAX_DATA_SIZE = BUSTUB_PAGE_SIZE - SIZE_OVER_FLOW_HEADER;
+
  private:
   static_assert(sizeof(page_id_t) == 4);
+  static_assert(SIZE_OVER_FLOW_HEADER == 16, "changing the header changes the file format, see FILE_FORMAT_VERSION");
 
-  static constexpr size_t SIZE_OVER_FLOW_HEADER = 12;
   static constexpr size_t OFFSET_NEXT_PAGE_ID = 4;
   static constexpr size_t OFFSET_TUPLE_SIZE = 8;
+  static constexpr size_t OFFSET_CHAIN_SIZE = 12;
  
  
 
@@ -12,6 +12,7 @@
 
 #pragma once
 
+#include <atomic>
 #include <cstring>
 #include <iostream>
 
@@ -24,14 +25,17 @@ namespace bustub {
  * Page is the basic unit of storage within the database system. Page provides a wrapper for actual data pages being
  * held in main memory. Page also contains book-keeping information that is used by the buffer pool manager, e.g.
  * pin count, dirty flag, page id, etc.
+ *
+ * The data itself lives in the frame arena of the buffer pool, so a Page is only a descriptor. Descriptors are
+ * cache-line aligned, so that pinning or latching one page never contends with a neighbouring page.
  */
-class Page {
+class alignas(BUSTUB_CACHELINE_SIZE) Page {
   // There is book-keeping information inside the page that should only be relevant to the buffer pool manager.
   friend class BufferPoolManagerInstance;
 
  public:
-  /** Constructor. Zeros out the page data. */
-  Page() { ResetMemory(); }
+  /** Constructor. The buffer pool points the page at its data. */
+  Page() = default;
 
   /** Default destructor. */
   ~Page() = default;
@@ -83,12 +87,12 @@ class Page {
   /** Zeroes out the data that is held within the page. */
   inline void ResetMemory() { memset(data_, OFFSET_PAGE_START, BUSTUB_PAGE_SIZE); }
 
-  /** The actual data that is stored within a page. */
-  char data_[BUSTUB_PAGE_SIZE]{};
-  /** The ID of this page. */
-  page_id_t page_id_ = INVALID_PAGE_ID;
-  /** The pin count of this page. */
-  int pin_count_ = 0;
+  /** The actual data that is stored within a page, BUSTUB_PAGE_SIZE bytes in the frame arena. */
+  char *data_{nullptr};
+  /** The ID of this page. Atomic because the buffer pool validates lock-free pins against it. */
+  std::atomic<page_id_t> page_id_{INVALID_PAGE_ID};
+  /** The pin count of this page. Atomic because the buffer pool pins resident pages without its latch. */
+  std::atomic<int> pin_count_{0};
   /** True if the page is dirty, i.e. it is different from its corresponding page on disk. */
   bool is_dirty_ = false;
   /** Page latch. */
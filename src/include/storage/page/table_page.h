@@ -13,12 +13,14 @@
 #pragma once
 
 #include <cstring>
+#include <vector>
 
 #include "common/rid.h"
 #include "concurrency/lock_manager.h"
 #include "recovery/log_manager.h"
 #include "storage/page/page.h"
 #include "storage/table/tuple.h"
+#include "type/type.h"
 
 static constexpr uint64_t DELETE_MASK = (1U << (8 * sizeof(uint32_t) - 1));
 
@@ -36,13 +38,34 @@ namespace bustub {
  *  ----------------------------------------------------------------------------
  *  | PageId (4)| LSN (4)| PrevPageId (4)| NextPageId (4)| FreeSpacePointer(4) |
  *  ----------------------------------------------------------------------------
- *  ----------------------------------------------------------------
- *  | TupleCount (4) | Tuple_1 offset (4) | Tuple_1 size (4) | ... |
- *  ----------------------------------------------------------------
+ *  -----------------------------------------------------------------------------------------------------------
+ *  | FreeSpaceMapPageId (4) | ZoneMapPageId (4) | TupleCount (4) | PaxLayout (4) | Tuple_1 offset (4) | ... |
+ *  -----------------------------------------------------------------------------------------------------------
+ *  ----------------------------
+ *  | Tuple_1 size (4) | ... |
+ *  ----------------------------
+ *
+ *  FreeSpaceMapPageId and ZoneMapPageId are only set in the first page of a table heap, see FreeSpaceMap and ZoneMap.
+ *
+ * PAX page format, see InitPax(). The page has a fixed number of rows, and the slot of a tuple is its row. Every column
+ * has a null bitmap and a minipage, which holds the values of the column for all rows in row order:
+ *  ------------------------------------------------------------------------------------------------------------
+ *  | HEADER | ColumnType_1 (1) | ... | RowState_1 (1) | ... | NullBitmap_1 | ... | Minipage_1 | Minipage_2 | ... |
+ *  ------------------------------------------------------------------------------------------------------------
+ *
+ *  PaxLayout holds the number of columns (2) and the number of rows (2) of a PAX page, and is 0 on a slotted page.
+ *  TupleCount is the number of rows up to the last one in use. Minipages start at multiples of 8 bytes.
  *
  */
 class TablePage : public Page {
  public:
+  /** Where the data of a tuple is on a page, see CopyTuples(). */
+  struct TupleSlot {
+    uint32_t slot_num_;
+    uint32_t offset_;
+    uint32_t size_;
+  };
+
   /**
    * Initialize the TablePage header.
    * @param page_id the page ID of this table page
@@ -72,6 +95,60 @@ class TablePage : public Page {
     memcpy(GetData() + OFFSET_NEXT_PAGE_ID, &next_page_id, sizeof(page_id_t));
   }
 
+  /** @return the page ID of the free space map of the table, if this is its first page */
+  auto GetFreeSpaceMapPageId() -> page_id_t {
+    return *reinterpret_cast<page_id_t *>(GetData() + OFFSET_FREE_SPACE_MAP_PAGE_ID);
+  }
+
+  /** Set the page id of the free space map of the table in its first page. */
+  void SetFreeSpaceMapPageId(page_id_t free_space_map_page_id) {
+    memcpy(GetData() + OFFSET_FREE_SPACE_MAP_PAGE_ID, &free_space_map_page_id, sizeof(page_id_t));
+  }
+
+  /** @return the page ID of the zone map of the table, if this is its first page and the table has one */
+  auto GetZoneMapPageId() -> page_id_t { return *reinterpret_cast<page_id_t *>(GetData() + OFFSET_ZONE_MAP_PAGE_ID); }
+
+  /** Set the page id of the zone map of the table in its first page. */
+  void SetZoneMapPageId(page_id_t zone_map_page_id) {
+    memcpy(GetData() + OFFSET_ZONE_MAP_PAGE_ID, &zone_map_page_id, sizeof(page_id_t));
+  }
+
+  /**
+   * Turn a page that was just initialized into a PAX page, for tuples of the given fixed-width column types.
+   * @param column_types the types of the columns of the tuples; PaxCapacity() of them must not be 0
+   */
+  void InitPax(const std::vector<TypeId> &column_types);
+
+  /** @return true if the page stores its tuples column by column, see InitPax() */
+  auto IsPax() -> bool { return GetPaxColumnCount() != 0; }
+
+  /** @return the types of the columns of a PAX page, empty for a slotted page */
+  auto GetPaxColumnTypes() -> std::vector<TypeId>;
+
+  /** @return the number of rows of a PAX page, 0 for a slotted page */
+  auto GetPaxCapacity() -> uint32_t {
+    return *reinterpret_cast<uint16_t *>(GetData() + OFFSET_PAX_LAYOUT + sizeof(uint16_t));
+  }
+
+  /**
+   * @return the number of rows of a PAX page for columns of the given types, a multiple of 8; 0 if a type is not
+   *   fixed-width or not even 8 rows fit into a page
+   */
+  static auto PaxCapacity(const std::vector<TypeId> &column_types) -> uint32_t;
+
+  /**
+   * Copy a column of a PAX page straight out of its minipage, with one copy if no row up to the last one in use is
+   * empty or deleted.
+   * @param column_idx index of the column
+   * @param[out] values receives the values of the tuples that are not deleted, in slot order, as an array of values of
+   *   the type of the column; it needs room for GetPaxCapacity() values
+   * @param[out] slot_nums if not null, receives the slot numbers of the values
+   * @param[out] is_null if not null, receives for every value whether it is null, from the null bitmap of the column
+   * @return the number of values copied
+   */
+  auto CopyColumn(uint32_t column_idx, char *values, std::vector<uint32_t> *slot_nums, std::vector<bool> *is_null)
+      -> uint32_t;
+
   /**
    * Insert a tuple into the table.
    * @param tuple tuple to insert
@@ -137,20 +214,63 @@ class TablePage : public Page {
    * @return true if the next tuple exists, false otherwise
    */
   auto GetNextTupleRid(const RID &cur_rid, RID *next_rid) -> bool;
+
+  /**
+   * Copy out all tuples of the page at once, for a scan that reads the page at a time.
+   * @param[out] data receives the data of the tuples, at the offsets they have on a slotted page; the tuples of a PAX
+   *   page are put back together one after another
+   * @param[out] slots receives the slots of the tuples that are not deleted, in slot order
+   */
+  void CopyTuples(std::vector<char> *data, std::vector<TupleSlot> *slots);
+
+  /**
+   * Give the empty slots at the end of the slot array back to the free space. Tuple data needs no compaction, since
+   * ApplyDelete() and UpdateTuple() keep it packed, and slots before the last tuple keep their number because rids
+   * point to them.
+   * @return true if no slot is left, i.e. the page holds no tuple, not even a deleted one that is not yet applied
+   */
+  auto Compact() -> bool;
+
+  /** Take the free space of an empty page that was unlinked from its heap, so that an insert that still finds it fails. */
+  void Retire() { SetFreeSpacePointer(SIZE_TABLE_PAGE_HEADER); }
+
+  /** @return true if the page holds no tuple, not even a deleted one that is not yet applied */
+  auto IsEmpty() -> bool { return GetTupleCount() == 0; }
+
+  /**
+   * @return the free space of the page; a PAX page counts a tuple and a slot for every empty row, so that a tuple fits
+   *   iff there is room for it and its slot, as on a slotted page
+   */
   auto GetFreeSpaceRemaining() -> uint32_t {
+    if (IsPax()) {
+      return GetPaxFreeSpaceRemaining();
+    }
     return GetFreeSpacePointer() - SIZE_TABLE_PAGE_HEADER - SIZE_TUPLE * GetTupleCount();
   }
+
+  static constexpr size_t SIZE_TABLE_PAGE_HEADER = 36;
+  /** Size of the slot of a tuple, which a new tuple needs on top of its data unless it reuses an empty slot. */
+  static constexpr size_t SIZE_TUPLE = 8;
+  /** Largest tuple that fits into an empty page; larger ones continue in overflow pages. */
+  static constexpr size_t MAX_TUPLE_SIZE = BUSTUB_PAGE_SIZE - SIZE_TABLE_PAGE_HEADER - SIZE_TUPLE;
+
  private:
   static_assert(sizeof(page_id_t) == 4);
 
-  static constexpr size_t SIZE_TABLE_PAGE_HEADER = 24;
-  static constexpr size_t SIZE_TUPLE = 8;
   static constexpr size_t OFFSET_PREV_PAGE_ID = 8;
   static constexpr size_t OFFSET_NEXT_PAGE_ID = 12;
   static constexpr size_t OFFSET_FREE_SPACE = 16;
-  static constexpr size_t OFFSET_TUPLE_COUNT = 20;
-  static constexpr size_t OFFSET_TUPLE_OFFSET = 24;  // Naming things is hard.
-  static constexpr size_t OFFSET_TUPLE_SIZE = 28;
+  static constexpr size_t OFFSET_FREE_SPACE_MAP_PAGE_ID = 20;
+  static constexpr size_t OFFSET_ZONE_MAP_PAGE_ID = 24;
+  static constexpr size_t OFFSET_TUPLE_COUNT = 28;
+  static constexpr size_t OFFSET_PAX_LAYOUT = 32;
+  static constexpr size_t OFFSET_TUPLE_OFFSET = 36;  // Naming things is hard.
+  static constexpr size_t OFFSET_TUPLE_SIZE = 40;
+
+  /** States of the rows of a PAX page. */
+  static constexpr uint8_t PAX_ROW_EMPTY = 0;
+  static constexpr uint8_t PAX_ROW_LIVE = 1;
+  static constexpr uint8_t PAX_ROW_DELETED = 2;
 
   /** @return pointer to the end of the current free space, see header comment */
   auto GetFreeSpacePointer() -> uint32_t { return *reinterpret_cast<uint32_t *>(GetData() + OFFSET_FREE_SPACE); }
@@ -191,6 +311,56 @@ class TablePage : public Page {
     memcpy(GetData() + OFFSET_TUPLE_SIZE + SIZE_TUPLE * slot_num, &size, sizeof(uint32_t));
   }
 
+  /** @return the number of columns of a PAX page, 0 for a slotted page */
+  auto GetPaxColumnCount() -> uint32_t { return *reinterpret_cast<uint16_t *>(GetData() + OFFSET_PAX_LAYOUT); }
+
+  /** @return the width of the values of a column of a PAX page */
+  auto GetPaxColumnWidth(uint32_t column_idx) -> uint32_t {
+    return static_cast<uint32_t>(Type::GetTypeSize(static_cast<TypeId>(GetData()[SIZE_TABLE_PAGE_HEADER + column_idx])));
+  }
+
+  /** @return the state of a row of a PAX page, see PAX_ROW_EMPTY */
+  auto GetPaxRowState(uint32_t row) -> uint8_t {
+    return *reinterpret_cast<uint8_t *>(GetData() + SIZE_TABLE_PAGE_HEADER + GetPaxColumnCount() + row);
+  }
+
+  /** Set the state of a row of a PAX page. */
+  void SetPaxRowState(uint32_t row, uint8_t state) {
+    *reinterpret_cast<uint8_t *>(GetData() + SIZE_TABLE_PAGE_HEADER + GetPaxColumnCount() + row) = state;
+  }
+
+  /** @return the offset of the null bitmap of a column of a PAX page */
+  auto GetPaxNullBitmapOffset(uint32_t column_idx) -> uint32_t {
+    const uint32_t capacity = GetPaxCapacity();
+    return SIZE_TABLE_PAGE_HEADER + GetPaxColumnCount() + capacity + column_idx * capacity / 8;
+  }
+
+  /** @return the offset of the first minipage of a PAX page with the given number of columns and rows */
+  static auto PaxMinipagesOffset(uint32_t column_count, uint32_t capacity) -> uint32_t {
+    const uint32_t end_of_bitmaps = SIZE_TABLE_PAGE_HEADER + column_count + capacity + column_count * capacity / 8;
+    return (end_of_bitmaps + 7) / 8 * 8;
+  }
+
+  /** @return the size of a tuple of a PAX page, i.e. of the tuples that its rows hold */
+  auto GetPaxTupleSize() -> uint32_t;
+
+  /** Put the tuple in a row of a PAX page back together into data, which has room for GetPaxTupleSize() bytes. */
+  void ReadPaxRow(uint32_t row, char *data);
+
+  /** Write the values of a tuple into a row of a PAX page. */
+  void WritePaxRow(uint32_t row, const char *data);
+
+  auto GetPaxFreeSpaceRemaining() -> uint32_t;
+
+  /** InsertTuple() of a PAX page. */
+  auto InsertPaxTuple(const TupleRecord &tuple, RID *rid) -> bool;
+
+  /** UpdateTuple() of a PAX page, which always updates in place. */
+  auto UpdatePaxTuple(const TupleRecord &new_tuple, TupleRecord *old_tuple, const RID &rid, Transaction *txn) -> bool;
+
+  /** GetTuple() of a PAX page. */
+  auto GetPaxTuple(const RID &rid, TupleRecord *tuple, Transaction *txn) -> bool;
+
   /** @return true if the tuple is deleted or empty */
   static auto IsDeleted(uint32_t tuple_size) -> bool {
     return static_cast<bool>(tuple_size & DELETE_MASK) || tuple_size == 0;
@@ -0,0 +1,107 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// zone_map_page.h
+//
+// Identification: src/include/storage/page/zone_map_page.h
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cstring>
+
+#include "common/config.h"
+#include "storage/page/page.h"
+
+namespace bustub {
+
+/**
+ * A page of the zone map of a table heap: the ids of a run of heap pages, in the order of the page chain, and the range
+ * of values of the columns that the map tracks on each of them.
+ *
+ * Page format (size in bytes):
+ *  -------------------------------------------------------------------------------------
+ *  | NextPageId (4) | EntryCount (4) | ColumnCount (4) | Entry_1 | Entry_2 | ... | Entry_n |
+ *  -------------------------------------------------------------------------------------
+ *
+ * Entry format:
+ *  -----------------------------------------------------------------
+ *  | HeapPageId (4) | IsComplete (4) | Column_1 | ... | Column_k |
+ *  -----------------------------------------------------------------
+ *
+ * Column format, with Min and Max serialized in the type of the column:
+ *  -----------------------------------------------------------
+ *  | Min (8) | Max (8) | NullCount (4) | HasRange (4) |
+ *  -----------------------------------------------------------
+ */
+class ZoneMapPage : public Page {
+ public:
+  /** Initialize an empty map page for entries of column_count columns. */
+  void Init(uint32_t column_count) {
+    SetNextPageId(INVALID_PAGE_ID);
+    SetEntryCount(0);
+    memcpy(GetData() + OFFSET_COLUMN_COUNT, &column_count, sizeof(uint32_t));
+  }
+
+  /** @return the page ID of the next page of the map */
+  auto GetNextPageId() -> page_id_t { return *reinterpret_cast<page_id_t *>(GetData() + OFFSET_NEXT_PAGE_ID); }
+
+  /** Set the page id of the next page of the map. */
+  void SetNextPageId(page_id_t next_page_id) {
+    memcpy(GetData() + OFFSET_NEXT_PAGE_ID, &next_page_id, sizeof(page_id_t));
+  }
+
+  /** @return the number of heap pages on this map page */
+  auto GetEntryCount() -> uint32_t { return *reinterpret_cast<uint32_t *>(GetData() + OFFSET_ENTRY_COUNT); }
+
+  /** Set the number of heap pages on this map page. */
+  void SetEntryCount(uint32_t entry_count) { memcpy(GetData() + OFFSET_ENTRY_COUNT, &entry_count, sizeof(uint32_t)); }
+
+  /** @return the number of columns of every entry */
+  auto GetColumnCount() -> uint32_t { return *reinterpret_cast<uint32_t *>(GetData() + OFFSET_COLUMN_COUNT); }
+
+  /** @return the id of the heap page of an entry, INVALID_PAGE_ID for a page that was unlinked from the heap */
+  auto GetHeapPageId(uint32_t index) -> page_id_t { return *reinterpret_cast<page_id_t *>(GetEntry(index)); }
+
+  /** @return true if all tuples on the heap page of an entry were recorded in it */
+  auto IsComplete(uint32_t index) -> bool {
+    return *reinterpret_cast<uint32_t *>(GetEntry(index) + sizeof(page_id_t)) != 0;
+  }
+
+  /** Set the heap page of an entry and whether all of its tuples were recorded. */
+  void SetHeapPage(uint32_t index, page_id_t heap_page_id, bool is_complete) {
+    const uint32_t complete = is_complete ? 1 : 0;
+    memcpy(GetEntry(index), &heap_page_id, sizeof(page_id_t));
+    memcpy(GetEntry(index) + sizeof(page_id_t), &complete, sizeof(uint32_t));
+  }
+
+  /** @return the SIZE_COLUMN bytes of a column of an entry, see the column format above */
+  auto GetColumn(uint32_t index, uint32_t column) -> char * {
+    return GetEntry(index) + SIZE_ENTRY_HEADER + column * SIZE_COLUMN;
+  }
+
+  /** @return the number of entries that fit into a page, for entries of column_count columns */
+  static constexpr auto Capacity(uint32_t column_count) -> uint32_t {
+    return (BUSTUB_PAGE_SIZE - OFFSET_ENTRIES) / (SIZE_ENTRY_HEADER + column_count * SIZE_COLUMN);
+  }
+
+  static constexpr size_t OFFSET_NEXT_PAGE_ID = 0;
+  static constexpr size_t OFFSET_ENTRY_COUNT = 4;
+  static constexpr size_t OFFSET_COLUMN_COUNT = 8;
+  static constexpr size_t OFFSET_ENTRIES = 12;
+  static constexpr size_t SIZE_ENTRY_HEADER = 8;
+  static constexpr size_t SIZE_COLUMN = 24;
+  /** Size of a value of any of the fixed-width types. */
+  static constexpr size_t SIZE_VALUE = 8;
+
+ private:
+  auto GetEntry(uint32_t index) -> char * {
+    return GetData() + OFFSET_ENTRIES + index * (SIZE_ENTRY_HEADER + GetColumnCount() * SIZE_COLUMN);
+  }
+};
+
+}  // namespace bustub
@@ -0,0 +1,90 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// column_segment.h
+//
+// Identification: src/include/storage/table/column_segment.h
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <vector>
+
+#include "type/type_id.h"
+#include "type/value.h"
+
+namespace bustub {
+
+/**
+ * ColumnSegment encodes the values of one column of one row group of a ColumnTable into the bytes that the table
+ * writes to its segment pages, and decodes them again. Every segment is encoded in the encoding that makes it the
+ * smallest, of those that its type allows.
+ *
+ * Segment format (size in bytes), followed by the body of its encoding:
+ *  -----------------------------------------------------------------------------------------
+ *  | RowCount (4) | Encoding (4) | NullCount (4) | HasRange (4) | Min (8) | Max (8) | Body |
+ *  -----------------------------------------------------------------------------------------
+ * Min and Max are serialized in the type of the column. They are only kept for the numeric types, and only set if the
+ * segment has a value that is not null (HasRange).
+ *
+ * Body formats, where a fixed-width null is stored as the null value of its type:
+ *  - PLAIN, fixed width:  | Value_1 | ... | Value_n |
+ *  - PLAIN, VARCHAR:      | Length_1 (4) | Bytes_1 | ... |, with length BUSTUB_VALUE_NULL and no bytes for a null
+ *  - RLE, fixed width:    | RunCount (4) | Value_1 | RunLength_1 (4) | ... |
+ *  - FOR, integer types:  | Reference (8) | BitWidth (4) | NullBitmap | Delta_1 | ... | Delta_n |
+ *    every value is stored as its distance from the smallest value (Reference) in BitWidth bits; the null bitmap of
+ *    (n + 7) / 8 bytes is only there if the segment has nulls, whose deltas are 0
+ *  - DICTIONARY, VARCHAR: | EntryCount (4) | BitWidth (4) | Length_1 (4) | Bytes_1 | ... | Code_1 | ... | Code_n |
+ *    every value is stored as the index of its entry in BitWidth bits; a null has the code EntryCount
+ */
+class ColumnSegment {
+ public:
+  enum class Encoding : uint32_t { PLAIN = 0, RLE = 1, FOR = 2, DICTIONARY = 3 };
+
+  /** The header of a segment. */
+  struct Header {
+    uint32_t row_count_{0};
+    Encoding encoding_{Encoding::PLAIN};
+    uint32_t null_count_{0};
+    /** False if the type keeps no range or all values are null; min_ and max_ are only set if true. */
+    bool has_range_{false};
+    Value min_;
+    Value max_;
+  };
+
+  /**
+   * Encode the values of a column.
+   * @param type_id the type of the column
+   * @param values the values, all of the type of the column
+   * @return the segment, header and body
+   */
+  static auto Encode(TypeId type_id, const std::vector<Value> &values) -> std::vector<char>;
+
+  /** @return the header of a segment of a column of the type */
+  static auto ReadHeader(TypeId type_id, const char *data) -> Header;
+
+  /**
+   * Decode the values of a segment.
+   * @param type_id the type of the column
+   * @param data the segment, header and body
+   * @param[out] values the values of the segment, in the order they were encoded
+   */
+  static void Decode(TypeId type_id, const char *data, std::vector<Value> *values);
+
+  /** @return true if the segments of a column of the type keep the range of their values */
+  static auto KeepsRange(TypeId type_id) -> bool;
+
+  static constexpr size_t OFFSET_ROW_COUNT = 0;
+  static constexpr size_t OFFSET_ENCODING = 4;
+  static constexpr size_t OFFSET_NULL_COUNT = 8;
+  static constexpr size_t OFFSET_HAS_RANGE = 12;
+  static constexpr size_t OFFSET_MIN = 16;
+  static constexpr size_t OFFSET_MAX = 24;
+  static constexpr size_t SIZE_HEADER = 32;
+};
+
+}  // namespace bustub
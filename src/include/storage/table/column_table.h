@@ -0,0 +1,211 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// column_table.h
+//
+// Identification: src/include/storage/table/column_table.h
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <shared_mutex>
+#include <vector>
+
+#include "buffer/buffer_access_strategy.h"
+#include "buffer/buffer_pool_manager.h"
+#include "catalog/schema.h"
+#include "common/config.h"
+#include "common/macros.h"
+#include "common/rid.h"
+#include "concurrency/transaction.h"
+#include "storage/table/column_segment.h"
+#include "storage/table/tuple_record.h"
+#include "storage/table/zone_map.h"
+#include "type/value.h"
+
+namespace bustub {
+
+/**
+ * ColumnTable is the table engine for tables that are mostly appended to and scanned, see TableEngine::COLUMNAR.
+ *
+ * Every column is stored in a chain of ColumnSegmentPages of its own. The rows are cut into row groups of
+ * ROW_GROUP_SIZE rows, and every row group is one segment per column, encoded by ColumnSegment with the smallest of
+ * its encodings and with the range of its values, which scans with a range predicate pass over row groups with. A scan
+ * reads and decodes only the columns it asks for.
+ *
+ * Rows are appended to a tail that is kept in memory until it fills a row group, or until Flush() writes it out as a
+ * shorter one. A row is named by the rid (row group, row in the group), and is deleted by a mark in a delete vector,
+ * which is kept in memory, too. Segments are never rewritten: UpdateTuple() deletes the row and appends the new one.
+ *
+ * The directory of the segments is kept in memory as well, so a ColumnTable lives as long as its catalog, like the
+ * catalog itself; its pages are not logged.
+ */
+class ColumnTable {
+ public:
+  /**
+   * Reads the rows of a ColumnTable a row group at a time. The scan sees the rows that were in the table when it
+   * started, apart from the ones that are deleted while it runs.
+   */
+  class Scanner {
+   public:
+    /**
+     * @param table the table to scan
+     * @param column_ids the columns to read; the others are returned as nulls
+     * @param ranges conditions on the columns that every row the scan is looking for satisfies, which row groups are
+     *   passed over with; rows that do not satisfy them may be returned still
+     * @param strategy the ring of frames to read the segment pages into, or nullptr to read them into the pool
+     */
+    Scanner(ColumnTable *table, std::vector<uint32_t> column_ids, std::vector<ZoneMap::Range> ranges = {},
+            BufferAccessStrategy *strategy = nullptr);
+
+    /**
+     * Return the next row that is not deleted.
+     * @param[out] values the values of the row, one per column of the table
+     * @param[out] rid the rid of the row
+     * @return false if the scan is over
+     */
+    auto Next(std::vector<Value> *values, RID *rid) -> bool;
+
+   private:
+    /** Load the next row group that the ranges do not rule out. @return false if there is none */
+    auto LoadRowGroup() -> bool;
+
+    ColumnTable *table_;
+    std::vector<uint32_t> column_ids_;
+    std::vector<ZoneMap::Range> ranges_;
+    BufferAccessStrategy *strategy_;
+    /** The row groups, the last of them the tail, and the rows of the tail when the scan started. */
+    size_t row_group_count_;
+    uint32_t tail_row_count_;
+    /** The next row group to load, and the next row of the loaded one. */
+    size_t next_row_group_{0};
+    uint32_t next_row_{0};
+    /** The loaded row group: its number of rows, the values of the columns read, and its deleted rows. */
+    uint32_t row_count_{0};
+    std::vector<std::vector<Value>> columns_;
+    std::vector<bool> deleted_;
+    /** A row of nulls, which every returned row starts from. */
+    std::vector<Value> null_row_;
+  };
+
+  /**
+   * Create an empty table.
+   * @param buffer_pool_manager the buffer pool that holds the segment pages
+   * @param schema the schema of the rows
+   */
+  ColumnTable(BufferPoolManager *buffer_pool_manager, const Schema &schema);
+
+  DISALLOW_COPY_AND_MOVE(ColumnTable);
+
+  ~ColumnTable() = default;
+
+  /**
+   * Append a row to the table.
+   * @param tuple the row, in the schema of the table
+   * @param[out] rid the rid of the row
+   * @param txn the transaction performing the insert
+   * @return false if the tail was full and could not be written out
+   */
+  auto InsertTuple(const TupleRecord &tuple, RID *rid, Transaction *txn) -> bool;
+
+  /**
+   * Append rows to the table, in order.
+   * @param tuples the rows, in the schema of the table
+   * @param[out] rids the rids of the rows that were appended, a prefix of tuples
+   * @param txn the transaction performing the insert
+   * @return true if all rows were appended
+   */
+  auto InsertTuples(const std::vector<const TupleRecord *> &tuples, std::vector<RID> *rids, Transaction *txn) -> bool;
+
+  /**
+   * Delete a row; the delete is undone by RollbackDelete() if the transaction aborts.
+   * @return false if there is no such row, or it is deleted already
+   */
+  auto MarkDelete(const RID &rid, Transaction *txn) -> bool;
+
+  /**
+   * Replace a row, by deleting it and appending the new row, which gets a new rid.
+   * @param tuple the new row
+   * @param rid the rid of the row to replace
+   * @param txn the transaction performing the update
+   * @param[out] new_rid the rid of the new row, if not nullptr
+   * @return false if there is no such row, or the new row could not be appended
+   */
+  auto UpdateTuple(const TupleRecord &tuple, const RID &rid, Transaction *txn, RID *new_rid = nullptr) -> bool;
+
+  /** Delete a row for good: a row deleted by a transaction that committed, or inserted by one that aborted. */
+  void ApplyDelete(const RID &rid, Transaction *txn);
+
+  /** Undo MarkDelete() for a transaction that aborted. */
+  void RollbackDelete(const RID &rid, Transaction *txn);
+
+  /**
+   * Read a row, by decoding the segments of its row group; scans should use a Scanner.
+   * @param rid the rid of the row
+   * @param[out] values the values of the row, one per column
+   * @return false if there is no such row, or it is deleted
+   */
+  auto GetTuple(const RID &rid, std::vector<Value> *values) -> bool;
+
+  /**
+   * Write the tail out as a row group of its own, even if it does not fill one.
+   * @return false if the segment pages could not be allocated; the tail is kept then
+   */
+  auto Flush() -> bool;
+
+  /** @return the number of row groups that were written out, not counting the tail */
+  auto GetRowGroupCount() -> size_t;
+
+  /** @return the header of the segment of a column of a row group that was written out */
+  auto GetSegmentHeader(size_t row_group, uint32_t column_idx) -> ColumnSegment::Header;
+
+  /** @return the first page of the chain of a column, INVALID_PAGE_ID while no row group was written out */
+  auto GetFirstPageId(uint32_t column_idx) -> page_id_t;
+
+  /** @return the schema of the rows */
+  auto GetSchema() const -> const Schema & { return schema_; }
+
+  /** Number of rows of a row group, unless it was written out by Flush(). */
+  static constexpr uint32_t ROW_GROUP_SIZE = 4096;
+
+ private:
+  /** Where a segment is, and what its header says. */
+  struct Segment {
+    page_id_t first_page_id_;
+    uint32_t page_count_;
+    uint32_t size_;
+    ColumnSegment::Header header_;
+  };
+
+  /** @return true if the rid names a row of the table; the latch must be held */
+  auto IsValid(const RID &rid) const -> bool;
+
+  /** Append a row to the tail, first writing out a full tail. The latch must be held exclusively. */
+  auto AppendRow(const TupleRecord &tuple, RID *rid) -> bool;
+
+  /** Write the tail out as a row group and start a new tail. The latch must be held exclusively. */
+  auto WriteRowGroup() -> bool;
+
+  /** Read the bytes of a segment. */
+  void ReadSegment(const Segment &segment, BufferAccessStrategy *strategy, std::vector<char> *data);
+
+  BufferPoolManager *buffer_pool_manager_;
+  Schema schema_;
+  /** Protects everything below. */
+  std::shared_mutex latch_;
+  /** The first and the last page of the chain of every column. */
+  std::vector<page_id_t> first_page_ids_;
+  std::vector<page_id_t> last_page_ids_;
+  /** The segments of the row groups that were written out, one per column each. */
+  std::vector<std::vector<Segment>> segments_;
+  /** The values of the rows of the tail, per column. */
+  std::vector<std::vector<Value>> tail_;
+  /** The deleted rows of every row group, the tail last; one entry per row, so they count the rows, too. */
+  std::vector<std::vector<bool>> deleted_;
+};
+
+}  // namespace bustub
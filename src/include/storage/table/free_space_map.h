@@ -0,0 +1,119 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// free_space_map.h
+//
+// Identification: src/include/storage/table/free_space_map.h
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <mutex>  // NOLINT
+#include <unordered_map>
+#include <vector>
+
+#include "buffer/buffer_pool_manager.h"
+#include "common/config.h"
+#include "common/macros.h"
+
+namespace bustub {
+
+/**
+ * FreeSpaceMap records roughly how much free space every page of a table heap has, so that an insert can go straight
+ * to a page with room instead of trying the pages of the chain one by one.
+ *
+ * The map is stored in a chain of FreeSpaceMapPages whose first page is named in the header of the first heap page.
+ * It is a hint and is not logged: an entry may claim more room than its page has, and the insert that finds out
+ * corrects it. When a heap is opened, pages at the end of its chain that the map misses, e.g. after a crash, are
+ * added to it, and entries of pages that are no longer in the chain are dropped. The map pages stay pinned while the
+ * map is open, so that writing an entry through never waits for, or fails to get, a frame.
+ *
+ * A copy of the map is kept in memory, along with an upper bound of the free space on every map page, so a search
+ * reads no pages and skips a map page's worth of full heap pages at a time. The page where the previous search
+ * succeeded is tried first, which makes appending to a heap O(1).
+ *
+ * A page that is unlinked from the heap leaves its entry behind with an invalid page id, so that the entries of the
+ * other pages keep their place.
+ */
+class FreeSpaceMap {
+ public:
+  /** @param buffer_pool_manager the buffer pool that holds the heap and its map */
+  explicit FreeSpaceMap(BufferPoolManager *buffer_pool_manager) : buffer_pool_manager_(buffer_pool_manager) {}
+
+  DISALLOW_COPY_AND_MOVE(FreeSpaceMap);
+
+  ~FreeSpaceMap();
+
+  /**
+   * Load the map of a table heap, adding the pages of the heap that it misses.
+   * @param map_page_id the first page of the map, or INVALID_PAGE_ID to create one
+   * @param first_heap_page_id the first page of the heap
+   * @return the first page of the map, which differs from map_page_id if a new map was created
+   */
+  auto Open(page_id_t map_page_id, page_id_t first_heap_page_id) -> page_id_t;
+
+  /**
+   * @param space bytes that the insert needs on the page, including the slot
+   * @return a heap page that had at least `space` free bytes when it was last recorded, or INVALID_PAGE_ID
+   */
+  auto FindPage(uint32_t space) -> page_id_t;
+
+  /** Record the free space of a heap page after an insert, update or delete changed it. */
+  void Update(page_id_t heap_page_id, uint32_t free_space);
+
+  /** Record a page that was linked to the end of the heap. */
+  void Append(page_id_t heap_page_id, uint32_t free_space);
+
+  /** Forget a page that was unlinked from the heap. It must not be the last page. */
+  void Remove(page_id_t heap_page_id);
+
+  /** @return the last page of the heap */
+  auto GetLastPageId() -> page_id_t;
+
+  /**
+   * @return the next at most `count` pages after a heap page, in chain order, or nothing if the map misses the page;
+   *   read from the copy in memory, e.g. for read-ahead
+   */
+  auto GetNextPageIds(page_id_t heap_page_id, size_t count) -> std::vector<page_id_t>;
+
+  /** @return the recorded free space of a heap page, rounded down to FreeSpaceMapPage::FREE_SPACE_UNIT */
+  auto GetFreeSpace(page_id_t heap_page_id) -> uint32_t;
+
+  /** @return the number of heap pages in the map */
+  auto GetNumPages() -> size_t;
+
+ private:
+  /** Add a heap page to the end of the map, starting a new map page if the last one is full. */
+  void AppendEntry(page_id_t heap_page_id, uint8_t free_units);
+
+  /** Write an entry through to its map page. */
+  void StoreEntry(size_t index);
+
+  /** Pin a map page until the map is closed and add it to the end of the map. */
+  void PinMapPage(page_id_t map_page_id);
+
+  /** Turn an entry into that of a page which was unlinked from the heap. */
+  void RemoveEntry(size_t index);
+
+  BufferPoolManager *buffer_pool_manager_;
+  /** Protects everything below. */
+  std::mutex latch_;
+  /** The map pages in chain order, each pinned once for as long as the map is open. */
+  std::vector<page_id_t> map_page_ids_;
+  /** The heap pages in chain order, and their free space in units of FreeSpaceMapPage::FREE_SPACE_UNIT. */
+  std::vector<page_id_t> heap_page_ids_;
+  std::vector<uint8_t> free_units_;
+  /** Per map page, no entry on it has more free units than this. */
+  std::vector<uint8_t> max_free_units_;
+  std::unordered_map<page_id_t, size_t> entry_of_page_;
+  /** Number of entries of pages that were unlinked from the heap. */
+  size_t num_removed_{0};
+  /** Entry that the last successful search returned. */
+  size_t hint_{0};
+};
+
+}  // namespace bustub
@@ -12,17 +12,39 @@
 
 #pragma once
 
+#include <atomic>
+#include <memory>
+#include <mutex>  // NOLINT
+#include <vector>
+
 #include "buffer/buffer_pool_manager.h"
 #include "recovery/log_manager.h"
 #include "storage/page/table_page.h"
+#include "storage/table/free_space_map.h"
 #include "storage/table/table_iterator.h"
 #include "storage/table/tuple_record.h"
+#include "storage/table/zone_map.h"
+#include "type/type.h"
 
 namespace bustub {
 
 /**
  * TableHeap represents a physical table on disk.
  * This is just a doubly-linked list of pages.
+ *
+ * Inserts do not walk the list: a FreeSpaceMap names a page with enough room, and only if there is none is a page
+ * linked to the end of the list.
+ *
+ * Pages that become empty are unlinked from the list, on commit if auto_vacuum is set and otherwise by Vacuum(). An
+ * unlinked page is retired rather than freed while a scan or insert that may still hold its id is running.
+ *
+ * A tuple too large for a table page keeps the rest in a chain of overflow pages. An update of such a row writes a new
+ * chain and retires the old one, which a tuple read before may still have to read, see VisitOverflow().
+ *
+ * A table may also keep a ZoneMap, which lets scans with a range predicate pass over pages.
+ *
+ * The pages of a table with the PAX layout store its tuples column by column, see TablePage::InitPax(). Tuples and rids
+ * work the same as with slotted pages, and ScanColumn() reads a column without putting tuples together.
  */
 class TableHeap {
   friend class TableIterator;
@@ -59,6 +81,16 @@ class TableHeap {
    */
   auto InsertTuple(const TupleRecord &tuple, RID *rid, Transaction *txn) -> bool;
 
+  /**
+   * Insert a batch of tuples into the table, in order. Each page that has room is latched and pinned once and filled
+   * with as many of the tuples as fit, and the write set gets the entries of the whole batch at once.
+   * @param tuples tuples to insert
+   * @param[out] rids the rids of the inserted tuples, in the order of tuples
+   * @param txn the transaction performing the insert
+   * @return true iff all tuples were inserted; otherwise rids holds the rids of the tuples inserted before the failure
+   */
+  auto InsertTuples(const std::vector<const TupleRecord *> &tuples, std::vector<RID> *rids, Transaction *txn) -> bool;
+
   /**
    * Mark the tuple as deleted. The actual delete will occur when ApplyDelete is called.
    * @param rid resource id of the tuple of delete
@@ -91,29 +123,222 @@ class TableHeap {
   void RollbackDelete(const RID &rid, Transaction *txn);
 
   /**
-   * Read a tuple from the table.
+   * Read a tuple from the table. Of a tuple that overflows, only the part in the table page is read; the overflow pages
+   * are read when a value stored in them is accessed, see TupleRecord::LoadOverflow(). An update of the row meanwhile
+   * does not change the chain the tuple reads, see VisitOverflow().
    * @param rid rid of the tuple to read
    * @param tuple output variable for the tuple
    * @param txn transaction performing the read
+   * @param strategy if not null, pages that are not in the buffer pool are read into the ring of this bulk read
    * @return true if the read was successful (i.e. the tuple exists)
    */
-  auto GetTuple(const RID &rid, TupleRecord *tuple, Transaction *txn, bool acquire_read_lock = true) -> bool;
-   char* MergeData(char* ptr1, uint32_t size1, char* ptr2, uint32_t size2);
-   void SplitData(char*data, int length ,char**dest1,int length1,char**dest2,int length2);
-  /** @return the begin iterator of this table */
-  auto Begin(Transaction *txn) -> TableIterator;
+  auto GetTuple(const RID &rid, TupleRecord *tuple, Transaction *txn, bool acquire_read_lock = true,
+                BufferAccessStrategy *strategy = nullptr) -> bool;
+  /**
+   * @param txn transaction performing the scan
+   * @param strategy if not null, the scan reads pages into this ring of frames instead of the shared buffer pool
+   * @param zone_filter if not null, the scan passes over the pages that the zone map rules out for these ranges; the
+   *   iterator may still return tuples outside of them
+   * @return the begin iterator of this table
+   */
+  auto Begin(Transaction *txn, BufferAccessStrategy *strategy = nullptr,
+             const std::vector<ZoneMap::Range> *zone_filter = nullptr) -> TableIterator;
 
   /** @return the end iterator of this table */
   auto End() -> TableIterator;
 
+  /**
+   * Compact every page of the table and unlink the pages without tuples from the list, except the first and the last.
+   * @return the number of pages unlinked
+   */
+  auto Vacuum() -> size_t;
+
   /** @return the id of the first page of this table */
   inline auto GetFirstPageId() const -> page_id_t { return first_page_id_; }
 
+  /** @return the free space map of this table */
+  auto GetFreeSpaceMap() -> FreeSpaceMap * { return &free_space_map_; }
+
+  /**
+   * Keep a zone map of the fixed-width columns of the table, opening the one named in the first page or creating it.
+   * Does nothing if the schema has no column that a zone map tracks. Call it before the heap is shared.
+   * @param schema the schema of the tuples of the table
+   */
+  void EnableZoneMap(const Schema &schema);
+
+  /** @return the zone map of this table, or nullptr if it has none */
+  auto GetZoneMap() -> ZoneMap * { return zone_map_.get(); }
+
+  /**
+   * Store the tuples of the table column by column, in PAX pages. Call it on a new heap, before anything is inserted.
+   * @param schema the schema of the tuples of the table
+   * @throw Exception if the schema has a column that is not fixed-width, or its tuples are too wide for a PAX page
+   */
+  void UsePaxLayout(const Schema &schema);
+
+  /** @return how the pages of this table store its tuples */
+  auto GetLayout() const -> TableLayout { return pax_column_types_.empty() ? TableLayout::ROW : TableLayout::PAX; }
+
+  /**
+   * Scan a column of a table with the PAX layout, copying it page by page straight out of the minipage of the column
+   * into an array, without putting tuples together. The scan counts as a visitor of the heap, like an iterator.
+   * @param column_idx index of the column in the schema of the table
+   * @param on_page called for every page as on_page(page_id, values, slot_nums, is_null) with the values of the
+   *   column of the tuples on the page as a std::vector<T>, their slot numbers, and whether they are null; null values
+   *   hold the null value of the type
+   * @param strategy if not null, pages that are not in the buffer pool are read into the ring of this bulk read
+   * @return false if the table does not have the PAX layout, T does not have the width of the type of the column, e.g.
+   *   int32_t for INTEGER, or a page could not be fetched
+   */
+  template <typename T, typename Callback>
+  auto ScanColumn(uint32_t column_idx, Callback &&on_page, BufferAccessStrategy *strategy = nullptr) -> bool {
+    if (column_idx >= pax_column_types_.size() || Type::GetTypeSize(pax_column_types_[column_idx]) != sizeof(T)) {
+      return false;
+    }
+    std::vector<T> values;
+    std::vector<uint32_t> slot_nums;
+    std::vector<bool> is_null;
+    bool is_read = true;
+    EnterHeap();
+    for (page_id_t page_id = first_page_id_; is_read && page_id != INVALID_PAGE_ID;) {
+      page_id_t next_page_id;
+      values.resize(pax_capacity_);
+      const int64_t num_values = ReadColumnData(page_id, column_idx, reinterpret_cast<char *>(values.data()),
+                                                &next_page_id, &slot_nums, &is_null, strategy);
+      is_read = num_values >= 0;
+      if (is_read) {
+        values.resize(num_values);
+        on_page(page_id, values, slot_nums, is_null);
+        page_id = next_page_id;
+      }
+    }
+    LeaveHeap();
+    return is_read;
+  }
+
  private:
+  /**
+   * Read a column of a page for ScanColumn().
+   * @param[out] values receives the values; it has room for pax_capacity_ of them
+   * @return the number of values, or -1 if the page could not be fetched
+   */
+  auto ReadColumnData(page_id_t page_id, uint32_t column_idx, char *values, page_id_t *next_page_id,
+                      std::vector<uint32_t> *slot_nums, std::vector<bool> *is_null, BufferAccessStrategy *strategy)
+      -> int64_t;
+
+  /** Load the free space map named in the first page, creating it if there is none yet. */
+  void OpenFreeSpaceMap();
+
+  /** Insert a tuple that is too large for a page into a page and a chain of overflow pages, without adding it to the
+   * write set. */
+  auto InsertOverflowTuple(const TupleRecord &tuple, RID *rid, Transaction *txn) -> bool;
+
+  /**
+   * Update a row that overflows with a tuple that overflows, writing a new overflow chain and retiring the old one.
+   * @param[out] is_updated true iff the update is successful
+   * @return false, without changing anything, if the row has no overflow chain
+   */
+  auto UpdateOverflowTuple(const TupleRecord &tuple, const RID &rid, Transaction *txn, bool *is_updated) -> bool;
+
+  /**
+   * Write the part of a tuple that does not fit into a table page to a new chain of overflow pages, streaming it
+   * straight from the tuple into the pages.
+   * @param[out] page_ids receives the pages of the chain, in order
+   * @return false if a page could not be allocated; the transaction is aborted then
+   */
+  auto WriteOverflow(const char *data, uint32_t size, std::vector<page_id_t> *page_ids, Transaction *txn) -> bool;
+
+  /**
+   * Collect the pages of an overflow chain, in order.
+   * @param page_id first page of the chain
+   * @param[out] page_ids receives the pages of the chain
+   * @return false if a page could not be fetched
+   */
+  auto CollectOverflow(page_id_t page_id, std::vector<page_id_t> *page_ids) -> bool;
+
+  /** Free the pages of an overflow chain that never became part of the table. */
+  void DeleteOverflow(const std::vector<page_id_t> &page_ids);
+
+  /** Retire the pages of an overflow chain that the table no longer links to, see VisitOverflow(). */
+  void RetireOverflow(const std::vector<page_id_t> &page_ids);
+
+  /**
+   * Count a tuple that has not read its overflow chain yet as a visitor, see TupleRecord::LoadOverflow(). The caller
+   * must hold the latch of the table page of the tuple or be a visitor, so that the chain is not freed before.
+   * @return the visit, which ends once the tuple and all its copies have read the chain or are gone
+   */
+  auto VisitOverflow() -> std::shared_ptr<void>;
+
+  /** @return the part of a tuple that goes into a table page, copied into data, which has MAX_TUPLE_SIZE bytes */
+  static auto MakeOverflowHead(const TupleRecord &tuple, page_id_t overflow_page_id, char *data) -> TupleRecord;
+
+  /** Insert a tuple that fits into a page into one with room, without adding it to the write set. */
+  auto PlaceTuple(const TupleRecord &tuple, RID *rid, Transaction *txn) -> bool;
+
+  /**
+   * Insert tuples[*next] and as many of the tuples after it as fit into one page with room, without adding them to the
+   * write set. Falls back to AppendTuples() if no page has room. Advances *next past the inserted tuples.
+   */
+  auto PlaceTuples(const std::vector<const TupleRecord *> &tuples, size_t *next, std::vector<RID> *rids,
+                   Transaction *txn) -> bool;
+
+  /**
+   * Insert tuples from tuples[*next] on into the last page, and into new pages linked after it, up to the next tuple
+   * that is too large for a page. Advances *next past the inserted tuples.
+   */
+  auto AppendTuples(const std::vector<const TupleRecord *> &tuples, size_t *next, std::vector<RID> *rids,
+                    Transaction *txn) -> bool;
+
+  /**
+   * Insert tuples from tuples[*next] on into a write latched page until one does not fit. Advances *next past the
+   * inserted tuples and appends their rids.
+   * @return the number of tuples inserted
+   */
+  auto FillPage(TablePage *page, const std::vector<const TupleRecord *> &tuples, size_t *next, std::vector<RID> *rids,
+                Transaction *txn) -> size_t;
+
+  /**
+   * Unlink a page without tuples from the list and retire it, see TablePage::Retire(). The caller must be a visitor,
+   * see EnterHeap(), and must not hold a page latch.
+   * @return false if the page is the first or the last page, holds a tuple, or is no longer in the list
+   */
+  auto ReclaimPage(page_id_t page_id) -> bool;
+
+  /** Count a visitor, i.e. a scan or insert that may hold the id of a page that gets unlinked. */
+  void EnterHeap() { (*num_visitors_)++; }
+
+  /** Stop counting a visitor, freeing the retired pages if it was the last one. */
+  void LeaveHeap();
+
+  /** Free the retired pages, unless there is a visitor. */
+  void FreeRetiredPages();
+
   BufferPoolManager *buffer_pool_manager_;
   LockManager *lock_manager_;
   LogManager *log_manager_;
   page_id_t first_page_id_{};
+  /** Last page of the overflow chain written last, where the next chain starts. */
+  std::atomic<page_id_t> last_overflow_page_id_{INVALID_PAGE_ID};
+  FreeSpaceMap free_space_map_;
+  /** Set by EnableZoneMap(). */
+  std::unique_ptr<ZoneMap> zone_map_;
+  /** Types of the columns of the PAX pages of the table, empty if it has slotted pages. */
+  std::vector<TypeId> pax_column_types_;
+  /** Number of rows of a PAX page of the table. */
+  uint32_t pax_capacity_{0};
+  /** Serializes changing the links of the list, i.e. linking new pages to its end and unlinking empty pages. */
+  std::mutex append_latch_;
+  /**
+   * Number of visitors; retired pages are only freed while there is none. Shared with the iterators, which may outlive
+   * the heap and then only give up their count.
+   */
+  std::shared_ptr<std::atomic<size_t>> num_visitors_{std::make_shared<std::atomic<size_t>>(0)};
+  /** True while retired_pages_ is not empty. */
+  std::atomic<bool> has_retired_pages_{false};
+  /** Protects retired_pages_. */
+  std::mutex retired_latch_;
+  /** Pages that were unlinked from the list but are not freed yet. */
+  std::vector<page_id_t> retired_pages_;
 };
 
 }  // namespace bustub
@@ -12,29 +12,50 @@
 
 #pragma once
 
+#include <atomic>
 #include <cassert>
+#include <memory>
+#include <vector>
 
+#include "buffer/buffer_access_strategy.h"
 #include "common/rid.h"
 #include "concurrency/transaction.h"
+#include "storage/page/table_page.h"
 #include "storage/table/tuple.h"
+#include "storage/table/zone_map.h"
 
 namespace bustub {
 
 class TableHeap;
 
 /**
- * TableIterator enables the sequential scan of a TableHeap.
+ * TableIterator enables the sequential scan of a TableHeap. Until it reaches the end, it counts as a visitor of the
+ * heap, which keeps pages that are unlinked from the heap meanwhile from being freed under it.
+ *
+ * The iterator reads a page at a time: it pins and latches a page once to copy out all of its tuples, and then hands
+ * them out without going back to the buffer pool. The tuple it points to is a view into that copy, which is only valid
+ * until the iterator moves on; TupleRecord::Materialize() gives a copy of it its own data.
+ *
+ * Given a zone filter, the iterator does not read the pages that the zone map of the heap rules out for it.
+ *
+ * The pages ahead of the scan are read in the background, read_ahead_depth of them at a time. The page ids are taken
+ * from the free space map of the heap, so that the window slides by one page hint per page read, at no further
+ * round trip to the buffer pool.
  */
 class TableIterator {
   friend class Cursor;
 
  public:
-  TableIterator(TableHeap *table_heap, RID rid, Transaction *txn);
+  /**
+   * @param rid where the scan starts; it goes to the first tuple at or after it
+   * @param zone_filter if not null, ranges that the tuples the scan looks for satisfy, see ZoneMap::SkipPages()
+   */
+  TableIterator(TableHeap *table_heap, RID rid, Transaction *txn, BufferAccessStrategy *strategy = nullptr,
+                const std::vector<ZoneMap::Range> *zone_filter = nullptr);
 
-  TableIterator(const TableIterator &other)
-      : table_heap_(other.table_heap_), tuple_(new TupleRecord(*other.tuple_)), txn_(other.txn_) {}
+  TableIterator(const TableIterator &other);
 
-  ~TableIterator() { delete tuple_; }
+  ~TableIterator();
 
   inline auto operator==(const TableIterator &itr) const -> bool {
     return tuple_->rid_.Get() == itr.tuple_->rid_.Get();
@@ -50,17 +71,44 @@ class TableIterator {
 
   auto operator++(int) -> TableIterator;
 
-  auto operator=(const TableIterator &other) -> TableIterator & {
-    table_heap_ = other.table_heap_;
-    *tuple_ = *other.tuple_;
-    txn_ = other.txn_;
-    return *this;
-  }
+  auto operator=(const TableIterator &other) -> TableIterator &;
+
+  /** @return true if the iterator is past the last tuple, i.e. equal to TableHeap::End() */
+  inline auto IsEnd() const -> bool { return tuple_->rid_.GetPageId() == INVALID_PAGE_ID; }
 
  private:
+  /** The tuples of the page the iterator is on, copied out under one read latch of the page. */
+  struct PageCopy {
+    page_id_t page_id_;
+    page_id_t next_page_id_;
+    std::vector<TablePage::TupleSlot> slots_;
+    std::vector<char> data_;
+  };
+
+  /** Copy the tuples of a page, reusing the copy of the current page unless another iterator shares it. */
+  void ReadPage(page_id_t page_id);
+
+  /** Point the tuple at slots_[slot_index_] of the page copy, going on to the next pages if it is past the last one. */
+  void SeekTuple();
+
+  /** @return page_id, or the page after it that the scan goes on with if the zone filter rules it out */
+  auto SkipPages(page_id_t page_id) -> page_id_t;
+
   TableHeap *table_heap_;
   TupleRecord *tuple_;
   Transaction *txn_;
+  /** Ring of frames of a bulk read, nullptr to read through the shared buffer pool. */
+  BufferAccessStrategy *strategy_;
+  /** Ranges of the zone filter, nullptr to read every page. */
+  const std::vector<ZoneMap::Range> *zone_filter_;
+  /** Visitor count of the heap while this iterator is counted in it, i.e. until it reaches the end. */
+  std::shared_ptr<std::atomic<size_t>> num_visitors_;
+  /** Copy of the current page, shared by copies of the iterator. */
+  std::shared_ptr<PageCopy> page_;
+  /** Index of the current tuple in page_->slots_. */
+  size_t slot_index_{0};
+  /** The last page that was hinted to the read-ahead, INVALID_PAGE_ID if none. */
+  page_id_t read_ahead_page_id_{INVALID_PAGE_ID};
 };
 
 }  // namespace bustub
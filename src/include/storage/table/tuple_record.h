@@ -12,6 +12,8 @@
 
 #pragma once
 
+#include <algorithm>
+#include <memory>
 #include <string>
 #include <vector>
 
@@ -21,6 +23,8 @@
 #include "storage/table/tuple.h"
 namespace bustub {
 
+class BufferPoolManager;
+
 /**
  * Tuple format:
  * ---------------------------------------------------------------------
@@ -66,10 +70,29 @@ class TupleRecord : public Tuple {
   inline auto GetRid() const -> RID { return rid_; }
 
   // Get the address of this tuple in the table's backing store
-  inline auto GetData() const -> char * { return Tuple::GetData(); }
+  inline auto GetData() const -> char * {
+    LoadOverflow();
+    return Tuple::GetData();
+  }
 
   // Get length of the tuple, including varchar legth
-  inline auto GetLength() const -> uint32_t { return Tuple::GetLength(); }
+  inline auto GetLength() const -> uint32_t {
+    LoadOverflow();
+    return Tuple::GetLength();
+  }
+
+  /**
+   * Read the part of the tuple that is stored in overflow pages, if that has not happened yet. The whole tuple is put
+   * into one buffer of its full size. Accessors that need the overflow call this themselves.
+   * @throws Exception if an overflow page can't be read or the chain does not hold the rest of the tuple
+   */
+  void LoadOverflow() const;
+
+  /** Give the tuple its own copy of its data if it only points to data it does not own, e.g. a TableIterator's. */
+  void Materialize();
+
+  /** @return true if part of the tuple is still only in overflow pages, see TableHeap::GetTuple() */
+  inline auto IsOverflowPending() const -> bool { return overflow_bpm_ != nullptr; }
 
   // Get the value of a specified column (const)
   // checks the schema to see how to return the Value.
@@ -86,6 +109,12 @@ class TupleRecord : public Tuple {
   inline auto IsAllocated() const -> bool { return Tuple::IsAllocated(); }
 
   auto ToString(const Schema *schema) const -> std::string;
+
+  /** @return the bytes of the null bitmap of a tuple with column_count columns, one bit per column but at least 2 */
+  static auto NullBitmapSize(uint32_t column_count) -> uint32_t {
+    return std::max<uint32_t>(sizeof(uint16_t), (column_count + 7) / 8);
+  }
+
   //1 means null
   auto clearNull(int colIdx) -> void {
     int byteIndex = colIdx / 8;
@@ -102,9 +131,9 @@ class TupleRecord : public Tuple {
   auto isColNull(const Schema *schema, uint32_t colIdx)  const-> bool {
    
     
-    int byteIndex = (colIdx / 8) % 2;
+    int byteIndex = colIdx / 8;
     int bitOffset = colIdx % 8;
-    return ((GetData() + sizeof(uint32_t)+  schema->GetLength())[byteIndex] & (1 << bitOffset)) != 0;
+    return ((data_ + sizeof(uint32_t)+  schema->GetLength())[byteIndex] & (1 << bitOffset)) != 0;
 
   }
   auto SetOverFlowPageId(page_id_t overFlowId) -> void;
@@ -119,6 +148,10 @@ class TupleRecord : public Tuple {
   // char *data_{nullptr};
   char *tupleData_{nullptr};
   char *bitMapPtr_{nullptr};
+  // if not null, data_ only holds the part of the tuple that is in its table page, the rest is read through this
+  BufferPoolManager *overflow_bpm_{nullptr};
+  // keeps the overflow chain from being freed until it is read, shared by the copies; see TableHeap::VisitOverflow()
+  std::shared_ptr<void> overflow_visit_;
 };
 
 }  // namespace bustub
@@ -0,0 +1,157 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// zone_map.h
+//
+// Identification: src/include/storage/table/zone_map.h
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <mutex>  // NOLINT
+#include <optional>
+#include <unordered_map>
+#include <vector>
+
+#include "buffer/buffer_pool_manager.h"
+#include "catalog/schema.h"
+#include "common/config.h"
+#include "common/macros.h"
+#include "common/rid.h"
+#include "storage/table/tuple_record.h"
+#include "type/value.h"
+
+namespace bustub {
+
+/**
+ * ZoneMap records the smallest and the largest value, and the number of nulls, of the fixed-width columns of a table
+ * on every page of its heap, so that a scan with a range predicate can pass over the pages that cannot hold a match.
+ *
+ * Like the FreeSpaceMap, the map is stored in a chain of ZoneMapPages whose first page is named in the header of the
+ * first heap page, lists the heap pages in the order of the page chain, and is not logged. A zone only ever widens:
+ * inserts and updates record their values, deletes leave the zone as it was, so a zone may be wider than its page but
+ * never narrower. A page whose tuples were not all recorded, e.g. one that the map missed before a crash or that held
+ * tuples when the map was created, is incomplete and is never passed over.
+ *
+ * A copy of the map is kept in memory, so looking for the next page of a scan reads no pages. The map pages stay
+ * pinned while the map is open, so that writing an entry through never waits for, or fails to get, a frame.
+ */
+class ZoneMap {
+ public:
+  /**
+   * A condition `lower <= column <= upper` that a predicate puts on every tuple it is true for. A missing bound is
+   * unbounded; an exclusive bound leaves out the bound itself.
+   */
+  struct Range {
+    uint32_t column_idx_{0};
+    std::optional<Value> lower_;
+    bool lower_inclusive_{true};
+    std::optional<Value> upper_;
+    bool upper_inclusive_{true};
+  };
+
+  /**
+   * @param buffer_pool_manager the buffer pool that holds the heap and its map
+   * @param schema the schema of the tuples of the heap; its first MAX_COLUMNS fixed-width columns are tracked
+   */
+  ZoneMap(BufferPoolManager *buffer_pool_manager, const Schema &schema);
+
+  DISALLOW_COPY_AND_MOVE(ZoneMap);
+
+  ~ZoneMap();
+
+  /** @return true if a map of the schema would track any column */
+  static auto HasTrackedColumns(const Schema &schema) -> bool;
+
+  /**
+   * Load the map of a table heap, adding the pages of the heap that it misses.
+   * @param map_page_id the first page of the map, or INVALID_PAGE_ID to create one
+   * @param first_heap_page_id the first page of the heap
+   * @return the first page of the map, which differs from map_page_id if a new map was created
+   */
+  auto Open(page_id_t map_page_id, page_id_t first_heap_page_id) -> page_id_t;
+
+  /** Widen the zone of a heap page by the values of a tuple that is written to it. */
+  void Record(page_id_t heap_page_id, const TupleRecord &tuple);
+
+  /** Record an empty page that was linked to the end of the heap. */
+  void Append(page_id_t heap_page_id);
+
+  /** Forget a page that was unlinked from the heap. It must not be the last page. */
+  void Remove(page_id_t heap_page_id);
+
+  /**
+   * Pass over the pages that no tuple satisfying all ranges can be on.
+   * @param heap_page_id the next page that a scan would read
+   * @param ranges conditions that every tuple the scan is looking for satisfies
+   * @return heap_page_id or the first page after it in the heap that may hold such a tuple; the last page of the heap
+   *   is always returned rather than passed over, since pages that are linked after it are only found through it
+   */
+  auto SkipPages(page_id_t heap_page_id, const std::vector<Range> &ranges) -> page_id_t;
+
+  /** @return true if a tuple satisfying all ranges may be on the heap page; pages the map misses may hold anything */
+  auto MayMatch(page_id_t heap_page_id, const std::vector<Range> &ranges) -> bool;
+
+  /**
+   * @return true if a column of the type whose values lie within [min, max] may hold a value in the range; has_range
+   *   is false for a column that holds only nulls, which no range matches
+   */
+  static auto RangeMayMatch(const Range &range, TypeId type_id, bool has_range, const Value &min, const Value &max)
+      -> bool;
+
+  /** @return the number of nulls recorded in a column on a heap page, or 0 if the map misses the page or column */
+  auto GetNullCount(page_id_t heap_page_id, uint32_t column_idx) -> uint32_t;
+
+  /** Largest number of columns that a map tracks. */
+  static constexpr uint32_t MAX_COLUMNS = 16;
+
+ private:
+  /** The values of one column on one heap page. */
+  struct ColumnZone {
+    Value min_;
+    Value max_;
+    uint32_t null_count_{0};
+    /** False until a value that is not null is recorded; min_ and max_ are only set if true. */
+    bool has_range_{false};
+  };
+
+  /** @return true if the zone of an entry may hold a tuple satisfying all ranges */
+  auto MayMatchEntry(size_t index, const std::vector<Range> &ranges) -> bool;
+
+  /** Widen the zone of an entry by the values of a tuple. @return true if the zone changed */
+  auto RecordEntry(size_t index, const TupleRecord &tuple) -> bool;
+
+  /** Add a heap page to the end of the map, starting a new map page if the last one is full. */
+  void AppendEntry(page_id_t heap_page_id, bool is_complete);
+
+  /** Write an entry through to its map page. */
+  void StoreEntry(size_t index);
+
+  /** Pin a map page until the map is closed and add it to the end of the map. */
+  void PinMapPage(page_id_t map_page_id);
+
+  BufferPoolManager *buffer_pool_manager_;
+  Schema schema_;
+  /** The tracked columns, as indexes into schema_. */
+  std::vector<uint32_t> columns_;
+  /** Per column of schema_, its index in columns_, or -1 if it is not tracked. */
+  std::vector<int> slot_of_column_;
+  /** Number of entries per map page. */
+  uint32_t capacity_;
+  /** Protects everything below. */
+  std::mutex latch_;
+  /** The map pages in chain order, each pinned once for as long as the map is open. */
+  std::vector<page_id_t> map_page_ids_;
+  /** The heap pages in chain order, and whether all their tuples were recorded. */
+  std::vector<page_id_t> heap_page_ids_;
+  std::vector<bool> is_complete_;
+  /** The zones of the tracked columns of every entry, columns_.size() per entry. */
+  std::vector<ColumnZone> zones_;
+  std::unordered_map<page_id_t, size_t> entry_of_page_;
+};
+
+}  // namespace bustub
@@ -55,7 +55,9 @@ auto Optimizer::OptimizeOrderByAsIndexScan(const AbstractPlanNodeRef &plan) -> A
     BUSTUB_ENSURE(optimized_plan->children_.size() == 1, "Sort with multiple children?? Impossible!");
     const auto &child_plan = optimized_plan->children_[0];
 
-    if (child_plan->GetType() == PlanType::SeqScan) {
+    // an index scan has no filter, so it only replaces a scan without one
+    if (child_plan->GetType() == PlanType::SeqScan &&
+        dynamic_cast<const SeqScanPlanNode &>(*child_plan).filter_predicate_ == nullptr) {
       const auto &seq_scan = dynamic_cast<const SeqScanPlanNode &>(*child_plan);
       const auto *table_info = catalog_.GetTable(seq_scan.GetTableOid());
       const auto indices = catalog_.GetTableIndexes(table_info->name_);
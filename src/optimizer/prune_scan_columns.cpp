@@ -0,0 +1,161 @@
+#include <algorithm>
+#include <memory>
+#include <optional>
+#include <vector>
+#include "execution/expressions/column_value_expression.h"
+#include "execution/plans/aggregation_plan.h"
+#include "execution/plans/filter_plan.h"
+#include "execution/plans/hash_join_plan.h"
+#include "execution/plans/nested_index_join_plan.h"
+#include "execution/plans/nested_loop_join_plan.h"
+#include "execution/plans/projection_plan.h"
+#include "execution/plans/seq_scan_plan.h"
+#include "execution/plans/sort_plan.h"
+#include "execution/plans/topn_plan.h"
+
+#include "optimizer/optimizer.h"
+
+namespace bustub {
+
+/**
+ * Mark the columns that an expression reads.
+ * @param tuple_idx only mark the columns of this side of a join, or the columns of any side if nullopt
+ */
+static void MarkColumns(const AbstractExpressionRef &expr, std::optional<uint32_t> tuple_idx,
+                        std::vector<bool> *columns) {
+  if (expr == nullptr) {
+    return;
+  }
+  if (const auto *column = dynamic_cast<const ColumnValueExpression *>(expr.get()); column != nullptr) {
+    if ((!tuple_idx.has_value() || column->GetTupleIdx() == *tuple_idx) && column->GetColIdx() < columns->size()) {
+      (*columns)[column->GetColIdx()] = true;
+    }
+    return;
+  }
+  for (const auto &child : expr->GetChildren()) {
+    MarkColumns(child, tuple_idx, columns);
+  }
+}
+
+/** Split the columns required from a join between its left and its right child. */
+static void SplitJoinColumns(const std::vector<bool> &required, std::vector<bool> *left, std::vector<bool> *right) {
+  for (size_t i = 0; i < required.size(); i++) {
+    if (!required[i]) {
+      continue;
+    }
+    if (i < left->size()) {
+      (*left)[i] = true;
+    } else if (i - left->size() < right->size()) {
+      (*right)[i - left->size()] = true;
+    }
+  }
+}
+
+auto Optimizer::OptimizePruneScanColumns(const AbstractPlanNodeRef &plan) -> AbstractPlanNodeRef {
+  return PruneScanColumns(plan, std::vector<bool>(plan->OutputSchema().GetColumnCount(), true));
+}
+
+auto Optimizer::PruneScanColumns(const AbstractPlanNodeRef &plan, const std::vector<bool> &required)
+    -> AbstractPlanNodeRef {
+  if (plan->GetType() == PlanType::SeqScan) {
+    const auto &seq_scan_plan = dynamic_cast<const SeqScanPlanNode &>(*plan);
+    const TableInfo *table_info = catalog_.GetTable(seq_scan_plan.GetTableOid());
+    // only a columnar table stores its columns apart, a table heap reads whole tuples anyway
+    if (table_info == Catalog::NULL_TABLE_INFO || table_info->column_table_ == nullptr) {
+      return plan;
+    }
+    std::vector<bool> columns = required;
+    MarkColumns(seq_scan_plan.filter_predicate_, std::nullopt, &columns);
+    std::vector<uint32_t> column_ids;
+    for (uint32_t i = 0; i < columns.size(); i++) {
+      if (columns[i]) {
+        column_ids.push_back(i);
+      }
+    }
+    auto pruned_plan = std::make_shared<SeqScanPlanNode>(seq_scan_plan);
+    pruned_plan->column_ids_ = std::move(column_ids);
+    return pruned_plan;
+  }
+
+  // The columns that the plan node reads from each of its children. Expressions are evaluated whether or not the plan
+  // above reads their results, so all the columns they read are required.
+  std::vector<std::vector<bool>> child_required;
+  for (const auto &child : plan->GetChildren()) {
+    child_required.emplace_back(child->OutputSchema().GetColumnCount(), false);
+  }
+  const auto pass_through = [&]() {
+    for (size_t i = 0; i < std::min(required.size(), child_required[0].size()); i++) {
+      child_required[0][i] = required[i];
+    }
+  };
+  switch (plan->GetType()) {
+    case PlanType::Filter:
+      pass_through();
+      MarkColumns(dynamic_cast<const FilterPlanNode &>(*plan).GetPredicate(), std::nullopt, &child_required[0]);
+      break;
+    case PlanType::Limit:
+      pass_through();
+      break;
+    case PlanType::Sort:
+      pass_through();
+      for (const auto &[order_by_type, expr] : dynamic_cast<const SortPlanNode &>(*plan).GetOrderBy()) {
+        MarkColumns(expr, std::nullopt, &child_required[0]);
+      }
+      break;
+    case PlanType::TopN:
+      pass_through();
+      for (const auto &[order_by_type, expr] : dynamic_cast<const TopNPlanNode &>(*plan).GetOrderBy()) {
+        MarkColumns(expr, std::nullopt, &child_required[0]);
+      }
+      break;
+    case PlanType::Projection:
+      for (const auto &expr : dynamic_cast<const ProjectionPlanNode &>(*plan).GetExpressions()) {
+        MarkColumns(expr, std::nullopt, &child_required[0]);
+      }
+      break;
+    case PlanType::Aggregation: {
+      const auto &agg_plan = dynamic_cast<const AggregationPlanNode &>(*plan);
+      for (const auto &expr : agg_plan.GetGroupBys()) {
+        MarkColumns(expr, std::nullopt, &child_required[0]);
+      }
+      for (const auto &expr : agg_plan.GetAggregates()) {
+        MarkColumns(expr, std::nullopt, &child_required[0]);
+      }
+      break;
+    }
+    case PlanType::NestedLoopJoin: {
+      const auto &nlj_plan = dynamic_cast<const NestedLoopJoinPlanNode &>(*plan);
+      SplitJoinColumns(required, &child_required[0], &child_required[1]);
+      MarkColumns(nlj_plan.predicate_, 0, &child_required[0]);
+      MarkColumns(nlj_plan.predicate_, 1, &child_required[1]);
+      break;
+    }
+    case PlanType::HashJoin: {
+      // each key is evaluated on the tuples of its own side
+      const auto &hash_join_plan = dynamic_cast<const HashJoinPlanNode &>(*plan);
+      SplitJoinColumns(required, &child_required[0], &child_required[1]);
+      MarkColumns(hash_join_plan.left_key_expression_, std::nullopt, &child_required[0]);
+      MarkColumns(hash_join_plan.right_key_expression_, std::nullopt, &child_required[1]);
+      break;
+    }
+    case PlanType::NestedIndexJoin:
+      pass_through();
+      MarkColumns(dynamic_cast<const NestedIndexJoinPlanNode &>(*plan).KeyPredicate(), std::nullopt,
+                  &child_required[0]);
+      break;
+    default:
+      // e.g. inserts, updates and deletes, which write whole tuples
+      for (auto &columns : child_required) {
+        columns.assign(columns.size(), true);
+      }
+      break;
+  }
+
+  std::vector<AbstractPlanNodeRef> children;
+  for (size_t i = 0; i < plan->GetChildren().size(); i++) {
+    children.emplace_back(PruneScanColumns(plan->GetChildAt(i), child_required[i]));
+  }
+  return plan->CloneWithChildren(std::move(children));
+}
+
+}  // namespace bustub
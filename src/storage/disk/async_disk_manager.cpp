@@ -0,0 +1,321 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// async_disk_manager.cpp
+//
+// Identification: src/storage/disk/async_disk_manager.cpp
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/disk/async_disk_manager.h"
+
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+
+#include "common/exception.h"
+#include "common/logger.h"
+
+#if __has_include(<linux/io_uring.h>)
+#include <linux/io_uring.h>
+#define BUSTUB_HAVE_IO_URING 1
+#endif
+
+namespace bustub {
+
+AsyncDiskManager::AsyncDiskManager(const std::string &db_file, size_t queue_depth, bool use_io_uring, bool direct_io)
+    : DiskManager(db_file, direct_io), queue_depth_(std::max<size_t>(queue_depth, 1)) {
+  if (use_io_uring && SetUpRing()) {
+    reaper_ = std::thread(&AsyncDiskManager::ReaperLoop, this);
+    return;
+  }
+  for (size_t i = 0; i < queue_depth_; i++) {
+    workers_.emplace_back(&AsyncDiskManager::WorkerLoop, this);
+  }
+}
+
+AsyncDiskManager::~AsyncDiskManager() {
+  RunShutdownHooks();
+  SubmitIO();
+  if (IsUsingIoUring()) {
+    // a request without a promise wakes the reaper up and tells it to stop, once everything else has completed
+    SubmitToRing({nullptr});
+    reaper_.join();
+    TearDownRing();
+    return;
+  }
+  {
+    std::scoped_lock<std::mutex> lock(work_latch_);
+    stopping_ = true;
+  }
+  work_cv_.notify_all();
+  for (auto &worker : workers_) {
+    worker.join();
+  }
+}
+
+auto AsyncDiskManager::ReadPageAsync(page_id_t page_id, char *page_data) -> std::future<void> {
+  return Enqueue(false, page_id, page_data);
+}
+
+auto AsyncDiskManager::WritePageAsync(page_id_t page_id, const char *page_data) -> std::future<void> {
+  return Enqueue(true, page_id, const_cast<char *>(page_data));
+}
+
+auto AsyncDiskManager::Enqueue(bool is_write, page_id_t page_id, char *data) -> std::future<void> {
+  auto *request = new Request{is_write, page_id, data, {}};
+  auto done = request->done_.get_future();
+  bool full;
+  {
+    std::scoped_lock<std::mutex> lock(pending_latch_);
+    pending_.push_back(request);
+    full = pending_.size() >= queue_depth_;
+  }
+  if (full) {
+    SubmitIO();
+  }
+  return done;
+}
+
+void AsyncDiskManager::SubmitIO() {
+  std::vector<Request *> requests;
+  {
+    std::scoped_lock<std::mutex> lock(pending_latch_);
+    requests.swap(pending_);
+  }
+  if (requests.empty()) {
+    return;
+  }
+
+  if (!IsUsingIoUring()) {
+    {
+      std::scoped_lock<std::mutex> lock(work_latch_);
+      work_queue_.insert(work_queue_.end(), requests.begin(), requests.end());
+    }
+    work_cv_.notify_all();
+    return;
+  }
+
+  for (auto *request : requests) {
+    // the fallback threads go through ReadPage()/WritePage(), which copy unaligned buffers themselves
+    if (!IsIOAligned(request->data_)) {
+      request->bounce_.reset(static_cast<char *>(std::aligned_alloc(DIRECT_IO_ALIGNMENT, BUSTUB_PAGE_SIZE)));
+      if (request->is_write_) {
+        memcpy(request->bounce_.get(), request->data_, BUSTUB_PAGE_SIZE);
+      }
+    }
+    if (request->is_write_) {
+      // the fallback threads go through WritePage(), which counts the write
+      num_writes_ += 1;
+    }
+  }
+  SubmitToRing(requests);
+}
+
+void AsyncDiskManager::WorkerLoop() {
+  std::unique_lock<std::mutex> lock(work_latch_);
+  while (true) {
+    work_cv_.wait(lock, [this] { return stopping_ || !work_queue_.empty(); });
+    if (work_queue_.empty()) {
+      return;
+    }
+    Request *request = work_queue_.front();
+    work_queue_.pop_front();
+    lock.unlock();
+
+    if (request->is_write_) {
+      WritePage(request->page_id_, request->data_);
+    } else {
+      ReadPage(request->page_id_, request->data_);
+    }
+    request->done_.set_value();
+    delete request;
+    lock.lock();
+  }
+}
+
+#ifdef BUSTUB_HAVE_IO_URING
+
+static auto IoUringSetup(unsigned entries, io_uring_params *params) -> int {
+  return static_cast<int>(syscall(__NR_io_uring_setup, entries, params));
+}
+
+static auto IoUringEnter(int ring_fd, unsigned to_submit, unsigned min_complete, unsigned flags) -> int {
+  return static_cast<int>(syscall(__NR_io_uring_enter, ring_fd, to_submit, min_complete, flags, nullptr, 0));
+}
+
+auto AsyncDiskManager::SetUpRing() -> bool {
+  io_uring_params params{};
+  const int ring_fd = IoUringSetup(static_cast<unsigned>(queue_depth_), &params);
+  if (ring_fd < 0) {
+    LOG_DEBUG("io_uring is not available, serving asynchronous requests with threads");
+    return false;
+  }
+  ring_fd_ = ring_fd;
+
+  sq_ring_size_ = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+  cq_ring_size_ = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+  sqes_size_ = params.sq_entries * sizeof(io_uring_sqe);
+  sq_ring_ = mmap(nullptr, sq_ring_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_fd_,
+                  IORING_OFF_SQ_RING);
+  cq_ring_ = mmap(nullptr, cq_ring_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_fd_,
+                  IORING_OFF_CQ_RING);
+  sqes_ = mmap(nullptr, sqes_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_fd_, IORING_OFF_SQES);
+  if (sq_ring_ == MAP_FAILED || cq_ring_ == MAP_FAILED || sqes_ == MAP_FAILED) {
+    LOG_DEBUG("failed to map the io_uring queues, serving asynchronous requests with threads");
+    TearDownRing();
+    return false;
+  }
+
+  auto *sq = static_cast<char *>(sq_ring_);
+  auto *cq = static_cast<char *>(cq_ring_);
+  sq_tail_ = reinterpret_cast<unsigned *>(sq + params.sq_off.tail);
+  sq_mask_ = reinterpret_cast<unsigned *>(sq + params.sq_off.ring_mask);
+  sq_array_ = reinterpret_cast<unsigned *>(sq + params.sq_off.array);
+  cq_head_ = reinterpret_cast<unsigned *>(cq + params.cq_off.head);
+  cq_tail_ = reinterpret_cast<unsigned *>(cq + params.cq_off.tail);
+  cq_mask_ = reinterpret_cast<unsigned *>(cq + params.cq_off.ring_mask);
+  cqes_ = cq + params.cq_off.cqes;
+  return true;
+}
+
+void AsyncDiskManager::TearDownRing() {
+  if (sq_ring_ != nullptr && sq_ring_ != MAP_FAILED) {
+    munmap(sq_ring_, sq_ring_size_);
+  }
+  if (cq_ring_ != nullptr && cq_ring_ != MAP_FAILED) {
+    munmap(cq_ring_, cq_ring_size_);
+  }
+  if (sqes_ != nullptr && sqes_ != MAP_FAILED) {
+    munmap(sqes_, sqes_size_);
+  }
+  close(ring_fd_);
+  ring_fd_ = -1;
+}
+
+void AsyncDiskManager::SubmitToRing(const std::vector<Request *> &requests) {
+  std::unique_lock<std::mutex> lock(ring_latch_);
+  size_t next = 0;
+  while (next < requests.size()) {
+    ring_cv_.wait(lock, [this] { return in_flight_ < queue_depth_; });
+    // the kernel consumes every entry in io_uring_enter(), so the queue is empty and the tail is ours
+    unsigned tail = *sq_tail_;
+    unsigned count = 0;
+    for (; next < requests.size() && in_flight_ < queue_depth_; next++, count++, in_flight_++) {
+      Request *request = requests[next];
+      const unsigned index = tail & *sq_mask_;
+      auto *sqe = static_cast<io_uring_sqe *>(sqes_) + index;
+      memset(sqe, 0, sizeof(*sqe));
+      if (request == nullptr) {
+        sqe->opcode = IORING_OP_NOP;
+      } else {
+        sqe->opcode = request->is_write_ ? IORING_OP_WRITE : IORING_OP_READ;
+        sqe->fd = db_fd_;
+        sqe->addr = reinterpret_cast<uint64_t>(request->bounce_ ? request->bounce_.get() : request->data_);
+        sqe->len = BUSTUB_PAGE_SIZE;
+        sqe->off = GetPageOffset(request->page_id_);
+      }
+      sqe->user_data = reinterpret_cast<uint64_t>(request);
+      sq_array_[index] = index;
+      tail++;
+    }
+    __atomic_store_n(sq_tail_, tail, __ATOMIC_RELEASE);
+    while (count > 0) {
+      const int submitted = IoUringEnter(ring_fd_, count, 0, 0);
+      if (submitted < 0 && errno != EINTR && errno != EAGAIN && errno != EBUSY) {
+        LOG_DEBUG("io_uring_enter failed to submit");
+        // The kernel takes entries in order, so the last `count` are still in the queue; they are taken back and
+        // failed, so that nobody waits for them. The request to stop the reaper tells it to stop once it is idle.
+        tail -= count;
+        __atomic_store_n(sq_tail_, tail, __ATOMIC_RELEASE);
+        in_flight_ -= count;
+        for (size_t i = next - count; i < next; i++) {
+          if (requests[i] == nullptr) {
+            stop_reaper_ = true;
+            continue;
+          }
+          requests[i]->done_.set_exception(std::make_exception_ptr(Exception("failed to submit an I/O request")));
+          delete requests[i];
+        }
+        ring_cv_.notify_all();
+        break;
+      }
+      count -= submitted > 0 ? static_cast<unsigned>(submitted) : 0;
+    }
+  }
+}
+
+void AsyncDiskManager::ReaperLoop() {
+  bool stopping = false;
+  while (true) {
+    unsigned head = *cq_head_;
+    const unsigned tail = __atomic_load_n(cq_tail_, __ATOMIC_ACQUIRE);
+    if (head == tail) {
+      {
+        std::scoped_lock<std::mutex> lock(ring_latch_);
+        if ((stopping || stop_reaper_) && in_flight_ == 0) {
+          return;
+        }
+      }
+      IoUringEnter(ring_fd_, 0, 1, IORING_ENTER_GETEVENTS);
+      continue;
+    }
+
+    // Requests reach this thread through the kernel, which the C++ memory model knows nothing about; taking the latch
+    // that submitted them orders their construction before the accesses below.
+    { std::scoped_lock<std::mutex> lock(ring_latch_); }
+    size_t completed = 0;
+    for (; head != tail; head++, completed++) {
+      const auto &cqe = static_cast<io_uring_cqe *>(cqes_)[head & *cq_mask_];
+      auto *request = reinterpret_cast<Request *>(cqe.user_data);
+      if (request == nullptr) {
+        stopping = true;
+        continue;
+      }
+      // Reading past the end of the file, e.g. a page that was allocated but never written, yields zeroes. Any other
+      // transfer of less than a page failed, and so does the request.
+      const bool is_past_end = !request->is_write_ && cqe.res == 0;
+      if (cqe.res < BUSTUB_PAGE_SIZE && !is_past_end) {
+        LOG_DEBUG("I/O error in an asynchronous request");
+        const char *message = request->is_write_ ? "short or failed asynchronous write" : "short or failed asynchronous read";
+        request->done_.set_exception(std::make_exception_ptr(Exception(message)));
+        delete request;
+        continue;
+      }
+      if (is_past_end) {
+        memset(request->data_, 0, BUSTUB_PAGE_SIZE);
+      } else if (!request->is_write_ && request->bounce_) {
+        memcpy(request->data_, request->bounce_.get(), BUSTUB_PAGE_SIZE);
+      }
+      request->done_.set_value();
+      delete request;
+    }
+    __atomic_store_n(cq_head_, head, __ATOMIC_RELEASE);
+    {
+      std::scoped_lock<std::mutex> lock(ring_latch_);
+      in_flight_ -= completed;
+    }
+    ring_cv_.notify_all();
+  }
+}
+
+#else
+
+auto AsyncDiskManager::SetUpRing() -> bool { return false; }
+
+void AsyncDiskManager::TearDownRing() {}
+
+void AsyncDiskManager::SubmitToRing(const std::vector<Request *> &requests) {}
+
+void AsyncDiskManager::ReaperLoop() {}
+
+#endif
+
+}  // namespace bustub
@@ -10,10 +10,17 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <fcntl.h>
 #include <sys/stat.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#include <algorithm>
 #include <cassert>
+#include <cerrno>
+#include <cstdlib>
 #include <cstring>
 #include <iostream>
+#include <memory>
 #include <mutex>  // NOLINT
 #include <string>
 #include <thread>  // NOLINT
@@ -26,11 +33,26 @@ namespace bustub {
 
 static char *buffer_used;
 
+/** Name of the database file format at the start of the header page, without the terminating null. */
+static constexpr char FILE_MAGIC[] = "BusTubDB";
+static constexpr size_t FILE_MAGIC_SIZE = sizeof(FILE_MAGIC) - 1;
+
+static_assert(BUSTUB_PAGE_SIZE % DiskManager::DIRECT_IO_ALIGNMENT == 0, "O_DIRECT transfers whole aligned pages");
+
+/**
+ * Aligned buffer of one page per thread, for O_DIRECT transfers of buffers that are not aligned themselves
+ */
+static auto BounceBuffer() -> char * {
+  static thread_local std::unique_ptr<char, decltype(&free)> buffer(
+      static_cast<char *>(std::aligned_alloc(DiskManager::DIRECT_IO_ALIGNMENT, BUSTUB_PAGE_SIZE)), &free);
+  return buffer.get();
+}
+
 /**
  * Constructor: open/create a single database file & log file
  * @input db_file: database file name
  */
-DiskManager::DiskManager(const std::string &db_file) : file_name_(db_file) {
+DiskManager::DiskManager(const std::string &db_file, bool direct_io) : file_name_(db_file) {
   std::string::size_type n = file_name_.rfind('.');
   if (n == std::string::npos) {
     LOG_DEBUG("wrong file format");
@@ -49,79 +71,214 @@ DiskManager::DiskManager(const std::string &db_file) : file_name_(db_file) {
     }
   }
 
-  std::scoped_lock scoped_db_io_latch(db_io_latch_);
-  //File streams are associated with files either on construction, or by calling member open.
-
-    db_io_.open(db_file, std::ios::binary | std::ios::in | std::ios::out);
-  // directory or file does not exist
-  if (!db_io_.is_open()) {
-    db_io_.clear();
-    // create a new file
-    db_io_.open(db_file, std::ios::binary | std::ios::trunc | std::ios::out | std::ios::in);
-    if (!db_io_.is_open()) {
-      throw Exception("can't open db file");
+  std::scoped_lock scoped_allocator_latch(allocator_latch_);
+  // pages are read and written at their offsets, so there is no shared file position to protect
+  if (direct_io) {
+    db_fd_ = open(db_file.c_str(), O_RDWR | O_CREAT | O_DIRECT, 0644);
+    direct_io_ = db_fd_ >= 0;
+    if (db_fd_ < 0 && errno == EINVAL) {
+      LOG_WARN("the file system does not support O_DIRECT, going through the page cache");
     }
   }
+  if (db_fd_ < 0) {
+    db_fd_ = open(db_file.c_str(), O_RDWR | O_CREAT, 0644);
+  }
+  if (db_fd_ < 0) {
+    throw Exception("can't open db file");
+  }
+  char header[BUSTUB_PAGE_SIZE];
+  if (GetFileSize(file_name_) == 0) {
+    MakeFileHeader(header);
+    if (WriteFilePage(header, 0) != BUSTUB_PAGE_SIZE) {
+      LOG_DEBUG("I/O error while writing the header");
+    }
+  } else if (ReadFilePage(header, 0) != BUSTUB_PAGE_SIZE || !IsFileHeaderValid(header)) {
+    close(db_fd_);
+    db_fd_ = -1;
+    throw Exception("db file has an unsupported format");
+  }
+  LoadSpaceMaps();
   buffer_used = nullptr;
 }
 
+DiskManager::~DiskManager() {
+  RunShutdownHooks();
+  std::scoped_lock scoped_allocator_latch(allocator_latch_);
+  if (db_fd_ >= 0) {
+    FlushSpaceMaps();
+    close(db_fd_);
+  }
+}
+
 /**
  * Close all file streams
  */
 void DiskManager::ShutDown() {
+  RunShutdownHooks();
   {
-    std::scoped_lock scoped_db_io_latch(db_io_latch_);
-    db_io_.close();
+    std::scoped_lock scoped_allocator_latch(allocator_latch_);
+    if (db_fd_ >= 0) {
+      FlushSpaceMaps();
+      fdatasync(db_fd_);
+      close(db_fd_);
+      db_fd_ = -1;
+    }
   }
   log_io_.close();
 }
 
+auto DiskManager::AddShutdownHook(std::function<void()> hook) -> size_t {
+  std::scoped_lock scoped_hooks_latch(hooks_latch_);
+  shutdown_hooks_.emplace_back(next_hook_id_, std::move(hook));
+  return next_hook_id_++;
+}
+
+void DiskManager::RemoveShutdownHook(size_t hook_id) {
+  std::scoped_lock scoped_hooks_latch(hooks_latch_);
+  auto it = std::find_if(shutdown_hooks_.begin(), shutdown_hooks_.end(),
+                         [hook_id](const auto &hook) { return hook.first == hook_id; });
+  if (it != shutdown_hooks_.end()) {
+    shutdown_hooks_.erase(it);
+  }
+}
+
+void DiskManager::RunShutdownHooks() {
+  std::vector<std::pair<size_t, std::function<void()>>> hooks;
+  {
+    std::scoped_lock scoped_hooks_latch(hooks_latch_);
+    hooks.swap(shutdown_hooks_);
+  }
+  for (auto &[hook_id, hook] : hooks) {
+    hook();
+  }
+}
+
 /**
  * Write the contents of the specified page into disk file
  */
 void DiskManager::WritePage(page_id_t page_id, const char *page_data) {
-  std::scoped_lock scoped_db_io_latch(db_io_latch_);
-  size_t offset = static_cast<size_t>(page_id) * BUSTUB_PAGE_SIZE;
-  // set write cursor to offset
   num_writes_ += 1;
-  db_io_.seekp(offset);
-  db_io_.write(page_data, BUSTUB_PAGE_SIZE);
-  // check for I/O error
-  if (db_io_.bad()) {
+  if (WriteFilePage(page_data, GetPageOffset(page_id)) != BUSTUB_PAGE_SIZE) {
     LOG_DEBUG("I/O error while writing");
+  }
+}
+
+/**
+ * Write pages sorted by page id, coalescing pages that are adjacent in the file into one pwritev()
+ */
+void DiskManager::WritePages(std::vector<std::pair<page_id_t, const char *>> pages) {
+  if (pages.empty()) {
     return;
   }
-  // needs to flush to keep disk file in sync
-  db_io_.flush();
+  num_writes_ += static_cast<int>(pages.size());
+  std::sort(pages.begin(), pages.end());
+
+  std::vector<const char *> run;
+  size_t run_offset = 0;
+  for (const auto &[page_id, page_data] : pages) {
+    const size_t offset = GetPageOffset(page_id);
+    // a space map between two pages, or a page in between that is written on its own, ends the run
+    if (!run.empty() &&
+        (offset != run_offset + run.size() * BUSTUB_PAGE_SIZE || run.size() == MAX_PAGES_PER_WRITE)) {
+      WriteFileRun(run, run_offset);
+      run.clear();
+    }
+    if (!IsIOAligned(page_data)) {
+      if (WriteFilePage(page_data, offset) != BUSTUB_PAGE_SIZE) {
+        LOG_DEBUG("I/O error while writing");
+      }
+      continue;
+    }
+    if (run.empty()) {
+      run_offset = offset;
+    }
+    run.push_back(page_data);
+  }
+  if (!run.empty()) {
+    WriteFileRun(run, run_offset);
+  }
 }
 
 /**
  * Read the contents of the specified page into the given memory area
  */
 void DiskManager::ReadPage(page_id_t page_id, char *page_data) {
-  std::scoped_lock scoped_db_io_latch(db_io_latch_);
-  int offset = page_id * BUSTUB_PAGE_SIZE;
-  // check if read beyond file length
-  if (offset > GetFileSize(file_name_)) {
-    LOG_DEBUG("I/O error reading past end of file");
-    // std::cerr << "I/O error while reading" << std::endl;
-  } else {
-    // set read cursor to offset
-    db_io_.seekp(offset);
-    db_io_.read(page_data, BUSTUB_PAGE_SIZE);
-    if (db_io_.bad()) {
-      LOG_DEBUG("I/O error while reading");
+  const ssize_t read_count = ReadFilePage(page_data, GetPageOffset(page_id));
+  if (read_count < 0) {
+    LOG_DEBUG("I/O error while reading");
+    return;
+  }
+  // if file ends before reading BUSTUB_PAGE_SIZE, e.g. for a page that was allocated but never written
+  if (read_count < BUSTUB_PAGE_SIZE) {
+    memset(page_data + read_count, 0, BUSTUB_PAGE_SIZE - read_count);
+  }
+}
+
+/**
+ * Read a page synchronously, the future is ready right away
+ */
+auto DiskManager::ReadPageAsync(page_id_t page_id, char *page_data) -> std::future<void> {
+  std::promise<void> done;
+  ReadPage(page_id, page_data);
+  done.set_value();
+  return done.get_future();
+}
+
+/**
+ * Write a page synchronously, the future is ready right away
+ */
+auto DiskManager::WritePageAsync(page_id_t page_id, const char *page_data) -> std::future<void> {
+  std::promise<void> done;
+  WritePage(page_id, page_data);
+  done.set_value();
+  return done.get_future();
+}
+
+/**
+ * Make every page write so far durable, along with the space maps, which are written here and not with every page
+ */
+void DiskManager::Sync() {
+  {
+    std::scoped_lock scoped_allocator_latch(allocator_latch_);
+    if (db_fd_ < 0) {
       return;
     }
-    // if file ends before reading BUSTUB_PAGE_SIZE
-    int read_count = db_io_.gcount();
-    if (read_count < BUSTUB_PAGE_SIZE) {
-      LOG_DEBUG("Read less than a page");
-      db_io_.clear();
-      // std::cerr << "Read less than a page" << std::endl;
-      memset(page_data + read_count, 0, BUSTUB_PAGE_SIZE - read_count);
-    }
+    FlushSpaceMaps();
+  }
+  fdatasync(db_fd_);
+}
+
+/**
+ * Allocate the lowest free page id of a buffer pool instance
+ */
+auto DiskManager::AllocatePage(uint32_t instance_index, uint32_t num_instances) -> page_id_t {
+  std::scoped_lock scoped_allocator_latch(allocator_latch_);
+  return allocator_.Allocate(instance_index, num_instances);
+}
+
+/**
+ * Allocate a page id of a buffer pool instance in the extent of an object
+ */
+auto DiskManager::AllocatePageNear(page_id_t near_page_id, uint32_t instance_index, uint32_t num_instances)
+    -> page_id_t {
+  if (!extent_allocation) {
+    return AllocatePage(instance_index, num_instances);
   }
+  std::scoped_lock scoped_allocator_latch(allocator_latch_);
+  return allocator_.AllocateNear(near_page_id, instance_index, num_instances);
+}
+
+/**
+ * Return a page id to the free space
+ */
+void DiskManager::DeallocatePage(page_id_t page_id) {
+  std::scoped_lock scoped_allocator_latch(allocator_latch_);
+  allocator_.Free(page_id);
+}
+
+auto DiskManager::IsAllocated(page_id_t page_id) -> bool {
+  std::scoped_lock scoped_allocator_latch(allocator_latch_);
+  return allocator_.IsAllocated(page_id);
 }
 
 /**
@@ -201,13 +358,116 @@ auto DiskManager::GetNumWrites() const -> int { return num_writes_; }
  */
 auto DiskManager::GetFlushState() const -> bool { return flush_log_; }
 
+auto DiskManager::GetPageOffset(page_id_t page_id) -> size_t {
+  const auto page = static_cast<size_t>(page_id);
+  return (page + page / PageAllocator::PAGES_PER_MAP + 2) * BUSTUB_PAGE_SIZE;
+}
+
+auto DiskManager::GetSpaceMapOffset(size_t map_index) -> size_t {
+  return (map_index * (PageAllocator::PAGES_PER_MAP + 1) + 1) * BUSTUB_PAGE_SIZE;
+}
+
+void DiskManager::MakeFileHeader(char *header) {
+  memset(header, 0, BUSTUB_PAGE_SIZE);
+  memcpy(header, FILE_MAGIC, FILE_MAGIC_SIZE);
+  const uint32_t version = FILE_FORMAT_VERSION;
+  const uint32_t page_size = BUSTUB_PAGE_SIZE;
+  memcpy(header + FILE_MAGIC_SIZE, &version, sizeof(uint32_t));
+  memcpy(header + FILE_MAGIC_SIZE + sizeof(uint32_t), &page_size, sizeof(uint32_t));
+}
+
+auto DiskManager::IsFileHeaderValid(const char *header) -> bool {
+  char expected[BUSTUB_PAGE_SIZE];
+  MakeFileHeader(expected);
+  return memcmp(header, expected, FILE_MAGIC_SIZE + 2 * sizeof(uint32_t)) == 0;
+}
+
+void DiskManager::LoadSpaceMaps() {
+  const int64_t file_size = GetFileSize(file_name_);
+  char map_data[BUSTUB_PAGE_SIZE];
+  for (size_t map_index = 0; file_size > 0 && GetSpaceMapOffset(map_index) < static_cast<size_t>(file_size);
+       map_index++) {
+    const ssize_t read_count = ReadFilePage(map_data, GetSpaceMapOffset(map_index));
+    if (read_count < BUSTUB_PAGE_SIZE) {
+      memset(map_data + std::max<ssize_t>(read_count, 0), 0, BUSTUB_PAGE_SIZE - std::max<ssize_t>(read_count, 0));
+    }
+    allocator_.LoadMap(map_index, map_data);
+  }
+}
+
+void DiskManager::FlushSpaceMaps() {
+  char map_data[BUSTUB_PAGE_SIZE];
+  for (size_t map_index = 0; map_index < allocator_.GetNumMaps(); map_index++) {
+    if (!allocator_.IsMapDirty(map_index)) {
+      continue;
+    }
+    allocator_.StoreMap(map_index, map_data);
+    if (WriteFilePage(map_data, GetSpaceMapOffset(map_index)) != BUSTUB_PAGE_SIZE) {
+      LOG_DEBUG("I/O error while writing a space map");
+    }
+  }
+}
+
+auto DiskManager::ReadFilePage(char *data, size_t offset) -> ssize_t {
+  if (IsIOAligned(data)) {
+    return pread(db_fd_, data, BUSTUB_PAGE_SIZE, static_cast<off_t>(offset));
+  }
+  char *bounce = BounceBuffer();
+  const ssize_t read_count = pread(db_fd_, bounce, BUSTUB_PAGE_SIZE, static_cast<off_t>(offset));
+  if (read_count > 0) {
+    memcpy(data, bounce, read_count);
+  }
+  return read_count;
+}
+
+auto DiskManager::WriteFilePage(const char *data, size_t offset) -> ssize_t {
+  if (IsIOAligned(data)) {
+    return pwrite(db_fd_, data, BUSTUB_PAGE_SIZE, static_cast<off_t>(offset));
+  }
+  char *bounce = BounceBuffer();
+  memcpy(bounce, data, BUSTUB_PAGE_SIZE);
+  return pwrite(db_fd_, bounce, BUSTUB_PAGE_SIZE, static_cast<off_t>(offset));
+}
+
+void DiskManager::WriteFileRun(const std::vector<const char *> &run, size_t offset) {
+  std::vector<iovec> iovecs(run.size());
+  for (size_t i = 0; i < run.size(); i++) {
+    iovecs[i].iov_base = const_cast<char *>(run[i]);
+    iovecs[i].iov_len = BUSTUB_PAGE_SIZE;
+  }
+  size_t written = 0;
+  const size_t run_size = run.size() * BUSTUB_PAGE_SIZE;
+  while (written < run_size) {
+    const size_t first = written / BUSTUB_PAGE_SIZE;
+    if (written % BUSTUB_PAGE_SIZE != 0) {
+      // a short write stopped in the middle of a page; write that page on its own, then go on with the rest
+      if (WriteFilePage(run[first], offset + first * BUSTUB_PAGE_SIZE) != BUSTUB_PAGE_SIZE) {
+        LOG_DEBUG("I/O error while writing");
+        return;
+      }
+      written = (first + 1) * BUSTUB_PAGE_SIZE;
+      continue;
+    }
+    const ssize_t write_count = pwritev(db_fd_, &iovecs[first], static_cast<int>(iovecs.size() - first),
+                                        static_cast<off_t>(offset + written));
+    if (write_count <= 0) {
+      if (write_count < 0 && errno == EINTR) {
+        continue;
+      }
+      LOG_DEBUG("I/O error while writing");
+      return;
+    }
+    written += write_count;
+  }
+}
+
 /**
  * Private helper function to get disk file size
  */
-auto DiskManager::GetFileSize(const std::string &file_name) -> int {
+auto DiskManager::GetFileSize(const std::string &file_name) -> int64_t {
   struct stat stat_buf;
   int rc = stat(file_name.c_str(), &stat_buf);
-  return rc == 0 ? static_cast<int>(stat_buf.st_size) : -1;
+  return rc == 0 ? static_cast<int64_t>(stat_buf.st_size) : -1;
 }
 
 }  // namespace bustub
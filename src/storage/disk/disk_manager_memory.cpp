@@ -39,6 +39,15 @@ void DiskManagerMemory::WritePage(page_id_t page_id, const char *page_data) {
   memcpy(memory_ + offset, page_data, BUSTUB_PAGE_SIZE);
 }
 
+/**
+ * Write many pages, there is nothing to gain from coalescing copies in memory
+ */
+void DiskManagerMemory::WritePages(std::vector<std::pair<page_id_t, const char *>> pages) {
+  for (const auto &[page_id, page_data] : pages) {
+    WritePage(page_id, page_data);
+  }
+}
+
 /**
  * Read the contents of the specified page into the given memory area
  */
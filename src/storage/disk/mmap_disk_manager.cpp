@@ -0,0 +1,118 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// mmap_disk_manager.cpp
+//
+// Identification: src/storage/disk/mmap_disk_manager.cpp
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/disk/mmap_disk_manager.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstring>
+
+#include "common/exception.h"
+#include "common/logger.h"
+
+namespace bustub {
+
+MmapDiskManager::MmapDiskManager(const std::string &db_file) {
+  file_name_ = db_file;
+  std::scoped_lock scoped_allocator_latch(allocator_latch_);
+  db_fd_ = open(db_file.c_str(), O_RDONLY);
+  if (db_fd_ < 0) {
+    throw Exception("can't open db file");
+  }
+  const int64_t file_size = GetFileSize(file_name_);
+  if (file_size > 0) {
+    char header[BUSTUB_PAGE_SIZE];
+    if (pread(db_fd_, header, BUSTUB_PAGE_SIZE, 0) != BUSTUB_PAGE_SIZE || !IsFileHeaderValid(header)) {
+      close(db_fd_);
+      db_fd_ = -1;
+      throw Exception("db file has an unsupported format");
+    }
+    mapping_size_ = static_cast<size_t>(file_size);
+    void *mapping = mmap(nullptr, mapping_size_, PROT_READ, MAP_SHARED, db_fd_, 0);
+    if (mapping == MAP_FAILED) {
+      close(db_fd_);
+      db_fd_ = -1;
+      throw Exception("can't map db file");
+    }
+    mapping_ = static_cast<char *>(mapping);
+  }
+  LoadSpaceMaps();
+}
+
+MmapDiskManager::~MmapDiskManager() {
+  RunShutdownHooks();
+  if (mapping_ != nullptr) {
+    munmap(mapping_, mapping_size_);
+  }
+}
+
+void MmapDiskManager::ReadPage(page_id_t page_id, char *page_data) {
+  const size_t offset = GetPageOffset(page_id);
+  // pages past the end of the file were never written, like in DiskManager::ReadPage()
+  const size_t available = offset < mapping_size_ ? std::min<size_t>(mapping_size_ - offset, BUSTUB_PAGE_SIZE) : 0;
+  if (available > 0) {
+    memcpy(page_data, mapping_ + offset, available);
+  }
+  if (available < BUSTUB_PAGE_SIZE) {
+    memset(page_data + available, 0, BUSTUB_PAGE_SIZE - available);
+  }
+}
+
+void MmapDiskManager::WritePage(page_id_t page_id, const char *page_data) {
+  throw Exception(ExceptionType::READ_ONLY, "can't write a page of a read-only database file");
+}
+
+void MmapDiskManager::WritePages(std::vector<std::pair<page_id_t, const char *>> pages) {
+  throw Exception(ExceptionType::READ_ONLY, "can't write pages of a read-only database file");
+}
+
+auto MmapDiskManager::AllocatePage(uint32_t instance_index, uint32_t num_instances) -> page_id_t {
+  throw Exception(ExceptionType::READ_ONLY, "can't allocate a page in a read-only database file");
+}
+
+auto MmapDiskManager::AllocatePageNear(page_id_t near_page_id, uint32_t instance_index, uint32_t num_instances)
+    -> page_id_t {
+  throw Exception(ExceptionType::READ_ONLY, "can't allocate a page in a read-only database file");
+}
+
+void MmapDiskManager::DeallocatePage(page_id_t page_id) {
+  throw Exception(ExceptionType::READ_ONLY, "can't free a page of a read-only database file");
+}
+
+void MmapDiskManager::BeginSequentialScan() {
+  std::scoped_lock scoped_advice_latch(advice_latch_);
+  if (sequential_scans_++ == 0 && mapping_ != nullptr) {
+    // read ahead aggressively and start reading the file right away; pages behind a scan may be dropped early
+    madvise(mapping_, mapping_size_, MADV_SEQUENTIAL);
+    madvise(mapping_, mapping_size_, MADV_WILLNEED);
+  }
+}
+
+void MmapDiskManager::EndSequentialScan() {
+  std::scoped_lock scoped_advice_latch(advice_latch_);
+  if (sequential_scans_ == 0) {
+    return;
+  }
+  if (--sequential_scans_ == 0 && mapping_ != nullptr) {
+    madvise(mapping_, mapping_size_, MADV_NORMAL);
+  }
+}
+
+auto MmapDiskManager::GetSequentialScanCount() -> size_t {
+  std::scoped_lock scoped_advice_latch(advice_latch_);
+  return sequential_scans_;
+}
+
+}  // namespace bustub
@@ -0,0 +1,149 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// page_allocator.cpp
+//
+// Identification: src/storage/disk/page_allocator.cpp
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/disk/page_allocator.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace bustub {
+
+/** @return the bits of a word whose page ids belong to the given instance */
+static auto InstanceMask(size_t word, uint32_t instance_index, uint32_t num_instances) -> uint64_t {
+  if (num_instances == 1) {
+    return ~static_cast<uint64_t>(0);
+  }
+  const size_t first_id = word * 64;
+  uint64_t mask = 0;
+  for (size_t bit = (instance_index + num_instances - first_id % num_instances) % num_instances; bit < 64;
+       bit += num_instances) {
+    mask |= static_cast<uint64_t>(1) << bit;
+  }
+  return mask;
+}
+
+auto PageAllocator::Allocate(uint32_t instance_index, uint32_t num_instances) -> page_id_t {
+  if (num_instances != num_instances_) {
+    // the hints only hold for the striping they were made for
+    num_instances_ = num_instances;
+    first_free_words_.assign(num_instances, 0);
+  }
+  size_t &first_free_word = first_free_words_[instance_index];
+  for (size_t word = first_free_word;; word++) {
+    if (word == words_.size()) {
+      EnsureMap(GetNumMaps());
+    }
+    const uint64_t free_bits = ~words_[word] & InstanceMask(word, instance_index, num_instances);
+    // the free pages of a reserved extent are kept for the object it is reserved for
+    if (free_bits == 0 || reserved_[word]) {
+      continue;
+    }
+    first_free_word = word;
+    return TakeBit(word, static_cast<size_t>(__builtin_ctzll(free_bits)));
+  }
+}
+
+auto PageAllocator::AllocateNear(page_id_t near_page_id, uint32_t instance_index, uint32_t num_instances)
+    -> page_id_t {
+  if (near_page_id >= 0 && static_cast<size_t>(near_page_id) / BITS_PER_WORD < words_.size()) {
+    const size_t word = static_cast<size_t>(near_page_id) / BITS_PER_WORD;
+    const size_t near_bit = static_cast<size_t>(near_page_id) % BITS_PER_WORD;
+    const uint64_t free_bits = ~words_[word] & InstanceMask(word, instance_index, num_instances);
+    if (free_bits != 0) {
+      // pages after the near page keep a scan that follows the object going forward
+      const uint64_t after =
+          near_bit == BITS_PER_WORD - 1 ? 0 : free_bits & (~static_cast<uint64_t>(0) << (near_bit + 1));
+      return TakeBit(word, static_cast<size_t>(__builtin_ctzll(after != 0 ? after : free_bits)));
+    }
+  }
+
+  for (size_t word = first_empty_word_;; word++) {
+    if (word == words_.size()) {
+      EnsureMap(GetNumMaps());
+    }
+    if (words_[word] != 0 || reserved_[word]) {
+      if (word == first_empty_word_) {
+        first_empty_word_++;
+      }
+      continue;
+    }
+    // with more than 64 instances, an extent can have no page of this instance at all
+    const uint64_t instance_bits = InstanceMask(word, instance_index, num_instances);
+    if (instance_bits == 0) {
+      continue;
+    }
+    reserved_[word] = true;
+    if (word == first_empty_word_) {
+      first_empty_word_ = word + 1;
+    }
+    return TakeBit(word, static_cast<size_t>(__builtin_ctzll(instance_bits)));
+  }
+}
+
+auto PageAllocator::TakeBit(size_t word, size_t bit) -> page_id_t {
+  words_[word] |= static_cast<uint64_t>(1) << bit;
+  dirty_maps_[word / WORDS_PER_MAP] = true;
+  return static_cast<page_id_t>(word * BITS_PER_WORD + bit);
+}
+
+void PageAllocator::Free(page_id_t page_id) {
+  if (!IsAllocated(page_id)) {
+    return;
+  }
+  const size_t word = static_cast<size_t>(page_id) / BITS_PER_WORD;
+  words_[word] &= ~(static_cast<uint64_t>(1) << (static_cast<size_t>(page_id) % BITS_PER_WORD));
+  dirty_maps_[word / WORDS_PER_MAP] = true;
+  if (!first_free_words_.empty()) {
+    size_t &first_free_word = first_free_words_[static_cast<size_t>(page_id) % num_instances_];
+    first_free_word = std::min(first_free_word, word);
+  }
+  // an extent whose object freed all of its pages is open to everyone again
+  if (words_[word] == 0) {
+    reserved_[word] = false;
+    first_empty_word_ = std::min(first_empty_word_, word);
+    for (auto &first_free_word : first_free_words_) {
+      first_free_word = std::min(first_free_word, word);
+    }
+  }
+}
+
+auto PageAllocator::IsAllocated(page_id_t page_id) const -> bool {
+  if (page_id < 0 || static_cast<size_t>(page_id) / BITS_PER_WORD >= words_.size()) {
+    return false;
+  }
+  const size_t word = static_cast<size_t>(page_id) / BITS_PER_WORD;
+  return (words_[word] >> (static_cast<size_t>(page_id) % BITS_PER_WORD) & 1) != 0;
+}
+
+void PageAllocator::LoadMap(size_t map_index, const char *data) {
+  EnsureMap(map_index);
+  static_assert(WORDS_PER_MAP * sizeof(uint64_t) == BUSTUB_PAGE_SIZE);
+  memcpy(&words_[map_index * WORDS_PER_MAP], data, BUSTUB_PAGE_SIZE);
+  dirty_maps_[map_index] = false;
+  std::fill(first_free_words_.begin(), first_free_words_.end(), 0);
+  first_empty_word_ = 0;
+}
+
+void PageAllocator::StoreMap(size_t map_index, char *data) {
+  memcpy(data, &words_[map_index * WORDS_PER_MAP], BUSTUB_PAGE_SIZE);
+  dirty_maps_[map_index] = false;
+}
+
+void PageAllocator::EnsureMap(size_t map_index) {
+  if (map_index >= GetNumMaps()) {
+    words_.resize((map_index + 1) * WORDS_PER_MAP, 0);
+    reserved_.resize(words_.size(), false);
+    dirty_maps_.resize(map_index + 1, true);
+  }
+}
+
+}  // namespace bustub
@@ -76,7 +76,8 @@ namespace bustub {
     auto BPLUSTREE_TYPE::BuildRootNode(int maxSize) -> T * {
 
       page_id_t currentPageId;
-      Page * rawPage = buffer_pool_manager_ -> NewPage( & currentPageId);
+      // a new root goes next to the old one, the root of an empty tree starts a new extent
+      Page * rawPage = buffer_pool_manager_ -> NewPage( & currentPageId, root_page_id_);
       //assert(rawPage != nullptr);
  
       T * rootPage = reinterpret_cast < T * > (rawPage -> GetData());
@@ -134,8 +135,8 @@ namespace bustub {
       }
       
       std::pair < KeyType, page_id_t > m = std::make_pair(returnedLeaf -> KeyAt(0), returnedLeaf -> GetPageId());
-        buffer_pool_manager_ -> UnpinPage(returnedLeaf -> GetPageId(), true);
-      InsertIntoParent(parentPage, m.first, returnedLeaf->GetPageId(), ourLeaf -> GetPageId(), transaction);
+        buffer_pool_manager_ -> UnpinPage(m.second, true);
+      InsertIntoParent(parentPage, m.first, m.second, ourLeaf -> GetPageId(), transaction);
       ClearLatches(INSERT_TRAVERSE, transaction, true);
        buffer_pool_manager_ -> UnpinPage(parentId, true);
       // buffer_pool_manager_ -> UnpinPage(ourLeaf -> GetPageId(), true);
@@ -341,8 +342,8 @@ namespace bustub {
       // currentPage -> SetParentPageId(brotherPage -> GetPageId());
       // currentPage->SetParentPageId(returnedPair.second);
 
-      buffer_pool_manager_ -> UnpinPage(brotherPage -> GetPageId(), true);
-      InsertIntoParent(parentPage, returnedPair.first, brotherPage->GetPageId(), currentInternal -> GetPageId(), transaction);
+      buffer_pool_manager_ -> UnpinPage(returnedPair.second, true);
+      InsertIntoParent(parentPage, returnedPair.first, returnedPair.second, currentInternal -> GetPageId(), transaction);
       //   parentPage->Insert(currentInternal->GetPageId(), returnedPair.first, brotherPage->GetPageId(), comparator_);
  
       buffer_pool_manager_ -> UnpinPage(parentPageId, true);
@@ -480,7 +481,7 @@ namespace bustub {
          
         }
   
-      buffer_pool_manager_ -> UnpinPage(currentPage -> GetParentPageId(), true);
+      buffer_pool_manager_ -> UnpinPage(parentPage -> GetPageId(), true);
       }
       if (leftBrotherId != INVALID_PAGE_ID)  buffer_pool_manager_ ->UnpinPage(leftBrotherId, true);
       if (rightBrotherId != INVALID_PAGE_ID) buffer_pool_manager_ ->UnpinPage(rightBrotherId, true);
@@ -501,7 +502,7 @@ namespace bustub {
       if (currentPage -> GetSize() == 0) {
         page_id_t newRootId = reinterpret_cast < InternalPage * > (currentPage) -> ValueAt(0);
         Page * newRootPage = buffer_pool_manager_ -> FetchPage(newRootId);
-        reinterpret_cast < BPlusTreePage * > (newRootPage) -> SetParentPageId(INVALID_PAGE_ID);
+        reinterpret_cast < BPlusTreePage * > (newRootPage -> GetData()) -> SetParentPageId(INVALID_PAGE_ID);
         root_page_id_ = newRootId;
         UpdateRootPageId(0);
         buffer_pool_manager_ -> UnpinPage(newRootId, true);
@@ -543,7 +544,7 @@ namespace bustub {
           currentInternalPage -> SetKeyAt(1, parentPage -> GetKeyOfValue(currentPageId));
           parentPage -> ChangeKeyOfValue(currentPageId, movedPairs.first);
           Page * movedPage = buffer_pool_manager_ -> FetchPage(movedPairs.second);
-          BPlusTreePage * BmovedPage = reinterpret_cast < BPlusTreePage * > (movedPage);
+          BPlusTreePage * BmovedPage = reinterpret_cast < BPlusTreePage * > (movedPage -> GetData());
           BmovedPage -> SetParentPageId(currentInternalPage -> GetPageId());
           sucess = true;
           buffer_pool_manager_ -> UnpinPage(movedPairs.second, true);
@@ -567,7 +568,7 @@ namespace bustub {
           currentInternalPage -> SetKeyAt(currentInternalPage -> GetArraySize() - 1, parentPage -> GetKeyOfValue(rightBrotherId));
           parentPage -> ChangeKeyOfValue(rightBrotherId, movedPairs.first);
           Page * movedPage = buffer_pool_manager_ -> FetchPage(movedPairs.second);
-          BPlusTreePage * BmovedPage = reinterpret_cast < BPlusTreePage * > (movedPage);
+          BPlusTreePage * BmovedPage = reinterpret_cast < BPlusTreePage * > (movedPage -> GetData());
           BmovedPage -> SetParentPageId(currentInternalPage -> GetPageId());
           sucess = true;
           buffer_pool_manager_ -> UnpinPage(movedPairs.second, true);
@@ -586,7 +587,7 @@ namespace bustub {
           page_id_t firstPageId = currentInternalPage -> ValueAt(0);
           leftBrotherPage -> InsertAndShift(topKey, firstPageId, comparator_);
           Page * child = buffer_pool_manager_ -> FetchPage(firstPageId);
-          BPlusTreePage * page = reinterpret_cast < BPlusTreePage * > (child);
+          BPlusTreePage * page = reinterpret_cast < BPlusTreePage * > (child -> GetData());
           page -> SetParentPageId(leftBrotherPage -> GetPageId());
            
           MergeInternalPage(currentInternalPage, leftBrotherPage);
@@ -604,7 +605,7 @@ namespace bustub {
           page_id_t firstPageId = rightBrotherPage -> ValueAt(0);
           currentInternalPage -> InsertAndShift(topKey, firstPageId, comparator_);
           Page * child = buffer_pool_manager_ -> FetchPage(firstPageId);
-          BPlusTreePage * page = reinterpret_cast < BPlusTreePage * > (child);
+          BPlusTreePage * page = reinterpret_cast < BPlusTreePage * > (child -> GetData());
           page -> SetParentPageId(currentInternalPage -> GetPageId());
          
           MergeInternalPage(rightBrotherPage, currentInternalPage);
@@ -620,7 +621,7 @@ namespace bustub {
       }
           if (leftBrotherId != INVALID_PAGE_ID)  buffer_pool_manager_ ->UnpinPage(leftBrotherId, true);
       if (rightBrotherId != INVALID_PAGE_ID) buffer_pool_manager_ ->UnpinPage(rightBrotherId, true);
-      buffer_pool_manager_ -> UnpinPage(currentPage -> GetParentPageId(), true);
+      buffer_pool_manager_ -> UnpinPage(parentPage -> GetPageId(), true);
     }
   }
   INDEX_TEMPLATE_ARGUMENTS
@@ -650,7 +651,7 @@ namespace bustub {
       std::pair < KeyType, page_id_t > pair = src -> pop();
       destination -> InsertAndShift(pair.first, pair.second, comparator_);
       Page * child = buffer_pool_manager_ -> FetchPage(pair.second);
-      BPlusTreePage * page = reinterpret_cast < BPlusTreePage * > (child);
+      BPlusTreePage * page = reinterpret_cast < BPlusTreePage * > (child -> GetData());
       page -> SetParentPageId(destination -> GetPageId());
       buffer_pool_manager_ -> UnpinPage(child -> GetPageId(), true);
     }
@@ -674,8 +675,9 @@ namespace bustub {
     }
     rootLatch.RUnlock();
     LeafPage * leftMostLeaf = FindLeftMostLeaf(root_page_id_);
-    buffer_pool_manager_ -> UnpinPage(leftMostLeaf -> GetPageId(), false);
-    return INDEXITERATOR_TYPE(leftMostLeaf -> GetPageId(), buffer_pool_manager_, 0);
+    page_id_t leafPageId = leftMostLeaf -> GetPageId();
+    buffer_pool_manager_ -> UnpinPage(leafPageId, false);
+    return INDEXITERATOR_TYPE(leafPageId, buffer_pool_manager_, 0);
   }
 
   /*
@@ -693,8 +695,9 @@ namespace bustub {
         rootLatch.RUnlock();
     LeafPage * currentLeaf = FindLeaf(key, root_page_id_, LOOKUP_TRAVERSE);
     int index = currentLeaf -> KeyIndex(key, comparator_);
-     buffer_pool_manager_ -> UnpinPage(currentLeaf -> GetPageId(), false);
-    return INDEXITERATOR_TYPE(currentLeaf -> GetPageId(), buffer_pool_manager_, index);
+    page_id_t leafPageId = currentLeaf -> GetPageId();
+     buffer_pool_manager_ -> UnpinPage(leafPageId, false);
+    return INDEXITERATOR_TYPE(leafPageId, buffer_pool_manager_, index);
   }
 
   /*
@@ -962,7 +965,7 @@ namespace bustub {
   template < typename T >
     auto BPLUSTREE_TYPE::MakeTwin(T * oldNode) -> T * {
       page_id_t newPageId;
-      Page * rawNewPage = buffer_pool_manager_ -> NewPage( & newPageId);
+      Page * rawNewPage = buffer_pool_manager_ -> NewPage( & newPageId, oldNode -> GetPageId());
      //assert(rawNewPage != nullptr);
       if (rawNewPage == nullptr) throw Exception(ExceptionType::OUT_OF_MEMORY, "fail to fetch page9");;
       T * newPage = reinterpret_cast < T * > (rawNewPage -> GetData());
@@ -973,7 +976,7 @@ namespace bustub {
   INDEX_TEMPLATE_ARGUMENTS
   void BPLUSTREE_TYPE::HandleLatches(Page * page, TRAVERSE_TYPE type, Transaction * transaction, bool isChanged) {
     if (transaction == nullptr) return;
-    BPlusTreePage * BPage = reinterpret_cast < BPlusTreePage * > (page);
+    BPlusTreePage * BPage = reinterpret_cast < BPlusTreePage * > (page -> GetData());
     if (type == INSERT_TRAVERSE) {
       page -> WLatch();
            if ((BPage->GetSize() < BPage->GetMaxSize() - 1 || (!BPage->IsLeafPage() && BPage->GetSize() == BPage->GetMaxSize() - 1)) && !BPage->IsRootPage()) {
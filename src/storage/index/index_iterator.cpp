@@ -16,8 +16,16 @@ INDEXITERATOR_TYPE::IndexIterator(int pageId, BufferPoolManager *buffer_pool_man
         currentPageId = pageId;
         buffer_pool_manager_ = buffer_pool_manager;
         currentIndex = index;
+        if (!IsEnd() && read_ahead_depth > 0) {
+          buffer_pool_manager_->PrefetchChain(currentPageId, read_ahead_depth, &NextLeafPageId, nullptr);
+        }
 };
 
+INDEX_TEMPLATE_ARGUMENTS
+auto INDEXITERATOR_TYPE::NextLeafPageId(Page *page) -> page_id_t {
+  return reinterpret_cast<B_PLUS_TREE_LEAF_PAGE_TYPE *>(page->GetData())->GetNextPageId();
+}
+
 INDEX_TEMPLATE_ARGUMENTS
 INDEXITERATOR_TYPE::~IndexIterator() {
    if (!IsEnd()) buffer_pool_manager_->UnpinPage(currentPageId,false);
@@ -33,10 +41,10 @@ auto INDEXITERATOR_TYPE::operator*() -> const MappingType & {
    
    Page* currentPage = buffer_pool_manager_->FetchPage(currentPageId);
    B_PLUS_TREE_LEAF_PAGE_TYPE * currentLeaf =  reinterpret_cast<B_PLUS_TREE_LEAF_PAGE_TYPE *>(currentPage->GetData());
-   MappingType &myPair = currentLeaf->ItemAt(currentIndex);
+   currentItem = currentLeaf->ItemAt(currentIndex);
  
    buffer_pool_manager_->UnpinPage(currentPageId, false);
-   return myPair;
+   return currentItem;
 }
 
 INDEX_TEMPLATE_ARGUMENTS
@@ -53,6 +61,10 @@ auto INDEXITERATOR_TYPE::operator++() -> INDEXITERATOR_TYPE & {
    if (currentLeaf->GetSize() == currentIndex) {
     currentIndex = 0;
     currentPageId = currentLeaf->GetNextPageId();
+    // keep the read-ahead window of the leaf chain in front of the iterator
+    if (!IsEnd() && read_ahead_depth > 0) {
+      buffer_pool_manager_->PrefetchChain(currentPageId, read_ahead_depth, &NextLeafPageId, nullptr);
+    }
    }
    buffer_pool_manager_->UnpinPage(oldPageId, false);
 //    buffer_pool_manager_->UnpinPage(currentPageId, false);
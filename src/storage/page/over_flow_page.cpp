@@ -22,9 +22,10 @@ void OverFlowPage::Init(page_id_t page_id, uint32_t page_size, page_id_t nextPag
   memcpy(GetData(), &page_id, sizeof(page_id));
   SetNextPageId(nextPageId);
   SetTupleSize(0);
+  SetChainSize(0);
 }
 
-auto OverFlowPage::InsertOverFlowedData(char*data,int size) -> bool {
+auto OverFlowPage::InsertOverFlowedData(const char *data, int size) -> bool {
         memcpy(GetData() + SIZE_OVER_FLOW_HEADER, data, size);  
         SetTupleSize(size);    
  
@@ -12,10 +12,23 @@
 
 #include "storage/page/table_page.h"
 
+#include <algorithm>
 #include <cassert>
 
+#include "storage/table/tuple_record.h"
+#include "type/type.h"
+
 namespace bustub {
 
+/** Copy the values of a minipage at the given slots into the tuples at offset in them, WIDTH bytes each. */
+template <uint32_t WIDTH>
+static void ScatterMinipage(const char *minipage, const std::vector<TablePage::TupleSlot> &slots, uint32_t offset,
+                            char *tuples) {
+  for (const auto &slot : slots) {
+    memcpy(tuples + slot.offset_ + offset, minipage + slot.slot_num_ * WIDTH, WIDTH);
+  }
+}
+
 void TablePage::Init(page_id_t page_id, uint32_t page_size, page_id_t prev_page_id, LogManager *log_manager,
                      Transaction *txn) {
   // Set the page ID.
@@ -32,12 +45,223 @@ void TablePage::Init(page_id_t page_id, uint32_t page_size, page_id_t prev_page_
   SetPrevPageId(prev_page_id);
   SetNextPageId(INVALID_PAGE_ID);
   SetFreeSpacePointer(page_size);
+  SetFreeSpaceMapPageId(INVALID_PAGE_ID);
+  SetZoneMapPageId(INVALID_PAGE_ID);
   SetTupleCount(0);
+  memset(GetData() + OFFSET_PAX_LAYOUT, 0, sizeof(uint32_t));
+}
+
+void TablePage::InitPax(const std::vector<TypeId> &column_types) {
+  const uint32_t capacity = PaxCapacity(column_types);
+  BUSTUB_ASSERT(capacity > 0 && GetTupleCount() == 0, "A PAX page needs fixed-width columns and an empty page.");
+  const auto column_count = static_cast<uint16_t>(column_types.size());
+  const auto row_count = static_cast<uint16_t>(capacity);
+  memcpy(GetData() + OFFSET_PAX_LAYOUT, &column_count, sizeof(uint16_t));
+  memcpy(GetData() + OFFSET_PAX_LAYOUT + sizeof(uint16_t), &row_count, sizeof(uint16_t));
+  for (uint32_t i = 0; i < column_count; i++) {
+    GetData()[SIZE_TABLE_PAGE_HEADER + i] = static_cast<char>(column_types[i]);
+  }
+  // all rows empty, no nulls
+  memset(GetData() + SIZE_TABLE_PAGE_HEADER + column_count, 0, PaxMinipagesOffset(column_count, capacity) -
+                                                                   SIZE_TABLE_PAGE_HEADER - column_count);
+}
+
+auto TablePage::GetPaxColumnTypes() -> std::vector<TypeId> {
+  std::vector<TypeId> column_types(GetPaxColumnCount());
+  for (uint32_t i = 0; i < column_types.size(); i++) {
+    column_types[i] = static_cast<TypeId>(GetData()[SIZE_TABLE_PAGE_HEADER + i]);
+  }
+  return column_types;
+}
+
+auto TablePage::PaxCapacity(const std::vector<TypeId> &column_types) -> uint32_t {
+  const auto column_count = static_cast<uint32_t>(column_types.size());
+  if (column_count == 0 || column_count > UINT16_MAX) {
+    return 0;
+  }
+  uint32_t row_size = 0;
+  for (const auto type : column_types) {
+    if (type == TypeId::VARCHAR || type == TypeId::INVALID) {
+      return 0;
+    }
+    row_size += Type::GetTypeSize(type);
+  }
+  // Every 8 rows take 8 state bytes, a byte of every null bitmap and their values; the minipages start aligned.
+  const uint32_t fixed_size = SIZE_TABLE_PAGE_HEADER + column_count + 7;
+  if (fixed_size >= BUSTUB_PAGE_SIZE) {
+    return 0;
+  }
+  uint32_t capacity = (BUSTUB_PAGE_SIZE - fixed_size) / (8 + column_count + 8 * row_size) * 8;
+  while (capacity > 0 && PaxMinipagesOffset(column_count, capacity) + capacity * row_size > BUSTUB_PAGE_SIZE) {
+    capacity -= 8;
+  }
+  return capacity;
+}
+
+auto TablePage::GetPaxTupleSize() -> uint32_t {
+  uint32_t row_size = 0;
+  for (uint32_t i = 0; i < GetPaxColumnCount(); i++) {
+    row_size += GetPaxColumnWidth(i);
+  }
+  // the tuple has no overflow page id and an empty null bitmap, as TupleRecord writes for fixed-width columns
+  return sizeof(page_id_t) + row_size + TupleRecord::NullBitmapSize(GetPaxColumnCount());
+}
+
+void TablePage::ReadPaxRow(uint32_t row, char *data) {
+  const uint32_t column_count = GetPaxColumnCount();
+  const uint32_t capacity = GetPaxCapacity();
+  const page_id_t overflow_page_id = INVALID_PAGE_ID;
+  memcpy(data, &overflow_page_id, sizeof(page_id_t));
+  uint32_t offset = sizeof(page_id_t);
+  uint32_t minipage_offset = PaxMinipagesOffset(column_count, capacity);
+  for (uint32_t i = 0; i < column_count; i++) {
+    const auto width = GetPaxColumnWidth(i);
+    memcpy(data + offset, GetData() + minipage_offset + row * width, width);
+    offset += width;
+    minipage_offset += capacity * width;
+  }
+  memset(data + offset, 0, TupleRecord::NullBitmapSize(column_count));
+}
+
+void TablePage::WritePaxRow(uint32_t row, const char *data) {
+  const uint32_t column_count = GetPaxColumnCount();
+  const uint32_t capacity = GetPaxCapacity();
+  uint32_t offset = sizeof(page_id_t);
+  uint32_t minipage_offset = PaxMinipagesOffset(column_count, capacity);
+  for (uint32_t i = 0; i < column_count; i++) {
+    const auto type = static_cast<TypeId>(GetData()[SIZE_TABLE_PAGE_HEADER + i]);
+    const auto width = static_cast<uint32_t>(Type::GetTypeSize(type));
+    memcpy(GetData() + minipage_offset + row * width, data + offset, width);
+    // fixed-width values are null by holding the null value of their type
+    auto &null_byte = GetData()[GetPaxNullBitmapOffset(i) + row / 8];
+    if (Value::DeserializeFrom(data + offset, type).IsNull()) {
+      null_byte = static_cast<char>(null_byte | (1 << (row % 8)));
+    } else {
+      null_byte = static_cast<char>(null_byte & ~(1 << (row % 8)));
+    }
+    offset += width;
+    minipage_offset += capacity * width;
+  }
+}
+
+auto TablePage::GetPaxFreeSpaceRemaining() -> uint32_t {
+  // a retired page has no room
+  if (GetFreeSpacePointer() == SIZE_TABLE_PAGE_HEADER) {
+    return 0;
+  }
+  uint32_t num_empty_rows = GetPaxCapacity() - GetTupleCount();
+  for (uint32_t i = 0; i < GetTupleCount(); i++) {
+    num_empty_rows += GetPaxRowState(i) == PAX_ROW_EMPTY ? 1 : 0;
+  }
+  return num_empty_rows * (GetPaxTupleSize() + SIZE_TUPLE);
+}
+
+auto TablePage::InsertPaxTuple(const TupleRecord &tuple, RID *rid) -> bool {
+  BUSTUB_ASSERT(tuple.size_ == GetPaxTupleSize(), "The tuple does not have the columns of the PAX page.");
+  if (GetFreeSpacePointer() == SIZE_TABLE_PAGE_HEADER) {
+    return false;
+  }
+  // Reuse the first empty row, or take the row after the last one in use.
+  const uint32_t tuple_count = GetTupleCount();
+  const auto *states = reinterpret_cast<const uint8_t *>(GetData() + SIZE_TABLE_PAGE_HEADER + GetPaxColumnCount());
+  const auto *empty_state = static_cast<const uint8_t *>(memchr(states, PAX_ROW_EMPTY, tuple_count));
+  const uint32_t row = empty_state != nullptr ? static_cast<uint32_t>(empty_state - states) : tuple_count;
+  if (row == GetPaxCapacity()) {
+    return false;
+  }
+  WritePaxRow(row, tuple.data_);
+  SetPaxRowState(row, PAX_ROW_LIVE);
+  if (row == tuple_count) {
+    SetTupleCount(tuple_count + 1);
+  }
+  rid->Set(GetTablePageId(), row);
+  return true;
+}
+
+auto TablePage::UpdatePaxTuple(const TupleRecord &new_tuple, TupleRecord *old_tuple, const RID &rid, Transaction *txn)
+    -> bool {
+  BUSTUB_ASSERT(new_tuple.size_ == GetPaxTupleSize(), "The tuple does not have the columns of the PAX page.");
+  if (!GetPaxTuple(rid, old_tuple, txn)) {
+    return false;
+  }
+  WritePaxRow(rid.GetSlotNum(), new_tuple.data_);
+  return true;
+}
+
+auto TablePage::GetPaxTuple(const RID &rid, TupleRecord *tuple, Transaction *txn) -> bool {
+  const uint32_t slot_num = rid.GetSlotNum();
+  if (slot_num >= GetTupleCount() || GetPaxRowState(slot_num) != PAX_ROW_LIVE) {
+    if (enable_logging) {
+      txn->SetState(TransactionState::ABORTED);
+    }
+    return false;
+  }
+  tuple->size_ = GetPaxTupleSize();
+  if (tuple->allocated_) {
+    delete[] tuple->data_;
+  }
+  tuple->data_ = new char[tuple->size_];
+  tuple->tupleData_ = tuple->data_ + sizeof(uint32_t);
+  ReadPaxRow(slot_num, tuple->data_);
+  tuple->rid_ = rid;
+  tuple->allocated_ = true;
+  return true;
+}
+
+auto TablePage::CopyColumn(uint32_t column_idx, char *values, std::vector<uint32_t> *slot_nums,
+                           std::vector<bool> *is_null) -> uint32_t {
+  const uint32_t column_count = GetPaxColumnCount();
+  const uint32_t capacity = GetPaxCapacity();
+  BUSTUB_ASSERT(column_idx < column_count, "No such column on the PAX page.");
+  uint32_t minipage_offset = PaxMinipagesOffset(column_count, capacity);
+  uint32_t width = 0;
+  for (uint32_t i = 0; i <= column_idx; i++) {
+    minipage_offset += capacity * width;
+    width = GetPaxColumnWidth(i);
+  }
+  const char *minipage = GetData() + minipage_offset;
+  const char *null_bitmap = GetData() + GetPaxNullBitmapOffset(column_idx);
+
+  const uint32_t tuple_count = GetTupleCount();
+  uint32_t num_values = 0;
+  const auto *states = reinterpret_cast<const uint8_t *>(GetData() + SIZE_TABLE_PAGE_HEADER + column_count);
+  if (std::all_of(states, states + tuple_count, [](uint8_t state) { return state == PAX_ROW_LIVE; })) {
+    memcpy(values, minipage, tuple_count * width);
+    num_values = tuple_count;
+  } else {
+    for (uint32_t i = 0; i < tuple_count; i++) {
+      if (states[i] == PAX_ROW_LIVE) {
+        memcpy(values + num_values * width, minipage + i * width, width);
+        num_values++;
+      }
+    }
+  }
+
+  if (slot_nums != nullptr) {
+    slot_nums->clear();
+    for (uint32_t i = 0; i < tuple_count; i++) {
+      if (states[i] == PAX_ROW_LIVE) {
+        slot_nums->push_back(i);
+      }
+    }
+  }
+  if (is_null != nullptr) {
+    is_null->clear();
+    for (uint32_t i = 0; i < tuple_count; i++) {
+      if (states[i] == PAX_ROW_LIVE) {
+        is_null->push_back((null_bitmap[i / 8] & (1 << (i % 8))) != 0);
+      }
+    }
+  }
+  return num_values;
 }
 
 auto TablePage::InsertTuple(const TupleRecord &tuple, RID *rid, Transaction *txn, LockManager *lock_manager,
                             LogManager *log_manager) -> bool {
   BUSTUB_ASSERT(tuple.size_ > 0, "Cannot have empty tuples.");
+  if (IsPax()) {
+    return InsertPaxTuple(tuple, rid);
+  }
   // If there is not enough space, then return false.
   if (GetFreeSpaceRemaining() < tuple.size_ + SIZE_TUPLE) {
        return false;
@@ -100,6 +324,17 @@ auto TablePage::MarkDelete(const RID &rid, Transaction *txn, LockManager *lock_m
     return false;
   }
 
+  if (IsPax()) {
+    if (GetPaxRowState(slot_num) != PAX_ROW_LIVE) {
+      if (enable_logging) {
+        txn->SetState(TransactionState::ABORTED);
+      }
+      return false;
+    }
+    SetPaxRowState(slot_num, PAX_ROW_DELETED);
+    return true;
+  }
+
   uint32_t tuple_size = GetTupleSize(slot_num);
   // If the tuple is already deleted, abort the transaction.
   if (IsDeleted(tuple_size)) {
@@ -139,6 +374,9 @@ auto TablePage::MarkDelete(const RID &rid, Transaction *txn, LockManager *lock_m
 auto TablePage::UpdateTuple(const TupleRecord &new_tuple, TupleRecord *old_tuple, const RID &rid, Transaction *txn,
                             LockManager *lock_manager, LogManager *log_manager) -> bool {
   BUSTUB_ASSERT(new_tuple.size_ > 0, "Cannot have empty tuples.");
+  if (IsPax()) {
+    return UpdatePaxTuple(new_tuple, old_tuple, rid, txn);
+  }
   uint32_t slot_num = rid.GetSlotNum();
   // If the slot number is invalid, abort the transaction.
   if (slot_num >= GetTupleCount()) {
@@ -213,6 +451,10 @@ auto TablePage::UpdateTuple(const TupleRecord &new_tuple, TupleRecord *old_tuple
 void TablePage::ApplyDelete(const RID &rid, Transaction *txn, LogManager *log_manager) {
   uint32_t slot_num = rid.GetSlotNum();
   BUSTUB_ASSERT(slot_num < GetTupleCount(), "Cannot have more slots than tuples.");
+  if (IsPax()) {
+    SetPaxRowState(slot_num, PAX_ROW_EMPTY);
+    return;
+  }
 
   uint32_t tuple_offset = GetTupleOffsetAtSlot(slot_num);
   uint32_t tuple_size = GetTupleSize(slot_num);
@@ -276,6 +518,12 @@ void TablePage::RollbackDelete(const RID &rid, Transaction *txn, LogManager *log
 
   uint32_t slot_num = rid.GetSlotNum();
   BUSTUB_ASSERT(slot_num < GetTupleCount(), "We can't have more slots than tuples.");
+  if (IsPax()) {
+    if (GetPaxRowState(slot_num) == PAX_ROW_DELETED) {
+      SetPaxRowState(slot_num, PAX_ROW_LIVE);
+    }
+    return;
+  }
   uint32_t tuple_size = GetTupleSize(slot_num);
 
   // Unset the deleted flag.
@@ -285,6 +533,9 @@ void TablePage::RollbackDelete(const RID &rid, Transaction *txn, LogManager *log
 }
 
 auto TablePage::GetTuple(const RID &rid, TupleRecord *tuple, Transaction *txn, LockManager *lock_manager) -> bool {
+  if (IsPax()) {
+    return GetPaxTuple(rid, tuple, txn);
+  }
   // Get the current slot number.
   uint32_t slot_num = rid.GetSlotNum();
   // If somehow we have more slots than tuples, abort the transaction.
@@ -333,7 +584,7 @@ auto TablePage::GetTuple(const RID &rid, TupleRecord *tuple, Transaction *txn, L
 auto TablePage::GetFirstTupleRid(RID *first_rid) -> bool {
   // Find and return the first valid tuple.
   for (uint32_t i = 0; i < GetTupleCount(); ++i) {
-    if (!IsDeleted(GetTupleSize(i))) {
+    if (IsPax() ? GetPaxRowState(i) == PAX_ROW_LIVE : !IsDeleted(GetTupleSize(i))) {
       first_rid->Set(GetTablePageId(), i);
       return true;
     }
@@ -346,7 +597,7 @@ auto TablePage::GetNextTupleRid(const RID &cur_rid, RID *next_rid) -> bool {
   BUSTUB_ASSERT(cur_rid.GetPageId() == GetTablePageId(), "Wrong table!");
   // Find and return the first valid tuple after our current slot number.
   for (auto i = cur_rid.GetSlotNum() + 1; i < GetTupleCount(); ++i) {
-    if (!IsDeleted(GetTupleSize(i))) {
+    if (IsPax() ? GetPaxRowState(i) == PAX_ROW_LIVE : !IsDeleted(GetTupleSize(i))) {
       next_rid->Set(GetTablePageId(), i);
       return true;
     }
@@ -355,4 +606,69 @@ auto TablePage::GetNextTupleRid(const RID &cur_rid, RID *next_rid) -> bool {
   next_rid->Set(INVALID_PAGE_ID, 0);
   return false;
 }
+
+void TablePage::CopyTuples(std::vector<char> *data, std::vector<TupleSlot> *slots) {
+  slots->clear();
+  if (IsPax()) {
+    // put the tuples together a column at a time, which reads every minipage front to back
+    const uint32_t tuple_size = GetPaxTupleSize();
+    const uint32_t column_count = GetPaxColumnCount();
+    const uint32_t capacity = GetPaxCapacity();
+    for (uint32_t i = 0; i < GetTupleCount(); i++) {
+      if (GetPaxRowState(i) == PAX_ROW_LIVE) {
+        slots->push_back({i, static_cast<uint32_t>(slots->size()) * tuple_size, tuple_size});
+      }
+    }
+    data->resize(slots->size() * tuple_size);
+    char *tuples = data->data();
+    const page_id_t overflow_page_id = INVALID_PAGE_ID;
+    const uint32_t null_bitmap_size = TupleRecord::NullBitmapSize(column_count);
+    for (const auto &slot : *slots) {
+      memcpy(tuples + slot.offset_, &overflow_page_id, sizeof(page_id_t));
+      memset(tuples + slot.offset_ + tuple_size - null_bitmap_size, 0, null_bitmap_size);
+    }
+    uint32_t offset = sizeof(page_id_t);
+    const char *minipage = GetData() + PaxMinipagesOffset(column_count, capacity);
+    for (uint32_t c = 0; c < column_count; c++) {
+      const auto width = GetPaxColumnWidth(c);
+      switch (width) {
+        case 1:
+          ScatterMinipage<1>(minipage, *slots, offset, tuples);
+          break;
+        case 2:
+          ScatterMinipage<2>(minipage, *slots, offset, tuples);
+          break;
+        case 4:
+          ScatterMinipage<4>(minipage, *slots, offset, tuples);
+          break;
+        default:
+          ScatterMinipage<8>(minipage, *slots, offset, tuples);
+          break;
+      }
+      offset += width;
+      minipage += capacity * width;
+    }
+    return;
+  }
+  // the tuples are packed at the end of the page
+  data->resize(BUSTUB_PAGE_SIZE);
+  const uint32_t free_space_pointer = GetFreeSpacePointer();
+  memcpy(data->data() + free_space_pointer, GetData() + free_space_pointer, BUSTUB_PAGE_SIZE - free_space_pointer);
+  for (uint32_t i = 0; i < GetTupleCount(); i++) {
+    const uint32_t tuple_size = GetTupleSize(i);
+    if (!IsDeleted(tuple_size)) {
+      slots->push_back({i, GetTupleOffsetAtSlot(i), tuple_size});
+    }
+  }
+}
+
+auto TablePage::Compact() -> bool {
+  uint32_t tuple_count = GetTupleCount();
+  while (tuple_count > 0 &&
+         (IsPax() ? GetPaxRowState(tuple_count - 1) == PAX_ROW_EMPTY : GetTupleSize(tuple_count - 1) == 0)) {
+    tuple_count--;
+  }
+  SetTupleCount(tuple_count);
+  return tuple_count == 0;
+}
 }  // namespace bustub
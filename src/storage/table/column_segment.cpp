@@ -0,0 +1,454 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// column_segment.cpp
+//
+// Identification: src/storage/table/column_segment.cpp
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/table/column_segment.h"
+
+#include <algorithm>
+#include <cstring>
+#include <string>
+#include <unordered_map>
+
+#include "common/exception.h"
+#include "type/limits.h"
+#include "type/type.h"
+#include "type/value_factory.h"
+
+namespace bustub {
+
+/** Flips the order of the signed integers, so that they compare like their keys as unsigned integers. */
+static constexpr uint64_t SIGN_BIT = uint64_t{1} << 63;
+
+// the numeric types; timestamps have no comparisons in the type system
+auto ColumnSegment::KeepsRange(TypeId type_id) -> bool {
+  switch (type_id) {
+    case TypeId::TINYINT:
+    case TypeId::SMALLINT:
+    case TypeId::INTEGER:
+    case TypeId::BIGINT:
+    case TypeId::DECIMAL:
+      return true;
+    default:
+      return false;
+  }
+}
+
+/** @return true if a column of the type can be encoded with FOR */
+static auto IsInteger(TypeId type_id) -> bool {
+  switch (type_id) {
+    case TypeId::TINYINT:
+    case TypeId::SMALLINT:
+    case TypeId::INTEGER:
+    case TypeId::BIGINT:
+    case TypeId::TIMESTAMP:
+      return true;
+    default:
+      return false;
+  }
+}
+
+template <class T>
+static auto Load(const char *data) -> T {
+  T value;
+  memcpy(&value, data, sizeof(T));
+  return value;
+}
+
+template <class T>
+static void Append(std::vector<char> *out, T value) {
+  const size_t offset = out->size();
+  out->resize(offset + sizeof(T));
+  memcpy(out->data() + offset, &value, sizeof(T));
+}
+
+/** Write a value of a fixed-width type; a null is written as the null value of the type. */
+static void WriteFixed(TypeId type_id, const Value &value, char *storage) {
+  if (value.IsNull()) {
+    ValueFactory::GetNullValueByType(type_id).SerializeTo(storage);
+  } else {
+    value.SerializeTo(storage);
+  }
+}
+
+/** @return the value of an integer type stored at raw, as an unsigned key that compares like the value */
+static auto ToKey(TypeId type_id, const char *raw) -> uint64_t {
+  int64_t value = 0;
+  switch (type_id) {
+    case TypeId::TINYINT:
+      value = Load<int8_t>(raw);
+      break;
+    case TypeId::SMALLINT:
+      value = Load<int16_t>(raw);
+      break;
+    case TypeId::INTEGER:
+      value = Load<int32_t>(raw);
+      break;
+    case TypeId::BIGINT:
+      value = Load<int64_t>(raw);
+      break;
+    default:
+      // TIMESTAMP is unsigned already
+      return Load<uint64_t>(raw);
+  }
+  return static_cast<uint64_t>(value) ^ SIGN_BIT;
+}
+
+/** Store the value of an integer type that a key was made of at raw. */
+static void FromKey(TypeId type_id, uint64_t key, char *raw) {
+  if (type_id == TypeId::TIMESTAMP) {
+    memcpy(raw, &key, sizeof(uint64_t));
+    return;
+  }
+  const auto value = static_cast<int64_t>(key ^ SIGN_BIT);
+  switch (type_id) {
+    case TypeId::TINYINT: {
+      const auto narrow = static_cast<int8_t>(value);
+      memcpy(raw, &narrow, sizeof(int8_t));
+      break;
+    }
+    case TypeId::SMALLINT: {
+      const auto narrow = static_cast<int16_t>(value);
+      memcpy(raw, &narrow, sizeof(int16_t));
+      break;
+    }
+    case TypeId::INTEGER: {
+      const auto narrow = static_cast<int32_t>(value);
+      memcpy(raw, &narrow, sizeof(int32_t));
+      break;
+    }
+    default:
+      memcpy(raw, &value, sizeof(int64_t));
+      break;
+  }
+}
+
+/** @return the number of bits that the largest of a set of unsigned values needs */
+static auto BitWidth(uint64_t max_value) -> uint32_t {
+  uint32_t bit_width = 0;
+  while (bit_width < 64 && (max_value >> bit_width) != 0) {
+    bit_width++;
+  }
+  return bit_width;
+}
+
+/** Append values of bit_width bits each to out, the lowest bits first. */
+static void PackBits(const std::vector<uint64_t> &values, uint32_t bit_width, std::vector<char> *out) {
+  const size_t start = out->size();
+  out->resize(start + (values.size() * bit_width + 7) / 8, 0);
+  auto *data = reinterpret_cast<uint8_t *>(out->data() + start);
+  size_t bit = 0;
+  for (const uint64_t value : values) {
+    for (uint32_t written = 0; written < bit_width;) {
+      const uint32_t offset = bit % 8;
+      const uint32_t take = std::min(8 - offset, bit_width - written);
+      data[bit / 8] |= static_cast<uint8_t>(((value >> written) & ((1U << take) - 1)) << offset);
+      written += take;
+      bit += take;
+    }
+  }
+}
+
+/** Read count values of bit_width bits each, as written by PackBits(). */
+static void UnpackBits(const char *data, size_t count, uint32_t bit_width, std::vector<uint64_t> *values) {
+  values->assign(count, 0);
+  if (bit_width == 0) {
+    return;
+  }
+  const auto *bytes = reinterpret_cast<const uint8_t *>(data);
+  const size_t byte_size = (count * bit_width + 7) / 8;
+  const uint64_t mask = bit_width == 64 ? ~uint64_t{0} : (uint64_t{1} << bit_width) - 1;
+  size_t bit = 0;
+  for (size_t i = 0; i < count; i++, bit += bit_width) {
+    // a value of up to 56 bits is in the 8 bytes from the byte it starts in, unless they run past the end
+    if (bit_width <= 56 && bit / 8 + sizeof(uint64_t) <= byte_size) {
+      (*values)[i] = (Load<uint64_t>(data + bit / 8) >> (bit % 8)) & mask;
+      continue;
+    }
+    uint64_t value = 0;
+    for (uint32_t read = 0; read < bit_width;) {
+      const size_t at = bit + read;
+      const uint32_t offset = at % 8;
+      const uint32_t take = std::min(8 - offset, bit_width - read);
+      value |= static_cast<uint64_t>((bytes[at / 8] >> offset) & ((1U << take) - 1)) << read;
+      read += take;
+    }
+    (*values)[i] = value;
+  }
+}
+
+static void EncodePlain(TypeId type_id, const std::vector<Value> &values, std::vector<char> *out) {
+  if (type_id == TypeId::VARCHAR) {
+    for (const auto &value : values) {
+      if (value.IsNull()) {
+        Append<uint32_t>(out, BUSTUB_VALUE_NULL);
+        continue;
+      }
+      const uint32_t length = value.GetLength();
+      Append<uint32_t>(out, length);
+      out->insert(out->end(), value.GetData(), value.GetData() + length);
+    }
+    return;
+  }
+  const uint32_t width = Type::GetTypeSize(type_id);
+  const size_t start = out->size();
+  out->resize(start + values.size() * width);
+  for (size_t i = 0; i < values.size(); i++) {
+    WriteFixed(type_id, values[i], out->data() + start + i * width);
+  }
+}
+
+static void EncodeRle(TypeId type_id, const std::vector<Value> &values, std::vector<char> *out) {
+  const uint32_t width = Type::GetTypeSize(type_id);
+  const size_t run_count_offset = out->size();
+  Append<uint32_t>(out, 0);
+  uint32_t run_count = 0;
+  char value[sizeof(uint64_t)];
+  char last[sizeof(uint64_t)];
+  uint32_t run_length = 0;
+  for (const auto &v : values) {
+    WriteFixed(type_id, v, value);
+    if (run_length > 0 && memcmp(value, last, width) == 0) {
+      run_length++;
+      continue;
+    }
+    if (run_length > 0) {
+      out->insert(out->end(), last, last + width);
+      Append<uint32_t>(out, run_length);
+      run_count++;
+    }
+    memcpy(last, value, width);
+    run_length = 1;
+  }
+  if (run_length > 0) {
+    out->insert(out->end(), last, last + width);
+    Append<uint32_t>(out, run_length);
+    run_count++;
+  }
+  memcpy(out->data() + run_count_offset, &run_count, sizeof(uint32_t));
+}
+
+static void EncodeFor(TypeId type_id, const std::vector<Value> &values, uint32_t null_count, std::vector<char> *out) {
+  char raw[sizeof(uint64_t)];
+  std::vector<uint64_t> keys(values.size(), 0);
+  uint64_t reference = ~uint64_t{0};
+  uint64_t largest = 0;
+  for (size_t i = 0; i < values.size(); i++) {
+    if (values[i].IsNull()) {
+      continue;
+    }
+    values[i].SerializeTo(raw);
+    keys[i] = ToKey(type_id, raw);
+    reference = std::min(reference, keys[i]);
+    largest = std::max(largest, keys[i]);
+  }
+  if (null_count == values.size()) {
+    reference = 0;
+  }
+  for (size_t i = 0; i < values.size(); i++) {
+    keys[i] = values[i].IsNull() ? 0 : keys[i] - reference;
+  }
+  const uint32_t bit_width = BitWidth(null_count == values.size() ? 0 : largest - reference);
+  Append<uint64_t>(out, reference);
+  Append<uint32_t>(out, bit_width);
+  if (null_count > 0) {
+    const size_t start = out->size();
+    out->resize(start + (values.size() + 7) / 8, 0);
+    for (size_t i = 0; i < values.size(); i++) {
+      if (values[i].IsNull()) {
+        (*out)[start + i / 8] = static_cast<char>((*out)[start + i / 8] | (1 << (i % 8)));
+      }
+    }
+  }
+  PackBits(keys, bit_width, out);
+}
+
+static void EncodeDictionary(const std::vector<Value> &values, uint32_t null_count, std::vector<char> *out) {
+  std::unordered_map<std::string, uint64_t> code_of;
+  std::vector<const Value *> entries;
+  std::vector<uint64_t> codes(values.size(), 0);
+  for (size_t i = 0; i < values.size(); i++) {
+    if (values[i].IsNull()) {
+      continue;
+    }
+    auto [entry, is_new] = code_of.emplace(std::string(values[i].GetData(), values[i].GetLength()), entries.size());
+    if (is_new) {
+      entries.push_back(&values[i]);
+    }
+    codes[i] = entry->second;
+  }
+  const auto entry_count = static_cast<uint32_t>(entries.size());
+  for (size_t i = 0; i < values.size(); i++) {
+    if (values[i].IsNull()) {
+      codes[i] = entry_count;
+    }
+  }
+  const uint32_t bit_width = BitWidth(null_count > 0 || entry_count == 0 ? entry_count : entry_count - 1);
+  Append<uint32_t>(out, entry_count);
+  Append<uint32_t>(out, bit_width);
+  for (const auto *entry : entries) {
+    Append<uint32_t>(out, entry->GetLength());
+    out->insert(out->end(), entry->GetData(), entry->GetData() + entry->GetLength());
+  }
+  PackBits(codes, bit_width, out);
+}
+
+auto ColumnSegment::Encode(TypeId type_id, const std::vector<Value> &values) -> std::vector<char> {
+  const auto row_count = static_cast<uint32_t>(values.size());
+  uint32_t null_count = 0;
+  const Value *min = nullptr;
+  const Value *max = nullptr;
+  for (const auto &value : values) {
+    if (value.IsNull()) {
+      null_count++;
+    } else if (KeepsRange(type_id)) {
+      if (min == nullptr || value.CompareLessThan(*min) == CmpBool::CmpTrue) {
+        min = &value;
+      }
+      if (max == nullptr || value.CompareGreaterThan(*max) == CmpBool::CmpTrue) {
+        max = &value;
+      }
+    }
+  }
+
+  std::vector<char> body;
+  auto encoding = Encoding::PLAIN;
+  EncodePlain(type_id, values, &body);
+  const auto try_encoding = [&](Encoding candidate, auto &&encode) {
+    std::vector<char> other;
+    encode(&other);
+    if (other.size() < body.size()) {
+      body = std::move(other);
+      encoding = candidate;
+    }
+  };
+  if (type_id == TypeId::VARCHAR) {
+    try_encoding(Encoding::DICTIONARY, [&](std::vector<char> *out) { EncodeDictionary(values, null_count, out); });
+  } else {
+    try_encoding(Encoding::RLE, [&](std::vector<char> *out) { EncodeRle(type_id, values, out); });
+    if (IsInteger(type_id)) {
+      try_encoding(Encoding::FOR, [&](std::vector<char> *out) { EncodeFor(type_id, values, null_count, out); });
+    }
+  }
+
+  std::vector<char> segment(SIZE_HEADER, 0);
+  const auto encoding_id = static_cast<uint32_t>(encoding);
+  const uint32_t has_range = min != nullptr ? 1 : 0;
+  memcpy(segment.data() + OFFSET_ROW_COUNT, &row_count, sizeof(uint32_t));
+  memcpy(segment.data() + OFFSET_ENCODING, &encoding_id, sizeof(uint32_t));
+  memcpy(segment.data() + OFFSET_NULL_COUNT, &null_count, sizeof(uint32_t));
+  memcpy(segment.data() + OFFSET_HAS_RANGE, &has_range, sizeof(uint32_t));
+  if (min != nullptr) {
+    min->SerializeTo(segment.data() + OFFSET_MIN);
+    max->SerializeTo(segment.data() + OFFSET_MAX);
+  }
+  segment.insert(segment.end(), body.begin(), body.end());
+  return segment;
+}
+
+auto ColumnSegment::ReadHeader(TypeId type_id, const char *data) -> Header {
+  Header header;
+  header.row_count_ = Load<uint32_t>(data + OFFSET_ROW_COUNT);
+  header.encoding_ = static_cast<Encoding>(Load<uint32_t>(data + OFFSET_ENCODING));
+  header.null_count_ = Load<uint32_t>(data + OFFSET_NULL_COUNT);
+  header.has_range_ = Load<uint32_t>(data + OFFSET_HAS_RANGE) != 0;
+  if (header.has_range_) {
+    header.min_ = Value::DeserializeFrom(data + OFFSET_MIN, type_id);
+    header.max_ = Value::DeserializeFrom(data + OFFSET_MAX, type_id);
+  }
+  return header;
+}
+
+void ColumnSegment::Decode(TypeId type_id, const char *data, std::vector<Value> *values) {
+  const Header header = ReadHeader(type_id, data);
+  const uint32_t row_count = header.row_count_;
+  const char *body = data + SIZE_HEADER;
+  values->clear();
+  values->reserve(row_count);
+
+  switch (header.encoding_) {
+    case Encoding::PLAIN: {
+      if (type_id == TypeId::VARCHAR) {
+        for (uint32_t i = 0; i < row_count; i++) {
+          const auto length = Load<uint32_t>(body);
+          body += sizeof(uint32_t);
+          if (length == BUSTUB_VALUE_NULL) {
+            values->push_back(ValueFactory::GetNullValueByType(type_id));
+            continue;
+          }
+          values->emplace_back(type_id, body, length, true);
+          body += length;
+        }
+        return;
+      }
+      const uint32_t width = Type::GetTypeSize(type_id);
+      for (uint32_t i = 0; i < row_count; i++) {
+        values->push_back(Value::DeserializeFrom(body + i * width, type_id));
+      }
+      return;
+    }
+    case Encoding::RLE: {
+      const uint32_t width = Type::GetTypeSize(type_id);
+      const auto run_count = Load<uint32_t>(body);
+      body += sizeof(uint32_t);
+      for (uint32_t run = 0; run < run_count; run++) {
+        const Value value = Value::DeserializeFrom(body, type_id);
+        const auto run_length = Load<uint32_t>(body + width);
+        values->insert(values->end(), run_length, value);
+        body += width + sizeof(uint32_t);
+      }
+      return;
+    }
+    case Encoding::FOR: {
+      const auto reference = Load<uint64_t>(body);
+      const auto bit_width = Load<uint32_t>(body + sizeof(uint64_t));
+      body += sizeof(uint64_t) + sizeof(uint32_t);
+      const char *null_bitmap = nullptr;
+      if (header.null_count_ > 0) {
+        null_bitmap = body;
+        body += (row_count + 7) / 8;
+      }
+      std::vector<uint64_t> deltas;
+      UnpackBits(body, row_count, bit_width, &deltas);
+      char raw[sizeof(uint64_t)];
+      for (uint32_t i = 0; i < row_count; i++) {
+        if (null_bitmap != nullptr && (null_bitmap[i / 8] & (1 << (i % 8))) != 0) {
+          values->push_back(ValueFactory::GetNullValueByType(type_id));
+          continue;
+        }
+        FromKey(type_id, reference + deltas[i], raw);
+        values->push_back(Value::DeserializeFrom(raw, type_id));
+      }
+      return;
+    }
+    case Encoding::DICTIONARY: {
+      const auto entry_count = Load<uint32_t>(body);
+      const auto bit_width = Load<uint32_t>(body + sizeof(uint32_t));
+      body += 2 * sizeof(uint32_t);
+      std::vector<Value> entries;
+      entries.reserve(entry_count + 1);
+      for (uint32_t i = 0; i < entry_count; i++) {
+        const auto length = Load<uint32_t>(body);
+        entries.emplace_back(type_id, body + sizeof(uint32_t), length, true);
+        body += sizeof(uint32_t) + length;
+      }
+      entries.push_back(ValueFactory::GetNullValueByType(type_id));
+      std::vector<uint64_t> codes;
+      UnpackBits(body, row_count, bit_width, &codes);
+      for (uint32_t i = 0; i < row_count; i++) {
+        values->push_back(entries[codes[i]]);
+      }
+      return;
+    }
+  }
+  throw Exception(ExceptionType::INVALID, "unknown column segment encoding");
+}
+
+}  // namespace bustub
@@ -0,0 +1,336 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// column_table.cpp
+//
+// Identification: src/storage/table/column_table.cpp
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/table/column_table.h"
+
+#include <algorithm>
+#include <cstring>
+#include <mutex>  // NOLINT
+
+#include "common/exception.h"
+#include "storage/page/column_segment_page.h"
+#include "type/value_factory.h"
+
+namespace bustub {
+
+ColumnTable::Scanner::Scanner(ColumnTable *table, std::vector<uint32_t> column_ids, std::vector<ZoneMap::Range> ranges,
+                              BufferAccessStrategy *strategy)
+    : table_(table),
+      column_ids_(std::move(column_ids)),
+      ranges_(std::move(ranges)),
+      strategy_(strategy),
+      columns_(column_ids_.size()) {
+  const Schema &schema = table_->schema_;
+  for (uint32_t i = 0; i < schema.GetColumnCount(); i++) {
+    null_row_.push_back(ValueFactory::GetNullValueByType(schema.GetColumn(i).GetType()));
+  }
+  std::shared_lock lock(table_->latch_);
+  row_group_count_ = table_->deleted_.size();
+  tail_row_count_ = table_->deleted_.back().size();
+}
+
+auto ColumnTable::Scanner::Next(std::vector<Value> *values, RID *rid) -> bool {
+  while (true) {
+    while (next_row_ < row_count_) {
+      const uint32_t row = next_row_++;
+      if (deleted_[row]) {
+        continue;
+      }
+      *values = null_row_;
+      for (size_t i = 0; i < column_ids_.size(); i++) {
+        (*values)[column_ids_[i]] = columns_[i][row];
+      }
+      *rid = RID(static_cast<page_id_t>(next_row_group_ - 1), row);
+      return true;
+    }
+    if (!LoadRowGroup()) {
+      return false;
+    }
+  }
+}
+
+auto ColumnTable::Scanner::LoadRowGroup() -> bool {
+  const Schema &schema = table_->schema_;
+  std::vector<char> segment;
+  std::shared_lock lock(table_->latch_);
+  for (; next_row_group_ < row_group_count_; next_row_group_++) {
+    const size_t row_group = next_row_group_;
+    // the tail that the scan started with may have been written out since, and rows appended to it
+    const auto row_count = static_cast<uint32_t>(
+        row_group + 1 == row_group_count_ ? tail_row_count_ : table_->deleted_[row_group].size());
+    if (row_count == 0) {
+      continue;
+    }
+    const bool is_written = row_group < table_->segments_.size();
+    bool may_match = true;
+    for (const auto &range : ranges_) {
+      if (!is_written || range.column_idx_ >= schema.GetColumnCount()) {
+        continue;
+      }
+      const TypeId type_id = schema.GetColumn(range.column_idx_).GetType();
+      const ColumnSegment::Header &header = table_->segments_[row_group][range.column_idx_].header_;
+      if (ColumnSegment::KeepsRange(type_id) &&
+          !ZoneMap::RangeMayMatch(range, type_id, header.has_range_, header.min_, header.max_)) {
+        may_match = false;
+        break;
+      }
+    }
+    if (!may_match) {
+      continue;
+    }
+
+    for (size_t i = 0; i < column_ids_.size(); i++) {
+      const uint32_t column_idx = column_ids_[i];
+      if (is_written) {
+        table_->ReadSegment(table_->segments_[row_group][column_idx], strategy_, &segment);
+        ColumnSegment::Decode(schema.GetColumn(column_idx).GetType(), segment.data(), &columns_[i]);
+      } else {
+        const auto &tail = table_->tail_[column_idx];
+        columns_[i].assign(tail.begin(), tail.begin() + row_count);
+      }
+    }
+    deleted_ = table_->deleted_[row_group];
+    row_count_ = row_count;
+    next_row_ = 0;
+    next_row_group_++;
+    return true;
+  }
+  return false;
+}
+
+ColumnTable::ColumnTable(BufferPoolManager *buffer_pool_manager, const Schema &schema)
+    : buffer_pool_manager_(buffer_pool_manager),
+      schema_(schema),
+      first_page_ids_(schema.GetColumnCount(), INVALID_PAGE_ID),
+      last_page_ids_(schema.GetColumnCount(), INVALID_PAGE_ID),
+      tail_(schema.GetColumnCount()),
+      deleted_(1) {}
+
+auto ColumnTable::InsertTuple(const TupleRecord &tuple, RID *rid, Transaction *txn) -> bool {
+  std::unique_lock lock(latch_);
+  if (!AppendRow(tuple, rid)) {
+    return false;
+  }
+  txn->GetWriteSet()->emplace_back(*rid, WType::INSERT, this);
+  return true;
+}
+
+auto ColumnTable::InsertTuples(const std::vector<const TupleRecord *> &tuples, std::vector<RID> *rids,
+                               Transaction *txn) -> bool {
+  rids->clear();
+  rids->reserve(tuples.size());
+  auto write_set = txn->GetWriteSet();
+  std::unique_lock lock(latch_);
+  for (const auto *tuple : tuples) {
+    RID rid;
+    if (!AppendRow(*tuple, &rid)) {
+      return false;
+    }
+    rids->push_back(rid);
+    write_set->emplace_back(rid, WType::INSERT, this);
+  }
+  return true;
+}
+
+auto ColumnTable::MarkDelete(const RID &rid, Transaction *txn) -> bool {
+  std::unique_lock lock(latch_);
+  if (!IsValid(rid) || deleted_[rid.GetPageId()][rid.GetSlotNum()]) {
+    return false;
+  }
+  deleted_[rid.GetPageId()][rid.GetSlotNum()] = true;
+  txn->GetWriteSet()->emplace_back(rid, WType::DELETE, this);
+  return true;
+}
+
+auto ColumnTable::UpdateTuple(const TupleRecord &tuple, const RID &rid, Transaction *txn, RID *new_rid) -> bool {
+  std::unique_lock lock(latch_);
+  if (!IsValid(rid) || deleted_[rid.GetPageId()][rid.GetSlotNum()]) {
+    return false;
+  }
+  RID appended_rid;
+  if (!AppendRow(tuple, &appended_rid)) {
+    return false;
+  }
+  deleted_[rid.GetPageId()][rid.GetSlotNum()] = true;
+  // an abort undoes the records from the back, so the new row goes before the old one comes back
+  auto write_set = txn->GetWriteSet();
+  write_set->emplace_back(rid, WType::DELETE, this);
+  write_set->emplace_back(appended_rid, WType::INSERT, this);
+  if (new_rid != nullptr) {
+    *new_rid = appended_rid;
+  }
+  return true;
+}
+
+void ColumnTable::ApplyDelete(const RID &rid, [[maybe_unused]] Transaction *txn) {
+  std::unique_lock lock(latch_);
+  if (IsValid(rid)) {
+    deleted_[rid.GetPageId()][rid.GetSlotNum()] = true;
+  }
+}
+
+void ColumnTable::RollbackDelete(const RID &rid, [[maybe_unused]] Transaction *txn) {
+  std::unique_lock lock(latch_);
+  if (IsValid(rid)) {
+    deleted_[rid.GetPageId()][rid.GetSlotNum()] = false;
+  }
+}
+
+auto ColumnTable::GetTuple(const RID &rid, std::vector<Value> *values) -> bool {
+  std::shared_lock lock(latch_);
+  if (!IsValid(rid) || deleted_[rid.GetPageId()][rid.GetSlotNum()]) {
+    return false;
+  }
+  const auto row_group = static_cast<size_t>(rid.GetPageId());
+  values->clear();
+  if (row_group == segments_.size()) {
+    for (const auto &column : tail_) {
+      values->push_back(column[rid.GetSlotNum()]);
+    }
+    return true;
+  }
+  std::vector<char> segment;
+  std::vector<Value> column;
+  for (uint32_t i = 0; i < schema_.GetColumnCount(); i++) {
+    ReadSegment(segments_[row_group][i], nullptr, &segment);
+    ColumnSegment::Decode(schema_.GetColumn(i).GetType(), segment.data(), &column);
+    values->push_back(column[rid.GetSlotNum()]);
+  }
+  return true;
+}
+
+auto ColumnTable::Flush() -> bool {
+  std::unique_lock lock(latch_);
+  return deleted_.back().empty() || WriteRowGroup();
+}
+
+auto ColumnTable::GetRowGroupCount() -> size_t {
+  std::shared_lock lock(latch_);
+  return segments_.size();
+}
+
+auto ColumnTable::GetSegmentHeader(size_t row_group, uint32_t column_idx) -> ColumnSegment::Header {
+  std::shared_lock lock(latch_);
+  return segments_[row_group][column_idx].header_;
+}
+
+auto ColumnTable::GetFirstPageId(uint32_t column_idx) -> page_id_t {
+  std::shared_lock lock(latch_);
+  return first_page_ids_[column_idx];
+}
+
+auto ColumnTable::IsValid(const RID &rid) const -> bool {
+  return rid.GetPageId() >= 0 && static_cast<size_t>(rid.GetPageId()) < deleted_.size() &&
+         rid.GetSlotNum() < deleted_[rid.GetPageId()].size();
+}
+
+auto ColumnTable::AppendRow(const TupleRecord &tuple, RID *rid) -> bool {
+  if (deleted_.back().size() >= ROW_GROUP_SIZE && !WriteRowGroup()) {
+    return false;
+  }
+  // a tuple read from a table has to bring its overflow with it
+  tuple.LoadOverflow();
+  for (uint32_t i = 0; i < schema_.GetColumnCount(); i++) {
+    tail_[i].push_back(tuple.GetValue(&schema_, i));
+  }
+  *rid = RID(static_cast<page_id_t>(segments_.size()), static_cast<uint32_t>(deleted_.back().size()));
+  deleted_.back().push_back(false);
+  return true;
+}
+
+auto ColumnTable::WriteRowGroup() -> bool {
+  const uint32_t column_count = schema_.GetColumnCount();
+  std::vector<Segment> segments;
+  std::vector<page_id_t> segment_last_page_ids;
+  std::vector<page_id_t> new_page_ids;
+  const auto undo = [&]() {
+    for (const page_id_t page_id : new_page_ids) {
+      buffer_pool_manager_->DeletePage(page_id);
+    }
+    return false;
+  };
+
+  // Write the segments to new pages first, and only then link them to the chains of the columns, so that a row group
+  // that cannot be written out whole leaves the table as it was.
+  for (uint32_t i = 0; i < column_count; i++) {
+    const std::vector<char> data = ColumnSegment::Encode(schema_.GetColumn(i).GetType(), tail_[i]);
+    Segment segment{INVALID_PAGE_ID, 0, static_cast<uint32_t>(data.size()),
+                    ColumnSegment::ReadHeader(schema_.GetColumn(i).GetType(), data.data())};
+    ColumnSegmentPage *prev_page = nullptr;
+    page_id_t prev_page_id = last_page_ids_[i];
+    for (size_t offset = 0; offset < data.size(); offset += ColumnSegmentPage::DATA_CAPACITY) {
+      page_id_t page_id;
+      // the pages of a column follow each other on disk, so a scan of the column reads them in one sweep
+      auto *page = reinterpret_cast<ColumnSegmentPage *>(buffer_pool_manager_->NewPage(&page_id, prev_page_id));
+      if (page == nullptr) {
+        if (prev_page != nullptr) {
+          buffer_pool_manager_->UnpinPage(prev_page_id, true);
+        }
+        return undo();
+      }
+      new_page_ids.push_back(page_id);
+      page->Init();
+      const auto size = static_cast<uint32_t>(std::min(ColumnSegmentPage::DATA_CAPACITY, data.size() - offset));
+      memcpy(page->GetSegmentData(), data.data() + offset, size);
+      page->SetDataSize(size);
+      if (prev_page != nullptr) {
+        prev_page->SetNextPageId(page_id);
+        buffer_pool_manager_->UnpinPage(prev_page_id, true);
+      } else {
+        segment.first_page_id_ = page_id;
+      }
+      prev_page = page;
+      prev_page_id = page_id;
+      segment.page_count_++;
+    }
+    buffer_pool_manager_->UnpinPage(prev_page_id, true);
+    segments.push_back(segment);
+    segment_last_page_ids.push_back(prev_page_id);
+  }
+
+  for (uint32_t i = 0; i < column_count; i++) {
+    if (last_page_ids_[i] == INVALID_PAGE_ID) {
+      first_page_ids_[i] = segments[i].first_page_id_;
+    } else {
+      auto *last_page = reinterpret_cast<ColumnSegmentPage *>(buffer_pool_manager_->FetchPage(last_page_ids_[i]));
+      if (last_page == nullptr) {
+        throw Exception(ExceptionType::OUT_OF_MEMORY, "no frame to link a column segment into");
+      }
+      last_page->SetNextPageId(segments[i].first_page_id_);
+      buffer_pool_manager_->UnpinPage(last_page_ids_[i], true);
+    }
+    last_page_ids_[i] = segment_last_page_ids[i];
+    tail_[i].clear();
+  }
+  segments_.push_back(std::move(segments));
+  deleted_.emplace_back();
+  return true;
+}
+
+void ColumnTable::ReadSegment(const Segment &segment, BufferAccessStrategy *strategy, std::vector<char> *data) {
+  data->resize(segment.size_);
+  page_id_t page_id = segment.first_page_id_;
+  size_t offset = 0;
+  for (uint32_t i = 0; i < segment.page_count_; i++) {
+    auto *page = reinterpret_cast<ColumnSegmentPage *>(buffer_pool_manager_->FetchPage(page_id, strategy));
+    if (page == nullptr) {
+      throw Exception(ExceptionType::OUT_OF_MEMORY, "no frame to read a column segment into");
+    }
+    memcpy(data->data() + offset, page->GetSegmentData(), page->GetDataSize());
+    offset += page->GetDataSize();
+    const page_id_t next_page_id = page->GetNextPageId();
+    buffer_pool_manager_->UnpinPage(page_id, false);
+    page_id = next_page_id;
+  }
+}
+
+}  // namespace bustub
@@ -0,0 +1,270 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// free_space_map.cpp
+//
+// Identification: src/storage/table/free_space_map.cpp
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/table/free_space_map.h"
+
+#include <algorithm>
+#include <unordered_set>
+
+#include "common/exception.h"
+#include "storage/page/free_space_map_page.h"
+#include "storage/page/table_page.h"
+
+namespace bustub {
+
+FreeSpaceMap::~FreeSpaceMap() {
+  for (const page_id_t map_page_id : map_page_ids_) {
+    buffer_pool_manager_->UnpinPage(map_page_id, false);
+  }
+}
+
+auto FreeSpaceMap::Open(page_id_t map_page_id, page_id_t first_heap_page_id) -> page_id_t {
+  std::scoped_lock lock(latch_);
+  if (map_page_id == INVALID_PAGE_ID) {
+    auto *map_page =
+        reinterpret_cast<FreeSpaceMapPage *>(buffer_pool_manager_->NewPage(&map_page_id, first_heap_page_id));
+    if (map_page == nullptr) {
+      throw Exception(ExceptionType::OUT_OF_MEMORY, "no frame for the free space map of a table");
+    }
+    map_page->Init();
+    buffer_pool_manager_->UnpinPage(map_page_id, true);
+  }
+
+  for (page_id_t page_id = map_page_id; page_id != INVALID_PAGE_ID;) {
+    auto *map_page = reinterpret_cast<FreeSpaceMapPage *>(buffer_pool_manager_->FetchPage(page_id));
+    if (map_page == nullptr) {
+      throw Exception(ExceptionType::OUT_OF_MEMORY, "no frame for the free space map of a table");
+    }
+    // the page keeps this pin until the map is closed
+    map_page_ids_.push_back(page_id);
+    max_free_units_.push_back(0);
+    for (uint32_t i = 0; i < map_page->GetEntryCount(); i++) {
+      if (map_page->GetHeapPageId(i) == INVALID_PAGE_ID) {
+        num_removed_++;
+      } else {
+        entry_of_page_[map_page->GetHeapPageId(i)] = heap_page_ids_.size();
+      }
+      heap_page_ids_.push_back(map_page->GetHeapPageId(i));
+      free_units_.push_back(map_page->GetFreeUnits(i));
+      max_free_units_.back() = std::max(max_free_units_.back(), map_page->GetFreeUnits(i));
+    }
+    page_id = map_page->GetNextPageId();
+  }
+
+  // The map is checked against the chain of the heap, which it may have fallen behind of, e.g. because of a crash.
+  std::vector<page_id_t> chain_page_ids;
+  std::vector<uint32_t> chain_free_spaces;
+  for (page_id_t page_id = first_heap_page_id; page_id != INVALID_PAGE_ID;) {
+    auto *page = reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(page_id));
+    if (page == nullptr) {
+      throw Exception(ExceptionType::OUT_OF_MEMORY, "no frame for a page of a table");
+    }
+    chain_page_ids.push_back(page_id);
+    chain_free_spaces.push_back(page->GetFreeSpaceRemaining());
+    const page_id_t next_page_id = page->GetNextPageId();
+    buffer_pool_manager_->UnpinPage(page_id, false);
+    page_id = next_page_id;
+  }
+  const std::unordered_set<page_id_t> chain(chain_page_ids.begin(), chain_page_ids.end());
+
+  // A map that does not start with the heap was never written; one that ends with a page which is no longer in the
+  // heap does not know where the heap ends. Either is built again from the heap, and further pages of it are not
+  // reused.
+  if (heap_page_ids_.empty() || heap_page_ids_[0] != first_heap_page_id || chain.count(heap_page_ids_.back()) == 0) {
+    for (const page_id_t pinned_page_id : map_page_ids_) {
+      buffer_pool_manager_->UnpinPage(pinned_page_id, false);
+    }
+    map_page_ids_.clear();
+    auto *map_page = reinterpret_cast<FreeSpaceMapPage *>(buffer_pool_manager_->FetchPage(map_page_id));
+    if (map_page == nullptr) {
+      throw Exception(ExceptionType::OUT_OF_MEMORY, "no frame for the free space map of a table");
+    }
+    map_page->Init();
+    buffer_pool_manager_->UnpinPage(map_page_id, true);
+    PinMapPage(map_page_id);
+    max_free_units_ = {0};
+    heap_page_ids_.clear();
+    free_units_.clear();
+    entry_of_page_.clear();
+    num_removed_ = 0;
+  }
+
+  // drop the pages that were unlinked from the heap after the map was last written
+  for (size_t i = 0; i < heap_page_ids_.size(); i++) {
+    if (heap_page_ids_[i] != INVALID_PAGE_ID && chain.count(heap_page_ids_[i]) == 0) {
+      RemoveEntry(i);
+    }
+  }
+
+  // add the pages that were linked to the heap after the map was last written
+  size_t next = 0;
+  if (!heap_page_ids_.empty()) {
+    next = std::find(chain_page_ids.begin(), chain_page_ids.end(), heap_page_ids_.back()) - chain_page_ids.begin() + 1;
+  }
+  for (; next < chain_page_ids.size(); next++) {
+    AppendEntry(chain_page_ids[next], FreeSpaceMapPage::ToFreeUnits(chain_free_spaces[next]));
+  }
+  return map_page_id;
+}
+
+auto FreeSpaceMap::FindPage(uint32_t space) -> page_id_t {
+  const uint32_t needed = (space + FreeSpaceMapPage::FREE_SPACE_UNIT - 1) / FreeSpaceMapPage::FREE_SPACE_UNIT;
+  std::scoped_lock lock(latch_);
+  if (hint_ < heap_page_ids_.size() && free_units_[hint_] >= needed) {
+    return heap_page_ids_[hint_];
+  }
+  for (size_t map_index = 0; map_index < map_page_ids_.size(); map_index++) {
+    if (max_free_units_[map_index] < needed) {
+      continue;
+    }
+    const size_t begin = map_index * FreeSpaceMapPage::CAPACITY;
+    const size_t end = std::min(begin + FreeSpaceMapPage::CAPACITY, heap_page_ids_.size());
+    uint8_t max_free_units = 0;
+    for (size_t i = begin; i < end; i++) {
+      if (free_units_[i] >= needed) {
+        hint_ = i;
+        return heap_page_ids_[i];
+      }
+      max_free_units = std::max(max_free_units, free_units_[i]);
+    }
+    // the bound only ever rises on updates, so a search that comes up empty tightens it
+    max_free_units_[map_index] = max_free_units;
+  }
+  return INVALID_PAGE_ID;
+}
+
+void FreeSpaceMap::Update(page_id_t heap_page_id, uint32_t free_space) {
+  std::scoped_lock lock(latch_);
+  const auto entry = entry_of_page_.find(heap_page_id);
+  if (entry == entry_of_page_.end()) {
+    return;
+  }
+  const size_t index = entry->second;
+  const uint8_t free_units = FreeSpaceMapPage::ToFreeUnits(free_space);
+  if (free_units_[index] == free_units) {
+    return;
+  }
+  free_units_[index] = free_units;
+  auto &max_free_units = max_free_units_[index / FreeSpaceMapPage::CAPACITY];
+  max_free_units = std::max(max_free_units, free_units);
+  StoreEntry(index);
+}
+
+void FreeSpaceMap::Append(page_id_t heap_page_id, uint32_t free_space) {
+  std::scoped_lock lock(latch_);
+  AppendEntry(heap_page_id, FreeSpaceMapPage::ToFreeUnits(free_space));
+  // inserts that follow go to the new page
+  hint_ = heap_page_ids_.size() - 1;
+}
+
+void FreeSpaceMap::Remove(page_id_t heap_page_id) {
+  std::scoped_lock lock(latch_);
+  const auto entry = entry_of_page_.find(heap_page_id);
+  if (entry == entry_of_page_.end()) {
+    return;
+  }
+  BUSTUB_ASSERT(entry->second + 1 < heap_page_ids_.size(), "the last page of a heap stays in it");
+  RemoveEntry(entry->second);
+}
+
+auto FreeSpaceMap::GetLastPageId() -> page_id_t {
+  std::scoped_lock lock(latch_);
+  return heap_page_ids_.back();
+}
+
+auto FreeSpaceMap::GetNextPageIds(page_id_t heap_page_id, size_t count) -> std::vector<page_id_t> {
+  std::scoped_lock lock(latch_);
+  std::vector<page_id_t> page_ids;
+  const auto entry = entry_of_page_.find(heap_page_id);
+  if (entry == entry_of_page_.end()) {
+    return page_ids;
+  }
+  for (size_t i = entry->second + 1; i < heap_page_ids_.size() && page_ids.size() < count; i++) {
+    if (heap_page_ids_[i] != INVALID_PAGE_ID) {
+      page_ids.push_back(heap_page_ids_[i]);
+    }
+  }
+  return page_ids;
+}
+
+auto FreeSpaceMap::GetFreeSpace(page_id_t heap_page_id) -> uint32_t {
+  std::scoped_lock lock(latch_);
+  const auto entry = entry_of_page_.find(heap_page_id);
+  return entry == entry_of_page_.end() ? 0 : free_units_[entry->second] * FreeSpaceMapPage::FREE_SPACE_UNIT;
+}
+
+auto FreeSpaceMap::GetNumPages() -> size_t {
+  std::scoped_lock lock(latch_);
+  return heap_page_ids_.size() - num_removed_;
+}
+
+void FreeSpaceMap::AppendEntry(page_id_t heap_page_id, uint8_t free_units) {
+  if (heap_page_ids_.size() == map_page_ids_.size() * FreeSpaceMapPage::CAPACITY) {
+    const page_id_t last_map_page_id = map_page_ids_.back();
+    page_id_t map_page_id;
+    auto *map_page =
+        reinterpret_cast<FreeSpaceMapPage *>(buffer_pool_manager_->NewPage(&map_page_id, last_map_page_id));
+    if (map_page == nullptr) {
+      throw Exception(ExceptionType::OUT_OF_MEMORY, "no frame for the free space map of a table");
+    }
+    map_page->Init();
+    buffer_pool_manager_->UnpinPage(map_page_id, true);
+    PinMapPage(map_page_id);
+    max_free_units_.push_back(0);
+    auto *last_map_page = reinterpret_cast<FreeSpaceMapPage *>(buffer_pool_manager_->FetchPage(last_map_page_id));
+    last_map_page->WLatch();
+    last_map_page->SetNextPageId(map_page_id);
+    last_map_page->WUnlatch();
+    buffer_pool_manager_->UnpinPage(last_map_page_id, true);
+  }
+
+  entry_of_page_[heap_page_id] = heap_page_ids_.size();
+  heap_page_ids_.push_back(heap_page_id);
+  free_units_.push_back(free_units);
+  max_free_units_.back() = std::max(max_free_units_.back(), free_units);
+
+  const page_id_t map_page_id = map_page_ids_.back();
+  auto *map_page = reinterpret_cast<FreeSpaceMapPage *>(buffer_pool_manager_->FetchPage(map_page_id));
+  map_page->WLatch();
+  map_page->Append(heap_page_id, free_units);
+  map_page->WUnlatch();
+  buffer_pool_manager_->UnpinPage(map_page_id, true);
+}
+
+void FreeSpaceMap::StoreEntry(size_t index) {
+  const page_id_t map_page_id = map_page_ids_[index / FreeSpaceMapPage::CAPACITY];
+  // the map page is pinned, so fetching it takes no frame and cannot fail
+  auto *map_page = reinterpret_cast<FreeSpaceMapPage *>(buffer_pool_manager_->FetchPage(map_page_id));
+  BUSTUB_ASSERT(map_page != nullptr, "the pages of an open free space map are pinned");
+  map_page->WLatch();
+  map_page->SetHeapPageId(index % FreeSpaceMapPage::CAPACITY, heap_page_ids_[index]);
+  map_page->SetFreeUnits(index % FreeSpaceMapPage::CAPACITY, free_units_[index]);
+  map_page->WUnlatch();
+  buffer_pool_manager_->UnpinPage(map_page_id, true);
+}
+
+void FreeSpaceMap::PinMapPage(page_id_t map_page_id) {
+  if (buffer_pool_manager_->FetchPage(map_page_id) == nullptr) {
+    throw Exception(ExceptionType::OUT_OF_MEMORY, "no frame for the free space map of a table");
+  }
+  map_page_ids_.push_back(map_page_id);
+}
+
+void FreeSpaceMap::RemoveEntry(size_t index) {
+  entry_of_page_.erase(heap_page_ids_[index]);
+  heap_page_ids_[index] = INVALID_PAGE_ID;
+  free_units_[index] = 0;
+  num_removed_++;
+  StoreEntry(index);
+}
+
+}  // namespace bustub
@@ -10,8 +10,12 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <algorithm>
+#include <array>
 #include <cassert>
+#include <utility>
 
+#include "common/exception.h"
 #include "common/logger.h" 
 #include "fmt/format.h"
 #include "storage/table/table_heap.h"
@@ -23,165 +27,408 @@ TableHeap::TableHeap(BufferPoolManager *buffer_pool_manager, LockManager *lock_m
     : buffer_pool_manager_(buffer_pool_manager),
       lock_manager_(lock_manager),
       log_manager_(log_manager),
-      first_page_id_(first_page_id) {}
+      first_page_id_(first_page_id),
+      free_space_map_(buffer_pool_manager) {
+  OpenFreeSpaceMap();
+  auto first_page = static_cast<TablePage *>(buffer_pool_manager_->FetchPage(first_page_id_));
+  BUSTUB_ASSERT(first_page != nullptr, "Couldn't fetch the first page of the table heap.");
+  pax_column_types_ = first_page->GetPaxColumnTypes();
+  pax_capacity_ = first_page->GetPaxCapacity();
+  buffer_pool_manager_->UnpinPage(first_page_id_, false);
+}
 
 TableHeap::TableHeap(BufferPoolManager *buffer_pool_manager, LockManager *lock_manager, LogManager *log_manager,
                      Transaction *txn)
-    : buffer_pool_manager_(buffer_pool_manager), lock_manager_(lock_manager), log_manager_(log_manager) {
+    : buffer_pool_manager_(buffer_pool_manager),
+      lock_manager_(lock_manager),
+      log_manager_(log_manager),
+      free_space_map_(buffer_pool_manager) {
   // Initialize the first table page.
-  auto first_page = reinterpret_cast<TablePage *>(buffer_pool_manager_->NewPage(&first_page_id_));
+  auto first_page = reinterpret_cast<TablePage *>(buffer_pool_manager_->NewPage(&first_page_id_, INVALID_PAGE_ID));
   BUSTUB_ASSERT(first_page != nullptr,
                 "Couldn't create a page for the table heap. Have you completed the buffer pool manager project?");
   first_page->Init(first_page_id_, BUSTUB_PAGE_SIZE, INVALID_LSN, log_manager_, txn);
   buffer_pool_manager_->UnpinPage(first_page_id_, true);
+  OpenFreeSpaceMap();
+}
+
+void TableHeap::OpenFreeSpaceMap() {
+  auto first_page = static_cast<TablePage *>(buffer_pool_manager_->FetchPage(first_page_id_));
+  BUSTUB_ASSERT(first_page != nullptr, "Couldn't fetch the first page of the table heap.");
+  const page_id_t map_page_id = first_page->GetFreeSpaceMapPageId();
+  const page_id_t opened_map_page_id = free_space_map_.Open(map_page_id, first_page_id_);
+  if (opened_map_page_id != map_page_id) {
+    first_page->WLatch();
+    first_page->SetFreeSpaceMapPageId(opened_map_page_id);
+    first_page->WUnlatch();
+  }
+  buffer_pool_manager_->UnpinPage(first_page_id_, opened_map_page_id != map_page_id);
+}
+
+void TableHeap::EnableZoneMap(const Schema &schema) {
+  if (zone_map_ != nullptr || !ZoneMap::HasTrackedColumns(schema)) {
+    return;
+  }
+  zone_map_ = std::make_unique<ZoneMap>(buffer_pool_manager_, schema);
+  auto first_page = static_cast<TablePage *>(buffer_pool_manager_->FetchPage(first_page_id_));
+  BUSTUB_ASSERT(first_page != nullptr, "Couldn't fetch the first page of the table heap.");
+  const page_id_t map_page_id = first_page->GetZoneMapPageId();
+  const page_id_t opened_map_page_id = zone_map_->Open(map_page_id, first_page_id_);
+  if (opened_map_page_id != map_page_id) {
+    first_page->WLatch();
+    first_page->SetZoneMapPageId(opened_map_page_id);
+    first_page->WUnlatch();
+  }
+  buffer_pool_manager_->UnpinPage(first_page_id_, opened_map_page_id != map_page_id);
+}
+
+void TableHeap::UsePaxLayout(const Schema &schema) {
+  std::vector<TypeId> column_types;
+  for (const auto &column : schema.GetColumns()) {
+    column_types.push_back(column.GetType());
+  }
+  pax_capacity_ = TablePage::PaxCapacity(column_types);
+  if (pax_capacity_ == 0) {
+    throw Exception(ExceptionType::INVALID, "the pax layout needs fixed-width columns that fit 8 rows into a page");
+  }
+  pax_column_types_ = std::move(column_types);
+  auto first_page = static_cast<TablePage *>(buffer_pool_manager_->FetchPage(first_page_id_));
+  BUSTUB_ASSERT(first_page != nullptr, "Couldn't fetch the first page of the table heap.");
+  first_page->WLatch();
+  first_page->InitPax(pax_column_types_);
+  const uint32_t free_space = first_page->GetFreeSpaceRemaining();
+  first_page->WUnlatch();
+  buffer_pool_manager_->UnpinPage(first_page_id_, true);
+  free_space_map_.Update(first_page_id_, free_space);
 }
 
 auto TableHeap::InsertTuple(const TupleRecord &tuple, RID *rid, Transaction *txn) -> bool {
- 
-  auto cur_page = static_cast<TablePage *>(buffer_pool_manager_->FetchPage(first_page_id_));
-  if (cur_page == nullptr) {
-    txn->SetState(TransactionState::ABORTED);
+  // a tuple read from a table has to bring its overflow with it
+  tuple.LoadOverflow();
+  const bool inserted = tuple.size_ > TablePage::MAX_TUPLE_SIZE ? InsertOverflowTuple(tuple, rid, txn)
+                                                                 : PlaceTuple(tuple, rid, txn);
+  if (!inserted) {
     return false;
   }
+  // Update the transaction's write set.
+  txn->GetWriteSet()->emplace_back(*rid, WType::INSERT, TupleRecord{}, this);
+  return true;
+}
 
-
-  if (tuple.size_ + 32 > BUSTUB_PAGE_SIZE) { 
-    //  LOG_DEBUG("Overflowing...."); // larger than one page size
-    // txn->SetState(TransactionState::ABORTED); 
-    page_id_t over_flow_id;
-    auto overFlowPage = static_cast<OverFlowPage *>(buffer_pool_manager_->NewPage(&over_flow_id));
-      if (overFlowPage == nullptr) {
-        txn->SetState(TransactionState::ABORTED);
-        return false;
+auto TableHeap::InsertTuples(const std::vector<const TupleRecord *> &tuples, std::vector<RID> *rids, Transaction *txn)
+    -> bool {
+  rids->clear();
+  rids->reserve(tuples.size());
+  size_t next = 0;
+  bool inserted = true;
+  for (const auto *tuple : tuples) {
+    tuple->LoadOverflow();
+  }
+  while (inserted && next < tuples.size()) {
+    if (tuples[next]->size_ > TablePage::MAX_TUPLE_SIZE) {
+      RID rid;
+      inserted = InsertOverflowTuple(*tuples[next], &rid, txn);
+      if (inserted) {
+        rids->push_back(rid);
+        next++;
       }
-      //SHOULD I LOOK FOR THE LAST PAGE OR I MAKE TUPLE CAN BE WITH AVAILABLE SIZE AND AN OVERFLOW ? (THIS DECISSION AFFECT WHETHER OVERFLOWID IN IN TUPLE LIKE SQLITE) OR NOT LOOKHERE
-      //Searching for the last page in the table_heap (SEQUENTIAL FILE ORGANIZATION SUCKS!!!)
-      cur_page->WLatch();
-      overFlowPage->WLatch();
-      auto next_page_id = cur_page->GetNextPageId();
-      while (next_page_id != INVALID_PAGE_ID) {
-      auto next_page = static_cast<TablePage *>(buffer_pool_manager_->FetchPage(next_page_id));
-      next_page->WLatch();
-      buffer_pool_manager_->UnpinPage(cur_page->GetTablePageId(), false);
-      cur_page->WUnlatch();
-      cur_page = next_page;
-      next_page_id = cur_page->GetNextPageId();
+      continue;
+    }
+    inserted = PlaceTuples(tuples, &next, rids, txn);
+  }
+  // Update the transaction's write set, once for the whole batch.
+  auto write_set = txn->GetWriteSet();
+  for (const auto &rid : *rids) {
+    write_set->emplace_back(rid, WType::INSERT, TupleRecord{}, this);
+  }
+  return inserted;
+}
+
+auto TableHeap::InsertOverflowTuple(const TupleRecord &tuple, RID *rid, Transaction *txn) -> bool {
+  // The first part of the tuple fills a page of the heap, the rest goes to a chain of overflow pages. The chain is
+  // written first, so the part in the heap never points to a chain that is not there yet.
+  std::vector<page_id_t> page_ids;
+  if (!WriteOverflow(tuple.data_ + TablePage::MAX_TUPLE_SIZE, tuple.size_ - TablePage::MAX_TUPLE_SIZE, &page_ids,
+                     txn)) {
+    DeleteOverflow(page_ids);
+    return false;
+  }
+  std::array<char, TablePage::MAX_TUPLE_SIZE> head_data;
+  const TupleRecord head = MakeOverflowHead(tuple, page_ids[0], head_data.data());
+  if (!PlaceTuple(head, rid, txn)) {
+    DeleteOverflow(page_ids);
+    return false;
+  }
+  return true;
+}
+
+auto TableHeap::UpdateOverflowTuple(const TupleRecord &tuple, const RID &rid, Transaction *txn, bool *is_updated)
+    -> bool {
+  auto page = static_cast<TablePage *>(buffer_pool_manager_->FetchPage(rid.GetPageId()));
+  if (page == nullptr) {
+    return false;
+  }
+  page->WLatch();
+  TupleRecord old_tuple;
+  std::vector<page_id_t> old_page_ids;
+  if (!page->GetTuple(rid, &old_tuple, txn, lock_manager_) || old_tuple.GetOverFlowPageId() == INVALID_PAGE_ID) {
+    page->WUnlatch();
+    buffer_pool_manager_->UnpinPage(rid.GetPageId(), false);
+    return false;
+  }
+  if (!CollectOverflow(old_tuple.GetOverFlowPageId(), &old_page_ids)) {
+    page->WUnlatch();
+    buffer_pool_manager_->UnpinPage(rid.GetPageId(), false);
+    txn->SetState(TransactionState::ABORTED);
+    *is_updated = false;
+    return true;
+  }
+
+  // The old value kept for rollbacks brings its overflow with it. The new value goes to a new chain: a reader that got
+  // the row before may still read the old chain, which is retired and only freed once no such reader is left.
+  old_tuple.overflow_bpm_ = buffer_pool_manager_;
+  old_tuple.LoadOverflow();
+  std::vector<page_id_t> page_ids;
+  *is_updated =
+      WriteOverflow(tuple.data_ + TablePage::MAX_TUPLE_SIZE, tuple.size_ - TablePage::MAX_TUPLE_SIZE, &page_ids, txn);
+  if (*is_updated) {
+    std::array<char, TablePage::MAX_TUPLE_SIZE> head_data;
+    const TupleRecord head = MakeOverflowHead(tuple, page_ids[0], head_data.data());
+    TupleRecord replaced;
+    // the part in the heap has the same size as before, so it always fits
+    *is_updated = page->UpdateTuple(head, &replaced, rid, txn, lock_manager_, log_manager_);
+  }
+  page->WUnlatch();
+  buffer_pool_manager_->UnpinPage(rid.GetPageId(), *is_updated);
+  if (!*is_updated) {
+    DeleteOverflow(page_ids);
+    return true;
+  }
+  RetireOverflow(old_page_ids);
+  if (txn->GetState() != TransactionState::ABORTED) {
+    txn->GetWriteSet()->emplace_back(rid, WType::UPDATE, old_tuple, this);
+  }
+  return true;
+}
+
+auto TableHeap::WriteOverflow(const char *data, uint32_t size, std::vector<page_id_t> *page_ids, Transaction *txn)
+    -> bool {
+  OverFlowPage *prev_page = nullptr;
+  page_id_t prev_page_id = INVALID_PAGE_ID;
+  for (uint32_t written = 0; written < size;) {
+    page_id_t page_id = INVALID_PAGE_ID;
+    // New pages go next to the last page of the chain, or of the chain written before, which keeps the chains of the
+    // table in extents of their own and every chain in a run of adjacent pages.
+    const page_id_t near_page_id = prev_page != nullptr ? prev_page_id : last_overflow_page_id_.load();
+    auto page = static_cast<OverFlowPage *>(buffer_pool_manager_->NewPage(&page_id, near_page_id));
+    if (page != nullptr) {
+      page->Init(page_id, BUSTUB_PAGE_SIZE, INVALID_PAGE_ID, log_manager_, txn);
+      page_ids->push_back(page_id);
+      if (prev_page != nullptr) {
+        prev_page->SetNextPageId(page_id);
       }
-      auto new_page = static_cast<TablePage *>(buffer_pool_manager_->NewPage(&next_page_id));
-      if (new_page == nullptr) {
-        // Then life sucks and we abort the transaction.
-        cur_page->WUnlatch();
-        buffer_pool_manager_->UnpinPage(cur_page->GetTablePageId(), false);
-        txn->SetState(TransactionState::ABORTED);
-        return false;
+    }
+    if (prev_page != nullptr) {
+      prev_page->WUnlatch();
+      buffer_pool_manager_->UnpinPage(prev_page_id, true);
+    }
+    if (page == nullptr) {
+      txn->SetState(TransactionState::ABORTED);
+      return false;
+    }
+    page->WLatch();
+    // the payload goes straight from the tuple into the page
+    const uint32_t chunk = std::min<uint32_t>(size - written, OverFlowPage::MAX_DATA_SIZE);
+    page->SetChainSize(size - written);
+    page->InsertOverFlowedData(data + written, chunk);
+    written += chunk;
+    prev_page = page;
+    prev_page_id = page_id;
+  }
+  prev_page->WUnlatch();
+  buffer_pool_manager_->UnpinPage(prev_page_id, true);
+  last_overflow_page_id_ = prev_page_id;
+  return true;
+}
+
+auto TableHeap::CollectOverflow(page_id_t page_id, std::vector<page_id_t> *page_ids) -> bool {
+  while (page_id != INVALID_PAGE_ID) {
+    auto page = static_cast<OverFlowPage *>(buffer_pool_manager_->FetchPage(page_id));
+    if (page == nullptr) {
+      return false;
+    }
+    page_ids->push_back(page_id);
+    page_id = page->GetNextPageId();
+    buffer_pool_manager_->UnpinPage(page_ids->back(), false);
+  }
+  return true;
+}
+
+void TableHeap::DeleteOverflow(const std::vector<page_id_t> &page_ids) {
+  for (const auto page_id : page_ids) {
+    buffer_pool_manager_->DeletePage(page_id);
+  }
+}
+
+void TableHeap::RetireOverflow(const std::vector<page_id_t> &page_ids) {
+  EnterHeap();
+  {
+    std::scoped_lock retired_lock(retired_latch_);
+    retired_pages_.insert(retired_pages_.end(), page_ids.begin(), page_ids.end());
+    has_retired_pages_ = true;
+  }
+  LeaveHeap();
+}
+
+auto TableHeap::VisitOverflow() -> std::shared_ptr<void> {
+  EnterHeap();
+  // like an iterator, the tuple may outlive the heap, so the retired pages are left to the next visitor to free
+  return {nullptr, [num_visitors = num_visitors_](void * /*unused*/) { (*num_visitors)--; }};
+}
+
+auto TableHeap::MakeOverflowHead(const TupleRecord &tuple, page_id_t overflow_page_id, char *data) -> TupleRecord {
+  // the only copy of tuple data on the way to disk, and it is bounded by the page size
+  memcpy(data, tuple.data_, TablePage::MAX_TUPLE_SIZE);
+  TupleRecord head;
+  head.data_ = data;
+  head.size_ = TablePage::MAX_TUPLE_SIZE;
+  head.rid_ = tuple.rid_;
+  head.SetOverFlowPageId(overflow_page_id);
+  return head;
+}
+
+auto TableHeap::PlaceTuple(const TupleRecord &tuple, RID *rid, Transaction *txn) -> bool {
+  const std::vector<const TupleRecord *> tuples{&tuple};
+  std::vector<RID> rids;
+  size_t next = 0;
+  if (!PlaceTuples(tuples, &next, &rids, txn)) {
+    return false;
+  }
+  *rid = rids[0];
+  return true;
+}
+
+auto TableHeap::PlaceTuples(const std::vector<const TupleRecord *> &tuples, size_t *next, std::vector<RID> *rids,
+                            Transaction *txn) -> bool {
+  // Insert into a page that the free space map says has room for the next tuple. The map can be off, so a page that
+  // turns out to be too full gets its entry corrected and the search goes on.
+  // The page may also be unlinked from the list before it is latched, which leaves it without room; the insert is
+  // counted as a visitor, so that the page is not freed meanwhile.
+  const uint32_t space = tuples[*next]->size_ + TablePage::SIZE_TUPLE;
+  EnterHeap();
+  for (page_id_t page_id = free_space_map_.FindPage(space); page_id != INVALID_PAGE_ID;
+       page_id = free_space_map_.FindPage(space)) {
+    auto page = static_cast<TablePage *>(buffer_pool_manager_->FetchPage(page_id));
+    if (page == nullptr) {
+      LeaveHeap();
+      txn->SetState(TransactionState::ABORTED);
+      return false;
+    }
+    page->WLatch();
+    const size_t inserted = FillPage(page, tuples, next, rids, txn);
+    const uint32_t free_space = page->GetFreeSpaceRemaining();
+    page->WUnlatch();
+    buffer_pool_manager_->UnpinPage(page_id, inserted > 0);
+    free_space_map_.Update(page_id, free_space);
+    if (inserted > 0) {
+      LeaveHeap();
+      return true;
+    }
+  }
+  LeaveHeap();
+  return AppendTuples(tuples, next, rids, txn);
+}
+
+auto TableHeap::AppendTuples(const std::vector<const TupleRecord *> &tuples, size_t *next, std::vector<RID> *rids,
+                             Transaction *txn) -> bool {
+  std::scoped_lock append_lock(append_latch_);
+  page_id_t page_id = free_space_map_.GetLastPageId();
+  auto page = static_cast<TablePage *>(buffer_pool_manager_->FetchPage(page_id));
+  if (page == nullptr) {
+    txn->SetState(TransactionState::ABORTED);
+    return false;
+  }
+  page->WLatch();
+  // another insert may have appended a page while this one waited for the latch
+  FillPage(page, tuples, next, rids, txn);
+  bool is_last_in_map = true;
+
+  // link new pages until every tuple up to the next one that needs overflow pages is in
+  while (*next < tuples.size() && tuples[*next]->size_ <= TablePage::MAX_TUPLE_SIZE) {
+    page_id_t new_page_id;
+    auto new_page = static_cast<TablePage *>(buffer_pool_manager_->NewPage(&new_page_id, page_id));
+    // If we could not create a new page,
+    if (new_page == nullptr) {
+      // Then life sucks and we abort the transaction.
+      const uint32_t free_space = page->GetFreeSpaceRemaining();
+      page->WUnlatch();
+      buffer_pool_manager_->UnpinPage(page_id, true);
+      if (is_last_in_map) {
+        free_space_map_.Update(page_id, free_space);
+      } else {
+        free_space_map_.Append(page_id, free_space);
       }
-      new_page->WLatch();
-      cur_page->SetNextPageId(next_page_id);
-      new_page->Init(next_page_id, BUSTUB_PAGE_SIZE, cur_page->GetTablePageId(), log_manager_, txn);
-      overFlowPage->Init(over_flow_id, BUSTUB_PAGE_SIZE, INVALID_PAGE_ID, log_manager_, txn);
-      cur_page->WUnlatch();
-      buffer_pool_manager_->UnpinPage(cur_page->GetTablePageId(), true);
-
-      //Split the Tuple 
-       TupleRecord leftTuple;
-       size_t tupleInPageSize = BUSTUB_PAGE_SIZE - 32; //this 32 for slotted page metadata (why i am aware of this in the heap? LOOKHERE)
-       char*overFlowedData;
-       SplitData(tuple.data_, tuple.size_, &leftTuple.data_, tupleInPageSize, &overFlowedData, tuple.size_ - tupleInPageSize);
-      //  LOG_DEBUG("First Page Size = %d", (int)tupleInPageSize);
-        // LOG_DEBUG("Second Page Size = %d", (int)(tuple.size_ - tupleInPageSize));
-         
-   
-       leftTuple.rid_ = tuple.rid_;
-       leftTuple.allocated_ = tuple.allocated_;
-       leftTuple.size_ = tupleInPageSize;
-       leftTuple.SetOverFlowPageId(over_flow_id);
-       
-       bool result =  new_page->InsertTuple(leftTuple, rid, txn, lock_manager_, log_manager_);
-       new_page->WUnlatch();
-       buffer_pool_manager_->UnpinPage(next_page_id, true);
-       auto overFlowedDataSize = tuple.size_ - tupleInPageSize;
-       //Here we will check if the overFlowedData need another overFlowPages?
-       while (overFlowedDataSize > 0) {
-          if (overFlowedDataSize > BUSTUB_PAGE_SIZE - 12) {
-            page_id_t over_flow_id;
-            auto newOverFlowPage = static_cast<OverFlowPage *>(buffer_pool_manager_->NewPage(&over_flow_id));
-            newOverFlowPage->Init(over_flow_id, BUSTUB_PAGE_SIZE, INVALID_PAGE_ID, log_manager_, txn);
-            char *overFlowedTemp;
-            char * overFlowRemain;
-            SplitData(overFlowedData, overFlowedDataSize, &overFlowedTemp, BUSTUB_PAGE_SIZE - 12, &overFlowRemain, overFlowedDataSize - (BUSTUB_PAGE_SIZE - 12));
-            overFlowPage->SetNextPageId(over_flow_id);
-            overFlowPage->SetTupleSize(BUSTUB_PAGE_SIZE - 12);
-            overFlowPage->InsertOverFlowedData(overFlowedTemp, BUSTUB_PAGE_SIZE - 12);
-            overFlowPage->WUnlatch();
-            buffer_pool_manager_->UnpinPage(over_flow_id, true);
-            delete []overFlowedData;
-            delete[]overFlowedTemp;
-            overFlowedData = overFlowRemain;
-            overFlowedDataSize -= (BUSTUB_PAGE_SIZE - 12);
-            buffer_pool_manager_->UnpinPage(overFlowPage->GetPageId(), true);
-            overFlowPage = newOverFlowPage;
-            overFlowPage->WLatch();
-          } else {
-           overFlowPage->InsertOverFlowedData(overFlowedData, overFlowedDataSize);
-           overFlowPage->SetTupleSize(overFlowedDataSize);
-           overFlowPage->WUnlatch(); //Pin l awl wla unLatch ana nasy (LOOKHERE)
-           buffer_pool_manager_->UnpinPage(overFlowPage->GetPageId(), true);
-           overFlowedDataSize = 0;
-           delete[] overFlowedData;
-          }
-
-       }
-   
-       txn->GetWriteSet()->emplace_back(*rid, WType::INSERT, TupleRecord{}, this);
-       
-       return result;
-  } 
-
-  cur_page->WLatch();
-
-  // Insert into the first page with enough space. If no such page exists, create a new page and insert into that.
-  // INVARIANT: cur_page is WLatched if you leave the loop normally.
-  while (!cur_page->InsertTuple(tuple, rid, txn, lock_manager_, log_manager_)) {
-    auto next_page_id = cur_page->GetNextPageId();
-    // If the next page is a valid page,
-    if (next_page_id != INVALID_PAGE_ID) {
-      auto next_page = static_cast<TablePage *>(buffer_pool_manager_->FetchPage(next_page_id));
-      next_page->WLatch();
-      // Unlatch and unpin the current page.
-      cur_page->WUnlatch();
-      buffer_pool_manager_->UnpinPage(cur_page->GetTablePageId(), false);
-      cur_page = next_page;
+      txn->SetState(TransactionState::ABORTED);
+      return false;
+    }
+    // Otherwise we were able to create a new page. We initialize it now.
+    new_page->WLatch();
+    page->SetNextPageId(new_page_id);
+    new_page->Init(new_page_id, BUSTUB_PAGE_SIZE, page_id, log_manager_, txn);
+    if (!pax_column_types_.empty()) {
+      new_page->InitPax(pax_column_types_);
+    }
+    if (zone_map_ != nullptr) {
+      zone_map_->Append(new_page_id);
+    }
+    const uint32_t free_space = page->GetFreeSpaceRemaining();
+    page->WUnlatch();
+    buffer_pool_manager_->UnpinPage(page_id, true);
+    if (is_last_in_map) {
+      free_space_map_.Update(page_id, free_space);
     } else {
-      // Otherwise we have run out of valid pages. We need to create a new page.
-      auto new_page = static_cast<TablePage *>(buffer_pool_manager_->NewPage(&next_page_id));
-      // If we could not create a new page,
-      if (new_page == nullptr) {
-        // Then life sucks and we abort the transaction.
-        cur_page->WUnlatch();
-        buffer_pool_manager_->UnpinPage(cur_page->GetTablePageId(), false);
-        txn->SetState(TransactionState::ABORTED);
-        return false;
-      }
-      // Otherwise we were able to create a new page. We initialize it now.
-      new_page->WLatch();
-      cur_page->SetNextPageId(next_page_id);
-      new_page->Init(next_page_id, BUSTUB_PAGE_SIZE, cur_page->GetTablePageId(), log_manager_, txn);
-      cur_page->WUnlatch();
-      buffer_pool_manager_->UnpinPage(cur_page->GetTablePageId(), true);
-      cur_page = new_page;
+      free_space_map_.Append(page_id, free_space);
     }
+    page = new_page;
+    page_id = new_page_id;
+    is_last_in_map = false;
+    // a tuple that does not need overflow pages always fits into an empty page
+    FillPage(page, tuples, next, rids, txn);
+  }
+
+  const uint32_t free_space = page->GetFreeSpaceRemaining();
+  page->WUnlatch();
+  buffer_pool_manager_->UnpinPage(page_id, true);
+  if (is_last_in_map) {
+    free_space_map_.Update(page_id, free_space);
+  } else {
+    free_space_map_.Append(page_id, free_space);
   }
-  // This line has caused most of us to double-take and "whoa double unlatch".
-  // We are not, in fact, double unlatching. See the invariant above.
-  cur_page->WUnlatch(); //by3ml unlatch ll newpage yo3tbr
-  buffer_pool_manager_->UnpinPage(cur_page->GetTablePageId(), true);
-  // Update the transaction's write set.
-  txn->GetWriteSet()->emplace_back(*rid, WType::INSERT, TupleRecord{}, this);
   return true;
 }
 
+auto TableHeap::FillPage(TablePage *page, const std::vector<const TupleRecord *> &tuples, size_t *next,
+                         std::vector<RID> *rids, Transaction *txn) -> size_t {
+  size_t inserted = 0;
+  for (; *next < tuples.size() && tuples[*next]->size_ <= TablePage::MAX_TUPLE_SIZE; (*next)++, inserted++) {
+    if (page->GetFreeSpaceRemaining() < tuples[*next]->size_ + TablePage::SIZE_TUPLE) {
+      break;
+    }
+    // The zone is widened before the tuple is on the page, so a scan never passes over the page once it is there,
+    // and the map page is never written back narrower than the heap page.
+    if (zone_map_ != nullptr) {
+      zone_map_->Record(page->GetTablePageId(), *tuples[*next]);
+    }
+    RID rid;
+    if (!page->InsertTuple(*tuples[*next], &rid, txn, lock_manager_, log_manager_)) {
+      break;
+    }
+    rids->push_back(rid);
+  }
+  return inserted;
+}
+
 auto TableHeap::MarkDelete(const RID &rid, Transaction *txn) -> bool {
-  // TODO(Amadou): remove empty page
   // Find the page which contains the tuple.
   auto page = reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(rid.GetPageId()));
   // If the page could not be found, then abort the transaction.
@@ -200,6 +447,16 @@ auto TableHeap::MarkDelete(const RID &rid, Transaction *txn) -> bool {
 }
 
 auto TableHeap::UpdateTuple(const TupleRecord &tuple, const RID &rid, Transaction *txn) -> bool {
+  tuple.LoadOverflow();
+  // Widening the zone first keeps a scan from passing over the page once the new values are on it. If the tuple moves
+  // to another page instead, the insert records it there.
+  if (zone_map_ != nullptr) {
+    zone_map_->Record(rid.GetPageId(), tuple);
+  }
+  bool is_updated;
+  if (tuple.size_ > TablePage::MAX_TUPLE_SIZE && UpdateOverflowTuple(tuple, rid, txn, &is_updated)) {
+    return is_updated;
+  }
   // Find the page which contains the tuple.
   auto page = reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(rid.GetPageId()));
   // If the page could not be found, then abort the transaction.
@@ -210,9 +467,27 @@ auto TableHeap::UpdateTuple(const TupleRecord &tuple, const RID &rid, Transactio
   // Update the tuple; but first save the old value for rollbacks.
   TupleRecord old_tuple;
   page->WLatch();
-  bool is_updated = page->UpdateTuple(tuple, &old_tuple, rid, txn, lock_manager_, log_manager_);
+  is_updated = page->UpdateTuple(tuple, &old_tuple, rid, txn, lock_manager_, log_manager_);
+  // A row that had overflow pages and now fits into its page leaves the chain behind. As in UpdateOverflowTuple(), the
+  // old value kept for rollbacks brings the rest of its data along, and the chain is retired.
+  std::vector<page_id_t> old_page_ids;
+  if (is_updated && old_tuple.GetOverFlowPageId() != INVALID_PAGE_ID) {
+    if (CollectOverflow(old_tuple.GetOverFlowPageId(), &old_page_ids)) {
+      old_tuple.overflow_bpm_ = buffer_pool_manager_;
+      old_tuple.LoadOverflow();
+    } else {
+      // without the old value there is nothing to roll back to, so the row gets it back; it was in the page before
+      // the update, so it fits
+      TupleRecord replaced;
+      page->UpdateTuple(old_tuple, &replaced, rid, txn, lock_manager_, log_manager_);
+      txn->SetState(TransactionState::ABORTED);
+      is_updated = false;
+      old_page_ids.clear();
+    }
+  }
   uint32_t freeSpace = page->GetFreeSpaceRemaining();
   page->WUnlatch();
+  free_space_map_.Update(rid.GetPageId(), freeSpace);
   if (is_updated == false && freeSpace + old_tuple.GetLength() < tuple.GetLength()) {
     bool isMarked =  this->MarkDelete(rid,txn);
      RID insertedRid;
@@ -226,6 +501,9 @@ auto TableHeap::UpdateTuple(const TupleRecord &tuple, const RID &rid, Transactio
   
    
   buffer_pool_manager_->UnpinPage(page->GetTablePageId(), is_updated);
+  if (!old_page_ids.empty()) {
+    RetireOverflow(old_page_ids);
+  }
   // Update the transaction's write set.
   if (is_updated && txn->GetState() != TransactionState::ABORTED) {
     txn->GetWriteSet()->emplace_back(rid, WType::UPDATE, old_tuple, this);
@@ -243,8 +521,19 @@ void TableHeap::ApplyDelete(const RID &rid, Transaction *txn) {
   /** Commented out to make compatible with p4; This is called only on commit or delete, which consequently unlocks the
    * tuple; so should be fine */
   // lock_manager_->Unlock(txn, rid);
+  const bool is_empty = auto_vacuum && page->Compact();
+  const uint32_t free_space = page->GetFreeSpaceRemaining();
+  if (is_empty) {
+    // keeps the page from being freed by another reclaim before this one gets to it
+    EnterHeap();
+  }
   page->WUnlatch();
   buffer_pool_manager_->UnpinPage(page->GetTablePageId(), true);
+  free_space_map_.Update(rid.GetPageId(), free_space);
+  if (is_empty) {
+    ReclaimPage(rid.GetPageId());
+    LeaveHeap();
+  }
 }
 
 void TableHeap::RollbackDelete(const RID &rid, Transaction *txn) {
@@ -257,35 +546,11 @@ void TableHeap::RollbackDelete(const RID &rid, Transaction *txn) {
   page->WUnlatch();
   buffer_pool_manager_->UnpinPage(page->GetTablePageId(), true);
 }
-char* TableHeap::MergeData( char* ptr1, uint32_t size1,  char* ptr2, uint32_t size2) {
-    // Calculate the size of the new buffer
-    size_t newSize = size1 + size2;
- 
-    // Allocate memory for the new buffer
-    char* mergedBuffer = new char[newSize];
-
-    // Copy data from the first pointer to the new buffer
-    std::memcpy(mergedBuffer, ptr1, size1);
-
-    // Copy data from the second pointer to the new buffer
-    std::memcpy(mergedBuffer + size1, ptr2, size2);
-  //   LOG_DEBUG("size 1 is %d, size 2 is %d", size1,size2);
-  //  for (uint32_t i = 0; i < newSize - 1; i++) {
-  //             LOG_DEBUG("%c", mergedBuffer[i]);
-  //           }
-    return mergedBuffer;
-}
-
-void TableHeap::SplitData(char*data, int length ,char**dest1,int length1,char**dest2,int length2){
-       (*dest1) = new char[length1];
-        (*dest2) = new char[length2];
-       std::memcpy(*dest1, data, length1);
-       std::memcpy(*dest2, data + length1, length2);
-} 
-auto TableHeap::GetTuple(const RID &rid, TupleRecord *tuple, Transaction *txn, bool acquire_read_lock) -> bool {
+auto TableHeap::GetTuple(const RID &rid, TupleRecord *tuple, Transaction *txn, bool acquire_read_lock,
+                         BufferAccessStrategy *strategy) -> bool {
   // Find the page which contains the tuple.
  
-  auto page = static_cast<TablePage *>(buffer_pool_manager_->FetchPage(rid.GetPageId()));
+  auto page = static_cast<TablePage *>(buffer_pool_manager_->FetchPage(rid.GetPageId(), strategy));
   // If the page could not be found, then abort the transaction.
   if (page == nullptr) {
     txn->SetState(TransactionState::ABORTED);
@@ -296,38 +561,16 @@ auto TableHeap::GetTuple(const RID &rid, TupleRecord *tuple, Transaction *txn, b
     page->RLatch();
   }
   bool res = page->GetTuple(rid, tuple, txn, lock_manager_);
-        //  LOG_DEBUG("The OverFlowPageId  in GetTuple is %d" , tuple->GetOverFlowPageId());
-  if (tuple->GetOverFlowPageId() != INVALID_PAGE_ID) {
-     auto overFlowPage = static_cast<OverFlowPage *>(buffer_pool_manager_->FetchPage(tuple->GetOverFlowPageId()));
-     
-    //  LOG_DEBUG("1162023 %d", tuple->GetLength());
-    //  LOG_DEBUG("xD %d", overFlowPage->GetDataSize());
-    //  LOG_DEBUG("xD5555 %d", tuple->GetLength() + overFlowPage->GetDataSize());
-
-      char *mergedData =   MergeData(tuple->data_, tuple->GetLength(), overFlowPage->GetTupleData(), overFlowPage->GetDataSize());
-      delete [] tuple->data_;
-      tuple->data_ = mergedData;
-      //  LOG_DEBUG("YBDANY");
-      tuple->size_ = tuple->GetLength() + overFlowPage->GetDataSize();
-      page_id_t nextOverFlowId = overFlowPage->GetNextPageId();
-      buffer_pool_manager_->UnpinPage(overFlowPage->GetPageId(), false);
-      while (nextOverFlowId != INVALID_PAGE_ID) {
-          auto overFlowPageChild = static_cast<OverFlowPage *>(buffer_pool_manager_->FetchPage(nextOverFlowId));
-          assert (overFlowPageChild != nullptr);
-
-          // LOG_DEBUG("Merging size of %d with %d", tuple->GetLength(), overFlowPageChild->GetDataSize());
-          char *childMergedData =   MergeData(tuple->data_, tuple->GetLength(), overFlowPageChild->GetTupleData(), overFlowPageChild->GetDataSize());
-           delete [] tuple->data_;
-           tuple->data_ = childMergedData;
-           tuple->size_ +=  overFlowPageChild->GetDataSize();
-           nextOverFlowId = overFlowPageChild->GetNextPageId();
-           buffer_pool_manager_->UnpinPage(overFlowPageChild->GetPageId(), false);
-          
-      }
-
+  // The rest of a tuple that overflows is read only once a value stored there is needed, see
+  // TupleRecord::LoadOverflow(). An update writes a new chain, and the tuple keeps the one it has from being freed.
+  if (res && tuple->GetOverFlowPageId() != INVALID_PAGE_ID) {
+    tuple->overflow_bpm_ = buffer_pool_manager_;
+    tuple->overflow_visit_ = VisitOverflow();
+  } else {
+    tuple->overflow_bpm_ = nullptr;
+    tuple->overflow_visit_.reset();
   }
 
-
   if (acquire_read_lock) {
     page->RUnlatch();
   }
@@ -335,26 +578,141 @@ auto TableHeap::GetTuple(const RID &rid, TupleRecord *tuple, Transaction *txn, b
   return res;
 }
  
-auto TableHeap::Begin(Transaction *txn) -> TableIterator {
-  // Start an iterator from the first page.
-  // TODO(Wuwen): Hacky fix for now. Removing empty pages is a better way to handle this.
-  RID rid;
-  auto page_id = first_page_id_;
-  while (page_id != INVALID_PAGE_ID) {
+auto TableHeap::ReadColumnData(page_id_t page_id, uint32_t column_idx, char *values, page_id_t *next_page_id,
+                               std::vector<uint32_t> *slot_nums, std::vector<bool> *is_null,
+                               BufferAccessStrategy *strategy) -> int64_t {
+  auto page = static_cast<TablePage *>(buffer_pool_manager_->FetchPage(page_id, strategy));
+  if (page == nullptr) {
+    return -1;
+  }
+  page->RLatch();
+  // a retired page is still a PAX page and links to the rest of the heap
+  const uint32_t num_values = page->CopyColumn(column_idx, values, slot_nums, is_null);
+  *next_page_id = page->GetNextPageId();
+  page->RUnlatch();
+  buffer_pool_manager_->UnpinPage(page_id, false);
+  return num_values;
+}
+
+auto TableHeap::Begin(Transaction *txn, BufferAccessStrategy *strategy, const std::vector<ZoneMap::Range> *zone_filter)
+    -> TableIterator {
+  // Start an iterator from the first page. It skips pages without tuples: the first page is never unlinked, and other
+  // pages may be empty until they are reclaimed.
+  return {this, RID(first_page_id_, 0), txn, strategy, zone_filter};
+}
+
+auto TableHeap::End() -> TableIterator { return {this, RID(INVALID_PAGE_ID, 0), nullptr}; }
+
+auto TableHeap::Vacuum() -> size_t {
+  EnterHeap();
+  std::vector<page_id_t> empty_page_ids;
+  for (page_id_t page_id = first_page_id_; page_id != INVALID_PAGE_ID;) {
     auto page = static_cast<TablePage *>(buffer_pool_manager_->FetchPage(page_id));
-    page->RLatch();
-    // If this fails because there is no tuple, then RID will be the default-constructed value, which means EOF.
-    auto found_tuple = page->GetFirstTupleRid(&rid);
-    page->RUnlatch();
-    buffer_pool_manager_->UnpinPage(page_id, false);
-    if (found_tuple) {
+    if (page == nullptr) {
       break;
     }
-    page_id = page->GetNextPageId();
+    page->WLatch();
+    const uint32_t old_free_space = page->GetFreeSpaceRemaining();
+    if (page->Compact()) {
+      empty_page_ids.push_back(page_id);
+    }
+    const uint32_t free_space = page->GetFreeSpaceRemaining();
+    const page_id_t next_page_id = page->GetNextPageId();
+    page->WUnlatch();
+    buffer_pool_manager_->UnpinPage(page_id, free_space != old_free_space);
+    free_space_map_.Update(page_id, free_space);
+    page_id = next_page_id;
   }
-  return {this, rid, txn};
+
+  size_t num_reclaimed = 0;
+  for (const page_id_t page_id : empty_page_ids) {
+    num_reclaimed += ReclaimPage(page_id) ? 1 : 0;
+  }
+  LeaveHeap();
+  return num_reclaimed;
 }
 
-auto TableHeap::End() -> TableIterator { return {this, RID(INVALID_PAGE_ID, 0), nullptr}; }
+auto TableHeap::ReclaimPage(page_id_t page_id) -> bool {
+  // Links only change under the append latch, so the neighbours read here stay the neighbours.
+  std::scoped_lock append_lock(append_latch_);
+  if (page_id == first_page_id_ || page_id == free_space_map_.GetLastPageId()) {
+    return false;
+  }
+  auto page = static_cast<TablePage *>(buffer_pool_manager_->FetchPage(page_id));
+  if (page == nullptr) {
+    return false;
+  }
+  page->RLatch();
+  const page_id_t prev_page_id = page->GetPrevPageId();
+  const page_id_t next_page_id = page->GetNextPageId();
+  page->RUnlatch();
+  auto prev_page = static_cast<TablePage *>(buffer_pool_manager_->FetchPage(prev_page_id));
+  auto next_page = next_page_id == INVALID_PAGE_ID
+                       ? nullptr
+                       : static_cast<TablePage *>(buffer_pool_manager_->FetchPage(next_page_id));
+  if (prev_page == nullptr || next_page == nullptr) {
+    if (prev_page != nullptr) {
+      buffer_pool_manager_->UnpinPage(prev_page_id, false);
+    }
+    if (next_page != nullptr) {
+      buffer_pool_manager_->UnpinPage(next_page_id, false);
+    }
+    buffer_pool_manager_->UnpinPage(page_id, false);
+    return false;
+  }
+
+  // Latch in list order, like scans do. A page that was unlinked before still names its old neighbours, but the
+  // previous one no longer names it.
+  prev_page->WLatch();
+  page->WLatch();
+  next_page->WLatch();
+  const bool is_reclaimed = prev_page->GetNextPageId() == page_id && page->Compact();
+  if (is_reclaimed) {
+    prev_page->SetNextPageId(next_page_id);
+    next_page->SetPrevPageId(prev_page_id);
+    // The page keeps its own links, so that a scan that is still on it goes on with the next page.
+    page->Retire();
+    free_space_map_.Remove(page_id);
+    if (zone_map_ != nullptr) {
+      zone_map_->Remove(page_id);
+    }
+  }
+  next_page->WUnlatch();
+  page->WUnlatch();
+  prev_page->WUnlatch();
+  buffer_pool_manager_->UnpinPage(next_page_id, is_reclaimed);
+  buffer_pool_manager_->UnpinPage(page_id, is_reclaimed);
+  buffer_pool_manager_->UnpinPage(prev_page_id, is_reclaimed);
+
+  if (is_reclaimed) {
+    std::scoped_lock retired_lock(retired_latch_);
+    retired_pages_.push_back(page_id);
+    has_retired_pages_ = true;
+  }
+  return is_reclaimed;
+}
+
+void TableHeap::LeaveHeap() {
+  if (num_visitors_->fetch_sub(1) == 1 && has_retired_pages_) {
+    FreeRetiredPages();
+  }
+}
+
+void TableHeap::FreeRetiredPages() {
+  std::scoped_lock retired_lock(retired_latch_);
+  // A visitor that comes later cannot reach a retired page anymore: the list and the free space map both lost it.
+  if (*num_visitors_ != 0) {
+    return;
+  }
+  std::vector<page_id_t> pinned_page_ids;
+  for (const page_id_t page_id : retired_pages_) {
+    // e.g. pinned by read-ahead; it is tried again next time
+    if (!buffer_pool_manager_->DeletePage(page_id)) {
+      pinned_page_ids.push_back(page_id);
+    }
+  }
+  retired_pages_ = std::move(pinned_page_ids);
+  has_retired_pages_ = !retired_pages_.empty();
+}
 
 }  // namespace bustub
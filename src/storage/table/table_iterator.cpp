@@ -10,6 +10,7 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <algorithm>
 #include <cassert>
 
 #include "common/exception.h"
@@ -18,60 +19,151 @@
 
 namespace bustub {
 
-TableIterator::TableIterator(TableHeap *table_heap, RID rid, Transaction *txn)
-    : table_heap_(table_heap), tuple_(new TupleRecord(rid)), txn_(txn) {
+TableIterator::TableIterator(TableHeap *table_heap, RID rid, Transaction *txn, BufferAccessStrategy *strategy,
+                             const std::vector<ZoneMap::Range> *zone_filter)
+    : table_heap_(table_heap), tuple_(new TupleRecord(rid)), txn_(txn), strategy_(strategy), zone_filter_(zone_filter) {
   if (rid.GetPageId() != INVALID_PAGE_ID) {
-    if (!table_heap_->GetTuple(tuple_->rid_, tuple_, txn_)) {
-      throw bustub::Exception("read non-existing tuple");
+    table_heap_->EnterHeap();
+    num_visitors_ = table_heap_->num_visitors_;
+    const page_id_t page_id = SkipPages(rid.GetPageId());
+    ReadPage(page_id);
+    while (page_id == rid.GetPageId() && slot_index_ < page_->slots_.size() &&
+           page_->slots_[slot_index_].slot_num_ < rid.GetSlotNum()) {
+      slot_index_++;
     }
+    SeekTuple();
   }
 }
 
+TableIterator::TableIterator(const TableIterator &other)
+    : table_heap_(other.table_heap_),
+      tuple_(new TupleRecord(*other.tuple_)),
+      txn_(other.txn_),
+      strategy_(other.strategy_),
+      zone_filter_(other.zone_filter_),
+      num_visitors_(other.num_visitors_),
+      page_(other.page_),
+      slot_index_(other.slot_index_),
+      read_ahead_page_id_(other.read_ahead_page_id_) {
+  if (num_visitors_ != nullptr) {
+    (*num_visitors_)++;
+  }
+}
+
+TableIterator::~TableIterator() {
+  // The heap may be gone by now, so retired pages are left to the next visitor of the heap to free.
+  if (num_visitors_ != nullptr) {
+    (*num_visitors_)--;
+  }
+  delete tuple_;
+}
+
+auto TableIterator::operator=(const TableIterator &other) -> TableIterator & {
+  if (other.num_visitors_ != nullptr) {
+    (*other.num_visitors_)++;
+  }
+  if (num_visitors_ != nullptr) {
+    (*num_visitors_)--;
+  }
+  table_heap_ = other.table_heap_;
+  *tuple_ = *other.tuple_;
+  txn_ = other.txn_;
+  strategy_ = other.strategy_;
+  zone_filter_ = other.zone_filter_;
+  num_visitors_ = other.num_visitors_;
+  page_ = other.page_;
+  slot_index_ = other.slot_index_;
+  read_ahead_page_id_ = other.read_ahead_page_id_;
+  return *this;
+}
+
 auto TableIterator::operator*() -> const TupleRecord & {
-  assert(*this != table_heap_->End());
+  assert(!IsEnd());
   return *tuple_;
 }
 
 auto TableIterator::operator->() -> TupleRecord * {
-  assert(*this != table_heap_->End());
+  assert(!IsEnd());
   return tuple_;
 }
 
 auto TableIterator::operator++() -> TableIterator & {
+  slot_index_++;
+  SeekTuple();
+  return *this;
+}
+
+void TableIterator::ReadPage(page_id_t page_id) {
   BufferPoolManager *buffer_pool_manager = table_heap_->buffer_pool_manager_;
-  auto cur_page = static_cast<TablePage *>(buffer_pool_manager->FetchPage(tuple_->rid_.GetPageId()));
-  BUSTUB_ENSURE(cur_page != nullptr, "BPM full");  // all pages are pinned
-
-  cur_page->RLatch();
-  RID next_tuple_rid;
-  if (!cur_page->GetNextTupleRid(tuple_->rid_,
-                                 &next_tuple_rid)) {  // end of this page
-    while (cur_page->GetNextPageId() != INVALID_PAGE_ID) {
-      auto next_page = static_cast<TablePage *>(buffer_pool_manager->FetchPage(cur_page->GetNextPageId()));
-      cur_page->RUnlatch();
-      buffer_pool_manager->UnpinPage(cur_page->GetTablePageId(), false);
-      cur_page = next_page;
-      cur_page->RLatch();
-      if (cur_page->GetFirstTupleRid(&next_tuple_rid)) {
-        break;
-      }
+  // Keep the read-ahead window in front of the scan. A scan with a ring reads ahead into the ring, by at most half of
+  // it, so that the pages read ahead are not recycled before the scan gets to them.
+  const size_t ring_size = strategy_ == nullptr ? 0 : strategy_->GetRingSize();
+  const size_t depth = ring_size == 0 ? read_ahead_depth.load() : std::min(read_ahead_depth.load(), ring_size / 2);
+  if (depth > 0) {
+    // Only the pages past the ones hinted before are new, i.e. the one at the edge of the window once the scan is
+    // under way; a scan that starts, or jumps ahead over pages, hints the whole window.
+    const std::vector<page_id_t> window = table_heap_->free_space_map_.GetNextPageIds(page_id, depth);
+    const auto hinted = std::find(window.begin(), window.end(), read_ahead_page_id_);
+    const std::vector<page_id_t> page_ids(hinted == window.end() ? window.begin() : hinted + 1, window.end());
+    if (!page_ids.empty()) {
+      buffer_pool_manager->PrefetchPages(page_ids, ring_size == 0 ? nullptr : strategy_);
+      read_ahead_page_id_ = page_ids.back();
     }
   }
-  tuple_->rid_ = next_tuple_rid;
-
-  if (*this != table_heap_->End()) {
-    // DO NOT ACQUIRE READ LOCK twice in a single thread otherwise it may deadlock.
-    // See https://users.rust-lang.org/t/how-bad-is-the-potential-deadlock-mentioned-in-rwlocks-document/67234
-    if (!table_heap_->GetTuple(tuple_->rid_, tuple_, txn_, false)) {
-      cur_page->RUnlatch();
-      buffer_pool_manager->UnpinPage(cur_page->GetTablePageId(), false);
-      throw bustub::Exception("read non-existing tuple");
+  auto page = static_cast<TablePage *>(buffer_pool_manager->FetchPage(page_id, strategy_));
+  BUSTUB_ENSURE(page != nullptr, "BPM full");  // all pages are pinned
+
+  if (page_ == nullptr || page_.use_count() > 1) {
+    page_ = std::make_shared<PageCopy>();
+  }
+  page->RLatch();
+  page->CopyTuples(&page_->data_, &page_->slots_);
+  page_->next_page_id_ = page->GetNextPageId();
+  page->RUnlatch();
+  buffer_pool_manager->UnpinPage(page_id, false);
+  page_->page_id_ = page_id;
+  slot_index_ = 0;
+}
+
+void TableIterator::SeekTuple() {
+  // The next page is reached through the copy of its link, without a latch. The page may be unlinked meanwhile, but
+  // not freed, because the iterator is a visitor of the heap; it then still links to the rest of the heap.
+  while (slot_index_ == page_->slots_.size()) {
+    if (page_->next_page_id_ == INVALID_PAGE_ID) {
+      *tuple_ = TupleRecord(RID(INVALID_PAGE_ID, 0));
+      page_ = nullptr;
+      num_visitors_ = nullptr;
+      table_heap_->LeaveHeap();
+      return;
     }
+    ReadPage(SkipPages(page_->next_page_id_));
   }
-  // release until copy the tuple
-  cur_page->RUnlatch();
-  buffer_pool_manager->UnpinPage(cur_page->GetTablePageId(), false);
-  return *this;
+
+  const TablePage::TupleSlot &slot = page_->slots_[slot_index_];
+  if (tuple_->allocated_) {
+    delete[] tuple_->data_;
+  }
+  tuple_->data_ = page_->data_.data() + slot.offset_;
+  tuple_->size_ = slot.size_;
+  tuple_->allocated_ = false;
+  tuple_->tupleData_ = tuple_->data_ + sizeof(uint32_t);
+  tuple_->rid_.Set(page_->page_id_, slot.slot_num_);
+  // the rest of a tuple that overflows is read when it is needed, see TableHeap::GetTuple()
+  if (tuple_->GetOverFlowPageId() != INVALID_PAGE_ID) {
+    tuple_->overflow_bpm_ = table_heap_->buffer_pool_manager_;
+    tuple_->overflow_visit_ = table_heap_->VisitOverflow();
+  } else {
+    tuple_->overflow_bpm_ = nullptr;
+    tuple_->overflow_visit_.reset();
+  }
+}
+
+auto TableIterator::SkipPages(page_id_t page_id) -> page_id_t {
+  ZoneMap *zone_map = table_heap_->zone_map_.get();
+  if (zone_filter_ == nullptr || zone_filter_->empty() || zone_map == nullptr) {
+    return page_id;
+  }
+  return zone_map->SkipPages(page_id, *zone_filter_);
 }
 
 auto TableIterator::operator++(int) -> TableIterator {
@@ -12,10 +12,14 @@
 
 #include <cassert>
 #include <cstdlib>
+#include <memory>
 #include <sstream>
 #include <string>
 #include <vector>
+#include "buffer/buffer_pool_manager.h"
+#include "common/exception.h"
 #include "common/logger.h"
+#include "storage/page/over_flow_page.h"
 #include "storage/table/tuple_record.h"
 
 namespace bustub {
@@ -40,7 +44,7 @@ TupleRecord::TupleRecord(std::vector<Value> values, const Schema *schema)   {
 
   // 2. Allocate memory.
         //size = fixedTupleSize + overFlowPageIdentifier + sizeof nullbitmap
-  size_ = tuple_size + sizeof(uint32_t) + sizeof(uint16_t);
+  size_ = tuple_size + sizeof(uint32_t) + NullBitmapSize(schema->GetColumnCount());
  
   data_ = new char[size_];
   tupleData_ = data_ + sizeof(uint32_t);
@@ -49,7 +53,7 @@ TupleRecord::TupleRecord(std::vector<Value> values, const Schema *schema)   {
   SetOverFlowPageId(INVALID_PAGE_ID);
   // 3. Serialize each attribute based on the input value.
   uint32_t column_count = schema->GetColumnCount();
-  uint32_t offset = schema->GetLength() + sizeof(uint16_t);
+  uint32_t offset = schema->GetLength() + NullBitmapSize(column_count);
 
   for (uint32_t i = 0; i < column_count; i++) {
     const auto &col = schema->GetColumn(i);
@@ -170,6 +174,14 @@ auto TupleRecord::GetDataPtr(const Schema *schema, const uint32_t column_idx)  c
   
   // We read the relative offset from the tuple data.
   int32_t offset = *reinterpret_cast<int32_t *>(data_ + sizeof(uint32_t) + col.GetOffset());
+  // The fixed-size part is always in the table page, but the value may not be.
+  if (IsOverflowPending()) {
+    const size_t begin = sizeof(uint32_t) + offset;
+    if (begin + sizeof(uint32_t) > size_ ||
+        begin + sizeof(uint32_t) + *reinterpret_cast<uint32_t *>(data_ + begin) > size_) {
+      LoadOverflow();
+    }
+  }
   // And return the beginning address of the real data for the VARCHAR type.
   return (data_ + sizeof(uint32_t)  + offset);
 }
@@ -202,11 +214,77 @@ auto TupleRecord::ToString(const Schema *schema) const -> std::string {
 
 
 auto TupleRecord::SetOverFlowPageId(page_id_t overFlowId) -> void {
-     memcpy(GetData(), &overFlowId, sizeof(page_id_t));
+     memcpy(data_, &overFlowId, sizeof(page_id_t));
 }
 
 auto TupleRecord::GetOverFlowPageId() const -> page_id_t {
-     return *reinterpret_cast<page_id_t *>(GetData());
+     return *reinterpret_cast<page_id_t *>(data_);
+}
+
+void TupleRecord::Materialize() {
+  if (allocated_ || data_ == nullptr) {
+    return;
+  }
+  char *data = new char[size_];
+  memcpy(data, data_, size_);
+  data_ = data;
+  allocated_ = true;
+  tupleData_ = data + sizeof(uint32_t);
+}
+
+void TupleRecord::LoadOverflow() const {
+  if (!IsOverflowPending()) {
+    return;
+  }
+  // Reading the overflow does not change the value of the tuple, so it is allowed on a const one.
+  auto *self = const_cast<TupleRecord *>(this);
+  BufferPoolManager *bpm = overflow_bpm_;
+  page_id_t page_id = GetOverFlowPageId();
+  auto *page = static_cast<OverFlowPage *>(bpm->FetchPage(page_id));
+  if (page == nullptr) {
+    throw Exception(ExceptionType::OUT_OF_MEMORY, "can't fetch the overflow page of a tuple");
+  }
+  page->RLatch();
+  const uint32_t size = size_ + page->GetChainSize();
+  std::unique_ptr<char[]> data(new char[size]);
+  memcpy(data.get(), data_, size_);
+  uint32_t offset = size_;
+  while (true) {
+    const uint32_t chunk = page->GetDataSize();
+    const bool fits = chunk <= size - offset;
+    if (fits) {
+      memcpy(data.get() + offset, page->GetTupleData(), chunk);
+      offset += chunk;
+    }
+    const page_id_t next_page_id = page->GetNextPageId();
+    page->RUnlatch();
+    bpm->UnpinPage(page_id, false);
+    if (!fits) {
+      throw Exception(ExceptionType::OUT_OF_RANGE, "the overflow chain of a tuple holds more than the tuple");
+    }
+    if (offset == size || next_page_id == INVALID_PAGE_ID) {
+      break;
+    }
+    page_id = next_page_id;
+    page = static_cast<OverFlowPage *>(bpm->FetchPage(page_id));
+    if (page == nullptr) {
+      throw Exception(ExceptionType::OUT_OF_MEMORY, "can't fetch the overflow page of a tuple");
+    }
+    page->RLatch();
+  }
+  if (offset != size) {
+    throw Exception(ExceptionType::OUT_OF_RANGE, "the overflow chain of a tuple ends before the tuple");
+  }
+
+  if (allocated_) {
+    delete[] data_;
+  }
+  self->data_ = data.release();
+  self->size_ = size;
+  self->allocated_ = true;
+  self->tupleData_ = self->data_ + sizeof(uint32_t);
+  self->overflow_bpm_ = nullptr;
+  self->overflow_visit_.reset();
 }
 // void Tuple::SerializeTo(char *storage) const {
 //   memcpy(storage, &size_, sizeof(int32_t));
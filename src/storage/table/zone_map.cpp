@@ -0,0 +1,356 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// zone_map.cpp
+//
+// Identification: src/storage/table/zone_map.cpp
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/table/zone_map.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "common/exception.h"
+#include "storage/page/table_page.h"
+#include "storage/page/zone_map_page.h"
+
+namespace bustub {
+
+/** @return true if the zone map tracks columns of the type */
+static auto IsTracked(TypeId type_id) -> bool {
+  switch (type_id) {
+    case TypeId::TINYINT:
+    case TypeId::SMALLINT:
+    case TypeId::INTEGER:
+    case TypeId::BIGINT:
+    case TypeId::DECIMAL:
+    case TypeId::TIMESTAMP:
+      return true;
+    default:
+      return false;
+  }
+}
+
+/** @return true if the bound of a range can be compared with the zone of a column of the type */
+static auto IsComparable(TypeId column_type, const Value &bound) -> bool {
+  if (bound.IsNull()) {
+    return false;
+  }
+  if (column_type == TypeId::TIMESTAMP) {
+    return bound.GetTypeId() == TypeId::TIMESTAMP;
+  }
+  switch (bound.GetTypeId()) {
+    case TypeId::TINYINT:
+    case TypeId::SMALLINT:
+    case TypeId::INTEGER:
+    case TypeId::BIGINT:
+    case TypeId::DECIMAL:
+      return true;
+    default:
+      return false;
+  }
+}
+
+ZoneMap::ZoneMap(BufferPoolManager *buffer_pool_manager, const Schema &schema)
+    : buffer_pool_manager_(buffer_pool_manager), schema_(schema), slot_of_column_(schema.GetColumnCount(), -1) {
+  for (uint32_t i = 0; i < schema.GetColumnCount() && columns_.size() < MAX_COLUMNS; i++) {
+    if (IsTracked(schema.GetColumn(i).GetType())) {
+      slot_of_column_[i] = static_cast<int>(columns_.size());
+      columns_.push_back(i);
+    }
+  }
+  capacity_ = ZoneMapPage::Capacity(columns_.size());
+}
+
+ZoneMap::~ZoneMap() {
+  for (const page_id_t map_page_id : map_page_ids_) {
+    buffer_pool_manager_->UnpinPage(map_page_id, false);
+  }
+}
+
+auto ZoneMap::HasTrackedColumns(const Schema &schema) -> bool {
+  for (const auto &column : schema.GetColumns()) {
+    if (IsTracked(column.GetType())) {
+      return true;
+    }
+  }
+  return false;
+}
+
+auto ZoneMap::Open(page_id_t map_page_id, page_id_t first_heap_page_id) -> page_id_t {
+  std::scoped_lock lock(latch_);
+  if (map_page_id == INVALID_PAGE_ID) {
+    auto *map_page = reinterpret_cast<ZoneMapPage *>(buffer_pool_manager_->NewPage(&map_page_id, first_heap_page_id));
+    if (map_page == nullptr) {
+      throw Exception(ExceptionType::OUT_OF_MEMORY, "no frame for the zone map of a table");
+    }
+    map_page->Init(columns_.size());
+    buffer_pool_manager_->UnpinPage(map_page_id, true);
+  }
+
+  bool is_usable = true;
+  for (page_id_t page_id = map_page_id; page_id != INVALID_PAGE_ID;) {
+    auto *map_page = reinterpret_cast<ZoneMapPage *>(buffer_pool_manager_->FetchPage(page_id));
+    if (map_page == nullptr) {
+      throw Exception(ExceptionType::OUT_OF_MEMORY, "no frame for the zone map of a table");
+    }
+    // a map of other columns, e.g. of an earlier schema, is no use
+    if (map_page->GetColumnCount() != columns_.size()) {
+      buffer_pool_manager_->UnpinPage(page_id, false);
+      is_usable = false;
+      break;
+    }
+    // the page keeps this pin until the map is closed
+    map_page_ids_.push_back(page_id);
+    for (uint32_t i = 0; i < map_page->GetEntryCount(); i++) {
+      if (map_page->GetHeapPageId(i) != INVALID_PAGE_ID) {
+        entry_of_page_[map_page->GetHeapPageId(i)] = heap_page_ids_.size();
+      }
+      heap_page_ids_.push_back(map_page->GetHeapPageId(i));
+      is_complete_.push_back(map_page->IsComplete(i));
+      for (uint32_t c = 0; c < columns_.size(); c++) {
+        const char *data = map_page->GetColumn(i, c);
+        ColumnZone zone;
+        uint32_t has_range;
+        memcpy(&zone.null_count_, data + 2 * ZoneMapPage::SIZE_VALUE, sizeof(uint32_t));
+        memcpy(&has_range, data + 2 * ZoneMapPage::SIZE_VALUE + sizeof(uint32_t), sizeof(uint32_t));
+        if (has_range != 0) {
+          const TypeId type_id = schema_.GetColumn(columns_[c]).GetType();
+          zone.min_ = Value::DeserializeFrom(data, type_id);
+          zone.max_ = Value::DeserializeFrom(data + ZoneMapPage::SIZE_VALUE, type_id);
+          zone.has_range_ = true;
+        }
+        zones_.push_back(zone);
+      }
+    }
+    page_id = map_page->GetNextPageId();
+  }
+
+  // A map that does not start with the heap was never written, e.g. because of a crash; it is built again from the
+  // heap. Further pages of such a map are not reused.
+  if (!is_usable || heap_page_ids_.empty() || heap_page_ids_[0] != first_heap_page_id) {
+    for (const page_id_t pinned_page_id : map_page_ids_) {
+      buffer_pool_manager_->UnpinPage(pinned_page_id, false);
+    }
+    map_page_ids_.clear();
+    auto *map_page = reinterpret_cast<ZoneMapPage *>(buffer_pool_manager_->FetchPage(map_page_id));
+    if (map_page == nullptr) {
+      throw Exception(ExceptionType::OUT_OF_MEMORY, "no frame for the zone map of a table");
+    }
+    map_page->Init(columns_.size());
+    buffer_pool_manager_->UnpinPage(map_page_id, true);
+    PinMapPage(map_page_id);
+    heap_page_ids_.clear();
+    is_complete_.clear();
+    zones_.clear();
+    entry_of_page_.clear();
+  }
+
+  // Add the pages that were linked to the heap after the map was last written. Their tuples were not recorded, so
+  // only a page without any is complete.
+  page_id_t page_id = first_heap_page_id;
+  if (!heap_page_ids_.empty()) {
+    auto *last_page = reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(heap_page_ids_.back()));
+    page_id = last_page->GetNextPageId();
+    buffer_pool_manager_->UnpinPage(heap_page_ids_.back(), false);
+  }
+  while (page_id != INVALID_PAGE_ID) {
+    auto *page = reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(page_id));
+    const bool is_empty = page->IsEmpty();
+    const page_id_t next_page_id = page->GetNextPageId();
+    buffer_pool_manager_->UnpinPage(page_id, false);
+    AppendEntry(page_id, is_empty);
+    page_id = next_page_id;
+  }
+  return map_page_id;
+}
+
+void ZoneMap::Record(page_id_t heap_page_id, const TupleRecord &tuple) {
+  std::scoped_lock lock(latch_);
+  const auto entry = entry_of_page_.find(heap_page_id);
+  if (entry != entry_of_page_.end() && RecordEntry(entry->second, tuple)) {
+    StoreEntry(entry->second);
+  }
+}
+
+void ZoneMap::Append(page_id_t heap_page_id) {
+  std::scoped_lock lock(latch_);
+  AppendEntry(heap_page_id, true);
+}
+
+void ZoneMap::Remove(page_id_t heap_page_id) {
+  std::scoped_lock lock(latch_);
+  const auto entry = entry_of_page_.find(heap_page_id);
+  if (entry == entry_of_page_.end()) {
+    return;
+  }
+  const size_t index = entry->second;
+  BUSTUB_ASSERT(index + 1 < heap_page_ids_.size(), "the last page of a heap stays in it");
+  entry_of_page_.erase(entry);
+  heap_page_ids_[index] = INVALID_PAGE_ID;
+  is_complete_[index] = false;
+  std::fill(zones_.begin() + index * columns_.size(), zones_.begin() + (index + 1) * columns_.size(), ColumnZone{});
+  StoreEntry(index);
+}
+
+auto ZoneMap::SkipPages(page_id_t heap_page_id, const std::vector<Range> &ranges) -> page_id_t {
+  std::scoped_lock lock(latch_);
+  const auto entry = entry_of_page_.find(heap_page_id);
+  // e.g. a page that is linked to the heap but not yet appended to the map
+  if (entry == entry_of_page_.end()) {
+    return heap_page_id;
+  }
+  for (size_t i = entry->second; i + 1 < heap_page_ids_.size(); i++) {
+    if (heap_page_ids_[i] != INVALID_PAGE_ID && MayMatchEntry(i, ranges)) {
+      return heap_page_ids_[i];
+    }
+  }
+  return heap_page_ids_.back();
+}
+
+auto ZoneMap::MayMatch(page_id_t heap_page_id, const std::vector<Range> &ranges) -> bool {
+  std::scoped_lock lock(latch_);
+  const auto entry = entry_of_page_.find(heap_page_id);
+  return entry == entry_of_page_.end() || MayMatchEntry(entry->second, ranges);
+}
+
+auto ZoneMap::GetNullCount(page_id_t heap_page_id, uint32_t column_idx) -> uint32_t {
+  std::scoped_lock lock(latch_);
+  const auto entry = entry_of_page_.find(heap_page_id);
+  if (entry == entry_of_page_.end() || column_idx >= slot_of_column_.size() || slot_of_column_[column_idx] < 0) {
+    return 0;
+  }
+  return zones_[entry->second * columns_.size() + slot_of_column_[column_idx]].null_count_;
+}
+
+auto ZoneMap::MayMatchEntry(size_t index, const std::vector<Range> &ranges) -> bool {
+  if (!is_complete_[index]) {
+    return true;
+  }
+  for (const auto &range : ranges) {
+    if (range.column_idx_ >= slot_of_column_.size() || slot_of_column_[range.column_idx_] < 0) {
+      continue;
+    }
+    const ColumnZone &zone = zones_[index * columns_.size() + slot_of_column_[range.column_idx_]];
+    if (!RangeMayMatch(range, schema_.GetColumn(range.column_idx_).GetType(), zone.has_range_, zone.min_, zone.max_)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+auto ZoneMap::RangeMayMatch(const Range &range, TypeId type_id, bool has_range, const Value &min, const Value &max)
+    -> bool {
+  // a comparison with null is never true, so a zone of nulls only holds no match
+  if (!has_range) {
+    return false;
+  }
+  if (range.lower_.has_value() && IsComparable(type_id, *range.lower_)) {
+    const CmpBool below =
+        range.lower_inclusive_ ? max.CompareLessThan(*range.lower_) : max.CompareLessThanEquals(*range.lower_);
+    if (below == CmpBool::CmpTrue) {
+      return false;
+    }
+  }
+  if (range.upper_.has_value() && IsComparable(type_id, *range.upper_)) {
+    const CmpBool above =
+        range.upper_inclusive_ ? min.CompareGreaterThan(*range.upper_) : min.CompareGreaterThanEquals(*range.upper_);
+    if (above == CmpBool::CmpTrue) {
+      return false;
+    }
+  }
+  return true;
+}
+
+auto ZoneMap::RecordEntry(size_t index, const TupleRecord &tuple) -> bool {
+  bool is_changed = false;
+  for (size_t c = 0; c < columns_.size(); c++) {
+    const Value value = tuple.GetValue(&schema_, columns_[c]);
+    ColumnZone &zone = zones_[index * columns_.size() + c];
+    if (value.IsNull()) {
+      zone.null_count_++;
+      is_changed = true;
+    } else if (!zone.has_range_) {
+      zone.min_ = value;
+      zone.max_ = value;
+      zone.has_range_ = true;
+      is_changed = true;
+    } else if (value.CompareLessThan(zone.min_) == CmpBool::CmpTrue) {
+      zone.min_ = value;
+      is_changed = true;
+    } else if (value.CompareGreaterThan(zone.max_) == CmpBool::CmpTrue) {
+      zone.max_ = value;
+      is_changed = true;
+    }
+  }
+  return is_changed;
+}
+
+void ZoneMap::AppendEntry(page_id_t heap_page_id, bool is_complete) {
+  if (heap_page_ids_.size() == map_page_ids_.size() * capacity_) {
+    const page_id_t last_map_page_id = map_page_ids_.back();
+    page_id_t map_page_id;
+    auto *map_page = reinterpret_cast<ZoneMapPage *>(buffer_pool_manager_->NewPage(&map_page_id, last_map_page_id));
+    if (map_page == nullptr) {
+      throw Exception(ExceptionType::OUT_OF_MEMORY, "no frame for the zone map of a table");
+    }
+    map_page->Init(columns_.size());
+    buffer_pool_manager_->UnpinPage(map_page_id, true);
+    PinMapPage(map_page_id);
+    auto *last_map_page = reinterpret_cast<ZoneMapPage *>(buffer_pool_manager_->FetchPage(last_map_page_id));
+    last_map_page->WLatch();
+    last_map_page->SetNextPageId(map_page_id);
+    last_map_page->WUnlatch();
+    buffer_pool_manager_->UnpinPage(last_map_page_id, true);
+  }
+
+  entry_of_page_[heap_page_id] = heap_page_ids_.size();
+  heap_page_ids_.push_back(heap_page_id);
+  is_complete_.push_back(is_complete);
+  zones_.resize(zones_.size() + columns_.size());
+
+  auto *map_page = reinterpret_cast<ZoneMapPage *>(buffer_pool_manager_->FetchPage(map_page_ids_.back()));
+  map_page->WLatch();
+  map_page->SetEntryCount(map_page->GetEntryCount() + 1);
+  map_page->WUnlatch();
+  buffer_pool_manager_->UnpinPage(map_page_ids_.back(), true);
+  StoreEntry(heap_page_ids_.size() - 1);
+}
+
+void ZoneMap::StoreEntry(size_t index) {
+  const page_id_t map_page_id = map_page_ids_[index / capacity_];
+  // the map page is pinned, so fetching it takes no frame and cannot fail
+  auto *map_page = reinterpret_cast<ZoneMapPage *>(buffer_pool_manager_->FetchPage(map_page_id));
+  BUSTUB_ASSERT(map_page != nullptr, "the pages of an open zone map are pinned");
+  const auto slot = static_cast<uint32_t>(index % capacity_);
+  map_page->WLatch();
+  map_page->SetHeapPage(slot, heap_page_ids_[index], is_complete_[index]);
+  for (uint32_t c = 0; c < columns_.size(); c++) {
+    const ColumnZone &zone = zones_[index * columns_.size() + c];
+    char *data = map_page->GetColumn(slot, c);
+    const uint32_t has_range = zone.has_range_ ? 1 : 0;
+    memset(data, 0, ZoneMapPage::SIZE_COLUMN);
+    if (zone.has_range_) {
+      zone.min_.SerializeTo(data);
+      zone.max_.SerializeTo(data + ZoneMapPage::SIZE_VALUE);
+    }
+    memcpy(data + 2 * ZoneMapPage::SIZE_VALUE, &zone.null_count_, sizeof(uint32_t));
+    memcpy(data + 2 * ZoneMapPage::SIZE_VALUE + sizeof(uint32_t), &has_range, sizeof(uint32_t));
+  }
+  map_page->WUnlatch();
+  buffer_pool_manager_->UnpinPage(map_page_id, true);
+}
+
+void ZoneMap::PinMapPage(page_id_t map_page_id) {
+  if (buffer_pool_manager_->FetchPage(map_page_id) == nullptr) {
+    throw Exception(ExceptionType::OUT_OF_MEMORY, "no frame for the zone map of a table");
+  }
+  map_page_ids_.push_back(map_page_id);
+}
+
+}  // namespace bustub
@@ -0,0 +1,136 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// buffer_access_strategy_test.cpp
+//
+// Identification: test/buffer/buffer_access_strategy_test.cpp
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/buffer_access_strategy.h"
+
+#include <cstring>
+#include <memory>
+
+#include "buffer/buffer_pool_manager_instance.h"
+#include "buffer/parallel_buffer_pool_manager.h"
+#include "gtest/gtest.h"
+#include "storage/disk/disk_manager_memory.h"
+
+namespace bustub {
+
+/** In-memory disk that counts reads. */
+class ReadCountingDiskManager : public DiskManagerUnlimitedMemory {
+ public:
+  void ReadPage(page_id_t page_id, char *page_data) override {
+    reads_++;
+    DiskManagerUnlimitedMemory::ReadPage(page_id, page_data);
+  }
+
+  int reads_{0};
+};
+
+static const int NUM_HOT_PAGES = 8;
+static const int NUM_SCAN_PAGES = 200;
+
+/**
+ * Pages [0, NUM_HOT_PAGES) are looked up all the time, like the inner pages of a B+ tree; the pages after them are
+ * read once by a full scan. Returns how many of the point lookups missed the buffer pool while the scan ran.
+ */
+static auto PointLookupMissesDuringScan(BufferPoolManager *bpm, ReadCountingDiskManager *disk_manager,
+                                        BufferAccessStrategy *strategy) -> int {
+  for (int i = 0; i < NUM_HOT_PAGES + NUM_SCAN_PAGES; i++) {
+    page_id_t page_id;
+    EXPECT_NE(nullptr, bpm->NewPage(&page_id));
+    EXPECT_TRUE(bpm->UnpinPage(page_id, true));
+  }
+  // warm up the hot pages
+  for (page_id_t page_id = 0; page_id < NUM_HOT_PAGES; page_id++) {
+    EXPECT_NE(nullptr, bpm->FetchPage(page_id));
+    EXPECT_TRUE(bpm->UnpinPage(page_id, false));
+  }
+
+  int point_lookup_misses = 0;
+  for (page_id_t page_id = NUM_HOT_PAGES; page_id < NUM_HOT_PAGES + NUM_SCAN_PAGES; page_id++) {
+    EXPECT_NE(nullptr, bpm->FetchPage(page_id, strategy));
+    EXPECT_TRUE(bpm->UnpinPage(page_id, false));
+
+    const page_id_t hot_page_id = page_id % NUM_HOT_PAGES;
+    const int reads = disk_manager->reads_;
+    EXPECT_NE(nullptr, bpm->FetchPage(hot_page_id));
+    EXPECT_TRUE(bpm->UnpinPage(hot_page_id, false));
+    point_lookup_misses += disk_manager->reads_ - reads;
+  }
+  return point_lookup_misses;
+}
+
+// NOLINTNEXTLINE
+TEST(BufferAccessStrategyTest, PointLookupsSurviveScanTest) {
+  // Scenario: a scan through the shared pool evicts the hot pages over and over.
+  {
+    auto disk_manager = std::make_unique<ReadCountingDiskManager>();
+    auto bpm = std::make_unique<BufferPoolManagerInstance>(32, disk_manager.get());
+    EXPECT_LT(0, PointLookupMissesDuringScan(bpm.get(), disk_manager.get(), nullptr));
+  }
+
+  // Scenario: a scan with a ring of 16 frames leaves the hot pages alone, so every point lookup hits.
+  {
+    auto disk_manager = std::make_unique<ReadCountingDiskManager>();
+    auto bpm = std::make_unique<BufferPoolManagerInstance>(32, disk_manager.get());
+    BufferAccessStrategy strategy(16);
+    EXPECT_EQ(0, PointLookupMissesDuringScan(bpm.get(), disk_manager.get(), &strategy));
+  }
+
+  // Scenario: the same holds for the shards of a parallel buffer pool.
+  {
+    auto disk_manager = std::make_unique<ReadCountingDiskManager>();
+    auto bpm = std::make_unique<ParallelBufferPoolManager>(4, 16, disk_manager.get());
+    BufferAccessStrategy strategy(16);
+    EXPECT_EQ(0, PointLookupMissesDuringScan(bpm.get(), disk_manager.get(), &strategy));
+  }
+}
+
+// NOLINTNEXTLINE
+TEST(BufferAccessStrategyTest, DirtyRingPagesTest) {
+  auto disk_manager = std::make_unique<DiskManagerUnlimitedMemory>();
+  auto bpm = std::make_unique<BufferPoolManagerInstance>(8, disk_manager.get());
+  const int num_pages = 40;
+  for (int i = 0; i < num_pages; i++) {
+    page_id_t page_id;
+    ASSERT_NE(nullptr, bpm->NewPage(&page_id));
+    ASSERT_TRUE(bpm->UnpinPage(page_id, true));
+  }
+
+  // Scenario: a ring of 4 frames that the scan dirties writes every page back before recycling its frame.
+  BufferAccessStrategy strategy(4);
+  for (page_id_t page_id = 0; page_id < num_pages; page_id++) {
+    auto *page = bpm->FetchPage(page_id, &strategy);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), BUSTUB_PAGE_SIZE, "page %d", page_id);
+    ASSERT_TRUE(bpm->UnpinPage(page_id, true));
+  }
+  for (page_id_t page_id = 0; page_id < num_pages; page_id++) {
+    auto *page = bpm->FetchPage(page_id);
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ("page " + std::to_string(page_id), std::string(page->GetData()));
+    ASSERT_TRUE(bpm->UnpinPage(page_id, false));
+  }
+
+  // Scenario: a ring frame that somebody else pinned is not recycled; the scan evicts another page instead.
+  BufferAccessStrategy small_ring(1);
+  auto *pinned_page = bpm->FetchPage(0, &small_ring);
+  ASSERT_NE(nullptr, pinned_page);
+  ASSERT_NE(nullptr, bpm->FetchPage(1, &small_ring));
+  auto *page = bpm->FetchPage(2, &small_ring);
+  ASSERT_NE(nullptr, page);
+  EXPECT_EQ("page 2", std::string(page->GetData()));
+  EXPECT_EQ("page 0", std::string(pinned_page->GetData()));
+  for (page_id_t page_id = 0; page_id < 3; page_id++) {
+    EXPECT_TRUE(bpm->UnpinPage(page_id, false));
+  }
+}
+
+}  // namespace bustub
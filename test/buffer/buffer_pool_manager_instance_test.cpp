@@ -12,12 +12,20 @@
 
 #include "buffer/buffer_pool_manager_instance.h"
 
+#include <atomic>
+#include <chrono>  // NOLINT
 #include <cstdio>
+#include <future>  // NOLINT
 #include <random>
 #include <string>
+#include <thread>  // NOLINT
+#include <unordered_map>
+#include <utility>
+#include <vector>
 
 #include "buffer/buffer_pool_manager.h"
 #include "gtest/gtest.h"
+#include "storage/disk/disk_manager_memory.h"
 
 namespace bustub {
 
@@ -148,4 +156,295 @@ TEST(BufferPoolManagerInstanceTest, SampleTest) {
   delete disk_manager;
 }
 
+/**
+ * In-memory disk whose reads of one page block until the test releases them.
+ */
+class GatedDiskManager : public DiskManagerUnlimitedMemory {
+ public:
+  explicit GatedDiskManager(page_id_t gated_page_id) : gated_page_id_(gated_page_id) {}
+
+  void ReadPage(page_id_t page_id, char *page_data) override {
+    if (page_id == gated_page_id_) {
+      gated_reads_++;
+      read_started_.set_value();
+      release_.get_future().wait();
+    }
+    DiskManagerUnlimitedMemory::ReadPage(page_id, page_data);
+  }
+
+  const page_id_t gated_page_id_;
+  std::atomic<int> gated_reads_{0};
+  std::promise<void> read_started_;
+  std::promise<void> release_;
+};
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerInstanceTest, HitsDoNotWaitForMisses) {
+  const size_t buffer_pool_size = 3;
+  auto disk_manager = std::make_unique<GatedDiskManager>(0);
+  auto bpm = std::make_unique<BufferPoolManagerInstance>(buffer_pool_size, disk_manager.get());
+
+  // Page 0 only lives on disk (flushing an unpinned page drops it from the pool), page 1 stays resident.
+  page_id_t page_id;
+  auto *page = bpm->NewPage(&page_id);
+  ASSERT_EQ(0, page_id);
+  snprintf(page->GetData(), BUSTUB_PAGE_SIZE, "cold");
+  EXPECT_TRUE(bpm->UnpinPage(0, true));
+  EXPECT_TRUE(bpm->FlushPage(0));
+  page = bpm->NewPage(&page_id);
+  ASSERT_EQ(1, page_id);
+  snprintf(page->GetData(), BUSTUB_PAGE_SIZE, "hot");
+  EXPECT_TRUE(bpm->UnpinPage(1, true));
+
+  // Scenario: two threads miss on page 0, the first one blocks inside the disk read.
+  auto read_started = disk_manager->read_started_.get_future();
+  std::thread first_reader([&bpm] {
+    auto *cold = bpm->FetchPage(0);
+    ASSERT_NE(nullptr, cold);
+    EXPECT_EQ(0, strcmp(cold->GetData(), "cold"));
+    EXPECT_TRUE(bpm->UnpinPage(0, false));
+  });
+  read_started.wait();
+  std::thread second_reader([&bpm] {
+    auto *cold = bpm->FetchPage(0);
+    ASSERT_NE(nullptr, cold);
+    EXPECT_EQ(0, strcmp(cold->GetData(), "cold"));
+    EXPECT_TRUE(bpm->UnpinPage(0, false));
+  });
+
+  // Scenario: a hit on page 1 must not wait for the read of page 0.
+  auto hit = std::async(std::launch::async, [&bpm] {
+    auto *hot = bpm->FetchPage(1);
+    bool found = hot != nullptr && strcmp(hot->GetData(), "hot") == 0;
+    bpm->UnpinPage(1, false);
+    return found;
+  });
+  ASSERT_EQ(std::future_status::ready, hit.wait_for(std::chrono::seconds(10)));
+  EXPECT_TRUE(hit.get());
+
+  // Scenario: once the read completes, both readers see the page, and it was read from disk only once.
+  disk_manager->release_.set_value();
+  first_reader.join();
+  second_reader.join();
+  EXPECT_EQ(1, disk_manager->gated_reads_);
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerInstanceTest, ConcurrentFetchTest) {
+  // Few frames and a few hot pages: most fetches pin pages that are already pinned by another thread, the rest race
+  // with evictions of the same frames.
+  const size_t buffer_pool_size = 8;
+  const int num_pages = 32;
+  const int num_threads = 8;
+  const int rounds = 20000;
+  for (auto policy : {ReplacerPolicy::LRU_K, ReplacerPolicy::CLOCK}) {
+  SCOPED_TRACE(policy == ReplacerPolicy::CLOCK ? "clock" : "lru-k");
+  auto disk_manager = std::make_unique<DiskManagerUnlimitedMemory>();
+  auto bpm =
+      std::make_unique<BufferPoolManagerInstance>(buffer_pool_size, disk_manager.get(), LRUK_REPLACER_K, nullptr, policy);
+
+  for (int i = 0; i < num_pages; i++) {
+    page_id_t page_id;
+    auto *page = bpm->NewPage(&page_id);
+    ASSERT_NE(nullptr, page);
+    memcpy(page->GetData(), &page_id, sizeof(page_id));
+    EXPECT_TRUE(bpm->UnpinPage(page_id, true));
+  }
+
+  std::vector<std::thread> threads;
+  for (int tid = 0; tid < num_threads; tid++) {
+    threads.emplace_back([&bpm, tid] {
+      std::default_random_engine gen(tid);
+      for (int i = 0; i < rounds; i++) {
+        const auto page_id = static_cast<page_id_t>(gen() % 2 == 0 ? gen() % 2 : gen() % num_pages);
+        auto *page = bpm->FetchPage(page_id);
+        if (page == nullptr) {
+          continue;
+        }
+        const bool is_write = i % 8 == 0;
+        if (is_write) {
+          page->WLatch();
+        } else {
+          page->RLatch();
+        }
+        page_id_t stored_id;
+        memcpy(&stored_id, page->GetData(), sizeof(stored_id));
+        EXPECT_EQ(page_id, stored_id);
+        EXPECT_EQ(page_id, page->GetPageId());
+        if (is_write) {
+          page->WUnlatch();
+        } else {
+          page->RUnlatch();
+        }
+        EXPECT_TRUE(bpm->UnpinPage(page_id, is_write));
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+
+  // every pin was given back, so all frames are free or evictable
+  EXPECT_EQ(static_cast<int>(buffer_pool_size), bpm->GetFreeListSize() + bpm->GetFreeEvictableSize());
+  }
+}
+
+/** In-memory disk that counts the reads of every page. */
+class ReadCountingDiskManager : public DiskManagerUnlimitedMemory {
+ public:
+  void ReadPage(page_id_t page_id, char *page_data) override {
+    reads_[page_id]++;
+    DiskManagerUnlimitedMemory::ReadPage(page_id, page_data);
+  }
+
+  std::unordered_map<page_id_t, int> reads_;
+};
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerInstanceTest, ClockPolicyTest) {
+  const size_t buffer_pool_size = 4;
+  auto disk_manager = std::make_unique<ReadCountingDiskManager>();
+  auto bpm = std::make_unique<BufferPoolManagerInstance>(buffer_pool_size, disk_manager.get(), LRUK_REPLACER_K,
+                                                         nullptr, ReplacerPolicy::CLOCK);
+
+  // Scenario: with every frame pinned, there is nothing to evict.
+  page_id_t page_id;
+  for (size_t i = 0; i < buffer_pool_size; i++) {
+    auto *page = bpm->NewPage(&page_id);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), BUSTUB_PAGE_SIZE, "page %d", page_id);
+  }
+  EXPECT_EQ(nullptr, bpm->NewPage(&page_id));
+  for (page_id_t i = 0; i < static_cast<page_id_t>(buffer_pool_size); i++) {
+    EXPECT_TRUE(bpm->UnpinPage(i, true));
+  }
+
+  // Scenario: page 0 is hit between the reads of a stream of other pages, so the sweep passes over it every time.
+  for (int i = 0; i < 50; i++) {
+    auto *hot = bpm->FetchPage(0);
+    ASSERT_NE(nullptr, hot);
+    EXPECT_EQ(0, strcmp(hot->GetData(), "page 0"));
+    EXPECT_TRUE(bpm->UnpinPage(0, false));
+    auto *page = bpm->NewPage(&page_id);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), BUSTUB_PAGE_SIZE, "page %d", page_id);
+    EXPECT_TRUE(bpm->UnpinPage(page_id, true));
+  }
+  EXPECT_EQ(0, disk_manager->reads_[0]);
+
+  // Scenario: evicted pages are written back and read again.
+  for (page_id_t i = 1; i < 10; i++) {
+    auto *page = bpm->FetchPage(i);
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ("page " + std::to_string(i), std::string(page->GetData()));
+    EXPECT_TRUE(bpm->UnpinPage(i, false));
+  }
+  EXPECT_EQ(static_cast<int>(buffer_pool_size), bpm->GetFreeEvictableSize());
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerInstanceTest, BackgroundWriterTest) {
+  const size_t buffer_pool_size = 10;
+  auto disk_manager = std::make_unique<DiskManagerUnlimitedMemory>();
+  auto bpm = std::make_unique<BufferPoolManagerInstance>(buffer_pool_size, disk_manager.get());
+  auto new_dirty_pages = [&bpm](size_t num_pages) {
+    for (size_t i = 0; i < num_pages; i++) {
+      page_id_t page_id;
+      auto *page = bpm->NewPage(&page_id);
+      ASSERT_NE(nullptr, page);
+      snprintf(page->GetData(), BUSTUB_PAGE_SIZE, "page %d", page_id);
+      EXPECT_TRUE(bpm->UnpinPage(page_id, true));
+    }
+  };
+
+  // Scenario: without a background writer, every dirty victim is written by the thread that evicts it.
+  new_dirty_pages(2 * buffer_pool_size);
+  EXPECT_EQ(buffer_pool_size, bpm->GetForegroundWriteCount());
+  EXPECT_EQ(0, bpm->GetBackgroundWriteCount());
+
+  // Scenario: the background writer cleans all resident pages, since all of them are about to be evicted.
+  bpm->RunBackgroundWriter(2, buffer_pool_size);
+  for (int i = 0; i < 500 && bpm->GetBackgroundWriteCount() < buffer_pool_size; i++) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  }
+  bpm->StopBackgroundWriter();
+  EXPECT_EQ(buffer_pool_size, bpm->GetBackgroundWriteCount());
+
+  // Scenario: evicting the cleaned pages does not write anything in the foreground, and nothing was lost.
+  for (size_t i = 0; i < buffer_pool_size; i++) {
+    page_id_t page_id;
+    ASSERT_NE(nullptr, bpm->NewPage(&page_id));
+    EXPECT_TRUE(bpm->UnpinPage(page_id, false));
+  }
+  EXPECT_EQ(buffer_pool_size, bpm->GetForegroundWriteCount());
+  for (page_id_t page_id = 0; page_id < static_cast<page_id_t>(2 * buffer_pool_size); page_id++) {
+    auto *page = bpm->FetchPage(page_id);
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ("page " + std::to_string(page_id), page->GetData());
+    EXPECT_TRUE(bpm->UnpinPage(page_id, false));
+  }
+}
+
+/** In-memory disk that records every batch of WritePages() and counts reads. */
+class BatchRecordingDiskManager : public ReadCountingDiskManager {
+ public:
+  void WritePages(std::vector<std::pair<page_id_t, const char *>> pages) override {
+    std::vector<page_id_t> page_ids;
+    for (const auto &[page_id, page_data] : pages) {
+      page_ids.push_back(page_id);
+    }
+    batches_.push_back(page_ids);
+    ReadCountingDiskManager::WritePages(std::move(pages));
+  }
+
+  std::vector<std::vector<page_id_t>> batches_;
+};
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerInstanceTest, FlushAllPagesTest) {
+  const size_t buffer_pool_size = 8;
+  auto disk_manager = std::make_unique<BatchRecordingDiskManager>();
+  auto bpm = std::make_unique<BufferPoolManagerInstance>(buffer_pool_size, disk_manager.get());
+
+  // pages 0 to 11 were created, the last 8 of them are resident and dirty, and page 11 is still pinned
+  for (size_t i = 0; i < buffer_pool_size + 4; i++) {
+    page_id_t page_id;
+    auto *page = bpm->NewPage(&page_id);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), BUSTUB_PAGE_SIZE, "page %d", page_id);
+    if (i + 1 < buffer_pool_size + 4) {
+      EXPECT_TRUE(bpm->UnpinPage(page_id, true));
+    }
+  }
+
+  // Scenario: all dirty pages go to the disk in one batch, sorted by page id, pinned or not.
+  disk_manager->batches_.clear();
+  bpm->FlushAllPages();
+  ASSERT_EQ(1, disk_manager->batches_.size());
+  EXPECT_EQ(std::vector<page_id_t>({4, 5, 6, 7, 8, 9, 10, 11}), disk_manager->batches_[0]);
+
+  // Scenario: the flushed pages stay in the pool and are clean, so fetching them reads nothing and a second flush
+  // writes nothing.
+  for (page_id_t page_id = 4; page_id < 12; page_id++) {
+    auto *page = bpm->FetchPage(page_id);
+    ASSERT_NE(nullptr, page);
+    EXPECT_FALSE(page->IsDirty());
+    EXPECT_EQ("page " + std::to_string(page_id), page->GetData());
+    EXPECT_TRUE(bpm->UnpinPage(page_id, false));
+    EXPECT_EQ(0, disk_manager->reads_[page_id]);
+  }
+  bpm->FlushAllPages();
+  EXPECT_EQ(1, disk_manager->batches_.size());
+
+  // Scenario: the pinned page is still pinned, and a page dirtied again is flushed again.
+  EXPECT_TRUE(bpm->UnpinPage(11, false));
+  EXPECT_FALSE(bpm->UnpinPage(11, false));
+  auto *page = bpm->FetchPage(6);
+  ASSERT_NE(nullptr, page);
+  EXPECT_TRUE(bpm->UnpinPage(6, true));
+  bpm->FlushAllPages();
+  ASSERT_EQ(2, disk_manager->batches_.size());
+  EXPECT_EQ(std::vector<page_id_t>({6}), disk_manager->batches_[1]);
+}
+
 }  // namespace bustub
@@ -10,7 +10,10 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <algorithm>
+#include <atomic>
 #include <cstdio>
+#include <random>
 #include <thread>  // NOLINT
 #include <vector>
 
@@ -19,44 +22,122 @@
 
 namespace bustub {
 
-TEST(ClockReplacerTest, DISABLED_SampleTest) {
+TEST(ClockReplacerTest, SampleTest) {
   ClockReplacer clock_replacer(7);
 
-  // Scenario: unpin six elements, i.e. add them to the replacer.
-  clock_replacer.Unpin(1);
-  clock_replacer.Unpin(2);
-  clock_replacer.Unpin(3);
-  clock_replacer.Unpin(4);
-  clock_replacer.Unpin(5);
-  clock_replacer.Unpin(6);
-  clock_replacer.Unpin(1);
+  // Scenario: load pages into six frames and unpin them, i.e. add them to the replacer. Frame 1 is hit once more.
+  for (frame_id_t frame_id = 1; frame_id <= 6; frame_id++) {
+    clock_replacer.RecordAccess(frame_id);
+    clock_replacer.SetEvictable(frame_id, true);
+  }
+  clock_replacer.RecordHit(1);
   EXPECT_EQ(6, clock_replacer.Size());
 
-  // Scenario: get three victims from the clock.
+  // Scenario: the first turn of the hand only decrements usage counts; frame 1 needs a second turn to get to zero.
+  EXPECT_EQ(2, clock_replacer.EvictionCandidates(1)[0]);
   int value;
-  clock_replacer.Victim(&value);
-  EXPECT_EQ(1, value);
-  clock_replacer.Victim(&value);
+  ASSERT_TRUE(clock_replacer.Evict(&value));
   EXPECT_EQ(2, value);
-  clock_replacer.Victim(&value);
+  ASSERT_TRUE(clock_replacer.Evict(&value));
   EXPECT_EQ(3, value);
+  ASSERT_TRUE(clock_replacer.Evict(&value));
+  EXPECT_EQ(4, value);
 
-  // Scenario: pin elements in the replacer.
-  // Note that 3 has already been victimized, so pinning 3 should have no effect.
-  clock_replacer.Pin(3);
-  clock_replacer.Pin(4);
+  // Scenario: pin frames. Frame 3 has already been evicted, so pinning it has no effect.
+  clock_replacer.SetEvictable(3, false);
+  clock_replacer.SetEvictable(5, false);
   EXPECT_EQ(2, clock_replacer.Size());
 
-  // Scenario: unpin 4. We expect that the reference bit of 4 will be set to 1.
-  clock_replacer.Unpin(4);
-
-  // Scenario: continue looking for victims. We expect these victims.
-  clock_replacer.Victim(&value);
-  EXPECT_EQ(5, value);
-  clock_replacer.Victim(&value);
+  // Scenario: the hand skips the pinned frame.
+  ASSERT_TRUE(clock_replacer.Evict(&value));
   EXPECT_EQ(6, value);
-  clock_replacer.Victim(&value);
-  EXPECT_EQ(4, value);
+  ASSERT_TRUE(clock_replacer.Evict(&value));
+  EXPECT_EQ(1, value);
+  EXPECT_FALSE(clock_replacer.Evict(&value));
+  EXPECT_EQ(0, clock_replacer.Size());
+
+  // Scenario: removing a frame forgets it, whether it is evictable or not.
+  clock_replacer.SetEvictable(5, true);
+  EXPECT_EQ(1, clock_replacer.Size());
+  clock_replacer.Remove(5);
+  EXPECT_EQ(0, clock_replacer.Size());
+  clock_replacer.SetEvictable(5, true);
+  EXPECT_EQ(0, clock_replacer.Size());
+}
+
+TEST(ClockReplacerTest, HotFramesSurviveTest) {
+  ClockReplacer clock_replacer(8);
+  for (frame_id_t frame_id = 0; frame_id < 8; frame_id++) {
+    clock_replacer.RecordAccess(frame_id);
+    clock_replacer.SetEvictable(frame_id, true);
+  }
+
+  // Scenario: frames 0 and 1 are hit all the time; a stream of pages that are read once cycles through the others.
+  for (int i = 0; i < 1000; i++) {
+    clock_replacer.RecordHit(0);
+    clock_replacer.RecordHit(1);
+    frame_id_t frame_id;
+    ASSERT_TRUE(clock_replacer.Evict(&frame_id));
+    ASSERT_NE(0, frame_id);
+    ASSERT_NE(1, frame_id);
+    clock_replacer.RecordAccess(frame_id);
+    clock_replacer.SetEvictable(frame_id, true);
+  }
+
+  // Scenario: once the hits stop, the usage counts run down and the hot frames become victims too.
+  std::vector<frame_id_t> victims;
+  frame_id_t frame_id;
+  while (clock_replacer.Evict(&frame_id)) {
+    victims.push_back(frame_id);
+  }
+  std::sort(victims.begin(), victims.end());
+  EXPECT_EQ((std::vector<frame_id_t>{0, 1, 2, 3, 4, 5, 6, 7}), victims);
+}
+
+TEST(ClockReplacerTest, ConcurrentEvictTest) {
+  const size_t num_frames = 1000;
+  const int num_threads = 4;
+  ClockReplacer clock_replacer(num_frames);
+  for (size_t i = 0; i < num_frames; i++) {
+    clock_replacer.RecordAccess(static_cast<frame_id_t>(i));
+    clock_replacer.SetEvictable(static_cast<frame_id_t>(i), true);
+  }
+
+  // Scenario: threads evict while others hit random frames; every frame is evicted exactly once.
+  std::atomic<bool> done{false};
+  std::thread hitter([&] {
+    std::default_random_engine gen(42);
+    while (!done) {
+      clock_replacer.RecordHit(static_cast<frame_id_t>(gen() % num_frames));
+    }
+  });
+  std::vector<std::vector<frame_id_t>> victims(num_threads);
+  std::vector<std::thread> evictors;
+  for (int tid = 0; tid < num_threads; tid++) {
+    evictors.emplace_back([&, tid] {
+      frame_id_t frame_id;
+      while (clock_replacer.Size() > 0) {
+        if (clock_replacer.Evict(&frame_id)) {
+          victims[tid].push_back(frame_id);
+        }
+      }
+    });
+  }
+  for (auto &evictor : evictors) {
+    evictor.join();
+  }
+  done = true;
+  hitter.join();
+
+  std::vector<frame_id_t> all_victims;
+  for (const auto &thread_victims : victims) {
+    all_victims.insert(all_victims.end(), thread_victims.begin(), thread_victims.end());
+  }
+  std::sort(all_victims.begin(), all_victims.end());
+  ASSERT_EQ(num_frames, all_victims.size());
+  for (size_t i = 0; i < num_frames; i++) {
+    EXPECT_EQ(static_cast<frame_id_t>(i), all_victims[i]);
+  }
 }
 
 }  // namespace bustub
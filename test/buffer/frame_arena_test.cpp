@@ -0,0 +1,82 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// frame_arena_test.cpp
+//
+// Identification: test/buffer/frame_arena_test.cpp
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/frame_arena.h"
+
+#include <cstdint>
+#include <memory>
+
+#include "buffer/buffer_pool_manager_instance.h"
+#include "gtest/gtest.h"
+#include "storage/disk/disk_manager_memory.h"
+
+namespace bustub {
+
+// NOLINTNEXTLINE
+TEST(FrameArenaTest, AlignmentTest) {
+  // Scenario: frames are zeroed, page aligned and do not overlap.
+  FrameArena small_arena(10, true);
+  for (frame_id_t frame_id = 0; frame_id < 10; frame_id++) {
+    char *data = small_arena.GetFrame(frame_id);
+    EXPECT_EQ(0, reinterpret_cast<uintptr_t>(data) % BUSTUB_PAGE_SIZE);
+    for (int i = 0; i < BUSTUB_PAGE_SIZE; i++) {
+      ASSERT_EQ(0, data[i]);
+    }
+    memset(data, frame_id, BUSTUB_PAGE_SIZE);
+  }
+  for (frame_id_t frame_id = 0; frame_id < 10; frame_id++) {
+    EXPECT_EQ(frame_id, small_arena.GetFrame(frame_id)[BUSTUB_PAGE_SIZE - 1]);
+  }
+  // too small for a huge page
+  EXPECT_FALSE(small_arena.IsHugePageBacked());
+
+  // Scenario: an arena of several huge pages starts on a huge page boundary.
+  const size_t num_frames = 3 * FrameArena::HUGE_PAGE_SIZE / BUSTUB_PAGE_SIZE + 1;
+  FrameArena huge_arena(num_frames, true);
+  EXPECT_EQ(0, reinterpret_cast<uintptr_t>(huge_arena.GetFrame(0)) % FrameArena::HUGE_PAGE_SIZE);
+  huge_arena.GetFrame(static_cast<frame_id_t>(num_frames - 1))[BUSTUB_PAGE_SIZE - 1] = 1;
+
+  FrameArena plain_arena(num_frames, false);
+  EXPECT_FALSE(plain_arena.IsHugePageBacked());
+  plain_arena.GetFrame(static_cast<frame_id_t>(num_frames - 1))[BUSTUB_PAGE_SIZE - 1] = 1;
+}
+
+// NOLINTNEXTLINE
+TEST(FrameArenaTest, BufferPoolLayoutTest) {
+  auto disk_manager = std::make_unique<DiskManagerUnlimitedMemory>();
+  auto bpm = std::make_unique<BufferPoolManagerInstance>(16, disk_manager.get());
+
+  // Scenario: page descriptors sit on cache lines of their own, away from the page-aligned data.
+  Page *pages = bpm->GetPages();
+  for (size_t i = 0; i < 16; i++) {
+    EXPECT_EQ(0, reinterpret_cast<uintptr_t>(&pages[i]) % BUSTUB_CACHELINE_SIZE);
+    EXPECT_EQ(0, reinterpret_cast<uintptr_t>(pages[i].GetData()) % BUSTUB_PAGE_SIZE);
+  }
+  EXPECT_EQ(0, sizeof(Page) % BUSTUB_CACHELINE_SIZE);
+
+  // Scenario: the data of evicted pages survives the trip through the arena.
+  for (int i = 0; i < 64; i++) {
+    page_id_t page_id;
+    auto *page = bpm->NewPage(&page_id);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), BUSTUB_PAGE_SIZE, "page %d", page_id);
+    ASSERT_TRUE(bpm->UnpinPage(page_id, true));
+  }
+  for (page_id_t page_id = 0; page_id < 64; page_id++) {
+    auto *page = bpm->FetchPage(page_id);
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ("page " + std::to_string(page_id), std::string(page->GetData()));
+    ASSERT_TRUE(bpm->UnpinPage(page_id, false));
+  }
+}
+
+}  // namespace bustub
@@ -12,6 +12,7 @@
 #include <thread>  // NOLINT
 #include <vector>
 
+#include "common/exception.h"
 #include "gtest/gtest.h"
 
 namespace bustub {
@@ -97,4 +98,74 @@ TEST(LRUKReplacerTest, SampleTest) {
   lru_replacer.Remove(1);
   ASSERT_EQ(0, lru_replacer.Size());
 }
+
+TEST(LRUKReplacerTest, EvictionCandidatesTest) {
+  LRUKReplacer lru_replacer(5, 2);
+  for (frame_id_t frame_id : {0, 1, 2, 3, 0}) {
+    lru_replacer.RecordAccess(frame_id);
+  }
+  for (frame_id_t frame_id = 0; frame_id < 4; frame_id++) {
+    lru_replacer.SetEvictable(frame_id, true);
+  }
+  lru_replacer.SetEvictable(2, false);
+
+  // Frame 0 has a full history and goes last, frame 2 is pinned; nothing is evicted by looking.
+  EXPECT_EQ((std::vector<frame_id_t>{1, 3, 0}), lru_replacer.EvictionCandidates(5));
+  EXPECT_EQ((std::vector<frame_id_t>{1, 3}), lru_replacer.EvictionCandidates(2));
+  EXPECT_EQ(3, lru_replacer.Size());
+
+  frame_id_t frame_id;
+  for (auto candidate : lru_replacer.EvictionCandidates(5)) {
+    ASSERT_TRUE(lru_replacer.Evict(&frame_id));
+    EXPECT_EQ(candidate, frame_id);
+  }
+  EXPECT_TRUE(lru_replacer.EvictionCandidates(5).empty());
+}
+
+TEST(LRUKReplacerTest, InvalidFrameIdTest) {
+  LRUKReplacer lru_replacer(3, 2);
+  lru_replacer.RecordAccess(2);
+  lru_replacer.SetEvictable(2, true);
+
+  // Frame ids outside of the replacer are rejected, and the frames it tracks are left alone.
+  for (frame_id_t frame_id : {-1, 3}) {
+    EXPECT_THROW(lru_replacer.RecordAccess(frame_id), Exception);
+    EXPECT_THROW(lru_replacer.SetEvictable(frame_id, true), Exception);
+    EXPECT_THROW(lru_replacer.Remove(frame_id), Exception);
+  }
+  EXPECT_EQ(1, lru_replacer.Size());
+  frame_id_t frame_id;
+  ASSERT_TRUE(lru_replacer.Evict(&frame_id));
+  EXPECT_EQ(2, frame_id);
+}
+
+TEST(LRUKReplacerTest, BackwardKDistanceTest) {
+  LRUKReplacer lru_replacer(4, 2);
+
+  // Access pattern: 1, 2, 2, 1, 3. Frames 1 and 2 have two accesses, frame 3 only one.
+  lru_replacer.RecordAccess(1);
+  lru_replacer.RecordAccess(2);
+  lru_replacer.RecordAccess(2);
+  lru_replacer.RecordAccess(1);
+  lru_replacer.RecordAccess(3);
+  for (frame_id_t frame_id = 1; frame_id <= 3; ++frame_id) {
+    lru_replacer.SetEvictable(frame_id, true);
+  }
+
+  // Frame 3 has +inf backward k-distance. Frame 1 was used most recently, but its second most recent access is older
+  // than the one of frame 2, so it has the larger backward k-distance and goes before frame 2.
+  int value;
+  ASSERT_EQ(true, lru_replacer.Evict(&value));
+  ASSERT_EQ(3, value);
+  ASSERT_EQ(true, lru_replacer.Evict(&value));
+  ASSERT_EQ(1, value);
+  ASSERT_EQ(true, lru_replacer.Evict(&value));
+  ASSERT_EQ(2, value);
+  ASSERT_EQ(false, lru_replacer.Evict(&value));
+
+  // Frames that were never accessed are ignored, and out of range frames are rejected.
+  lru_replacer.SetEvictable(0, true);
+  EXPECT_THROW(lru_replacer.RecordAccess(4), Exception);
+  ASSERT_EQ(0, lru_replacer.Size());
+}
 }  // namespace bustub
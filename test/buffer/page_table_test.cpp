@@ -0,0 +1,121 @@
+/**
+ * page_table_test.cpp
+ */
+
+#include "buffer/page_table.h"
+
+#include <atomic>
+#include <random>
+#include <thread>  // NOLINT
+#include <unordered_map>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace bustub {
+
+TEST(PageTableTest, SampleTest) {
+  PageTable page_table(8);
+  EXPECT_EQ(32, page_table.GetCapacity());
+
+  frame_id_t frame_id;
+  EXPECT_FALSE(page_table.Find(0, &frame_id));
+
+  for (page_id_t page_id = 0; page_id < 8; page_id++) {
+    page_table.Insert(page_id, page_id + 100);
+  }
+  for (page_id_t page_id = 0; page_id < 8; page_id++) {
+    ASSERT_TRUE(page_table.Find(page_id, &frame_id));
+    EXPECT_EQ(page_id + 100, frame_id);
+  }
+
+  // Scenario: inserting a mapped page moves it to the new frame.
+  page_table.Insert(3, 7);
+  ASSERT_TRUE(page_table.Find(3, &frame_id));
+  EXPECT_EQ(7, frame_id);
+
+  // Scenario: removing a page only removes that page.
+  EXPECT_TRUE(page_table.Remove(3));
+  EXPECT_FALSE(page_table.Remove(3));
+  EXPECT_FALSE(page_table.Find(3, &frame_id));
+  for (page_id_t page_id = 0; page_id < 8; page_id++) {
+    EXPECT_EQ(page_id != 3, page_table.Find(page_id, &frame_id));
+  }
+}
+
+TEST(PageTableTest, RandomOperationsTest) {
+  // A small table with strided page ids, the way a parallel buffer pool instance uses it, gives long probe sequences
+  // that wrap around, which is where removing entries gets tricky.
+  const size_t num_frames = 16;
+  const page_id_t stride = 7;
+  PageTable page_table(num_frames);
+  std::unordered_map<page_id_t, frame_id_t> expected;
+
+  std::default_random_engine gen(42);
+  std::uniform_int_distribution<page_id_t> page_dist(0, 4 * num_frames);
+  for (int i = 0; i < 100000; i++) {
+    const page_id_t page_id = page_dist(gen) * stride;
+    if (expected.size() < 2 * num_frames && gen() % 2 == 0) {
+      const auto frame_id = static_cast<frame_id_t>(gen() % num_frames);
+      page_table.Insert(page_id, frame_id);
+      expected[page_id] = frame_id;
+    } else {
+      EXPECT_EQ(expected.erase(page_id) == 1, page_table.Remove(page_id));
+    }
+
+    if (i % 100 == 0) {
+      for (page_id_t candidate = 0; candidate <= 4 * static_cast<page_id_t>(num_frames); candidate++) {
+        frame_id_t frame_id;
+        auto it = expected.find(candidate * stride);
+        ASSERT_EQ(it != expected.end(), page_table.Find(candidate * stride, &frame_id));
+        if (it != expected.end()) {
+          EXPECT_EQ(it->second, frame_id);
+        }
+      }
+    }
+  }
+}
+
+TEST(PageTableTest, ConcurrentFindTest) {
+  // Readers may miss a page while the writer moves entries around, but they must never see a wrong mapping.
+  const size_t num_frames = 64;
+  const int num_readers = 4;
+  PageTable page_table(num_frames);
+  auto frame_of = [](page_id_t page_id) { return static_cast<frame_id_t>(page_id % 1000); };
+
+  std::atomic<bool> done{false};
+  std::vector<std::thread> readers;
+  for (int tid = 0; tid < num_readers; tid++) {
+    readers.emplace_back([&, tid] {
+      std::default_random_engine gen(tid);
+      while (!done) {
+        const auto page_id = static_cast<page_id_t>(gen() % (8 * num_frames));
+        frame_id_t frame_id;
+        if (page_table.Find(page_id, &frame_id)) {
+          EXPECT_EQ(frame_of(page_id), frame_id);
+        }
+      }
+    });
+  }
+
+  std::default_random_engine gen(42);
+  std::vector<page_id_t> mapped;
+  for (int i = 0; i < 200000; i++) {
+    if (mapped.size() < 2 * num_frames) {
+      const auto page_id = static_cast<page_id_t>(gen() % (8 * num_frames));
+      page_table.Insert(page_id, frame_of(page_id));
+      mapped.push_back(page_id);
+    } else {
+      const size_t victim = gen() % mapped.size();
+      page_table.Remove(mapped[victim]);
+      mapped[victim] = mapped.back();
+      mapped.pop_back();
+    }
+  }
+  done = true;
+  for (auto &reader : readers) {
+    reader.join();
+  }
+}
+
+}  // namespace bustub
@@ -0,0 +1,212 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// parallel_buffer_pool_manager_test.cpp
+//
+// Identification: test/buffer/parallel_buffer_pool_manager_test.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/parallel_buffer_pool_manager.h"
+
+#include <atomic>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "buffer/buffer_pool_manager.h"
+#include "gtest/gtest.h"
+#include "storage/disk/disk_manager_memory.h"
+
+namespace bustub {
+
+/** In-memory disk that counts syncs. */
+class SyncCountingDiskManager : public DiskManagerUnlimitedMemory {
+ public:
+  void Sync() override {
+    syncs_++;
+    DiskManagerUnlimitedMemory::Sync();
+  }
+
+  std::atomic<int> syncs_{0};
+};
+
+// NOLINTNEXTLINE
+TEST(ParallelBufferPoolManagerTest, SampleTest) {
+  const size_t num_instances = 5;
+  const size_t buffer_pool_size = 10;
+  const size_t k = 2;
+
+  auto disk_manager = std::make_unique<DiskManagerUnlimitedMemory>();
+  auto bpm = std::make_unique<ParallelBufferPoolManager>(num_instances, buffer_pool_size, disk_manager.get(), k);
+  EXPECT_EQ(num_instances * buffer_pool_size, bpm->GetPoolSize());
+  EXPECT_EQ(static_cast<int>(num_instances * buffer_pool_size), bpm->GetFreeListSize());
+
+  // Scenario: New pages are handed out round-robin, so the first pages land in distinct instances.
+  page_id_t page_id_temp;
+  auto *page0 = bpm->NewPage(&page_id_temp);
+  ASSERT_NE(nullptr, page0);
+  EXPECT_EQ(0, page_id_temp);
+
+  // Scenario: Once we have a page, we should be able to read and write content.
+  snprintf(page0->GetData(), BUSTUB_PAGE_SIZE, "Hello");
+  EXPECT_EQ(0, strcmp(page0->GetData(), "Hello"));
+
+  // Scenario: We should be able to create new pages until we fill up the whole pool.
+  for (size_t i = 1; i < num_instances * buffer_pool_size; ++i) {
+    EXPECT_NE(nullptr, bpm->NewPage(&page_id_temp));
+  }
+  EXPECT_EQ(0, bpm->GetFreeListSize());
+
+  // Scenario: Once every instance is full, we should not be able to create any new pages.
+  for (size_t i = 0; i < num_instances; ++i) {
+    EXPECT_EQ(nullptr, bpm->NewPage(&page_id_temp));
+  }
+
+  // Scenario: Pages {0, 1, 2, 3, 4} live in five different instances. After unpinning them, every instance has exactly
+  // one evictable frame, so we can create five new pages and the whole pool is pinned again.
+  for (int i = 0; i < 5; ++i) {
+    EXPECT_EQ(true, bpm->UnpinPage(i, true));
+  }
+  std::vector<page_id_t> new_page_ids;
+  for (int i = 0; i < 5; ++i) {
+    EXPECT_NE(nullptr, bpm->NewPage(&page_id_temp));
+    new_page_ids.push_back(page_id_temp);
+  }
+  EXPECT_EQ(nullptr, bpm->FetchPage(0));
+
+  // Scenario: Unpinning the new page that shares an instance with page 0 frees the frame that page 0 needs, and we
+  // should be able to fetch the data we wrote a while ago.
+  for (auto new_page_id : new_page_ids) {
+    if (new_page_id % static_cast<page_id_t>(num_instances) == 0) {
+      EXPECT_EQ(true, bpm->UnpinPage(new_page_id, false));
+    }
+  }
+  page0 = bpm->FetchPage(0);
+  ASSERT_NE(nullptr, page0);
+  EXPECT_EQ(0, strcmp(page0->GetData(), "Hello"));
+  EXPECT_EQ(true, bpm->UnpinPage(0, false));
+}
+
+// NOLINTNEXTLINE
+TEST(ParallelBufferPoolManagerTest, PagesStayInTheirInstance) {
+  const size_t num_instances = 4;
+  const size_t buffer_pool_size = 2;
+
+  auto disk_manager = std::make_unique<DiskManagerUnlimitedMemory>();
+  auto bpm = std::make_unique<ParallelBufferPoolManager>(num_instances, buffer_pool_size, disk_manager.get());
+
+  // Fill every instance with pinned pages, keeping track of which ids were handed out.
+  std::vector<page_id_t> page_ids;
+  for (size_t i = 0; i < num_instances * buffer_pool_size; ++i) {
+    page_id_t page_id;
+    auto *page = bpm->NewPage(&page_id);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), BUSTUB_PAGE_SIZE, "%d", page_id);
+    page_ids.push_back(page_id);
+  }
+
+  // Unpinning a single page frees exactly one frame, in the instance that owns that page. The next new page must be
+  // allocated by that instance, i.e. its id has to map back to the same instance.
+  const page_id_t victim = page_ids[1];
+  EXPECT_TRUE(bpm->UnpinPage(victim, true));
+  page_id_t page_id;
+  ASSERT_NE(nullptr, bpm->NewPage(&page_id));
+  EXPECT_EQ(victim % static_cast<page_id_t>(num_instances), page_id % static_cast<page_id_t>(num_instances));
+  EXPECT_TRUE(bpm->UnpinPage(page_id, false));
+
+  // The evicted page was written back and can be read again through the same instance.
+  auto *page = bpm->FetchPage(victim);
+  ASSERT_NE(nullptr, page);
+  EXPECT_EQ(std::to_string(victim), page->GetData());
+  EXPECT_TRUE(bpm->UnpinPage(victim, false));
+
+  for (auto id : page_ids) {
+    if (id != victim) {
+      EXPECT_TRUE(bpm->UnpinPage(id, false));
+    }
+  }
+  EXPECT_TRUE(bpm->DeletePage(victim));
+  EXPECT_FALSE(bpm->UnpinPage(INVALID_PAGE_ID, false));
+}
+
+// NOLINTNEXTLINE
+TEST(ParallelBufferPoolManagerTest, FlushAllPagesSyncsOnce) {
+  const size_t num_instances = 4;
+  const size_t buffer_pool_size = 4;
+
+  auto disk_manager = std::make_unique<SyncCountingDiskManager>();
+  auto bpm = std::make_unique<ParallelBufferPoolManager>(num_instances, buffer_pool_size, disk_manager.get());
+  std::vector<page_id_t> page_ids;
+  for (size_t i = 0; i < num_instances * buffer_pool_size; ++i) {
+    page_id_t page_id;
+    auto *page = bpm->NewPage(&page_id);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), BUSTUB_PAGE_SIZE, "%d", page_id);
+    EXPECT_TRUE(bpm->UnpinPage(page_id, true));
+    page_ids.push_back(page_id);
+  }
+
+  // Scenario: the dirty pages of every instance are written back, and the disk is synced once for all of them.
+  bpm->FlushAllPages();
+  EXPECT_EQ(1, disk_manager->syncs_);
+  for (auto page_id : page_ids) {
+    char data[BUSTUB_PAGE_SIZE];
+    disk_manager->ReadPage(page_id, data);
+    EXPECT_EQ(std::to_string(page_id), data);
+  }
+}
+
+// NOLINTNEXTLINE
+TEST(ParallelBufferPoolManagerTest, ConcurrencyTest) {
+  const size_t num_instances = 4;
+  const size_t buffer_pool_size = 16;
+  const size_t num_threads = 8;
+  const int num_pages = 256;
+  const int rounds = 2000;
+
+  auto disk_manager = std::make_unique<DiskManagerUnlimitedMemory>();
+  auto bpm = std::make_unique<ParallelBufferPoolManager>(num_instances, buffer_pool_size, disk_manager.get());
+
+  for (int i = 0; i < num_pages; ++i) {
+    page_id_t page_id;
+    auto *page = bpm->NewPage(&page_id);
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ(i, page_id);
+    memcpy(page->GetData(), &page_id, sizeof(page_id));
+    EXPECT_TRUE(bpm->UnpinPage(page_id, true));
+  }
+
+  std::vector<std::thread> threads;
+  for (size_t tid = 0; tid < num_threads; ++tid) {
+    threads.emplace_back([&bpm, tid] {
+      for (int i = 0; i < rounds; ++i) {
+        page_id_t page_id = static_cast<page_id_t>((i * 7 + tid * 31) % num_pages);
+        auto *page = bpm->FetchPage(page_id);
+        if (page == nullptr) {
+          continue;
+        }
+        page->RLatch();
+        page_id_t stored_id;
+        memcpy(&stored_id, page->GetData(), sizeof(stored_id));
+        page->RUnlatch();
+        EXPECT_EQ(page_id, stored_id);
+        EXPECT_TRUE(bpm->UnpinPage(page_id, false));
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+
+  EXPECT_EQ(static_cast<int>(num_instances * buffer_pool_size),
+            bpm->GetFreeListSize() + bpm->GetFreeEvictableSize());
+}
+
+}  // namespace bustub
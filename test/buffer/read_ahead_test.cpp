@@ -0,0 +1,228 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// read_ahead_test.cpp
+//
+// Identification: test/buffer/read_ahead_test.cpp
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/read_ahead.h"
+
+#include <atomic>
+#include <chrono>  // NOLINT
+#include <cstring>
+#include <memory>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "buffer/buffer_pool_manager_instance.h"
+#include "catalog/schema.h"
+#include "concurrency/transaction.h"
+#include "gtest/gtest.h"
+#include "storage/disk/disk_manager_memory.h"
+#include "storage/table/table_heap.h"
+#include "type/value_factory.h"
+
+namespace bustub {
+
+/** In-memory disk that counts reads. */
+class CountingDiskManager : public DiskManagerUnlimitedMemory {
+ public:
+  void ReadPage(page_id_t page_id, char *page_data) override {
+    reads_++;
+    DiskManagerUnlimitedMemory::ReadPage(page_id, page_data);
+  }
+
+  std::atomic<int> reads_{0};
+};
+
+/** In-memory disk whose reads take a while, so that the read-ahead is still busy when the test moves on. */
+class SlowDiskManager : public DiskManagerUnlimitedMemory {
+ public:
+  ~SlowDiskManager() override { RunShutdownHooks(); }
+
+  void ReadPage(page_id_t page_id, char *page_data) override {
+    std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    DiskManagerUnlimitedMemory::ReadPage(page_id, page_data);
+  }
+};
+
+/** The test chains store the id of the next page in the first bytes of every page. */
+static auto NextPageId(Page *page) -> page_id_t {
+  page_id_t next_page_id;
+  memcpy(&next_page_id, page->GetData(), sizeof(next_page_id));
+  return next_page_id;
+}
+
+/** Write `num_pages` pages linked into a chain 0 -> 1 -> ..., then fill the pool with other pages to evict the chain. */
+static void BuildChain(BufferPoolManager *bpm, int num_pages) {
+  for (int i = 0; i < num_pages; i++) {
+    page_id_t page_id;
+    auto *page = bpm->NewPage(&page_id);
+    ASSERT_NE(nullptr, page);
+    ASSERT_EQ(i, page_id);
+    page_id_t next_page_id = i + 1 < num_pages ? i + 1 : INVALID_PAGE_ID;
+    memcpy(page->GetData(), &next_page_id, sizeof(next_page_id));
+    ASSERT_TRUE(bpm->UnpinPage(page_id, true));
+  }
+  for (size_t i = 0; i < bpm->GetPoolSize(); i++) {
+    page_id_t page_id;
+    ASSERT_NE(nullptr, bpm->NewPage(&page_id));
+    ASSERT_TRUE(bpm->UnpinPage(page_id, false));
+  }
+}
+
+static void WaitForPrefetches(ReadAhead *read_ahead, uint64_t count) {
+  for (int i = 0; i < 500 && read_ahead->GetPrefetchCount() < count; i++) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  }
+  ASSERT_EQ(count, read_ahead->GetPrefetchCount());
+}
+
+// NOLINTNEXTLINE
+TEST(ReadAheadTest, ChainTest) {
+  auto disk_manager = std::make_unique<CountingDiskManager>();
+  auto bpm = std::make_unique<BufferPoolManagerInstance>(16, disk_manager.get());
+  BuildChain(bpm.get(), 10);
+  ReadAhead read_ahead(bpm.get());
+
+  // Scenario: reading ahead 4 pages after page 2 reads pages 2 to 6, and nothing else.
+  read_ahead.PrefetchChain(2, 4, &NextPageId);
+  WaitForPrefetches(&read_ahead, 5);
+  EXPECT_EQ(5, disk_manager->reads_);
+  EXPECT_EQ(16, bpm->GetFreeListSize() + bpm->GetFreeEvictableSize());
+
+  // Scenario: the scan then finds those pages in the pool.
+  for (page_id_t page_id = 2; page_id <= 6; page_id++) {
+    auto *page = bpm->FetchPage(page_id);
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ(page_id + 1, NextPageId(page));
+    EXPECT_TRUE(bpm->UnpinPage(page_id, false));
+  }
+  EXPECT_EQ(5, disk_manager->reads_);
+
+  // Scenario: the read-ahead stops at the end of the chain.
+  read_ahead.PrefetchChain(8, 4, &NextPageId);
+  WaitForPrefetches(&read_ahead, 7);
+  EXPECT_EQ(7, disk_manager->reads_);
+}
+
+// NOLINTNEXTLINE
+TEST(ReadAheadTest, PageListTest) {
+  auto disk_manager = std::make_unique<CountingDiskManager>();
+  auto bpm = std::make_unique<BufferPoolManagerInstance>(4, disk_manager.get());
+  BuildChain(bpm.get(), 8);
+  ReadAhead read_ahead(bpm.get());
+
+  read_ahead.Prefetch({7, 3, INVALID_PAGE_ID, 5});
+  WaitForPrefetches(&read_ahead, 3);
+  EXPECT_EQ(3, disk_manager->reads_);
+  for (page_id_t page_id : {7, 3, 5}) {
+    auto *page = bpm->FetchPage(page_id);
+    ASSERT_NE(nullptr, page);
+    EXPECT_TRUE(bpm->UnpinPage(page_id, false));
+  }
+  EXPECT_EQ(3, disk_manager->reads_);
+
+  // Scenario: a hint that finds every frame pinned is dropped instead of failing.
+  std::vector<page_id_t> pinned = {0, 1, 2, 3};
+  for (auto page_id : pinned) {
+    ASSERT_NE(nullptr, bpm->FetchPage(page_id));
+  }
+  read_ahead.Prefetch({4, 6});
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  EXPECT_EQ(3, read_ahead.GetPrefetchCount());
+  for (auto page_id : pinned) {
+    EXPECT_TRUE(bpm->UnpinPage(page_id, false));
+  }
+}
+
+// NOLINTNEXTLINE
+TEST(ReadAheadTest, TableScanTest) {
+  auto disk_manager = std::make_unique<CountingDiskManager>();
+  auto bpm = std::make_unique<BufferPoolManagerInstance>(8, disk_manager.get());
+  Schema schema{{Column{"a", TypeId::BIGINT}}};
+  Transaction txn(0);
+  TableHeap table(bpm.get(), nullptr, nullptr, &txn);
+
+  // many more table pages than frames
+  const int64_t num_tuples = 5000;
+  for (int64_t i = 0; i < num_tuples; i++) {
+    RID rid;
+    ASSERT_TRUE(table.InsertTuple(TupleRecord({ValueFactory::GetBigIntValue(i)}, &schema), &rid, &txn));
+  }
+
+  const size_t old_read_ahead_depth = read_ahead_depth;
+  read_ahead_depth = 4;
+  int64_t expected = 0;
+  for (auto it = table.Begin(&txn); it != table.End(); ++it) {
+    EXPECT_EQ(expected, it->GetValue(&schema, 0).GetAs<int64_t>());
+    expected++;
+  }
+  EXPECT_EQ(num_tuples, expected);
+
+  // Scenario: a scan with a ring reads ahead into the ring.
+  {
+    BufferAccessStrategy strategy(4);
+    expected = 0;
+    for (auto it = table.Begin(&txn, &strategy); it != table.End(); ++it) {
+      EXPECT_EQ(expected, it->GetValue(&schema, 0).GetAs<int64_t>());
+      expected++;
+    }
+  }
+  read_ahead_depth = old_read_ahead_depth;
+  EXPECT_EQ(num_tuples, expected);
+}
+
+// NOLINTNEXTLINE
+TEST(ReadAheadTest, RingTest) {
+  auto disk_manager = std::make_unique<CountingDiskManager>();
+  auto bpm = std::make_unique<BufferPoolManagerInstance>(16, disk_manager.get());
+  BuildChain(bpm.get(), 10);
+  ReadAhead read_ahead(bpm.get());
+
+  // Scenario: reading ahead into a ring of 4 frames recycles the frames of the first pages for the last ones.
+  {
+    BufferAccessStrategy strategy(4);
+    read_ahead.PrefetchChain(0, 5, &NextPageId, &strategy);
+    WaitForPrefetches(&read_ahead, 6);
+    EXPECT_EQ(6, disk_manager->reads_);
+    for (page_id_t page_id = 2; page_id <= 5; page_id++) {
+      ASSERT_NE(nullptr, bpm->FetchPage(page_id, &strategy));
+      EXPECT_TRUE(bpm->UnpinPage(page_id, false));
+    }
+    EXPECT_EQ(6, disk_manager->reads_);
+    ASSERT_NE(nullptr, bpm->FetchPage(0, &strategy));
+    EXPECT_TRUE(bpm->UnpinPage(0, false));
+    EXPECT_EQ(7, disk_manager->reads_);
+    read_ahead.Cancel(&strategy);
+  }
+}
+
+// NOLINTNEXTLINE
+TEST(ReadAheadTest, ShutDownTest) {
+  auto disk_manager = std::make_unique<SlowDiskManager>();
+  auto bpm = std::make_unique<BufferPoolManagerInstance>(16, disk_manager.get());
+  BuildChain(bpm.get(), 10);
+
+  // Scenario: a strategy that goes away while the pool still reads ahead into it cancels the read-ahead first.
+  {
+    BufferAccessStrategy strategy(8);
+    bpm->PrefetchChain(0, 9, &NextPageId, &strategy);
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  }
+
+  // Scenario: the disk manager may go away before the buffer pool while the pool reads ahead; later hints are dropped.
+  bpm->PrefetchChain(0, 9, &NextPageId, nullptr);
+  std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  disk_manager.reset();
+  bpm->PrefetchChain(0, 9, &NextPageId, nullptr);
+  bpm->PrefetchPages({1, 2, 3}, nullptr);
+  bpm.reset();
+}
+
+}  // namespace bustub
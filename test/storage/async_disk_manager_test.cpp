@@ -0,0 +1,174 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// async_disk_manager_test.cpp
+//
+// Identification: test/storage/async_disk_manager_test.cpp
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/disk/async_disk_manager.h"
+
+#include <unistd.h>
+
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <future>  // NOLINT
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "buffer/buffer_pool_manager_instance.h"
+#include "common/exception.h"
+#include "gtest/gtest.h"
+
+namespace bustub {
+
+class AsyncDiskManagerTest : public ::testing::TestWithParam<bool> {
+ protected:
+  // This function is called before every test.
+  void SetUp() override {
+    remove("test.db");
+    remove("test.log");
+  }
+
+  // This function is called after every test.
+  void TearDown() override {
+    remove("test.db");
+    remove("test.log");
+  };
+};
+
+// NOLINTNEXTLINE
+TEST_P(AsyncDiskManagerTest, ReadWriteTest) {
+  // a queue depth of 8 makes the 100 requests below queue up behind the ones in flight
+  AsyncDiskManager dm("test.db", 8, GetParam());
+  const int num_pages = 100;
+  std::vector<std::array<char, BUSTUB_PAGE_SIZE>> pages(num_pages);
+
+  std::vector<std::future<void>> writes;
+  for (int i = 0; i < num_pages; i++) {
+    snprintf(pages[i].data(), BUSTUB_PAGE_SIZE, "page %d", i);
+    writes.push_back(dm.WritePageAsync(i, pages[i].data()));
+  }
+  dm.SubmitIO();
+  for (auto &write : writes) {
+    write.wait();
+  }
+  EXPECT_EQ(num_pages, dm.GetNumWrites());
+
+  // Scenario: reads come back with what was written, in any order, and pages past the end of the file are zeroed.
+  std::vector<std::array<char, BUSTUB_PAGE_SIZE>> buffers(num_pages + 1);
+  buffers[num_pages].fill('x');
+  std::vector<std::future<void>> reads;
+  for (int i = num_pages; i >= 0; i--) {
+    reads.push_back(dm.ReadPageAsync(i, buffers[i].data()));
+  }
+  dm.SubmitIO();
+  for (auto &read : reads) {
+    read.wait();
+  }
+  for (int i = 0; i < num_pages; i++) {
+    EXPECT_EQ("page " + std::to_string(i), std::string(buffers[i].data()));
+  }
+  EXPECT_EQ('\0', buffers[num_pages][BUSTUB_PAGE_SIZE - 1]);
+
+  // Scenario: the synchronous calls see the same file.
+  char buf[BUSTUB_PAGE_SIZE];
+  dm.ReadPage(42, buf);
+  EXPECT_STREQ("page 42", buf);
+
+  // Scenario: with io_uring, a read that comes back with only part of a page fails instead of returning it.
+  if (dm.IsUsingIoUring()) {
+    ASSERT_EQ(0, truncate("test.db", std::filesystem::file_size("test.db") - BUSTUB_PAGE_SIZE / 2));
+    auto short_read = dm.ReadPageAsync(num_pages - 1, buf);
+    dm.SubmitIO();
+    EXPECT_THROW(short_read.get(), Exception);
+  }
+  dm.ShutDown();
+}
+
+// NOLINTNEXTLINE
+TEST_P(AsyncDiskManagerTest, BufferPoolTest) {
+  AsyncDiskManager dm("test.db", 16, GetParam());
+  auto bpm = std::make_unique<BufferPoolManagerInstance>(32, &dm);
+  const int num_pages = 200;
+  for (int i = 0; i < num_pages; i++) {
+    page_id_t page_id;
+    auto *page = bpm->NewPage(&page_id);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), BUSTUB_PAGE_SIZE, "page %d", page_id);
+    ASSERT_TRUE(bpm->UnpinPage(page_id, true));
+  }
+  // the pool holds the last 32 pages, dirty; flushing writes them in one batch
+  bpm->FlushAllPages();
+
+  // Scenario: a batch of reads loads pages that were evicted long ago, and fetches then hit them.
+  std::vector<page_id_t> page_ids;
+  for (page_id_t page_id = 0; page_id < 20; page_id++) {
+    page_ids.push_back(page_id);
+  }
+  EXPECT_EQ(20, bpm->LoadPages(page_ids, nullptr));
+  const int writes = dm.GetNumWrites();
+  for (page_id_t page_id = 0; page_id < num_pages; page_id++) {
+    auto *page = bpm->FetchPage(page_id);
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ("page " + std::to_string(page_id), std::string(page->GetData()));
+    ASSERT_TRUE(bpm->UnpinPage(page_id, false));
+  }
+  EXPECT_EQ(writes, dm.GetNumWrites());
+  bpm.reset();
+  dm.ShutDown();
+}
+
+// NOLINTNEXTLINE
+TEST_P(AsyncDiskManagerTest, DirectIOTest) {
+  AsyncDiskManager dm("test.db", 8, GetParam(), true);
+  if (!dm.IsDirectIO()) {
+    GTEST_SKIP() << "the file system does not support O_DIRECT";
+  }
+  const int num_pages = 40;
+  // every other request uses a buffer that is not aligned and has to go through an aligned copy
+  std::vector<char> storage((num_pages + 1) * BUSTUB_PAGE_SIZE);
+  auto *aligned_pages = static_cast<char *>(std::aligned_alloc(DiskManager::DIRECT_IO_ALIGNMENT,
+                                                               num_pages * BUSTUB_PAGE_SIZE));
+  auto buffer = [&](int i) {
+    return i % 2 == 0 ? aligned_pages + i * BUSTUB_PAGE_SIZE : storage.data() + i * BUSTUB_PAGE_SIZE + 8;
+  };
+
+  std::vector<std::future<void>> requests;
+  for (int i = 0; i < num_pages; i++) {
+    snprintf(buffer(i), BUSTUB_PAGE_SIZE, "page %d", i);
+    requests.push_back(dm.WritePageAsync(i, buffer(i)));
+  }
+  dm.SubmitIO();
+  for (auto &request : requests) {
+    request.wait();
+  }
+
+  requests.clear();
+  for (int i = 0; i < num_pages; i++) {
+    memset(buffer(i), 'x', BUSTUB_PAGE_SIZE);
+    requests.push_back(dm.ReadPageAsync(num_pages - 1 - i, buffer(i)));
+  }
+  dm.SubmitIO();
+  for (auto &request : requests) {
+    request.wait();
+  }
+  for (int i = 0; i < num_pages; i++) {
+    EXPECT_EQ("page " + std::to_string(num_pages - 1 - i), std::string(buffer(i)));
+  }
+  free(aligned_pages);
+  dm.ShutDown();
+}
+
+INSTANTIATE_TEST_SUITE_P(AsyncDiskManagerTest, AsyncDiskManagerTest, ::testing::Values(true, false),
+                         [](const ::testing::TestParamInfo<bool> &info) {
+                           return info.param ? "IoUring" : "ThreadPool";
+                         });
+
+}  // namespace bustub
@@ -10,11 +10,20 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <array>
 #include <cstring>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <thread>  // NOLINT
+#include <utility>
+#include <vector>
 
+#include "buffer/buffer_pool_manager_instance.h"
 #include "common/exception.h"
 #include "gtest/gtest.h"
 #include "storage/disk/disk_manager.h"
+#include "storage/disk/page_allocator.h"
 
 namespace bustub {
 
@@ -72,6 +81,329 @@ TEST_F(DiskManagerTest, ReadWriteLogTest) {
   dm.ShutDown();
 }
 
+// NOLINTNEXTLINE
+TEST_F(DiskManagerTest, LargeOffsetTest) {
+  char buf[BUSTUB_PAGE_SIZE] = {0};
+  char data[BUSTUB_PAGE_SIZE] = {0};
+  std::string db_file("test.db");
+  DiskManager dm(db_file);
+  std::strncpy(data, "A page beyond 8 GB.", sizeof(data));
+
+  // page_id * BUSTUB_PAGE_SIZE does not fit into an int; the file is sparse, so this takes no space
+  const page_id_t page_id = 3 << 20;
+  dm.WritePage(page_id, data);
+  dm.ReadPage(page_id, buf);
+  EXPECT_EQ(std::memcmp(buf, data, sizeof(buf)), 0);
+  dm.ReadPage(page_id - 1, buf);
+  EXPECT_EQ('\0', buf[0]);
+
+  dm.ShutDown();
+}
+
+// NOLINTNEXTLINE
+TEST_F(DiskManagerTest, ConcurrentReadWriteTest) {
+  std::string db_file("test.db");
+  DiskManager dm(db_file);
+  const int num_threads = 8;
+  const int pages_per_thread = 64;
+
+  // Scenario: threads write and read back pages at the same time without seeing each other's data.
+  std::vector<std::thread> threads;
+  for (int thread_id = 0; thread_id < num_threads; thread_id++) {
+    threads.emplace_back([&dm, thread_id] {
+      char buf[BUSTUB_PAGE_SIZE];
+      char data[BUSTUB_PAGE_SIZE];
+      for (int round = 0; round < 4; round++) {
+        for (int i = 0; i < pages_per_thread; i++) {
+          const page_id_t page_id = i * num_threads + thread_id;
+          memset(data, 'a' + (page_id + round) % 26, sizeof(data));
+          dm.WritePage(page_id, data);
+          dm.ReadPage(page_id, buf);
+          ASSERT_EQ(std::memcmp(buf, data, sizeof(buf)), 0);
+        }
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  EXPECT_EQ(4 * num_threads * pages_per_thread, dm.GetNumWrites());
+
+  dm.Sync();
+  dm.ShutDown();
+}
+
+// NOLINTNEXTLINE
+TEST_F(DiskManagerTest, WritePagesTest) {
+  auto dm = std::make_unique<DiskManager>("test.db");
+  // the pages around the end of the first group of pages, with the space map of the second group in between
+  const page_id_t boundary = PageAllocator::PAGES_PER_MAP;
+  for (page_id_t page_id = 0; page_id <= boundary + 2; page_id++) {
+    ASSERT_EQ(page_id, dm->AllocatePage());
+  }
+
+  std::vector<std::array<char, BUSTUB_PAGE_SIZE>> data(8);
+  const std::vector<page_id_t> page_ids = {boundary + 1, 2, boundary - 1, 0, boundary, 1, boundary - 2, 5};
+  std::vector<std::pair<page_id_t, const char *>> pages;
+  for (size_t i = 0; i < page_ids.size(); i++) {
+    snprintf(data[i].data(), BUSTUB_PAGE_SIZE, "page %d", page_ids[i]);
+    pages.emplace_back(page_ids[i], data[i].data());
+  }
+  dm->WritePages(pages);
+  EXPECT_EQ(static_cast<int>(page_ids.size()), dm->GetNumWrites());
+
+  // Scenario: every page lands at its own place, and the space map between the runs is left alone.
+  dm->ShutDown();
+  dm = std::make_unique<DiskManager>("test.db");
+  char buf[BUSTUB_PAGE_SIZE];
+  for (auto page_id : page_ids) {
+    dm->ReadPage(page_id, buf);
+    EXPECT_EQ("page " + std::to_string(page_id), std::string(buf));
+  }
+  dm->ReadPage(3, buf);
+  EXPECT_EQ('\0', buf[0]);
+  EXPECT_TRUE(dm->IsAllocated(boundary + 2));
+  EXPECT_FALSE(dm->IsAllocated(boundary + 3));
+  dm->ShutDown();
+}
+
+// NOLINTNEXTLINE
+TEST_F(DiskManagerTest, DirectIOTest) {
+  auto dm = std::make_unique<DiskManager>("test.db", true);
+  if (!dm->IsDirectIO()) {
+    GTEST_SKIP() << "the file system does not support O_DIRECT";
+  }
+  auto bpm = std::make_unique<BufferPoolManagerInstance>(8, dm.get());
+
+  // Scenario: buffer pool frames are aligned and go to the file as they are.
+  const int num_pages = 32;
+  for (int i = 0; i < num_pages; i++) {
+    page_id_t page_id;
+    auto *page = bpm->NewPage(&page_id);
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ(0, reinterpret_cast<uintptr_t>(page->GetData()) % DiskManager::DIRECT_IO_ALIGNMENT);
+    snprintf(page->GetData(), BUSTUB_PAGE_SIZE, "page %d", page_id);
+    ASSERT_TRUE(bpm->UnpinPage(page_id, true));
+  }
+  bpm->FlushAllPages();
+
+  // Scenario: buffers that are not aligned are copied through an aligned one, in both directions.
+  std::vector<char> storage(2 * BUSTUB_PAGE_SIZE);
+  char *unaligned = storage.data() + 1;
+  dm->ReadPage(5, unaligned);
+  EXPECT_STREQ("page 5", unaligned);
+  std::strncpy(unaligned, "rewritten", BUSTUB_PAGE_SIZE);
+  dm->WritePage(6, unaligned);
+  dm->ReadPage(num_pages, unaligned);
+  EXPECT_EQ('\0', unaligned[0]);
+
+  // Scenario: the pages and the space maps survive a restart.
+  bpm.reset();
+  dm->ShutDown();
+  dm = std::make_unique<DiskManager>("test.db", true);
+  bpm = std::make_unique<BufferPoolManagerInstance>(8, dm.get());
+  for (page_id_t page_id = 0; page_id < num_pages; page_id++) {
+    EXPECT_TRUE(dm->IsAllocated(page_id));
+    auto *page = bpm->FetchPage(page_id);
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ(page_id == 6 ? "rewritten" : "page " + std::to_string(page_id), std::string(page->GetData()));
+    ASSERT_TRUE(bpm->UnpinPage(page_id, false));
+  }
+  bpm.reset();
+  dm->ShutDown();
+}
+
+// NOLINTNEXTLINE
+TEST_F(DiskManagerTest, PageAllocatorTest) {
+  PageAllocator allocator;
+  for (page_id_t page_id = 0; page_id < 200; page_id++) {
+    EXPECT_EQ(page_id, allocator.Allocate(0, 1));
+  }
+
+  // Scenario: the lowest free page is reused first.
+  allocator.Free(150);
+  allocator.Free(7);
+  allocator.Free(8);
+  EXPECT_FALSE(allocator.IsAllocated(7));
+  EXPECT_EQ(7, allocator.Allocate(0, 1));
+  EXPECT_EQ(8, allocator.Allocate(0, 1));
+  EXPECT_EQ(150, allocator.Allocate(0, 1));
+  EXPECT_EQ(200, allocator.Allocate(0, 1));
+
+  // Scenario: instances of a parallel buffer pool only get the page ids they own.
+  allocator.Free(9);
+  allocator.Free(10);
+  allocator.Free(12);
+  EXPECT_EQ(10, allocator.Allocate(2, 4));
+  EXPECT_EQ(9, allocator.Allocate(1, 4));
+  EXPECT_EQ(203, allocator.Allocate(3, 4));
+  EXPECT_EQ(12, allocator.Allocate(0, 1));
+
+  // Scenario: instances that share the words of the bitmap each go on after their own last page, and still get back
+  // the pages they free.
+  PageAllocator striped;
+  for (page_id_t page_id = 0; page_id < 400; page_id++) {
+    EXPECT_EQ(page_id, striped.Allocate(page_id % 4, 4));
+  }
+  striped.Free(5);
+  striped.Free(6);
+  EXPECT_EQ(400, striped.Allocate(0, 4));
+  EXPECT_EQ(5, striped.Allocate(1, 4));
+  EXPECT_EQ(6, striped.Allocate(2, 4));
+  EXPECT_EQ(401, striped.Allocate(1, 4));
+
+  // Scenario: the bitmap grows into a second space map, and maps survive a store/load round trip.
+  PageAllocator restored;
+  allocator.Free(0);
+  while (allocator.Allocate(0, 1) < static_cast<page_id_t>(PageAllocator::PAGES_PER_MAP)) {
+  }
+  ASSERT_EQ(2, allocator.GetNumMaps());
+  char map_data[BUSTUB_PAGE_SIZE];
+  for (size_t map_index = 0; map_index < allocator.GetNumMaps(); map_index++) {
+    allocator.StoreMap(map_index, map_data);
+    restored.LoadMap(map_index, map_data);
+  }
+  EXPECT_TRUE(restored.IsAllocated(static_cast<page_id_t>(PageAllocator::PAGES_PER_MAP)));
+  EXPECT_FALSE(restored.IsAllocated(static_cast<page_id_t>(PageAllocator::PAGES_PER_MAP) + 1));
+  EXPECT_EQ(static_cast<page_id_t>(PageAllocator::PAGES_PER_MAP) + 1, restored.Allocate(0, 1));
+}
+
+// NOLINTNEXTLINE
+TEST_F(DiskManagerTest, PageAllocatorExtentTest) {
+  const auto extent = static_cast<page_id_t>(PageAllocator::PAGES_PER_EXTENT);
+  PageAllocator allocator;
+  EXPECT_EQ(0, allocator.Allocate(0, 1));
+
+  // Scenario: two objects that grow at the same time each start an extent of their own and stay in it.
+  page_id_t table = allocator.AllocateNear(INVALID_PAGE_ID, 0, 1);
+  page_id_t index = allocator.AllocateNear(INVALID_PAGE_ID, 0, 1);
+  EXPECT_EQ(extent, table);
+  EXPECT_EQ(2 * extent, index);
+  for (page_id_t i = 1; i < extent; i++) {
+    table = allocator.AllocateNear(table, 0, 1);
+    index = allocator.AllocateNear(index, 0, 1);
+    EXPECT_EQ(extent + i, table);
+    EXPECT_EQ(2 * extent + i, index);
+  }
+  // a full extent makes the object start the next free one
+  EXPECT_EQ(3 * extent, allocator.AllocateNear(table, 0, 1));
+
+  // Scenario: first-fit allocation does not take free pages of reserved extents.
+  allocator.Free(2 * extent + 5);
+  for (page_id_t page_id = 1; page_id < extent; page_id++) {
+    EXPECT_EQ(page_id, allocator.Allocate(0, 1));
+  }
+  EXPECT_EQ(4 * extent, allocator.Allocate(0, 1));
+  EXPECT_EQ(2 * extent + 5, allocator.AllocateNear(index, 0, 1));
+
+  // Scenario: a page goes after its near page if there is room there, and before it otherwise.
+  allocator.Free(extent + 3);
+  EXPECT_EQ(3 * extent + 1, allocator.AllocateNear(3 * extent, 0, 1));
+  EXPECT_EQ(extent + 3, allocator.AllocateNear(extent + 20, 0, 1));
+
+  // Scenario: an extent whose pages are all freed can be reserved by another object.
+  for (page_id_t page_id = 2 * extent; page_id < 3 * extent; page_id++) {
+    allocator.Free(page_id);
+  }
+  EXPECT_EQ(2 * extent, allocator.AllocateNear(INVALID_PAGE_ID, 0, 1));
+
+  // Scenario: instances of a parallel buffer pool place their pages among the ids they own.
+  const page_id_t striped = allocator.AllocateNear(INVALID_PAGE_ID, 1, 4);
+  EXPECT_EQ(5 * extent + 1, striped);
+  EXPECT_EQ(5 * extent + 5, allocator.AllocateNear(striped, 1, 4));
+
+  // Scenario: with more than 64 instances, an extent without a page of the instance is left to the others.
+  ASSERT_EQ(64, extent);
+  EXPECT_EQ(450, allocator.AllocateNear(INVALID_PAGE_ID, 50, 100));
+  EXPECT_EQ(6 * extent, allocator.AllocateNear(INVALID_PAGE_ID, 0, 1));
+}
+
+// NOLINTNEXTLINE
+TEST_F(DiskManagerTest, PersistentAllocationTest) {
+  char buf[BUSTUB_PAGE_SIZE] = {0};
+  char data[BUSTUB_PAGE_SIZE] = {0};
+  std::string db_file("test.db");
+  {
+    DiskManager dm(db_file);
+    for (page_id_t page_id = 0; page_id < 10; page_id++) {
+      ASSERT_EQ(page_id, dm.AllocatePage());
+      snprintf(data, sizeof(data), "page %d", page_id);
+      dm.WritePage(page_id, data);
+    }
+    dm.DeallocatePage(3);
+    dm.DeallocatePage(4);
+    dm.ShutDown();
+  }
+
+  // Scenario: a reopened file knows which pages are in use and hands out the freed ones again.
+  {
+    DiskManager dm(db_file);
+    EXPECT_TRUE(dm.IsAllocated(9));
+    EXPECT_FALSE(dm.IsAllocated(3));
+    dm.ReadPage(9, buf);
+    EXPECT_STREQ("page 9", buf);
+    EXPECT_EQ(3, dm.AllocatePage());
+    EXPECT_EQ(4, dm.AllocatePage());
+    EXPECT_EQ(10, dm.AllocatePage());
+    dm.ShutDown();
+  }
+
+  // Scenario: pages that a buffer pool deletes are reused, whether they are resident or not.
+  {
+    DiskManager dm(db_file);
+    BufferPoolManagerInstance bpm(2, &dm);
+    page_id_t page_id;
+    ASSERT_NE(nullptr, bpm.NewPage(&page_id));
+    EXPECT_EQ(11, page_id);
+    ASSERT_TRUE(bpm.UnpinPage(page_id, false));
+    EXPECT_TRUE(bpm.DeletePage(page_id));
+    EXPECT_TRUE(bpm.DeletePage(0));
+    ASSERT_NE(nullptr, bpm.NewPage(&page_id));
+    EXPECT_EQ(0, page_id);
+    ASSERT_TRUE(bpm.UnpinPage(page_id, false));
+    ASSERT_NE(nullptr, bpm.NewPage(&page_id));
+    EXPECT_EQ(11, page_id);
+    ASSERT_TRUE(bpm.UnpinPage(page_id, false));
+
+    // the reused page starts out zeroed, not with the content of the deleted page
+    auto *page = bpm.FetchPage(0);
+    ASSERT_NE(nullptr, page);
+    EXPECT_STREQ("", page->GetData());
+    ASSERT_TRUE(bpm.UnpinPage(0, false));
+    bpm.FlushAllPages();
+    dm.ReadPage(0, buf);
+    EXPECT_STREQ("", buf);
+    dm.ShutDown();
+  }
+}
+
+// NOLINTNEXTLINE
+TEST_F(DiskManagerTest, FileFormatTest) {
+  char data[BUSTUB_PAGE_SIZE] = {0};
+  std::string db_file("test.db");
+
+  // Scenario: the space maps reach the file with Sync(), not with the pages written after an allocation.
+  {
+    DiskManager dm(db_file);
+    for (page_id_t page_id = 0; page_id < 3; page_id++) {
+      ASSERT_EQ(page_id, dm.AllocatePage());
+      dm.WritePage(page_id, data);
+    }
+    EXPECT_FALSE(DiskManager(db_file).IsAllocated(2));
+    dm.Sync();
+    EXPECT_TRUE(DiskManager(db_file).IsAllocated(2));
+    dm.ShutDown();
+  }
+
+  // Scenario: a file without the header of the current format, e.g. one from before the space maps, is rejected.
+  {
+    std::ofstream old_file(db_file, std::ios::binary | std::ios::trunc);
+    std::strncpy(data, "page 0", sizeof(data));
+    old_file.write(data, sizeof(data));
+  }
+  EXPECT_THROW(DiskManager{db_file}, Exception);
+}
+
 // NOLINTNEXTLINE
 TEST_F(DiskManagerTest, ThrowBadFileTest) { EXPECT_THROW(DiskManager("dev/null\\/foo/bar/baz/test.db"), Exception); }
 
@@ -0,0 +1,144 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// mmap_disk_manager_test.cpp
+//
+// Identification: test/storage/mmap_disk_manager_test.cpp
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/disk/mmap_disk_manager.h"
+
+#include <cstring>
+#include <memory>
+#include <string>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "buffer/buffer_pool_manager_instance.h"
+#include "common/exception.h"
+#include "gtest/gtest.h"
+
+namespace bustub {
+
+class MmapDiskManagerTest : public ::testing::Test {
+ protected:
+  // This function is called before every test.
+  void SetUp() override {
+    remove("test.db");
+    remove("test.log");
+  }
+
+  // This function is called after every test.
+  void TearDown() override {
+    remove("test.db");
+    remove("test.log");
+  };
+
+  /** Write `num_pages` pages that say which page they are, through a read-write disk manager. */
+  static void CreateDatabase(int num_pages) {
+    DiskManager dm("test.db");
+    auto bpm = std::make_unique<BufferPoolManagerInstance>(8, &dm);
+    for (int i = 0; i < num_pages; i++) {
+      page_id_t page_id;
+      auto *page = bpm->NewPage(&page_id);
+      ASSERT_NE(nullptr, page);
+      snprintf(page->GetData(), BUSTUB_PAGE_SIZE, "page %d", page_id);
+      ASSERT_TRUE(bpm->UnpinPage(page_id, true));
+    }
+    bpm->FlushAllPages();
+    bpm.reset();
+    dm.ShutDown();
+  }
+};
+
+// NOLINTNEXTLINE
+TEST_F(MmapDiskManagerTest, ReadTest) {
+  const int num_pages = 100;
+  CreateDatabase(num_pages);
+  MmapDiskManager dm("test.db");
+
+  // Scenario: pages and space maps are read from the mapping, by many threads at once.
+  std::vector<std::thread> threads;
+  for (int thread_id = 0; thread_id < 4; thread_id++) {
+    threads.emplace_back([&dm, thread_id] {
+      char buf[BUSTUB_PAGE_SIZE];
+      for (page_id_t page_id = thread_id; page_id < num_pages; page_id += 4) {
+        dm.ReadPage(page_id, buf);
+        EXPECT_EQ("page " + std::to_string(page_id), std::string(buf));
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  EXPECT_TRUE(dm.IsAllocated(num_pages - 1));
+  EXPECT_FALSE(dm.IsAllocated(num_pages));
+
+  // Scenario: pages past the end of the file read as zeroes.
+  char buf[BUSTUB_PAGE_SIZE];
+  memset(buf, 'x', sizeof(buf));
+  dm.ReadPage(10 * num_pages, buf);
+  EXPECT_EQ('\0', buf[0]);
+  EXPECT_EQ('\0', buf[BUSTUB_PAGE_SIZE - 1]);
+
+  // Scenario: nothing may change the file.
+  EXPECT_THROW(dm.WritePage(0, buf), Exception);
+  EXPECT_THROW(dm.WritePages({{0, buf}}), Exception);
+  EXPECT_THROW(dm.AllocatePage(), Exception);
+  EXPECT_THROW(dm.DeallocatePage(0), Exception);
+  dm.ReadPage(0, buf);
+  EXPECT_STREQ("page 0", buf);
+  dm.ShutDown();
+}
+
+// NOLINTNEXTLINE
+TEST_F(MmapDiskManagerTest, BufferPoolTest) {
+  const int num_pages = 50;
+  CreateDatabase(num_pages);
+  MmapDiskManager dm("test.db");
+  auto bpm = std::make_unique<BufferPoolManagerInstance>(8, &dm);
+
+  // Scenario: a buffer pool reads the pages from the mapping, evicting clean pages without writing anything.
+  for (page_id_t page_id = 0; page_id < num_pages; page_id++) {
+    auto *page = bpm->FetchPage(page_id);
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ("page " + std::to_string(page_id), std::string(page->GetData()));
+    ASSERT_TRUE(bpm->UnpinPage(page_id, false));
+  }
+  EXPECT_EQ(0, dm.GetNumWrites());
+  page_id_t page_id;
+  EXPECT_THROW(bpm->NewPage(&page_id), Exception);
+
+  // Scenario: scan hints reach the disk manager, and overlapping scans keep the sequential advice until the last ends.
+  bpm->BeginSequentialScan();
+  bpm->BeginSequentialScan();
+  EXPECT_EQ(2, dm.GetSequentialScanCount());
+  bpm->EndSequentialScan();
+  EXPECT_EQ(1, dm.GetSequentialScanCount());
+  bpm->EndSequentialScan();
+  EXPECT_EQ(0, dm.GetSequentialScanCount());
+  bpm.reset();
+  dm.ShutDown();
+}
+
+// NOLINTNEXTLINE
+TEST_F(MmapDiskManagerTest, EmptyFileTest) {
+  { DiskManager("test.db").ShutDown(); }
+  MmapDiskManager dm("test.db");
+  char buf[BUSTUB_PAGE_SIZE];
+  dm.ReadPage(0, buf);
+  EXPECT_EQ('\0', buf[0]);
+  EXPECT_FALSE(dm.IsAllocated(0));
+  dm.BeginSequentialScan();
+  dm.EndSequentialScan();
+  dm.ShutDown();
+}
+
+// NOLINTNEXTLINE
+TEST_F(MmapDiskManagerTest, MissingFileTest) { EXPECT_THROW(MmapDiskManager("test.db"), Exception); }
+
+}  // namespace bustub
@@ -0,0 +1,280 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// column_table_test.cpp
+//
+// Identification: test/table/column_table_test.cpp
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <string>
+#include <vector>
+
+#include "buffer/buffer_pool_manager_instance.h"
+#include "concurrency/transaction_manager.h"
+#include "fmt/format.h"
+#include "gtest/gtest.h"
+#include "storage/table/column_segment.h"
+#include "storage/table/column_table.h"
+#include "type/value_factory.h"
+
+namespace bustub {
+
+/** Encode values, check that the segment has the encoding, and that it decodes to the values again. */
+static void ExpectRoundTrip(TypeId type_id, const std::vector<Value> &values, ColumnSegment::Encoding encoding) {
+  const std::vector<char> segment = ColumnSegment::Encode(type_id, values);
+  const ColumnSegment::Header header = ColumnSegment::ReadHeader(type_id, segment.data());
+  EXPECT_EQ(encoding, header.encoding_);
+  EXPECT_EQ(values.size(), header.row_count_);
+  std::vector<Value> decoded;
+  ColumnSegment::Decode(type_id, segment.data(), &decoded);
+  ASSERT_EQ(values.size(), decoded.size());
+  for (size_t i = 0; i < values.size(); i++) {
+    ASSERT_EQ(values[i].IsNull(), decoded[i].IsNull()) << i;
+    if (!values[i].IsNull()) {
+      ASSERT_EQ(CmpBool::CmpTrue, values[i].CompareEquals(decoded[i])) << i;
+    }
+  }
+}
+
+TEST(ColumnTableTest, SegmentEncodings) {
+  // Scenario: a column of distinct integers packs their distance from the smallest one, here in 12 bits.
+  std::vector<Value> ids;
+  for (int32_t i = 0; i < 4096; i++) {
+    ids.push_back(ValueFactory::GetIntegerValue(100000 + i));
+  }
+  ExpectRoundTrip(TypeId::INTEGER, ids, ColumnSegment::Encoding::FOR);
+  const std::vector<char> id_segment = ColumnSegment::Encode(TypeId::INTEGER, ids);
+  EXPECT_GT(ColumnSegment::SIZE_HEADER + 12 + 4096 * 12 / 8 + 1, id_segment.size());
+  const ColumnSegment::Header id_header = ColumnSegment::ReadHeader(TypeId::INTEGER, id_segment.data());
+  ASSERT_TRUE(id_header.has_range_);
+  EXPECT_EQ(100000, id_header.min_.GetAs<int32_t>());
+  EXPECT_EQ(104095, id_header.max_.GetAs<int32_t>());
+
+  // Scenario: a column of long runs is run-length encoded.
+  std::vector<Value> groups;
+  for (int32_t i = 0; i < 4096; i++) {
+    groups.push_back(ValueFactory::GetIntegerValue(i / 1000));
+  }
+  ExpectRoundTrip(TypeId::INTEGER, groups, ColumnSegment::Encoding::RLE);
+
+  // Scenario: nulls and negative values of every integer type survive the frame of reference.
+  std::vector<Value> bigs;
+  std::vector<Value> tinys;
+  for (int64_t i = 0; i < 1000; i++) {
+    bigs.push_back(i % 7 == 0 ? ValueFactory::GetNullValueByType(TypeId::BIGINT)
+                              : ValueFactory::GetBigIntValue(-5000000000 + i * 12345));
+    tinys.push_back(ValueFactory::GetTinyIntValue(static_cast<int8_t>(i % 16 - 8)));
+  }
+  ExpectRoundTrip(TypeId::BIGINT, bigs, ColumnSegment::Encoding::FOR);
+  ExpectRoundTrip(TypeId::TINYINT, tinys, ColumnSegment::Encoding::FOR);
+  const std::vector<char> big_segment = ColumnSegment::Encode(TypeId::BIGINT, bigs);
+  const ColumnSegment::Header big_header = ColumnSegment::ReadHeader(TypeId::BIGINT, big_segment.data());
+  EXPECT_EQ(143, big_header.null_count_);
+  EXPECT_EQ(-5000000000 + 12345, big_header.min_.GetAs<int64_t>());
+  const std::vector<char> tiny_segment = ColumnSegment::Encode(TypeId::TINYINT, tinys);
+  const ColumnSegment::Header tiny_header = ColumnSegment::ReadHeader(TypeId::TINYINT, tiny_segment.data());
+  EXPECT_EQ(-8, tiny_header.min_.GetAs<int8_t>());
+  EXPECT_EQ(7, tiny_header.max_.GetAs<int8_t>());
+
+  // Scenario: a varchar column of few distinct values gets a dictionary, one of distinct values stays plain.
+  std::vector<Value> names;
+  std::vector<Value> comments;
+  for (int32_t i = 0; i < 2000; i++) {
+    names.push_back(i % 11 == 0 ? ValueFactory::GetNullValueByType(TypeId::VARCHAR)
+                                : ValueFactory::GetVarcharValue(fmt::format("name{}", i % 5)));
+    comments.push_back(ValueFactory::GetVarcharValue(fmt::format("comment number {}", i)));
+  }
+  ExpectRoundTrip(TypeId::VARCHAR, names, ColumnSegment::Encoding::DICTIONARY);
+  ExpectRoundTrip(TypeId::VARCHAR, comments, ColumnSegment::Encoding::PLAIN);
+  const std::vector<char> name_segment = ColumnSegment::Encode(TypeId::VARCHAR, names);
+  EXPECT_FALSE(ColumnSegment::ReadHeader(TypeId::VARCHAR, name_segment.data()).has_range_);
+
+  // Scenario: decimals can only be stored plain, or as runs.
+  std::vector<Value> prices;
+  for (int32_t i = 0; i < 1000; i++) {
+    prices.push_back(ValueFactory::GetDecimalValue(i * 0.25));
+  }
+  ExpectRoundTrip(TypeId::DECIMAL, prices, ColumnSegment::Encoding::PLAIN);
+  // a column of nulls only has no range
+  std::vector<Value> nulls(100, ValueFactory::GetNullValueByType(TypeId::INTEGER));
+  ExpectRoundTrip(TypeId::INTEGER, nulls, ColumnSegment::Encoding::RLE);
+  const std::vector<char> null_segment = ColumnSegment::Encode(TypeId::INTEGER, nulls);
+  EXPECT_FALSE(ColumnSegment::ReadHeader(TypeId::INTEGER, null_segment.data()).has_range_);
+}
+
+TEST(ColumnTableTest, InsertScanDelete) {
+  Schema schema{std::vector<Column>{Column{"id", TypeId::INTEGER}, Column{"grp", TypeId::INTEGER},
+                                    Column{"name", TypeId::VARCHAR, 16}, Column{"big", TypeId::BIGINT}}};
+  auto *disk_manager = new DiskManager("test.db");
+  auto *buffer_pool_manager = new BufferPoolManagerInstance(50, disk_manager);
+  auto *lock_manager = new LockManager();
+  auto *txn_manager = new TransactionManager(lock_manager);
+  auto *table = new ColumnTable(buffer_pool_manager, schema);
+
+  // every ninth big is null
+  auto make_tuple = [&schema](int32_t id) {
+    std::vector<Value> values{ValueFactory::GetIntegerValue(id), ValueFactory::GetIntegerValue(id / 1000),
+                              ValueFactory::GetVarcharValue(fmt::format("name{}", id % 10)),
+                              id % 9 == 0 ? ValueFactory::GetNullValueByType(TypeId::BIGINT)
+                                          : ValueFactory::GetBigIntValue(static_cast<int64_t>(id) * 7)};
+    return TupleRecord(values, &schema);
+  };
+  auto expect_row = [](int32_t id, const std::vector<Value> &values) {
+    ASSERT_EQ(4, values.size());
+    EXPECT_EQ(id, values[0].GetAs<int32_t>());
+    EXPECT_EQ(id / 1000, values[1].GetAs<int32_t>());
+    EXPECT_EQ(fmt::format("name{}", id % 10), values[2].ToString());
+    EXPECT_EQ(id % 9 == 0, values[3].IsNull());
+    if (id % 9 != 0) {
+      EXPECT_EQ(static_cast<int64_t>(id) * 7, values[3].GetAs<int64_t>());
+    }
+  };
+  auto count_rows = [&table]() {
+    ColumnTable::Scanner scanner(table, {});
+    std::vector<Value> values;
+    RID rid;
+    int count = 0;
+    while (scanner.Next(&values, &rid)) {
+      count++;
+    }
+    return count;
+  };
+
+  // Scenario: rows inserted in batches fill two row groups, and the rest stay in the tail.
+  auto *txn = txn_manager->Begin();
+  std::vector<RID> rids;
+  for (int32_t start = 0; start < 10000; start += 500) {
+    std::vector<TupleRecord> batch;
+    for (int32_t id = start; id < start + 500; id++) {
+      batch.push_back(make_tuple(id));
+    }
+    std::vector<const TupleRecord *> batch_ptrs;
+    for (const auto &tuple : batch) {
+      batch_ptrs.push_back(&tuple);
+    }
+    std::vector<RID> batch_rids;
+    ASSERT_TRUE(table->InsertTuples(batch_ptrs, &batch_rids, txn));
+    rids.insert(rids.end(), batch_rids.begin(), batch_rids.end());
+  }
+  txn_manager->Commit(txn);
+  delete txn;
+  ASSERT_EQ(2, table->GetRowGroupCount());
+  EXPECT_EQ(RID(1, 5), rids[ColumnTable::ROW_GROUP_SIZE + 5]);
+  EXPECT_EQ(ColumnSegment::Encoding::FOR, table->GetSegmentHeader(0, 0).encoding_);
+  EXPECT_EQ(ColumnSegment::Encoding::RLE, table->GetSegmentHeader(0, 1).encoding_);
+  EXPECT_EQ(ColumnSegment::Encoding::DICTIONARY, table->GetSegmentHeader(0, 2).encoding_);
+  EXPECT_EQ(ColumnSegment::Encoding::FOR, table->GetSegmentHeader(1, 3).encoding_);
+  EXPECT_NE(INVALID_PAGE_ID, table->GetFirstPageId(3));
+
+  // Scenario: a scan of all columns returns every row in order, from the segments and from the tail.
+  {
+    ColumnTable::Scanner scanner(table, {0, 1, 2, 3});
+    std::vector<Value> values;
+    RID rid;
+    int32_t next_id = 0;
+    while (scanner.Next(&values, &rid)) {
+      ASSERT_EQ(rids[next_id], rid);
+      expect_row(next_id, values);
+      next_id++;
+    }
+    EXPECT_EQ(10000, next_id);
+  }
+
+  // Scenario: a scan of one column returns nulls for the others.
+  {
+    ColumnTable::Scanner scanner(table, {2});
+    std::vector<Value> values;
+    RID rid;
+    ASSERT_TRUE(scanner.Next(&values, &rid));
+    EXPECT_TRUE(values[0].IsNull());
+    EXPECT_EQ("name0", values[2].ToString());
+    EXPECT_TRUE(values[3].IsNull());
+  }
+
+  // Scenario: a scan with a range passes over the row groups whose segments rule it out, but not over the tail.
+  {
+    ZoneMap::Range range;
+    range.column_idx_ = 0;
+    range.lower_ = ValueFactory::GetIntegerValue(5000);
+    range.upper_ = ValueFactory::GetIntegerValue(5100);
+    ColumnTable::Scanner scanner(table, {0}, {range});
+    std::vector<Value> values;
+    RID rid;
+    std::vector<int32_t> ids;
+    while (scanner.Next(&values, &rid)) {
+      ids.push_back(values[0].GetAs<int32_t>());
+    }
+    ASSERT_EQ(ColumnTable::ROW_GROUP_SIZE + 10000 - 2 * ColumnTable::ROW_GROUP_SIZE, ids.size());
+    EXPECT_EQ(static_cast<int32_t>(ColumnTable::ROW_GROUP_SIZE), ids.front());
+  }
+
+  // Scenario: a row is read by rid from a segment and from the tail.
+  std::vector<Value> values;
+  ASSERT_TRUE(table->GetTuple(rids[4321], &values));
+  expect_row(4321, values);
+  ASSERT_TRUE(table->GetTuple(rids[9999], &values));
+  expect_row(9999, values);
+  EXPECT_FALSE(table->GetTuple(RID(0, ColumnTable::ROW_GROUP_SIZE), &values));
+
+  // Scenario: an abort brings deleted rows back and drops the rows that updates appended.
+  txn = txn_manager->Begin();
+  ASSERT_TRUE(table->MarkDelete(rids[5], txn));
+  EXPECT_FALSE(table->MarkDelete(rids[5], txn));
+  RID new_rid;
+  ASSERT_TRUE(table->UpdateTuple(make_tuple(20006), rids[6], txn, &new_rid));
+  EXPECT_EQ(RID(2, 10000 - 2 * ColumnTable::ROW_GROUP_SIZE), new_rid);
+  EXPECT_FALSE(table->GetTuple(rids[6], &values));
+  ASSERT_TRUE(table->GetTuple(new_rid, &values));
+  expect_row(20006, values);
+  EXPECT_EQ(9999, count_rows());
+  txn_manager->Abort(txn);
+  EXPECT_EQ(10000, count_rows());
+  ASSERT_TRUE(table->GetTuple(rids[5], &values));
+  expect_row(5, values);
+  ASSERT_TRUE(table->GetTuple(rids[6], &values));
+  expect_row(6, values);
+  EXPECT_FALSE(table->GetTuple(new_rid, &values));
+  delete txn;
+
+  // Scenario: a commit keeps the deletes.
+  txn = txn_manager->Begin();
+  ASSERT_TRUE(table->MarkDelete(rids[7], txn));
+  txn_manager->Commit(txn);
+  delete txn;
+  EXPECT_EQ(9999, count_rows());
+  EXPECT_FALSE(table->GetTuple(rids[7], &values));
+
+  // Scenario: a scan sees the rows that were there when it started, even after the tail was written out.
+  txn = txn_manager->Begin();
+  {
+    ColumnTable::Scanner scanner(table, {0});
+    RID rid;
+    ASSERT_TRUE(table->InsertTuple(make_tuple(30000), &rid, txn));
+    ASSERT_TRUE(table->Flush());
+    ASSERT_EQ(3, table->GetRowGroupCount());
+    int count = 0;
+    while (scanner.Next(&values, &rid)) {
+      count++;
+    }
+    EXPECT_EQ(9999, count);
+  }
+  txn_manager->Commit(txn);
+  delete txn;
+  EXPECT_EQ(10000, count_rows());
+  ASSERT_TRUE(table->GetTuple(rids[9999], &values));
+  expect_row(9999, values);
+
+  delete table;
+  delete txn_manager;
+  delete lock_manager;
+  delete buffer_pool_manager;
+  disk_manager->ShutDown();
+  remove("test.db");
+  delete disk_manager;
+}
+
+}  // namespace bustub
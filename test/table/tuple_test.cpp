@@ -12,15 +12,22 @@
 
 #include <algorithm>
 #include <cstdio>
+#include <cstring>
 #include <iostream>
+#include <map>
+#include <set>
 #include <string>
 #include <vector>
 
 #include "buffer/buffer_pool_manager_instance.h"
+#include "common/exception.h"
+#include "fmt/format.h"
 #include "gtest/gtest.h"
 #include "logging/common.h"
+#include "storage/page/over_flow_page.h"
 #include "storage/table/table_heap.h"
 #include "storage/table/tuple.h"
+#include "type/value_factory.h"
 
 namespace bustub {
 // NOLINTNEXTLINE
@@ -569,5 +576,860 @@ TEST(TupleTest, TableInsertMostafaString) {
   delete lock_manager;
 }
 
- 
+TEST(TupleTest, TableHeapFreeSpaceMap) {
+  Schema schema{std::vector<Column>{Column{"a", TypeId::VARCHAR, 200}}};
+  TupleRecord tuple(std::vector<Value>{Value(TypeId::VARCHAR, std::string(200, 'x'))}, &schema);
+
+  auto *transaction = new Transaction(0);
+  auto *disk_manager = new DiskManager("test.db");
+  auto *buffer_pool_manager = new BufferPoolManagerInstance(50, disk_manager);
+  auto *lock_manager = new LockManager();
+  auto *log_manager = new LogManager(disk_manager);
+  auto *table = new TableHeap(buffer_pool_manager, lock_manager, log_manager, transaction);
+
+  // Scenario: inserts fill the pages of the heap in order, and the map knows every page.
+  std::vector<RID> rid_v;
+  for (int i = 0; i < 200; ++i) {
+    RID rid;
+    ASSERT_TRUE(table->InsertTuple(tuple, &rid, transaction));
+    rid_v.push_back(rid);
+  }
+  std::vector<page_id_t> page_ids;
+  for (page_id_t page_id = table->GetFirstPageId(); page_id != INVALID_PAGE_ID;) {
+    page_ids.push_back(page_id);
+    auto *page = static_cast<TablePage *>(buffer_pool_manager->FetchPage(page_id));
+    const page_id_t next_page_id = page->GetNextPageId();
+    buffer_pool_manager->UnpinPage(page_id, false);
+    page_id = next_page_id;
+  }
+  auto *free_space_map = table->GetFreeSpaceMap();
+  ASSERT_GT(page_ids.size(), 5);
+  EXPECT_EQ(page_ids.size(), free_space_map->GetNumPages());
+  EXPECT_EQ(page_ids.back(), free_space_map->GetLastPageId());
+  EXPECT_EQ(page_ids.back(), rid_v.back().GetPageId());
+  EXPECT_LT(free_space_map->GetFreeSpace(page_ids[0]), tuple.GetLength());
+
+  // Scenario: space that deletes free up on an early page is used once the page that inserts go to is full.
+  const page_id_t first_page_id = table->GetFirstPageId();
+  for (const auto &rid : rid_v) {
+    if (rid.GetPageId() == first_page_id && rid.GetSlotNum() < 3) {
+      ASSERT_TRUE(table->MarkDelete(rid, transaction));
+      table->ApplyDelete(rid, transaction);
+    }
+  }
+  EXPECT_GE(free_space_map->GetFreeSpace(first_page_id), 3 * tuple.GetLength());
+  RID rid;
+  do {
+    ASSERT_TRUE(table->InsertTuple(tuple, &rid, transaction));
+  } while (rid.GetPageId() == page_ids.back());
+  EXPECT_EQ(first_page_id, rid.GetPageId());
+
+  // Scenario: a reopened heap loads the map, and one without a map gets it rebuilt from the pages.
+  const uint32_t first_page_free_space = free_space_map->GetFreeSpace(first_page_id);
+  for (bool drop_map : {false, true}) {
+    if (drop_map) {
+      auto *page = static_cast<TablePage *>(buffer_pool_manager->FetchPage(first_page_id));
+      page->SetFreeSpaceMapPageId(INVALID_PAGE_ID);
+      buffer_pool_manager->UnpinPage(first_page_id, true);
+    }
+    TableHeap reopened(buffer_pool_manager, lock_manager, log_manager, first_page_id);
+    EXPECT_EQ(page_ids.size(), reopened.GetFreeSpaceMap()->GetNumPages());
+    EXPECT_EQ(page_ids.back(), reopened.GetFreeSpaceMap()->GetLastPageId());
+    EXPECT_EQ(first_page_free_space, reopened.GetFreeSpaceMap()->GetFreeSpace(first_page_id));
+  }
+
+  // Scenario: with every other frame of the pool pinned, an update of the map still reaches its map page.
+  {
+    TableHeap reopened(buffer_pool_manager, lock_manager, log_manager, first_page_id);
+    std::vector<page_id_t> pinned_page_ids;
+    for (page_id_t page_id; buffer_pool_manager->NewPage(&page_id) != nullptr;) {
+      pinned_page_ids.push_back(page_id);
+    }
+    reopened.GetFreeSpaceMap()->Update(page_ids[1], BUSTUB_PAGE_SIZE / 2);
+    for (const page_id_t page_id : pinned_page_ids) {
+      buffer_pool_manager->UnpinPage(page_id, false);
+      buffer_pool_manager->DeletePage(page_id);
+    }
+  }
+  {
+    TableHeap reopened(buffer_pool_manager, lock_manager, log_manager, first_page_id);
+    EXPECT_EQ(BUSTUB_PAGE_SIZE / 2, reopened.GetFreeSpaceMap()->GetFreeSpace(page_ids[1]));
+  }
+
+  // Scenario: a page that was unlinked from the heap without the map knowing is dropped from the map on open.
+  auto *page = static_cast<TablePage *>(buffer_pool_manager->FetchPage(page_ids[1]));
+  page->SetNextPageId(page_ids[3]);
+  buffer_pool_manager->UnpinPage(page_ids[1], true);
+  {
+    TableHeap reopened(buffer_pool_manager, lock_manager, log_manager, first_page_id);
+    EXPECT_EQ(page_ids.size() - 1, reopened.GetFreeSpaceMap()->GetNumPages());
+    EXPECT_EQ(0, reopened.GetFreeSpaceMap()->GetFreeSpace(page_ids[2]));
+    EXPECT_EQ(page_ids.back(), reopened.GetFreeSpaceMap()->GetLastPageId());
+  }
+
+  disk_manager->ShutDown();
+  remove("test.db");  // remove db file
+  remove("test.log");
+  delete table;
+  delete buffer_pool_manager;
+  delete disk_manager;
+  delete transaction;
+  delete log_manager;
+  delete lock_manager;
+}
+
+TEST(TupleTest, TableHeapBatchInsert) {
+  Schema schema{std::vector<Column>{Column{"a", TypeId::VARCHAR, 200}}};
+  Schema large_schema{std::vector<Column>{Column{"a", TypeId::VARCHAR, 10000}}};
+  TupleRecord tuple(std::vector<Value>{Value(TypeId::VARCHAR, std::string(200, 'x'))}, &schema);
+  TupleRecord large_tuple(std::vector<Value>{Value(TypeId::VARCHAR, std::string(10000, 'y'))}, &large_schema);
+
+  auto *transaction = new Transaction(0);
+  auto *disk_manager = new DiskManager("test.db");
+  auto *buffer_pool_manager = new BufferPoolManagerInstance(50, disk_manager);
+  auto *lock_manager = new LockManager();
+  auto *log_manager = new LogManager(disk_manager);
+  auto *table = new TableHeap(buffer_pool_manager, lock_manager, log_manager, transaction);
+
+  // Scenario: a batch that spans several pages fills them in order, like single inserts would.
+  std::vector<const TupleRecord *> batch(100, &tuple);
+  std::vector<RID> rids;
+  ASSERT_TRUE(table->InsertTuples(batch, &rids, transaction));
+  ASSERT_EQ(batch.size(), rids.size());
+  EXPECT_EQ(batch.size(), transaction->GetWriteSet()->size());
+  for (size_t i = 1; i < rids.size(); i++) {
+    if (rids[i].GetPageId() == rids[i - 1].GetPageId()) {
+      EXPECT_EQ(rids[i - 1].GetSlotNum() + 1, rids[i].GetSlotNum());
+    } else {
+      EXPECT_EQ(0, rids[i].GetSlotNum());
+      EXPECT_LT(table->GetFreeSpaceMap()->GetFreeSpace(rids[i - 1].GetPageId()), tuple.GetLength());
+    }
+  }
+  EXPECT_GT(rids.back().GetPageId(), rids.front().GetPageId());
+
+  // Scenario: a tuple that needs overflow pages in the middle of a batch keeps its place.
+  batch = {&tuple, &large_tuple, &tuple};
+  ASSERT_TRUE(table->InsertTuples(batch, &rids, transaction));
+  ASSERT_EQ(3, rids.size());
+  EXPECT_EQ(103, transaction->GetWriteSet()->size());
+  TupleRecord result;
+  ASSERT_TRUE(table->GetTuple(rids[1], &result, transaction));
+  EXPECT_EQ(large_tuple.GetLength(), result.GetLength());
+  EXPECT_EQ(result.GetValue(&large_schema, 0).CompareEquals(large_tuple.GetValue(&large_schema, 0)),
+            CmpBool::CmpTrue);
+  ASSERT_TRUE(table->GetTuple(rids[2], &result, transaction));
+  EXPECT_EQ(result.GetValue(&schema, 0).CompareEquals(tuple.GetValue(&schema, 0)), CmpBool::CmpTrue);
+
+  // The free space map knows every page of the heap.
+  size_t num_pages = 0;
+  page_id_t last_page_id = INVALID_PAGE_ID;
+  for (page_id_t page_id = table->GetFirstPageId(); page_id != INVALID_PAGE_ID; num_pages++) {
+    last_page_id = page_id;
+    auto *page = static_cast<TablePage *>(buffer_pool_manager->FetchPage(page_id));
+    const page_id_t next_page_id = page->GetNextPageId();
+    buffer_pool_manager->UnpinPage(page_id, false);
+    page_id = next_page_id;
+  }
+  EXPECT_EQ(num_pages, table->GetFreeSpaceMap()->GetNumPages());
+  EXPECT_EQ(last_page_id, table->GetFreeSpaceMap()->GetLastPageId());
+
+  disk_manager->ShutDown();
+  remove("test.db");  // remove db file
+  remove("test.log");
+  delete table;
+  delete buffer_pool_manager;
+  delete disk_manager;
+  delete transaction;
+  delete log_manager;
+  delete lock_manager;
+}
+
+TEST(TupleTest, TableHeapLazyOverflow) {
+  Schema schema{std::vector<Column>{Column{"id", TypeId::INTEGER}, Column{"name", TypeId::VARCHAR, 20},
+                                    Column{"body", TypeId::VARCHAR, 20000}}};
+  std::string body(20000, 'z');
+  for (size_t i = 0; i < body.size(); i++) {
+    body[i] = static_cast<char>('a' + i % 26);
+  }
+  TupleRecord tuple(std::vector<Value>{ValueFactory::GetIntegerValue(7), ValueFactory::GetVarcharValue("seven"),
+                                       ValueFactory::GetVarcharValue(body)},
+                    &schema);
+
+  auto *transaction = new Transaction(0);
+  auto *disk_manager = new DiskManager("test.db");
+  auto *buffer_pool_manager = new BufferPoolManagerInstance(50, disk_manager);
+  auto *lock_manager = new LockManager();
+  auto *log_manager = new LogManager(disk_manager);
+  auto *table = new TableHeap(buffer_pool_manager, lock_manager, log_manager, transaction);
+
+  RID rid;
+  ASSERT_TRUE(table->InsertTuple(tuple, &rid, transaction));
+
+  // Scenario: values in the table page are read without the overflow pages.
+  TupleRecord result;
+  ASSERT_TRUE(table->GetTuple(rid, &result, transaction));
+  EXPECT_TRUE(result.IsOverflowPending());
+  EXPECT_EQ(7, result.GetValue(&schema, 0).GetAs<int32_t>());
+  EXPECT_EQ("seven", result.GetValue(&schema, 1).ToString());
+  EXPECT_TRUE(result.IsOverflowPending());
+
+  // Scenario: a copy is just as lazy, and reads the whole tuple when a value in the overflow pages is needed.
+  TupleRecord copy;
+  copy = result;
+  EXPECT_TRUE(copy.IsOverflowPending());
+  EXPECT_EQ(body, copy.GetValue(&schema, 2).ToString());
+  EXPECT_FALSE(copy.IsOverflowPending());
+  EXPECT_EQ(tuple.GetLength(), copy.GetLength());
+  EXPECT_EQ(0, memcmp(tuple.GetData() + sizeof(page_id_t), copy.GetData() + sizeof(page_id_t),
+                      tuple.GetLength() - sizeof(page_id_t)));
+
+  // Scenario: asking for the whole tuple reads the overflow, and so does inserting it again.
+  EXPECT_EQ(tuple.GetLength(), result.GetLength());
+  EXPECT_FALSE(result.IsOverflowPending());
+  ASSERT_TRUE(table->GetTuple(rid, &result, transaction));
+  ASSERT_TRUE(result.IsOverflowPending());
+  RID second_rid;
+  ASSERT_TRUE(table->InsertTuple(result, &second_rid, transaction));
+  TupleRecord second;
+  ASSERT_TRUE(table->GetTuple(second_rid, &second, transaction));
+  EXPECT_NE(result.GetOverFlowPageId(), second.GetOverFlowPageId());
+  EXPECT_EQ(body, second.GetValue(&schema, 2).ToString());
+
+  // Scenario: a chain that does not hold the rest of the tuple is an error.
+  const page_id_t overflow_page_id = second.GetOverFlowPageId();
+  auto *overflow_page = static_cast<OverFlowPage *>(buffer_pool_manager->FetchPage(overflow_page_id));
+  overflow_page->SetChainSize(overflow_page->GetChainSize() + 1);
+  buffer_pool_manager->UnpinPage(overflow_page_id, true);
+  ASSERT_TRUE(table->GetTuple(second_rid, &second, transaction));
+  EXPECT_EQ(7, second.GetValue(&schema, 0).GetAs<int32_t>());
+  EXPECT_THROW(second.GetValue(&schema, 2), Exception);
+
+  disk_manager->ShutDown();
+  remove("test.db");  // remove db file
+  remove("test.log");
+  delete table;
+  delete buffer_pool_manager;
+  delete disk_manager;
+  delete transaction;
+  delete log_manager;
+  delete lock_manager;
+}
+
+TEST(TupleTest, TableHeapOverflowWrite) {
+  Schema schema{std::vector<Column>{Column{"id", TypeId::INTEGER}, Column{"body", TypeId::VARCHAR, 100000}}};
+  auto make_tuple = [&schema](int32_t id, size_t size, char c) {
+    return TupleRecord(
+        std::vector<Value>{ValueFactory::GetIntegerValue(id), ValueFactory::GetVarcharValue(std::string(size, c))},
+        &schema);
+  };
+  TupleRecord tuple = make_tuple(1, 100000, 'a');
+
+  auto *transaction = new Transaction(0);
+  auto *disk_manager = new DiskManager("test.db");
+  auto *buffer_pool_manager = new BufferPoolManagerInstance(10, disk_manager);
+  auto *lock_manager = new LockManager();
+  auto *log_manager = new LogManager(disk_manager);
+  auto *table = new TableHeap(buffer_pool_manager, lock_manager, log_manager, transaction);
+  auto chain_of = [&](const RID &rid) {
+    TupleRecord head;
+    EXPECT_TRUE(table->GetTuple(rid, &head, transaction));
+    std::vector<page_id_t> page_ids;
+    for (page_id_t page_id = head.GetOverFlowPageId(); page_id != INVALID_PAGE_ID;) {
+      page_ids.push_back(page_id);
+      auto *page = static_cast<OverFlowPage *>(buffer_pool_manager->FetchPage(page_id));
+      page_id = page->GetNextPageId();
+      buffer_pool_manager->UnpinPage(page_ids.back(), false);
+    }
+    return page_ids;
+  };
+
+  // Scenario: a value of many pages goes to a chain of adjacent pages, with a buffer pool much smaller than the chain.
+  RID rid;
+  ASSERT_TRUE(table->InsertTuple(tuple, &rid, transaction));
+  const std::vector<page_id_t> page_ids = chain_of(rid);
+  ASSERT_EQ((tuple.GetLength() - TablePage::MAX_TUPLE_SIZE + OverFlowPage::MAX_DATA_SIZE - 1) /
+                OverFlowPage::MAX_DATA_SIZE,
+            page_ids.size());
+  for (size_t i = 1; i < page_ids.size(); i++) {
+    EXPECT_EQ(page_ids[i - 1] + 1, page_ids[i]);
+  }
+  TupleRecord result;
+  ASSERT_TRUE(table->GetTuple(rid, &result, transaction));
+  EXPECT_EQ(tuple.GetValue(&schema, 1).ToString(), result.GetValue(&schema, 1).ToString());
+
+  // Scenario: an update writes a new chain, and a tuple read before it still reads the old value from the old chain.
+  TupleRecord smaller = make_tuple(2, 50000, 'b');
+  transaction->GetWriteSet()->clear();
+  std::vector<page_id_t> new_page_ids;
+  {
+    TupleRecord before;
+    ASSERT_TRUE(table->GetTuple(rid, &before, transaction));
+    ASSERT_TRUE(before.IsOverflowPending());
+    ASSERT_TRUE(table->UpdateTuple(smaller, rid, transaction));
+    new_page_ids = chain_of(rid);
+    for (const page_id_t page_id : new_page_ids) {
+      EXPECT_EQ(page_ids.end(), std::find(page_ids.begin(), page_ids.end(), page_id));
+    }
+    EXPECT_EQ(tuple.GetValue(&schema, 1).ToString(), before.GetValue(&schema, 1).ToString());
+    EXPECT_EQ(tuple.GetLength(), before.GetLength());
+  }
+  ASSERT_TRUE(table->GetTuple(rid, &result, transaction));
+  EXPECT_EQ(2, result.GetValue(&schema, 0).GetAs<int32_t>());
+  EXPECT_EQ(smaller.GetValue(&schema, 1).ToString(), result.GetValue(&schema, 1).ToString());
+  EXPECT_EQ(smaller.GetLength(), result.GetLength());
+
+  // Scenario: rolling the update back restores the old value, and frees the chains that no tuple reads anymore.
+  ASSERT_EQ(1, transaction->GetWriteSet()->size());
+  const TupleRecord old_tuple = transaction->GetWriteSet()->back().tuple_;
+  ASSERT_TRUE(table->UpdateTuple(old_tuple, rid, transaction));
+  ASSERT_TRUE(table->GetTuple(rid, &result, transaction));
+  EXPECT_EQ(1, result.GetValue(&schema, 0).GetAs<int32_t>());
+  EXPECT_EQ(tuple.GetValue(&schema, 1).ToString(), result.GetValue(&schema, 1).ToString());
+  EXPECT_FALSE(disk_manager->IsAllocated(page_ids[0]));
+  EXPECT_FALSE(disk_manager->IsAllocated(new_page_ids[0]));
+  EXPECT_TRUE(disk_manager->IsAllocated(chain_of(rid)[0]));
+
+  // Scenario: an update to a value that fits into the table page frees the chain, and the old value kept for rollbacks
+  // still has all of it.
+  const std::vector<page_id_t> last_page_ids = chain_of(rid);
+  TupleRecord fitting = make_tuple(3, 100, 'c');
+  transaction->GetWriteSet()->clear();
+  ASSERT_TRUE(table->UpdateTuple(fitting, rid, transaction));
+  ASSERT_TRUE(table->GetTuple(rid, &result, transaction));
+  EXPECT_EQ(fitting.GetValue(&schema, 1).ToString(), result.GetValue(&schema, 1).ToString());
+  for (const page_id_t page_id : last_page_ids) {
+    EXPECT_FALSE(disk_manager->IsAllocated(page_id));
+  }
+  ASSERT_EQ(1, transaction->GetWriteSet()->size());
+  EXPECT_EQ(tuple.GetValue(&schema, 1).ToString(),
+            transaction->GetWriteSet()->back().tuple_.GetValue(&schema, 1).ToString());
+
+  disk_manager->ShutDown();
+  remove("test.db");  // remove db file
+  remove("test.log");
+  delete table;
+  delete buffer_pool_manager;
+  delete disk_manager;
+  delete transaction;
+  delete log_manager;
+  delete lock_manager;
+}
+
+TEST(TupleTest, TableHeapVacuum) {
+  Schema schema{std::vector<Column>{Column{"a", TypeId::VARCHAR, 200}}};
+  TupleRecord tuple(std::vector<Value>{Value(TypeId::VARCHAR, std::string(200, 'x'))}, &schema);
+
+  auto *transaction = new Transaction(0);
+  auto *disk_manager = new DiskManager("test.db");
+  auto *buffer_pool_manager = new BufferPoolManagerInstance(50, disk_manager);
+  auto *lock_manager = new LockManager();
+  auto *log_manager = new LogManager(disk_manager);
+  auto *table = new TableHeap(buffer_pool_manager, lock_manager, log_manager, transaction);
+  auto chain = [&]() {
+    std::vector<page_id_t> page_ids;
+    for (page_id_t page_id = table->GetFirstPageId(); page_id != INVALID_PAGE_ID;) {
+      page_ids.push_back(page_id);
+      auto *page = static_cast<TablePage *>(buffer_pool_manager->FetchPage(page_id));
+      const page_id_t next_page_id = page->GetNextPageId();
+      buffer_pool_manager->UnpinPage(page_id, false);
+      page_id = next_page_id;
+    }
+    return page_ids;
+  };
+  auto scan = [&]() {
+    size_t num_tuples = 0;
+    for (auto itr = table->Begin(transaction); itr != table->End(); ++itr) {
+      num_tuples++;
+    }
+    return num_tuples;
+  };
+  auto delete_page = [&](std::vector<RID> *rids, page_id_t page_id) {
+    for (auto rid = rids->begin(); rid != rids->end();) {
+      if (rid->GetPageId() != page_id) {
+        ++rid;
+        continue;
+      }
+      ASSERT_TRUE(table->MarkDelete(*rid, transaction));
+      table->ApplyDelete(*rid, transaction);
+      rid = rids->erase(rid);
+    }
+  };
+
+  std::vector<RID> rid_v;
+  for (int i = 0; i < 200; ++i) {
+    RID rid;
+    ASSERT_TRUE(table->InsertTuple(tuple, &rid, transaction));
+    rid_v.push_back(rid);
+  }
+  const std::vector<page_id_t> page_ids = chain();
+  ASSERT_GT(page_ids.size(), 8);
+
+  // Scenario: without auto vacuum, emptied pages stay in the list until VACUUM unlinks them, but the first and the
+  // last page are kept.
+  auto_vacuum = false;
+  for (const size_t i : {size_t{0}, size_t{2}, size_t{3}, page_ids.size() - 1}) {
+    delete_page(&rid_v, page_ids[i]);
+  }
+  EXPECT_EQ(page_ids, chain());
+  EXPECT_EQ(2U, table->Vacuum());
+  std::vector<page_id_t> expected(page_ids);
+  expected.erase(expected.begin() + 2, expected.begin() + 4);
+  EXPECT_EQ(expected, chain());
+  EXPECT_EQ(expected.size(), table->GetFreeSpaceMap()->GetNumPages());
+  EXPECT_EQ(rid_v.size(), scan());
+  EXPECT_EQ(0U, table->Vacuum());
+
+  // Scenario: with auto vacuum, the delete that empties a page unlinks it, even while a scan is on it; the scan reads
+  // the rest of the page from its copy of it and goes on with the next page.
+  auto_vacuum = true;
+  auto itr = table->Begin(transaction);
+  while (itr->GetRid().GetPageId() != page_ids[5]) {
+    ++itr;
+  }
+  delete_page(&rid_v, page_ids[5]);
+  expected.erase(std::find(expected.begin(), expected.end(), page_ids[5]));
+  EXPECT_EQ(expected, chain());
+  while (itr->GetRid().GetPageId() == page_ids[5]) {
+    ++itr;
+  }
+  EXPECT_EQ(page_ids[6], itr->GetRid().GetPageId());
+  while (itr != table->End()) {
+    ++itr;
+  }
+  EXPECT_EQ(rid_v.size(), scan());
+
+  // Scenario: the pages that were kept take inserts again, and a reopened heap knows only the pages in the list.
+  RID rid;
+  ASSERT_TRUE(table->InsertTuple(tuple, &rid, transaction));
+  EXPECT_TRUE(rid.GetPageId() == page_ids[0] || rid.GetPageId() == page_ids.back());
+  {
+    TableHeap reopened(buffer_pool_manager, lock_manager, log_manager, table->GetFirstPageId());
+    EXPECT_EQ(expected.size(), reopened.GetFreeSpaceMap()->GetNumPages());
+    EXPECT_EQ(expected.back(), reopened.GetFreeSpaceMap()->GetLastPageId());
+  }
+
+  disk_manager->ShutDown();
+  remove("test.db");  // remove db file
+  remove("test.log");
+  delete table;
+  delete buffer_pool_manager;
+  delete disk_manager;
+  delete transaction;
+  delete log_manager;
+  delete lock_manager;
+}
+
+TEST(TupleTest, TableIteratorPageAtATime) {
+  Schema schema{std::vector<Column>{Column{"id", TypeId::INTEGER}, Column{"name", TypeId::VARCHAR, 32}}};
+
+  auto *transaction = new Transaction(0);
+  auto *disk_manager = new DiskManager("test.db");
+  auto *buffer_pool_manager = new BufferPoolManagerInstance(50, disk_manager);
+  auto *lock_manager = new LockManager();
+  auto *log_manager = new LogManager(disk_manager);
+  auto *table = new TableHeap(buffer_pool_manager, lock_manager, log_manager, transaction);
+
+  std::vector<RID> expected_rids;
+  std::vector<int32_t> expected_ids;
+  for (int32_t i = 0; i < 300; ++i) {
+    TupleRecord tuple(
+        std::vector<Value>{ValueFactory::GetIntegerValue(i), ValueFactory::GetVarcharValue(fmt::format("row-{}", i))},
+        &schema);
+    RID rid;
+    ASSERT_TRUE(table->InsertTuple(tuple, &rid, transaction));
+    // tuples that are marked as deleted are skipped
+    if (i % 7 == 0) {
+      ASSERT_TRUE(table->MarkDelete(rid, transaction));
+    } else {
+      expected_rids.push_back(rid);
+      expected_ids.push_back(i);
+    }
+  }
+
+  // Scenario: a scan returns the tuples of every page in slot order.
+  std::vector<RID> rids;
+  std::vector<int32_t> ids;
+  for (auto itr = table->Begin(transaction); itr != table->End(); ++itr) {
+    rids.push_back(itr->GetRid());
+    ids.push_back(itr->GetValue(&schema, 0).GetAs<int32_t>());
+    EXPECT_EQ(fmt::format("row-{}", ids.back()), itr->GetValue(&schema, 1).ToString());
+  }
+  EXPECT_EQ(expected_rids, rids);
+  EXPECT_EQ(expected_ids, ids);
+
+  // Scenario: a copy of an iterator keeps its place and its tuple when the original moves on to another page, and a
+  // materialized tuple outlives the scan.
+  auto itr = table->Begin(transaction);
+  auto copy = itr;
+  TupleRecord first = *itr;
+  first.Materialize();
+  while (itr != table->End() && itr->GetRid().GetPageId() == expected_rids[0].GetPageId()) {
+    ++itr;
+  }
+  ASSERT_NE(expected_rids[0].GetPageId(), itr->GetRid().GetPageId());
+  EXPECT_EQ(expected_rids[0], copy->GetRid());
+  EXPECT_EQ(expected_ids[0], copy->GetValue(&schema, 0).GetAs<int32_t>());
+  ++copy;
+  EXPECT_EQ(expected_rids[1], copy->GetRid());
+  while (itr != table->End()) {
+    ++itr;
+  }
+  EXPECT_EQ(fmt::format("row-{}", expected_ids[0]), first.GetValue(&schema, 1).ToString());
+
+  // Scenario: an iterator that starts at a rid begins with the first tuple at or after it.
+  ASSERT_EQ(8, expected_ids[6]);
+  TableIterator from(table, RID(expected_rids[6].GetPageId(), expected_rids[6].GetSlotNum() - 1), transaction);
+  EXPECT_EQ(expected_rids[6], from->GetRid());
+  while (from != table->End()) {
+    ++from;
+  }
+
+  disk_manager->ShutDown();
+  remove("test.db");  // remove db file
+  remove("test.log");
+  delete table;
+  delete buffer_pool_manager;
+  delete disk_manager;
+  delete transaction;
+  delete log_manager;
+  delete lock_manager;
+}
+
+
+TEST(TupleTest, TableHeapZoneMap) {
+  Schema schema{std::vector<Column>{Column{"id", TypeId::INTEGER}, Column{"score", TypeId::BIGINT},
+                                    Column{"name", TypeId::VARCHAR, 32}}};
+
+  auto *transaction = new Transaction(0);
+  auto *disk_manager = new DiskManager("test.db");
+  auto *buffer_pool_manager = new BufferPoolManagerInstance(50, disk_manager);
+  auto *lock_manager = new LockManager();
+  auto *log_manager = new LogManager(disk_manager);
+  auto *table = new TableHeap(buffer_pool_manager, lock_manager, log_manager, transaction);
+  table->EnableZoneMap(schema);
+  ZoneMap *zone_map = table->GetZoneMap();
+  ASSERT_NE(nullptr, zone_map);
+
+  // ids grow with the heap; every tenth score is null
+  auto make_tuple = [&schema](int32_t id) {
+    return TupleRecord(std::vector<Value>{ValueFactory::GetIntegerValue(id),
+                                          id % 10 == 0 ? ValueFactory::GetNullValueByType(TypeId::BIGINT)
+                                                       : ValueFactory::GetBigIntValue(id * 2),
+                                          ValueFactory::GetVarcharValue(fmt::format("row-{}", id))},
+                       &schema);
+  };
+  std::vector<RID> rids;
+  for (int32_t id = 0; id < 1000; ++id) {
+    RID rid;
+    ASSERT_TRUE(table->InsertTuple(make_tuple(id), &rid, transaction));
+    rids.push_back(rid);
+  }
+  std::vector<TupleRecord> batch;
+  for (int32_t id = 1000; id < 2000; ++id) {
+    batch.push_back(make_tuple(id));
+  }
+  std::vector<const TupleRecord *> batch_ptrs;
+  for (const auto &tuple : batch) {
+    batch_ptrs.push_back(&tuple);
+  }
+  std::vector<RID> batch_rids;
+  ASSERT_TRUE(table->InsertTuples(batch_ptrs, &batch_rids, transaction));
+  rids.insert(rids.end(), batch_rids.begin(), batch_rids.end());
+  transaction->GetWriteSet()->clear();
+
+  std::vector<page_id_t> page_ids;
+  std::map<page_id_t, std::pair<int32_t, int32_t>> ids_of_page;
+  std::map<page_id_t, uint32_t> nulls_of_page;
+  for (int32_t id = 0; id < 2000; ++id) {
+    const page_id_t page_id = rids[id].GetPageId();
+    if (page_ids.empty() || page_ids.back() != page_id) {
+      page_ids.push_back(page_id);
+      ids_of_page[page_id] = {id, id};
+    }
+    ids_of_page[page_id].second = id;
+    nulls_of_page[page_id] += id % 10 == 0 ? 1 : 0;
+  }
+  ASSERT_GT(page_ids.size(), 10);
+
+  ZoneMap::Range range;
+  range.column_idx_ = 0;
+  range.lower_ = ValueFactory::GetIntegerValue(1500);
+  range.upper_ = ValueFactory::GetIntegerValue(1510);
+  range.upper_inclusive_ = false;
+  const std::vector<ZoneMap::Range> ranges{range};
+  auto holds_match = [&ids_of_page](page_id_t page_id) {
+    return ids_of_page[page_id].second >= 1500 && ids_of_page[page_id].first < 1510;
+  };
+
+  // Scenario: the zone of every page covers exactly the values inserted into it, one at a time or in a batch.
+  for (const page_id_t page_id : page_ids) {
+    EXPECT_EQ(holds_match(page_id), zone_map->MayMatch(page_id, ranges)) << page_id;
+    EXPECT_EQ(nulls_of_page[page_id], zone_map->GetNullCount(page_id, 1));
+  }
+  // a range on a column that is not tracked rules out nothing
+  ZoneMap::Range name_range;
+  name_range.column_idx_ = 2;
+  name_range.lower_ = ValueFactory::GetVarcharValue("zzz");
+  EXPECT_TRUE(zone_map->MayMatch(page_ids[0], {name_range}));
+
+  // Scenario: a scan with a zone filter only reads the pages that may hold a match, and the last page, and still
+  // returns every match.
+  std::vector<int32_t> matches;
+  std::set<page_id_t> pages_read;
+  for (auto itr = table->Begin(transaction, nullptr, &ranges); itr != table->End(); ++itr) {
+    pages_read.insert(itr->GetRid().GetPageId());
+    const int32_t id = itr->GetValue(&schema, 0).GetAs<int32_t>();
+    if (id >= 1500 && id < 1510) {
+      matches.push_back(id);
+    }
+  }
+  EXPECT_EQ((std::vector<int32_t>{1500, 1501, 1502, 1503, 1504, 1505, 1506, 1507, 1508, 1509}), matches);
+  for (const page_id_t page_id : pages_read) {
+    EXPECT_TRUE(holds_match(page_id) || page_id == page_ids.back()) << page_id;
+  }
+  EXPECT_LE(pages_read.size(), 3);
+
+  // Scenario: an update widens the zone of the page of the row.
+  ASSERT_TRUE(table->UpdateTuple(make_tuple(1505), rids[3], transaction));
+  transaction->GetWriteSet()->clear();
+  EXPECT_TRUE(zone_map->MayMatch(page_ids[0], ranges));
+  std::vector<int32_t> updated;
+  for (auto itr = table->Begin(transaction, nullptr, &ranges); itr != table->End(); ++itr) {
+    const int32_t id = itr->GetValue(&schema, 0).GetAs<int32_t>();
+    if (id == 1505) {
+      updated.push_back(itr->GetRid().GetPageId());
+    }
+  }
+  EXPECT_EQ((std::vector<int32_t>{page_ids[0], rids[1505].GetPageId()}), updated);
+
+  // Scenario: the map is persisted with the heap, and a heap opened again finds the same zones.
+  auto *reopened = new TableHeap(buffer_pool_manager, lock_manager, log_manager, table->GetFirstPageId());
+  reopened->EnableZoneMap(schema);
+  for (const page_id_t page_id : page_ids) {
+    EXPECT_EQ(zone_map->MayMatch(page_id, ranges), reopened->GetZoneMap()->MayMatch(page_id, ranges)) << page_id;
+    EXPECT_EQ(nulls_of_page[page_id], reopened->GetZoneMap()->GetNullCount(page_id, 1));
+  }
+  delete reopened;
+
+  // Scenario: with every other frame of the pool pinned, a recorded zone still reaches its map page.
+  ZoneMap::Range far_range;
+  far_range.column_idx_ = 0;
+  far_range.lower_ = ValueFactory::GetIntegerValue(5000);
+  far_range.upper_ = ValueFactory::GetIntegerValue(5000);
+  const std::vector<ZoneMap::Range> far_ranges{far_range};
+  EXPECT_FALSE(zone_map->MayMatch(page_ids.back(), far_ranges));
+  std::vector<page_id_t> pinned_page_ids;
+  for (page_id_t page_id; buffer_pool_manager->NewPage(&page_id) != nullptr;) {
+    pinned_page_ids.push_back(page_id);
+  }
+  zone_map->Record(page_ids.back(), make_tuple(5000));
+  for (const page_id_t page_id : pinned_page_ids) {
+    buffer_pool_manager->UnpinPage(page_id, false);
+    buffer_pool_manager->DeletePage(page_id);
+  }
+  reopened = new TableHeap(buffer_pool_manager, lock_manager, log_manager, table->GetFirstPageId());
+  reopened->EnableZoneMap(schema);
+  EXPECT_TRUE(reopened->GetZoneMap()->MayMatch(page_ids.back(), far_ranges));
+  delete reopened;
+
+  disk_manager->ShutDown();
+  remove("test.db");  // remove db file
+  remove("test.log");
+  delete table;
+  delete buffer_pool_manager;
+  delete disk_manager;
+  delete transaction;
+  delete log_manager;
+  delete lock_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(TupleTest, TableHeapPaxLayout) {
+  // a wide table of fixed-width columns, as an aggregate over one of them would read it
+  std::vector<Column> columns{Column{"id", TypeId::INTEGER}, Column{"small", TypeId::SMALLINT},
+                              Column{"big", TypeId::BIGINT}, Column{"price", TypeId::DECIMAL}};
+  for (int i = 0; i < 16; ++i) {
+    columns.emplace_back(fmt::format("pad{}", i), TypeId::INTEGER);
+  }
+  Schema schema{columns};
+
+  auto *transaction = new Transaction(0);
+  auto *disk_manager = new DiskManager("test.db");
+  auto *buffer_pool_manager = new BufferPoolManagerInstance(50, disk_manager);
+  auto *lock_manager = new LockManager();
+  auto *log_manager = new LogManager(disk_manager);
+  auto *table = new TableHeap(buffer_pool_manager, lock_manager, log_manager, transaction);
+  table->UsePaxLayout(schema);
+  ASSERT_EQ(TableLayout::PAX, table->GetLayout());
+
+  // every seventh big is null
+  auto make_tuple = [&schema](int32_t id) {
+    std::vector<Value> values{ValueFactory::GetIntegerValue(id),
+                              ValueFactory::GetSmallIntValue(static_cast<int16_t>(id % 1000)),
+                              id % 7 == 0 ? ValueFactory::GetNullValueByType(TypeId::BIGINT)
+                                          : ValueFactory::GetBigIntValue(static_cast<int64_t>(id) * 3),
+                              ValueFactory::GetDecimalValue(id / 4.0)};
+    for (int i = 0; i < 16; ++i) {
+      values.push_back(ValueFactory::GetIntegerValue(id + i));
+    }
+    return TupleRecord(values, &schema);
+  };
+  auto expect_tuple = [&schema](int32_t id, const TupleRecord &tuple) {
+    EXPECT_EQ(id, tuple.GetValue(&schema, 0).GetAs<int32_t>());
+    EXPECT_EQ(id % 1000, tuple.GetValue(&schema, 1).GetAs<int16_t>());
+    EXPECT_EQ(id % 7 == 0, tuple.GetValue(&schema, 2).IsNull());
+    if (id % 7 != 0) {
+      EXPECT_EQ(static_cast<int64_t>(id) * 3, tuple.GetValue(&schema, 2).GetAs<int64_t>());
+    }
+    EXPECT_EQ(id / 4.0, tuple.GetValue(&schema, 3).GetAs<double>());
+    EXPECT_EQ(id + 15, tuple.GetValue(&schema, 19).GetAs<int32_t>());
+  };
+
+  // Scenario: tuples inserted one at a time and in a batch read back the same, by rid and in a scan.
+  std::vector<RID> rids;
+  for (int32_t id = 0; id < 1500; ++id) {
+    RID rid;
+    ASSERT_TRUE(table->InsertTuple(make_tuple(id), &rid, transaction));
+    rids.push_back(rid);
+  }
+  std::vector<TupleRecord> batch;
+  for (int32_t id = 1500; id < 3000; ++id) {
+    batch.push_back(make_tuple(id));
+  }
+  std::vector<const TupleRecord *> batch_ptrs;
+  for (const auto &tuple : batch) {
+    batch_ptrs.push_back(&tuple);
+  }
+  std::vector<RID> batch_rids;
+  ASSERT_TRUE(table->InsertTuples(batch_ptrs, &batch_rids, transaction));
+  rids.insert(rids.end(), batch_rids.begin(), batch_rids.end());
+  transaction->GetWriteSet()->clear();
+  // a page holds a run of rows, and the rows of a page are numbered from 0
+  ASSERT_GT(table->GetFreeSpaceMap()->GetNumPages(), 1);
+  ASSERT_EQ(0, rids[0].GetSlotNum());
+  ASSERT_EQ(1, rids[1].GetSlotNum());
+
+  for (int32_t id = 0; id < 3000; id += 37) {
+    TupleRecord tuple;
+    ASSERT_TRUE(table->GetTuple(rids[id], &tuple, transaction));
+    expect_tuple(id, tuple);
+  }
+  int32_t next_id = 0;
+  for (auto itr = table->Begin(transaction); itr != table->End(); ++itr, ++next_id) {
+    ASSERT_EQ(rids[next_id], itr->GetRid());
+    expect_tuple(next_id, *itr);
+  }
+  ASSERT_EQ(3000, next_id);
+
+  // Scenario: a column scan copies a column out of the minipages, with its slots and nulls.
+  auto scan_big = [&table]() {
+    std::map<int32_t, std::pair<int64_t, bool>> big_of_slot;
+    EXPECT_TRUE(table->ScanColumn<int64_t>(
+        2, [&big_of_slot](page_id_t page_id, const std::vector<int64_t> &values, const std::vector<uint32_t> &slot_nums,
+                          const std::vector<bool> &is_null) {
+          EXPECT_EQ(values.size(), slot_nums.size());
+          EXPECT_EQ(values.size(), is_null.size());
+          for (size_t i = 0; i < values.size(); ++i) {
+            big_of_slot[page_id * 10000 + static_cast<int32_t>(slot_nums[i])] = {values[i], is_null[i]};
+          }
+        }));
+    return big_of_slot;
+  };
+  auto big_of_slot = scan_big();
+  ASSERT_EQ(3000, big_of_slot.size());
+  for (int32_t id = 0; id < 3000; ++id) {
+    const int32_t key = rids[id].GetPageId() * 10000 + static_cast<int32_t>(rids[id].GetSlotNum());
+    const auto &[big, is_null] = big_of_slot[key];
+    EXPECT_EQ(id % 7 == 0, is_null) << id;
+    EXPECT_EQ(id % 7 == 0 ? BUSTUB_INT64_NULL : static_cast<int64_t>(id) * 3, big) << id;
+  }
+  int64_t id_sum = 0;
+  ASSERT_TRUE(table->ScanColumn<int32_t>(
+      0, [&id_sum](page_id_t, const std::vector<int32_t> &values, const std::vector<uint32_t> &,
+                   const std::vector<bool> &) {
+        for (const auto value : values) {
+          id_sum += value;
+        }
+      }));
+  EXPECT_EQ(2999 * 3000 / 2, id_sum);
+  // the type has to have the width of the column
+  EXPECT_FALSE(table->ScanColumn<int32_t>(
+      2, [](page_id_t, const std::vector<int32_t> &, const std::vector<uint32_t> &, const std::vector<bool> &) {}));
+
+  // Scenario: deletes, rollbacks and updates go through the rows in place, and a deleted row is reused.
+  ASSERT_TRUE(table->MarkDelete(rids[10], transaction));
+  ASSERT_TRUE(table->MarkDelete(rids[11], transaction));
+  ASSERT_TRUE(table->MarkDelete(rids[13], transaction));
+  TupleRecord tuple;
+  EXPECT_FALSE(table->GetTuple(rids[10], &tuple, transaction));
+  table->RollbackDelete(rids[11], transaction);
+  table->ApplyDelete(rids[10], transaction);
+  table->ApplyDelete(rids[13], transaction);
+  ASSERT_TRUE(table->GetTuple(rids[11], &tuple, transaction));
+  expect_tuple(11, tuple);
+  ASSERT_TRUE(table->UpdateTuple(make_tuple(7011), rids[12], transaction));
+  ASSERT_TRUE(table->GetTuple(rids[12], &tuple, transaction));
+  expect_tuple(7011, tuple);
+  big_of_slot = scan_big();
+  EXPECT_EQ(2998, big_of_slot.size());
+  EXPECT_EQ(big_of_slot.end(), big_of_slot.find(rids[10].GetPageId() * 10000 + 10));
+  EXPECT_EQ((std::pair<int64_t, bool>{7011 * 3, false}), big_of_slot[rids[12].GetPageId() * 10000 + 12]);
+  transaction->GetWriteSet()->clear();
+  // the free space map finds the page again once it has room for two tuples
+  RID rid;
+  ASSERT_TRUE(table->InsertTuple(make_tuple(5000), &rid, transaction));
+  EXPECT_EQ(rids[10], rid);
+  transaction->GetWriteSet()->clear();
+
+  // Scenario: a heap opened again knows its layout.
+  auto *reopened = new TableHeap(buffer_pool_manager, lock_manager, log_manager, table->GetFirstPageId());
+  EXPECT_EQ(TableLayout::PAX, reopened->GetLayout());
+  ASSERT_TRUE(reopened->GetTuple(rid, &tuple, transaction));
+  expect_tuple(5000, tuple);
+  delete reopened;
+
+  // Scenario: a schema with a column that is not fixed-width cannot have the PAX layout.
+  auto *row_table = new TableHeap(buffer_pool_manager, lock_manager, log_manager, transaction);
+  Schema varchar_schema{std::vector<Column>{Column{"id", TypeId::INTEGER}, Column{"name", TypeId::VARCHAR, 32}}};
+  EXPECT_THROW(row_table->UsePaxLayout(varchar_schema), Exception);
+  EXPECT_EQ(TableLayout::ROW, row_table->GetLayout());
+  delete row_table;
+
+  disk_manager->ShutDown();
+  remove("test.db");  // remove db file
+  remove("test.log");
+  delete table;
+  delete buffer_pool_manager;
+  delete disk_manager;
+  delete transaction;
+  delete log_manager;
+  delete lock_manager;
+}
+
+TEST(TupleTest, WideNullBitmap) {
+  std::vector<Column> columns;
+  for (int i = 0; i < 20; i++) {
+    columns.emplace_back(fmt::format("c{}", i), TypeId::VARCHAR, 10);
+  }
+  Schema schema{columns};
+
+  // Scenario: a null in column 16 leaves column 0 alone, and the other way around.
+  for (const uint32_t null_column : {16, 0, 19}) {
+    std::vector<Value> values;
+    for (uint32_t i = 0; i < 20; i++) {
+      values.push_back(i == null_column ? ValueFactory::GetNullValueByType(TypeId::VARCHAR)
+                                        : ValueFactory::GetVarcharValue(fmt::format("v{}", i)));
+    }
+    TupleRecord tuple(values, &schema);
+    for (uint32_t i = 0; i < 20; i++) {
+      if (i == null_column) {
+        EXPECT_TRUE(tuple.IsNull(&schema, i));
+      } else {
+        EXPECT_FALSE(tuple.IsNull(&schema, i));
+        EXPECT_EQ(fmt::format("v{}", i), tuple.GetValue(&schema, i).ToString());
+      }
+    }
+  }
+}
+
 }  // namespace bustub
@@ -0,0 +1,184 @@
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "argparse/argparse.hpp"
+#include "buffer/buffer_pool_manager_instance.h"
+#include "buffer/parallel_buffer_pool_manager.h"
+#include "common/config.h"
+#include "fmt/core.h"
+#include "storage/disk/disk_manager_memory.h"
+
+#include <sys/time.h>
+
+auto ClockMs() -> uint64_t {
+  struct timeval tm;
+  gettimeofday(&tm, nullptr);
+  return static_cast<uint64_t>(tm.tv_sec * 1000) + static_cast<uint64_t>(tm.tv_usec / 1000);
+}
+
+struct BpmMetrics {
+  std::atomic<uint64_t> fetch_cnt_{0};
+  std::atomic<uint64_t> retry_cnt_{0};
+};
+
+/**
+ * Fill the disk with `num_pages` pages whose first bytes hold their own page id, so that every fetch can be checked.
+ */
+void PopulatePages(bustub::BufferPoolManager *bpm, size_t num_pages) {
+  for (size_t i = 0; i < num_pages; i++) {
+    bustub::page_id_t page_id;
+    auto *page = bpm->NewPage(&page_id);
+    if (page == nullptr) {
+      throw std::runtime_error("failed to allocate page while populating the buffer pool");
+    }
+    memcpy(page->GetData(), &page_id, sizeof(page_id));
+    bpm->UnpinPage(page_id, true);
+  }
+  bpm->FlushAllPages();
+}
+
+/**
+ * Run `num_threads` threads fetching uniformly random pages for `duration_ms` and return the throughput in fetches per
+ * second. One in `write_every` fetches takes the page write latch and dirties the page.
+ */
+auto RunWorkload(bustub::BufferPoolManager *bpm, size_t num_pages, size_t num_threads, uint64_t duration_ms,
+                 size_t write_every) -> double {
+  BpmMetrics metrics;
+  std::atomic<bool> stop{false};
+  std::vector<std::thread> threads;
+
+  auto start = ClockMs();
+  for (size_t thread_id = 0; thread_id < num_threads; thread_id++) {
+    threads.emplace_back([thread_id, bpm, num_pages, write_every, &metrics, &stop] {
+      std::default_random_engine gen(thread_id);
+      std::uniform_int_distribution<bustub::page_id_t> page_dist(0, static_cast<bustub::page_id_t>(num_pages) - 1);
+      uint64_t fetch_cnt = 0;
+      uint64_t retry_cnt = 0;
+
+      while (!stop.load(std::memory_order_relaxed)) {
+        auto page_id = page_dist(gen);
+        auto *page = bpm->FetchPage(page_id);
+        if (page == nullptr) {
+          // every frame of the responsible instance is pinned by some other thread
+          retry_cnt++;
+          continue;
+        }
+
+        bool is_write = write_every != 0 && fetch_cnt % write_every == 0;
+        if (is_write) {
+          page->WLatch();
+        } else {
+          page->RLatch();
+        }
+        bustub::page_id_t stored_id;
+        memcpy(&stored_id, page->GetData(), sizeof(stored_id));
+        if (stored_id != page_id) {
+          fmt::print(stderr, "page {} contains data of page {}\n", page_id, stored_id);
+          exit(1);
+        }
+        if (is_write) {
+          page->WUnlatch();
+        } else {
+          page->RUnlatch();
+        }
+        bpm->UnpinPage(page_id, is_write);
+        fetch_cnt++;
+      }
+
+      metrics.fetch_cnt_ += fetch_cnt;
+      metrics.retry_cnt_ += retry_cnt;
+    });
+  }
+
+  std::this_thread::sleep_for(std::chrono::milliseconds(duration_ms));
+  stop = true;
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  auto elapsed = ClockMs() - start;
+
+  return metrics.fetch_cnt_ / static_cast<double>(elapsed) * 1000;
+}
+
+// NOLINTNEXTLINE
+auto main(int argc, char **argv) -> int {
+  argparse::ArgumentParser program("bustub-bpm-bench");
+  program.add_argument("--duration").help("run each configuration for n milliseconds");
+  program.add_argument("--pool-size").help("total number of frames in the buffer pool");
+  program.add_argument("--pages").help("number of distinct pages accessed by the workload");
+  program.add_argument("--instances").help("number of instances of the parallel buffer pool");
+  program.add_argument("--max-threads").help("scale the number of threads from 1 up to n");
+  program.add_argument("--write-every").help("dirty one in n fetched pages (0 = read only)");
+
+  try {
+    program.parse_args(argc, argv);
+  } catch (const std::runtime_error &err) {
+    std::cerr << err.what() << std::endl;
+    std::cerr << program;
+    return 1;
+  }
+
+  uint64_t duration_ms = 2000;
+  size_t pool_size = 1024;
+  size_t num_pages = 4096;
+  size_t num_instances = 16;
+  size_t max_threads = 32;
+  size_t write_every = 10;
+
+  if (program.present("--duration")) {
+    duration_ms = std::stoul(program.get("--duration"));
+  }
+  if (program.present("--pool-size")) {
+    pool_size = std::stoul(program.get("--pool-size"));
+  }
+  if (program.present("--pages")) {
+    num_pages = std::stoul(program.get("--pages"));
+  }
+  if (program.present("--instances")) {
+    num_instances = std::stoul(program.get("--instances"));
+  }
+  if (program.present("--max-threads")) {
+    max_threads = std::stoul(program.get("--max-threads"));
+  }
+  if (program.present("--write-every")) {
+    write_every = std::stoul(program.get("--write-every"));
+  }
+
+  std::cerr << "x: pool size " << pool_size << ", " << num_pages << " pages, " << duration_ms << "ms per run"
+            << std::endl;
+
+  std::vector<std::pair<std::string, double>> results;
+  for (size_t instances : {static_cast<size_t>(1), num_instances}) {
+    for (size_t threads = 1; threads <= max_threads; threads *= 2) {
+      auto disk_manager = std::make_unique<bustub::DiskManagerUnlimitedMemory>();
+      std::unique_ptr<bustub::BufferPoolManager> bpm;
+      if (instances == 1) {
+        bpm = std::make_unique<bustub::BufferPoolManagerInstance>(pool_size, disk_manager.get());
+      } else {
+        bpm = std::make_unique<bustub::ParallelBufferPoolManager>(instances, pool_size / instances,
+                                                                  disk_manager.get());
+      }
+      PopulatePages(bpm.get(), num_pages);
+
+      auto throughput = RunWorkload(bpm.get(), num_pages, threads, duration_ms, write_every);
+      auto name = fmt::format("instances={} threads={}", instances, threads);
+      fmt::print("{}: throughput={:.0f} fetch/s\n", name, throughput);
+      results.emplace_back(name, throughput);
+    }
+  }
+
+  fmt::print("<<< BEGIN\n");
+  for (const auto &[name, throughput] : results) {
+    fmt::print("{}: {:.0f}\n", name, throughput);
+  }
+  fmt::print(">>> END\n");
+
+  return 0;
+}
@@ -0,0 +1,130 @@
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <future>  // NOLINT
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "argparse/argparse.hpp"
+#include "common/config.h"
+#include "fmt/core.h"
+#include "storage/disk/async_disk_manager.h"
+#include "storage/disk/disk_manager.h"
+
+/** Write `num_pages` pages, so that random reads hit allocated parts of the file. */
+void PopulateFile(const std::string &db_file, size_t num_pages) {
+  remove(db_file.c_str());
+  bustub::DiskManager disk_manager(db_file);
+  std::vector<char> data(bustub::BUSTUB_PAGE_SIZE, 'x');
+  for (size_t i = 0; i < num_pages; i++) {
+    disk_manager.WritePage(disk_manager.AllocatePage(), data.data());
+  }
+  disk_manager.ShutDown();
+}
+
+/**
+ * Read uniformly random pages for `duration_ms`, keeping `queue_depth` reads in flight: every round starts
+ * `queue_depth` reads, submits them as one batch and waits for all of them. Returns the reads per second.
+ */
+auto RunRandomReads(bustub::DiskManager *disk_manager, size_t num_pages, size_t queue_depth, uint64_t duration_ms)
+    -> double {
+  std::default_random_engine gen(42);
+  std::uniform_int_distribution<bustub::page_id_t> page_dist(0, static_cast<bustub::page_id_t>(num_pages) - 1);
+  // aligned like buffer pool frames, so that direct I/O needs no copies
+  const size_t buffers_size = queue_depth * bustub::BUSTUB_PAGE_SIZE;
+  std::unique_ptr<char, decltype(&free)> buffers(
+      static_cast<char *>(std::aligned_alloc(bustub::DiskManager::DIRECT_IO_ALIGNMENT, buffers_size)), &free);
+  std::vector<std::future<void>> reads(queue_depth);
+
+  uint64_t num_reads = 0;
+  auto start = std::chrono::steady_clock::now();
+  auto deadline = start + std::chrono::milliseconds(duration_ms);
+  while (std::chrono::steady_clock::now() < deadline) {
+    for (size_t i = 0; i < queue_depth; i++) {
+      reads[i] = disk_manager->ReadPageAsync(page_dist(gen), buffers.get() + i * bustub::BUSTUB_PAGE_SIZE);
+    }
+    disk_manager->SubmitIO();
+    for (auto &read : reads) {
+      read.wait();
+    }
+    num_reads += queue_depth;
+  }
+  auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start);
+  return static_cast<double>(num_reads) / static_cast<double>(elapsed.count()) * 1000000;
+}
+
+// NOLINTNEXTLINE
+auto main(int argc, char **argv) -> int {
+  argparse::ArgumentParser program("bustub-disk-bench");
+  program.add_argument("--file").help("database file to create for the benchmark");
+  program.add_argument("--pages").help("number of pages in the file");
+  program.add_argument("--duration").help("run each configuration for n milliseconds");
+  program.add_argument("--max-queue-depth").help("scale the queue depth from 1 up to n");
+  program.add_argument("--direct-io").help("bypass the OS page cache").default_value(false).implicit_value(true);
+
+  try {
+    program.parse_args(argc, argv);
+  } catch (const std::runtime_error &err) {
+    std::cerr << err.what() << std::endl;
+    std::cerr << program;
+    return 1;
+  }
+
+  std::string db_file = "disk-bench.db";
+  size_t num_pages = 65536;
+  uint64_t duration_ms = 2000;
+  size_t max_queue_depth = 64;
+
+  if (program.present("--file")) {
+    db_file = program.get("--file");
+  }
+  if (program.present("--pages")) {
+    num_pages = std::stoul(program.get("--pages"));
+  }
+  if (program.present("--duration")) {
+    duration_ms = std::stoul(program.get("--duration"));
+  }
+  if (program.present("--max-queue-depth")) {
+    max_queue_depth = std::stoul(program.get("--max-queue-depth"));
+  }
+
+  const bool direct_io = program.get<bool>("--direct-io");
+
+  PopulateFile(db_file, num_pages);
+
+  std::vector<std::pair<std::string, double>> results;
+  {
+    // the synchronous disk manager completes every read before the next one starts, whatever the queue depth
+    bustub::DiskManager disk_manager(db_file, direct_io);
+    auto iops = RunRandomReads(&disk_manager, num_pages, 1, duration_ms);
+    fmt::print("sync qd=1: {:.0f} IOPS\n", iops);
+    results.emplace_back("sync qd=1", iops);
+    disk_manager.ShutDown();
+  }
+  for (bool use_io_uring : {true, false}) {
+    for (size_t queue_depth = 1; queue_depth <= max_queue_depth; queue_depth *= 4) {
+      bustub::AsyncDiskManager disk_manager(db_file, queue_depth, use_io_uring, direct_io);
+      if (use_io_uring && !disk_manager.IsUsingIoUring()) {
+        fmt::print(stderr, "io_uring is not available, skipping it\n");
+        break;
+      }
+      auto iops = RunRandomReads(&disk_manager, num_pages, queue_depth, duration_ms);
+      auto name = fmt::format("{} qd={}", use_io_uring ? "io_uring" : "threads", queue_depth);
+      fmt::print("{}: {:.0f} IOPS\n", name, iops);
+      results.emplace_back(name, iops);
+      disk_manager.ShutDown();
+    }
+  }
+  remove(db_file.c_str());
+
+  fmt::print("<<< BEGIN\n");
+  for (const auto &[name, iops] : results) {
+    fmt::print("{}: {:.0f}\n", name, iops);
+  }
+  fmt::print(">>> END\n");
+
+  return 0;
+}
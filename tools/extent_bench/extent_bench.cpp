@@ -0,0 +1,182 @@
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <chrono>
+#include <cstdio>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "argparse/argparse.hpp"
+#include "buffer/buffer_pool_manager_instance.h"
+#include "catalog/schema.h"
+#include "common/config.h"
+#include "concurrency/lock_manager.h"
+#include "concurrency/transaction.h"
+#include "fmt/core.h"
+#include "recovery/log_manager.h"
+#include "storage/disk/disk_manager.h"
+#include "storage/page/table_page.h"
+#include "storage/table/table_heap.h"
+#include "storage/table/tuple_record.h"
+
+/** Layout of one table on disk: its pages in chain order, and how many runs of adjacent pages they form. */
+struct HeapLayout {
+  size_t num_pages_{0};
+  size_t num_runs_{0};
+};
+
+/**
+ * Fill `num_tables` tables at the same time, one tuple per table in turn, the way concurrent loads fragment a heap
+ * whose pages are handed out first-fit. Returns the first page of every table.
+ */
+auto LoadTables(const std::string &db_file, size_t num_tables, size_t num_tuples) -> std::vector<bustub::page_id_t> {
+  remove(db_file.c_str());
+  bustub::DiskManager disk_manager(db_file);
+  bustub::BufferPoolManagerInstance bpm(256, &disk_manager);
+  bustub::LockManager lock_manager;
+  bustub::LogManager log_manager(&disk_manager);
+  bustub::Transaction txn(0);
+
+  // a tuple of about 900 bytes, so that a page holds four of them
+  bustub::Schema schema({bustub::Column{"payload", bustub::TypeId::VARCHAR, 900}});
+  const bustub::TupleRecord tuple({bustub::Value(bustub::TypeId::VARCHAR, std::string(900, 'x'))}, &schema);
+
+  std::vector<std::unique_ptr<bustub::TableHeap>> tables;
+  std::vector<bustub::page_id_t> first_page_ids;
+  for (size_t i = 0; i < num_tables; i++) {
+    tables.push_back(std::make_unique<bustub::TableHeap>(&bpm, &lock_manager, &log_manager, &txn));
+    first_page_ids.push_back(tables.back()->GetFirstPageId());
+  }
+  for (size_t i = 0; i < num_tuples; i++) {
+    for (auto &table : tables) {
+      bustub::RID rid;
+      table->InsertTuple(tuple, &rid, &txn);
+    }
+  }
+  bpm.FlushAllPages();
+  disk_manager.ShutDown();
+  return first_page_ids;
+}
+
+/** Follow the page chain of a table and count the places where the next page is not the next one in the file. */
+auto InspectLayout(bustub::BufferPoolManager *bpm, bustub::page_id_t first_page_id) -> HeapLayout {
+  HeapLayout layout;
+  bustub::page_id_t prev_page_id = bustub::INVALID_PAGE_ID;
+  for (bustub::page_id_t page_id = first_page_id; page_id != bustub::INVALID_PAGE_ID;) {
+    auto *page = static_cast<bustub::TablePage *>(bpm->FetchPage(page_id));
+    layout.num_pages_++;
+    if (page_id != prev_page_id + 1) {
+      layout.num_runs_++;
+    }
+    prev_page_id = page_id;
+    const bustub::page_id_t next_page_id = page->GetNextPageId();
+    bpm->UnpinPage(page_id, false);
+    page_id = next_page_id;
+  }
+  return layout;
+}
+
+/** Drop the clean pages of the file from the OS page cache, so that the scan has to read them from the disk. */
+void DropPageCache(const std::string &db_file) {
+  const int fd = open(db_file.c_str(), O_RDONLY);
+  if (fd < 0) {
+    return;
+  }
+  fdatasync(fd);
+  posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+  close(fd);
+}
+
+/** Scan every table once with a cold cache and a small buffer pool. Returns the milliseconds of all scans. */
+auto ScanTables(const std::string &db_file, const std::vector<bustub::page_id_t> &first_page_ids, bool direct_io)
+    -> double {
+  double total_ms = 0;
+  for (const auto first_page_id : first_page_ids) {
+    DropPageCache(db_file);
+    bustub::DiskManager disk_manager(db_file, direct_io);
+    bustub::BufferPoolManagerInstance bpm(64, &disk_manager);
+    bustub::LockManager lock_manager;
+    bustub::LogManager log_manager(&disk_manager);
+    bustub::Transaction txn(0);
+    bustub::TableHeap table(&bpm, &lock_manager, &log_manager, first_page_id);
+
+    size_t num_tuples = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (auto itr = table.Begin(&txn); itr != table.End(); ++itr) {
+      num_tuples++;
+    }
+    auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start);
+    total_ms += static_cast<double>(elapsed.count()) / 1000;
+    if (num_tuples == 0) {
+      fmt::print(stderr, "table at page {} is empty\n", first_page_id);
+    }
+    disk_manager.ShutDown();
+  }
+  return total_ms;
+}
+
+// NOLINTNEXTLINE
+auto main(int argc, char **argv) -> int {
+  argparse::ArgumentParser program("bustub-extent-bench");
+  program.add_argument("--file").help("database file to create for the benchmark");
+  program.add_argument("--tables").help("number of tables that are loaded at the same time");
+  program.add_argument("--tuples").help("number of tuples per table");
+  program.add_argument("--direct-io").help("scan without the OS page cache").default_value(false).implicit_value(true);
+
+  try {
+    program.parse_args(argc, argv);
+  } catch (const std::runtime_error &err) {
+    std::cerr << err.what() << std::endl;
+    std::cerr << program;
+    return 1;
+  }
+
+  std::string db_file = "extent-bench.db";
+  size_t num_tables = 4;
+  size_t num_tuples = 4000;
+  if (program.present("--file")) {
+    db_file = program.get("--file");
+  }
+  if (program.present("--tables")) {
+    num_tables = std::stoul(program.get("--tables"));
+  }
+  if (program.present("--tuples")) {
+    num_tuples = std::stoul(program.get("--tuples"));
+  }
+  const bool direct_io = program.get<bool>("--direct-io");
+
+  std::vector<std::pair<std::string, std::pair<HeapLayout, double>>> results;
+  for (bool extents : {false, true}) {
+    bustub::extent_allocation = extents;
+    const auto first_page_ids = LoadTables(db_file, num_tables, num_tuples);
+
+    HeapLayout layout;
+    {
+      bustub::DiskManager disk_manager(db_file);
+      bustub::BufferPoolManagerInstance bpm(64, &disk_manager);
+      for (const auto first_page_id : first_page_ids) {
+        const auto table_layout = InspectLayout(&bpm, first_page_id);
+        layout.num_pages_ += table_layout.num_pages_;
+        layout.num_runs_ += table_layout.num_runs_;
+      }
+      disk_manager.ShutDown();
+    }
+    const double scan_ms = ScanTables(db_file, first_page_ids, direct_io);
+
+    const std::string name = extents ? "extents" : "first-fit";
+    fmt::print("{}: {} pages in {} runs, scans took {:.1f} ms\n", name, layout.num_pages_, layout.num_runs_, scan_ms);
+    results.emplace_back(name, std::make_pair(layout, scan_ms));
+  }
+  remove(db_file.c_str());
+
+  fmt::print("<<< BEGIN\n");
+  for (const auto &[name, result] : results) {
+    fmt::print("{}: pages={} runs={} scan_ms={:.1f}\n", name, result.first.num_pages_, result.first.num_runs_,
+               result.second);
+  }
+  fmt::print(">>> END\n");
+
+  return 0;
+}
@@ -0,0 +1,166 @@
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <optional>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "argparse/argparse.hpp"
+#include "buffer/buffer_pool_manager_instance.h"
+#include "common/config.h"
+#include "fmt/core.h"
+#include "storage/disk/disk_manager_memory.h"
+
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+/**
+ * A hardware counter of the calling thread, read through perf_event_open(2). Counters that the kernel or the
+ * hypervisor does not provide, or that perf_event_paranoid hides, read as nullopt.
+ */
+class PerfCounter {
+ public:
+  PerfCounter(uint32_t type, uint64_t config) {
+    perf_event_attr attr{};
+    attr.size = sizeof(attr);
+    attr.type = type;
+    attr.config = config;
+    attr.disabled = 1;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    fd_ = static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+  }
+
+  ~PerfCounter() {
+    if (fd_ >= 0) {
+      close(fd_);
+    }
+  }
+
+  void Start() {
+    if (fd_ >= 0) {
+      ioctl(fd_, PERF_EVENT_IOC_RESET, 0);
+      ioctl(fd_, PERF_EVENT_IOC_ENABLE, 0);
+    }
+  }
+
+  auto Stop() -> std::optional<uint64_t> {
+    uint64_t count;
+    if (fd_ < 0 || ioctl(fd_, PERF_EVENT_IOC_DISABLE, 0) != 0 || read(fd_, &count, sizeof(count)) != sizeof(count)) {
+      return std::nullopt;
+    }
+    return count;
+  }
+
+ private:
+  int fd_;
+};
+
+static constexpr uint64_t DTLB_READ_MISS = PERF_COUNT_HW_CACHE_DTLB | (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+                                           (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+
+struct ArenaResult {
+  double ns_per_op_;
+  std::optional<uint64_t> dtlb_misses_;
+  std::optional<uint64_t> cache_misses_;
+};
+
+/**
+ * Keep `num_pages` pages resident and fetch random ones, reading one random cache line of each. This is the hit path
+ * of a buffer pool that is larger than the TLB reach, which is where huge pages pay off.
+ */
+auto RunRandomHits(size_t num_pages, size_t num_ops, bool huge_pages) -> ArenaResult {
+  bustub::buffer_pool_huge_pages = huge_pages;
+  auto disk_manager = std::make_unique<bustub::DiskManagerUnlimitedMemory>();
+  auto bpm = std::make_unique<bustub::BufferPoolManagerInstance>(num_pages, disk_manager.get());
+  for (size_t i = 0; i < num_pages; i++) {
+    bustub::page_id_t page_id;
+    auto *page = bpm->NewPage(&page_id);
+    if (page == nullptr) {
+      throw std::runtime_error("failed to allocate page while populating the buffer pool");
+    }
+    memset(page->GetData(), static_cast<int>(page_id), bustub::BUSTUB_PAGE_SIZE);
+    bpm->UnpinPage(page_id, true);
+  }
+  if (huge_pages && !bpm->IsHugePageBacked()) {
+    fmt::print(stderr, "the kernel did not accept transparent huge pages for the frame arena\n");
+  }
+
+  std::default_random_engine gen(42);
+  std::uniform_int_distribution<bustub::page_id_t> page_dist(0, static_cast<bustub::page_id_t>(num_pages) - 1);
+  std::uniform_int_distribution<size_t> line_dist(0, bustub::BUSTUB_PAGE_SIZE / bustub::BUSTUB_CACHELINE_SIZE - 1);
+  PerfCounter dtlb_misses(PERF_TYPE_HW_CACHE, DTLB_READ_MISS);
+  PerfCounter cache_misses(PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES);
+
+  uint64_t checksum = 0;
+  dtlb_misses.Start();
+  cache_misses.Start();
+  auto start = std::chrono::steady_clock::now();
+  for (size_t i = 0; i < num_ops; i++) {
+    auto page_id = page_dist(gen);
+    auto *page = bpm->FetchPage(page_id);
+    page->RLatch();
+    checksum += static_cast<uint8_t>(page->GetData()[line_dist(gen) * bustub::BUSTUB_CACHELINE_SIZE]);
+    page->RUnlatch();
+    bpm->UnpinPage(page_id, false);
+  }
+  auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start);
+  ArenaResult result{static_cast<double>(elapsed.count()) / num_ops, dtlb_misses.Stop(), cache_misses.Stop()};
+
+  if (checksum == 0) {
+    fmt::print(stderr, "unexpected checksum\n");
+  }
+  return result;
+}
+
+auto FormatPerOp(std::optional<uint64_t> count, size_t num_ops) -> std::string {
+  return count.has_value() ? fmt::format("{:.3f}", static_cast<double>(*count) / num_ops) : "n/a";
+}
+
+// NOLINTNEXTLINE
+auto main(int argc, char **argv) -> int {
+  argparse::ArgumentParser program("bustub-frame-arena-bench");
+  program.add_argument("--pages").help("number of resident pages, i.e. the size of the buffer pool");
+  program.add_argument("--ops").help("number of random fetches per configuration");
+
+  try {
+    program.parse_args(argc, argv);
+  } catch (const std::runtime_error &err) {
+    std::cerr << err.what() << std::endl;
+    std::cerr << program;
+    return 1;
+  }
+
+  size_t num_pages = 65536;
+  size_t num_ops = 5000000;
+
+  if (program.present("--pages")) {
+    num_pages = std::stoul(program.get("--pages"));
+  }
+  if (program.present("--ops")) {
+    num_ops = std::stoul(program.get("--ops"));
+  }
+
+  std::vector<std::pair<std::string, ArenaResult>> results;
+  for (bool huge_pages : {false, true}) {
+    auto result = RunRandomHits(num_pages, num_ops, huge_pages);
+    auto name = fmt::format("huge_pages={} pages={}", huge_pages, num_pages);
+    fmt::print("{}: {:.1f} ns/op, dTLB-load-misses/op={}, cache-misses/op={}\n", name, result.ns_per_op_,
+               FormatPerOp(result.dtlb_misses_, num_ops), FormatPerOp(result.cache_misses_, num_ops));
+    results.emplace_back(name, result);
+  }
+
+  fmt::print("<<< BEGIN\n");
+  for (const auto &[name, result] : results) {
+    fmt::print("{} ns/op: {:.1f}\n", name, result.ns_per_op_);
+    fmt::print("{} dTLB-load-misses/op: {}\n", name, FormatPerOp(result.dtlb_misses_, num_ops));
+    fmt::print("{} cache-misses/op: {}\n", name, FormatPerOp(result.cache_misses_, num_ops));
+  }
+  fmt::print(">>> END\n");
+
+  return 0;
+}
@@ -0,0 +1,131 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "argparse/argparse.hpp"
+#include "buffer/buffer_pool_manager_instance.h"
+#include "catalog/schema.h"
+#include "common/config.h"
+#include "concurrency/lock_manager.h"
+#include "concurrency/transaction.h"
+#include "fmt/core.h"
+#include "recovery/log_manager.h"
+#include "storage/disk/disk_manager.h"
+#include "storage/table/table_heap.h"
+#include "storage/table/tuple_record.h"
+#include "type/value_factory.h"
+
+// NOLINTNEXTLINE
+auto main(int argc, char **argv) -> int {
+  argparse::ArgumentParser program("bustub-heap-bench");
+  program.add_argument("--file").help("database file to create for the benchmark");
+  program.add_argument("--rows").help("number of rows to insert");
+  program.add_argument("--report").help("print the throughput every n rows");
+  program.add_argument("--bpm-size").help("number of frames in the buffer pool");
+  program.add_argument("--batch").help(
+      "number of rows to insert with one TableHeap::InsertTuples() call; 1 inserts the rows one by one");
+
+  try {
+    program.parse_args(argc, argv);
+  } catch (const std::runtime_error &err) {
+    std::cerr << err.what() << std::endl;
+    std::cerr << program;
+    return 1;
+  }
+
+  std::string db_file = "heap-bench.db";
+  size_t num_rows = 1000000;
+  size_t report_interval = 100000;
+  size_t bpm_size = 4096;
+  size_t batch_size = 1;
+  if (program.present("--file")) {
+    db_file = program.get("--file");
+  }
+  if (program.present("--rows")) {
+    num_rows = std::stoul(program.get("--rows"));
+  }
+  if (program.present("--report")) {
+    report_interval = std::stoul(program.get("--report"));
+  }
+  if (program.present("--bpm-size")) {
+    bpm_size = std::stoul(program.get("--bpm-size"));
+  }
+  if (program.present("--batch")) {
+    batch_size = std::max<size_t>(std::stoul(program.get("--batch")), 1);
+  }
+
+  remove(db_file.c_str());
+  bustub::DiskManager disk_manager(db_file);
+  bustub::BufferPoolManagerInstance bpm(bpm_size, &disk_manager);
+  bustub::LockManager lock_manager;
+  bustub::LogManager log_manager(&disk_manager);
+  bustub::Transaction txn(0);
+  bustub::TableHeap table(&bpm, &lock_manager, &log_manager, &txn);
+
+  // rows of about 40 bytes, so that a page holds about a hundred of them
+  bustub::Schema schema({bustub::Column{"id", bustub::TypeId::INTEGER}, bustub::Column{"value", bustub::TypeId::BIGINT},
+                         bustub::Column{"name", bustub::TypeId::VARCHAR, 24}});
+
+  std::vector<std::pair<size_t, double>> results;
+  auto start = std::chrono::steady_clock::now();
+  auto interval_start = start;
+  std::vector<std::unique_ptr<bustub::TupleRecord>> tuples;
+  std::vector<const bustub::TupleRecord *> batch;
+  std::vector<bustub::RID> rids;
+  for (size_t i = 1; i <= num_rows; i++) {
+    tuples.emplace_back(std::make_unique<bustub::TupleRecord>(
+        std::vector<bustub::Value>{bustub::ValueFactory::GetIntegerValue(static_cast<int32_t>(i)),
+                                   bustub::ValueFactory::GetBigIntValue(static_cast<int64_t>(i) * 7),
+                                   bustub::ValueFactory::GetVarcharValue(fmt::format("row-{:020}", i))},
+        &schema));
+    const bool report = i % report_interval == 0 || i == num_rows;
+    if (tuples.size() < batch_size && !report) {
+      continue;
+    }
+    if (batch_size == 1) {
+      bustub::RID rid;
+      if (!table.InsertTuple(*tuples[0], &rid, &txn)) {
+        fmt::print(stderr, "insert {} failed\n", i);
+        return 1;
+      }
+    } else {
+      batch.clear();
+      for (const auto &tuple : tuples) {
+        batch.push_back(tuple.get());
+      }
+      if (!table.InsertTuples(batch, &rids, &txn)) {
+        fmt::print(stderr, "insert of rows up to {} failed\n", i);
+        return 1;
+      }
+    }
+    tuples.clear();
+    // the write set would grow with every row
+    txn.GetWriteSet()->clear();
+    if (report) {
+      auto now = std::chrono::steady_clock::now();
+      auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(now - interval_start);
+      const size_t interval_rows = i % report_interval == 0 ? report_interval : i % report_interval;
+      const double rows_per_sec = static_cast<double>(interval_rows) / static_cast<double>(elapsed.count()) * 1000000;
+      fmt::print("{} rows: {:.0f} rows/s\n", i, rows_per_sec);
+      results.emplace_back(i, rows_per_sec);
+      interval_start = now;
+    }
+  }
+  auto total = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start);
+  const double total_rows_per_sec = static_cast<double>(num_rows) / static_cast<double>(total.count()) * 1000000;
+  disk_manager.ShutDown();
+  remove(db_file.c_str());
+
+  fmt::print("<<< BEGIN\n");
+  for (const auto &[rows, rows_per_sec] : results) {
+    fmt::print("{} rows: {:.0f}\n", rows, rows_per_sec);
+  }
+  fmt::print("total: {:.0f}\n", total_rows_per_sec);
+  fmt::print(">>> END\n");
+
+  return 0;
+}
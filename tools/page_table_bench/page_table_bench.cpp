@@ -0,0 +1,142 @@
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <mutex>  // NOLINT
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "argparse/argparse.hpp"
+#include "buffer/page_table.h"
+#include "common/config.h"
+#include "container/hash/extendible_hash_table.h"
+#include "fmt/core.h"
+
+/**
+ * The page table of a buffer pool is read on every fetch and only modified on a miss. `num_pages` pages are mapped at
+ * any time; one in `write_every` operations replaces a random mapped page by an unmapped one, every other operation
+ * looks up a random mapped page.
+ */
+template <typename Table>
+auto RunReadMostly(Table *table, size_t num_pages, size_t num_threads, uint64_t duration_ms, size_t write_every)
+    -> double {
+  // Writers are serialized the way the buffer pool serializes them with its latch. Pages [0, num_pages) start out
+  // mapped, and a page p is always mapped to frame p % num_pages, so lookups can be checked.
+  std::mutex writer_latch;
+  std::vector<bustub::page_id_t> mapped(num_pages);
+  for (size_t i = 0; i < num_pages; i++) {
+    mapped[i] = static_cast<bustub::page_id_t>(i);
+    table->Insert(mapped[i], static_cast<bustub::frame_id_t>(i));
+  }
+
+  std::atomic<bool> stop{false};
+  std::atomic<uint64_t> total_ops{0};
+  std::vector<std::thread> threads;
+  auto start = std::chrono::steady_clock::now();
+  for (size_t thread_id = 0; thread_id < num_threads; thread_id++) {
+    threads.emplace_back([&, thread_id] {
+      std::default_random_engine gen(thread_id);
+      std::uniform_int_distribution<bustub::page_id_t> page_dist(0, static_cast<bustub::page_id_t>(4 * num_pages) - 1);
+      uint64_t ops = 0;
+      while (!stop.load(std::memory_order_relaxed)) {
+        const auto page_id = page_dist(gen);
+        if (write_every != 0 && ops % write_every == 0) {
+          std::scoped_lock lock(writer_latch);
+          const auto frame_id = static_cast<size_t>(page_id) % num_pages;
+          table->Remove(mapped[frame_id]);
+          mapped[frame_id] = page_id;
+          table->Insert(page_id, static_cast<bustub::frame_id_t>(frame_id));
+        } else {
+          bustub::frame_id_t frame_id;
+          if (table->Find(page_id, &frame_id) && static_cast<size_t>(frame_id) != page_id % num_pages) {
+            fmt::print(stderr, "page {} is mapped to frame {}\n", page_id, frame_id);
+            exit(1);
+          }
+        }
+        ops++;
+      }
+      total_ops += ops;
+    });
+  }
+
+  std::this_thread::sleep_for(std::chrono::milliseconds(duration_ms));
+  stop = true;
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start);
+
+  return total_ops / static_cast<double>(elapsed.count()) * 1000;
+}
+
+/** Adapts the generic extendible hash table to the interface of PageTable. */
+class ExtendiblePageTable {
+ public:
+  explicit ExtendiblePageTable(size_t bucket_size) : table_(bucket_size) {}
+  auto Find(bustub::page_id_t page_id, bustub::frame_id_t *frame_id) -> bool { return table_.Find(page_id, *frame_id); }
+  void Insert(bustub::page_id_t page_id, bustub::frame_id_t frame_id) { table_.Insert(page_id, frame_id); }
+  auto Remove(bustub::page_id_t page_id) -> bool { return table_.Remove(page_id); }
+
+ private:
+  bustub::ExtendibleHashTable<bustub::page_id_t, bustub::frame_id_t> table_;
+};
+
+// NOLINTNEXTLINE
+auto main(int argc, char **argv) -> int {
+  argparse::ArgumentParser program("bustub-page-table-bench");
+  program.add_argument("--duration").help("run each configuration for n milliseconds");
+  program.add_argument("--pages").help("number of mapped pages, i.e. the buffer pool size");
+  program.add_argument("--max-threads").help("scale the number of threads from 1 up to n");
+  program.add_argument("--write-every").help("replace a mapped page in one of n operations (0 = lookups only)");
+
+  try {
+    program.parse_args(argc, argv);
+  } catch (const std::runtime_error &err) {
+    std::cerr << err.what() << std::endl;
+    std::cerr << program;
+    return 1;
+  }
+
+  uint64_t duration_ms = 1000;
+  size_t num_pages = 4096;
+  size_t max_threads = 16;
+  size_t write_every = 100;
+
+  if (program.present("--duration")) {
+    duration_ms = std::stoul(program.get("--duration"));
+  }
+  if (program.present("--pages")) {
+    num_pages = std::stoul(program.get("--pages"));
+  }
+  if (program.present("--max-threads")) {
+    max_threads = std::stoul(program.get("--max-threads"));
+  }
+  if (program.present("--write-every")) {
+    write_every = std::stoul(program.get("--write-every"));
+  }
+
+  std::vector<std::pair<std::string, double>> results;
+  for (size_t threads = 1; threads <= max_threads; threads *= 2) {
+    // the buffer pool used the extendible hash table with buckets of 4 entries
+    ExtendiblePageTable extendible(4);
+    auto throughput = RunReadMostly(&extendible, num_pages, threads, duration_ms, write_every);
+    auto name = fmt::format("extendible threads={}", threads);
+    fmt::print("{}: {:.0f} op/s\n", name, throughput);
+    results.emplace_back(name, throughput);
+
+    bustub::PageTable page_table(num_pages);
+    throughput = RunReadMostly(&page_table, num_pages, threads, duration_ms, write_every);
+    name = fmt::format("page_table threads={}", threads);
+    fmt::print("{}: {:.0f} op/s\n", name, throughput);
+    results.emplace_back(name, throughput);
+  }
+
+  fmt::print("<<< BEGIN\n");
+  for (const auto &[name, throughput] : results) {
+    fmt::print("{}: {:.0f}\n", name, throughput);
+  }
+  fmt::print(">>> END\n");
+
+  return 0;
+}
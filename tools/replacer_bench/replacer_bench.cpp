@@ -0,0 +1,99 @@
+#include <chrono>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "argparse/argparse.hpp"
+#include "buffer/clock_replacer.h"
+#include "buffer/lru_k_replacer.h"
+#include "common/config.h"
+#include "fmt/core.h"
+
+/**
+ * Measure the replacer on the buffer pool miss path: evict a victim, record the access of the page that is read into
+ * the freed frame, and make the frame evictable again once it is unpinned. Every iteration also touches one random
+ * resident frame, the way a buffer pool hit would.
+ */
+auto RunMissPath(bustub::FrameReplacer *replacer, size_t num_frames, size_t k, size_t num_ops) -> double {
+  std::default_random_engine gen(42);
+  std::uniform_int_distribution<bustub::frame_id_t> frame_dist(0, static_cast<bustub::frame_id_t>(num_frames) - 1);
+
+  // warm up: every frame is resident, about half of them have a full history
+  for (size_t i = 0; i < num_frames; i++) {
+    auto frame_id = static_cast<bustub::frame_id_t>(i);
+    replacer->RecordAccess(frame_id);
+    if (i % 2 == 0) {
+      for (size_t j = 1; j < k; j++) {
+        replacer->RecordAccess(frame_id);
+      }
+    }
+    replacer->SetEvictable(frame_id, true);
+  }
+
+  auto start = std::chrono::steady_clock::now();
+  for (size_t i = 0; i < num_ops; i++) {
+    auto hit = frame_dist(gen);
+    replacer->SetEvictable(hit, false);
+    replacer->RecordAccess(hit);
+    replacer->SetEvictable(hit, true);
+
+    bustub::frame_id_t victim;
+    if (!replacer->Evict(&victim)) {
+      fmt::print(stderr, "replacer has no victim after {} operations\n", i);
+      exit(1);
+    }
+    replacer->RecordAccess(victim);
+    replacer->SetEvictable(victim, true);
+  }
+  auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start);
+
+  return static_cast<double>(elapsed.count()) / num_ops;
+}
+
+// NOLINTNEXTLINE
+auto main(int argc, char **argv) -> int {
+  argparse::ArgumentParser program("bustub-replacer-bench");
+  program.add_argument("--k").help("lookback constant of the LRU-K replacer");
+  program.add_argument("--ops").help("number of miss-path iterations per pool size");
+
+  try {
+    program.parse_args(argc, argv);
+  } catch (const std::runtime_error &err) {
+    std::cerr << err.what() << std::endl;
+    std::cerr << program;
+    return 1;
+  }
+
+  size_t k = bustub::LRUK_REPLACER_K;
+  size_t num_ops = 1000000;
+
+  if (program.present("--k")) {
+    k = std::stoul(program.get("--k"));
+  }
+  if (program.present("--ops")) {
+    num_ops = std::stoul(program.get("--ops"));
+  }
+
+  std::vector<std::pair<std::string, double>> results;
+  for (size_t num_frames : {1000, 100000, 1000000}) {
+    bustub::LRUKReplacer lru_k_replacer(num_frames, k);
+    auto ns_per_op = RunMissPath(&lru_k_replacer, num_frames, k, num_ops);
+    fmt::print("lru-k frames={} k={}: {:.1f} ns/op\n", num_frames, k, ns_per_op);
+    results.emplace_back(fmt::format("lru-k {}", num_frames), ns_per_op);
+
+    bustub::ClockReplacer clock_replacer(num_frames);
+    ns_per_op = RunMissPath(&clock_replacer, num_frames, k, num_ops);
+    fmt::print("clock frames={}: {:.1f} ns/op\n", num_frames, ns_per_op);
+    results.emplace_back(fmt::format("clock {}", num_frames), ns_per_op);
+  }
+
+  fmt::print("<<< BEGIN\n");
+  for (const auto &[name, ns_per_op] : results) {
+    fmt::print("{}: {:.1f}\n", name, ns_per_op);
+  }
+  fmt::print(">>> END\n");
+
+  return 0;
+}
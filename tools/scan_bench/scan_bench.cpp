@@ -0,0 +1,231 @@
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "argparse/argparse.hpp"
+#include "buffer/buffer_pool_manager_instance.h"
+#include "catalog/schema.h"
+#include "common/config.h"
+#include "concurrency/lock_manager.h"
+#include "concurrency/transaction.h"
+#include "fmt/core.h"
+#include "recovery/log_manager.h"
+#include "storage/disk/disk_manager.h"
+#include "storage/table/table_heap.h"
+#include "storage/table/tuple_record.h"
+#include "type/value_factory.h"
+
+namespace {
+
+/**
+ * Passes every call on to another buffer pool and counts the calls that pin and unpin pages, and the pages that are
+ * hinted to its read-ahead.
+ */
+class CountingBufferPoolManager : public bustub::BufferPoolManager {
+ public:
+  explicit CountingBufferPoolManager(bustub::BufferPoolManager *bpm) : bpm_(bpm) {}
+
+  auto GetPoolSize() -> size_t override { return bpm_->GetPoolSize(); }
+  auto GetFreeListSize() -> int override { return bpm_->GetFreeListSize(); }
+  auto GetFreeEvictableSize() -> int override { return bpm_->GetFreeEvictableSize(); }
+
+  void PrefetchPages(const std::vector<bustub::page_id_t> &page_ids, bustub::BufferAccessStrategy *strategy) override {
+    read_ahead_pages_ += page_ids.size();
+    bpm_->PrefetchPages(page_ids, strategy);
+  }
+  void PrefetchChain(bustub::page_id_t page_id, size_t depth, NextPageIdFn next,
+                     bustub::BufferAccessStrategy *strategy) override {
+    // the read-ahead fetches the page itself to find the chain
+    read_ahead_pages_ += depth + 1;
+    bpm_->PrefetchChain(page_id, depth, next, strategy);
+  }
+  void CancelPrefetch(const bustub::BufferAccessStrategy *strategy) override { bpm_->CancelPrefetch(strategy); }
+
+  void ResetCounts() {
+    fetches_ = 0;
+    unpins_ = 0;
+    read_ahead_pages_ = 0;
+  }
+
+  std::atomic<size_t> fetches_{0};
+  std::atomic<size_t> unpins_{0};
+  std::atomic<size_t> read_ahead_pages_{0};
+
+ protected:
+  auto FetchPgImp(bustub::page_id_t page_id) -> bustub::Page * override {
+    fetches_++;
+    return bpm_->FetchPage(page_id);
+  }
+  auto FetchPgImp(bustub::page_id_t page_id, bustub::BufferAccessStrategy *strategy) -> bustub::Page * override {
+    fetches_++;
+    return bpm_->FetchPage(page_id, strategy);
+  }
+  auto UnpinPgImp(bustub::page_id_t page_id, bool is_dirty) -> bool override {
+    unpins_++;
+    return bpm_->UnpinPage(page_id, is_dirty);
+  }
+  auto FlushPgImp(bustub::page_id_t page_id) -> bool override { return bpm_->FlushPage(page_id); }
+  auto NewPgImp(bustub::page_id_t *page_id) -> bustub::Page * override { return bpm_->NewPage(page_id); }
+  auto NewPgImp(bustub::page_id_t *page_id, bustub::page_id_t near_page_id) -> bustub::Page * override {
+    return bpm_->NewPage(page_id, near_page_id);
+  }
+  auto DeletePgImp(bustub::page_id_t page_id) -> bool override { return bpm_->DeletePage(page_id); }
+  void FlushAllPgsImp() override { bpm_->FlushAllPages(); }
+
+ private:
+  bustub::BufferPoolManager *bpm_;
+};
+
+}  // namespace
+
+// NOLINTNEXTLINE
+auto main(int argc, char **argv) -> int {
+  argparse::ArgumentParser program("bustub-scan-bench");
+  program.add_argument("--file").help("database file to create for the benchmark");
+  program.add_argument("--rows").help("number of rows in the table");
+  program.add_argument("--scans").help("number of full scans of the table");
+  program.add_argument("--bpm-size").help("number of frames in the buffer pool");
+  program.add_argument("--wide")
+      .help("use a table of 20 INTEGER columns instead of one with a VARCHAR column")
+      .default_value(false)
+      .implicit_value(true);
+  program.add_argument("--layout").help("layout of the table pages, row or pax; pax needs --wide");
+  program.add_argument("--by-column")
+      .help("scan the column straight out of the PAX minipages instead of tuple by tuple")
+      .default_value(false)
+      .implicit_value(true);
+
+  try {
+    program.parse_args(argc, argv);
+  } catch (const std::runtime_error &err) {
+    std::cerr << err.what() << std::endl;
+    std::cerr << program;
+    return 1;
+  }
+
+  std::string db_file = "scan-bench.db";
+  size_t num_rows = 1000000;
+  size_t num_scans = 10;
+  size_t bpm_size = 16384;
+  if (program.present("--file")) {
+    db_file = program.get("--file");
+  }
+  if (program.present("--rows")) {
+    num_rows = std::stoul(program.get("--rows"));
+  }
+  if (program.present("--scans")) {
+    num_scans = std::stoul(program.get("--scans"));
+  }
+  if (program.present("--bpm-size")) {
+    bpm_size = std::stoul(program.get("--bpm-size"));
+  }
+  const bool wide = program.get<bool>("--wide");
+  const bool by_column = program.get<bool>("--by-column");
+  auto layout = bustub::TableLayout::ROW;
+  if (program.present("--layout")) {
+    const std::string layout_name = program.get("--layout");
+    if (layout_name == "pax") {
+      layout = bustub::TableLayout::PAX;
+    } else if (layout_name != "row") {
+      fmt::print(stderr, "unknown layout {}\n", layout_name);
+      return 1;
+    }
+  }
+  if ((layout == bustub::TableLayout::PAX && !wide) || (by_column && layout != bustub::TableLayout::PAX)) {
+    fmt::print(stderr, "--layout pax needs --wide, and --by-column needs --layout pax\n");
+    return 1;
+  }
+
+  remove(db_file.c_str());
+  bustub::DiskManager disk_manager(db_file);
+  bustub::BufferPoolManagerInstance pool(bpm_size, &disk_manager);
+  CountingBufferPoolManager bpm(&pool);
+  bustub::LockManager lock_manager;
+  bustub::LogManager log_manager(&disk_manager);
+  bustub::Transaction txn(0);
+  bustub::TableHeap table(&bpm, &lock_manager, &log_manager, &txn);
+
+  // rows of about 40 bytes, so that a page holds about a hundred of them; or 20 INTEGER columns, of which an
+  // aggregate over one reads a twentieth
+  std::vector<bustub::Column> columns{bustub::Column{"id", bustub::TypeId::INTEGER}};
+  if (wide) {
+    for (int i = 1; i < 20; i++) {
+      columns.emplace_back(fmt::format("c{}", i), bustub::TypeId::INTEGER);
+    }
+  } else {
+    columns.emplace_back("value", bustub::TypeId::BIGINT);
+    columns.emplace_back("name", bustub::TypeId::VARCHAR, 24);
+  }
+  bustub::Schema schema(columns);
+  if (layout == bustub::TableLayout::PAX) {
+    table.UsePaxLayout(schema);
+  }
+  for (size_t i = 1; i <= num_rows; i++) {
+    std::vector<bustub::Value> values{bustub::ValueFactory::GetIntegerValue(static_cast<int32_t>(i))};
+    if (wide) {
+      for (int c = 1; c < 20; c++) {
+        values.push_back(bustub::ValueFactory::GetIntegerValue(static_cast<int32_t>(i) + c));
+      }
+    } else {
+      values.push_back(bustub::ValueFactory::GetBigIntValue(static_cast<int64_t>(i) * 7));
+      values.push_back(bustub::ValueFactory::GetVarcharValue(fmt::format("row-{:020}", i)));
+    }
+    bustub::TupleRecord tuple(values, &schema);
+    bustub::RID rid;
+    if (!table.InsertTuple(tuple, &rid, &txn)) {
+      fmt::print(stderr, "insert {} failed\n", i);
+      return 1;
+    }
+    // the write set would grow with every row
+    if (i % 10000 == 0) {
+      txn.GetWriteSet()->clear();
+    }
+  }
+  txn.GetWriteSet()->clear();
+  const size_t num_pages = table.GetFreeSpaceMap()->GetNumPages();
+
+  // every scan reads a column of every row, like a filter would
+  int64_t sum = 0;
+  size_t num_tuples = 0;
+  bpm.ResetCounts();
+  auto start = std::chrono::steady_clock::now();
+  for (size_t i = 0; i < num_scans; i++) {
+    if (by_column) {
+      table.ScanColumn<int32_t>(0, [&](bustub::page_id_t, const std::vector<int32_t> &values,
+                                       const std::vector<uint32_t> &, const std::vector<bool> &) {
+        for (const int32_t value : values) {
+          sum += value;
+        }
+        num_tuples += values.size();
+      });
+      continue;
+    }
+    for (auto itr = table.Begin(&txn); itr != table.End(); ++itr) {
+      sum += itr->GetValue(&schema, 0).GetAs<int32_t>();
+      num_tuples++;
+    }
+  }
+  auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start);
+  disk_manager.ShutDown();
+  remove(db_file.c_str());
+
+  if (num_tuples != num_rows * num_scans) {
+    fmt::print(stderr, "scans returned {} tuples instead of {} (sum {})\n", num_tuples, num_rows * num_scans, sum);
+    return 1;
+  }
+  const auto tuples = static_cast<double>(num_tuples);
+  fmt::print("<<< BEGIN\n");
+  fmt::print("pages: {}\n", num_pages);
+  fmt::print("fetches per tuple: {:.3f}\n", static_cast<double>(bpm.fetches_) / tuples);
+  fmt::print("unpins per tuple: {:.3f}\n", static_cast<double>(bpm.unpins_) / tuples);
+  fmt::print("read-ahead pages per page: {:.3f}\n",
+             static_cast<double>(bpm.read_ahead_pages_) / static_cast<double>(num_pages * num_scans));
+  fmt::print("tuples/s: {:.0f}\n", tuples / static_cast<double>(elapsed.count()) * 1000000);
+  fmt::print(">>> END\n");
+
+  return 0;
+}
@@ -11,6 +11,7 @@
 #include "argparse/argparse.hpp"
 #include "binder/binder.h"
 #include "common/bustub_instance.h"
+#include "common/config.h"
 #include "common/exception.h"
 #include "common/util/string_util.h"
 #include "concurrency/transaction.h"
@@ -120,6 +121,8 @@ auto main(int argc, char **argv) -> int {
   program.add_argument("--duration").help("run terrier bench for n milliseconds");
   program.add_argument("--force-create-index").help("create index in terrier bench");
   program.add_argument("--force-enable-update").help("use update statement in terrier bench");
+  program.add_argument("--bpm-instances").help("shard the buffer pool into n instances");
+  program.add_argument("--replacer").help("buffer pool replacement policy: lru-k or clock");
 
   try {
     program.parse_args(argc, argv);
@@ -129,11 +132,27 @@ auto main(int argc, char **argv) -> int {
     return 1;
   }
 
-  auto bustub = std::make_unique<bustub::BustubInstance>();
+  size_t bpm_instances = 1;
+  if (program.present("--bpm-instances")) {
+    bpm_instances = std::stoul(program.get("--bpm-instances"));
+  }
+  if (program.present("--replacer")) {
+    auto replacer = program.get("--replacer");
+    if (replacer == "lru-k") {
+      bustub::replacer_policy = bustub::ReplacerPolicy::LRU_K;
+    } else if (replacer == "clock") {
+      bustub::replacer_policy = bustub::ReplacerPolicy::CLOCK;
+    } else {
+      throw bustub::Exception(fmt::format("unexpected replacer: {}", replacer));
+    }
+  }
+
+  auto bustub = std::make_unique<bustub::BustubInstance>(bpm_instances);
   auto writer = bustub::SimpleStreamWriter(std::cerr);
 
   // create schema
   auto schema = "CREATE TABLE nft(id int, terrier int);";
+  std::cerr << "x: buffer pool instances: " << bpm_instances << std::endl;
   std::cerr << "x: create schema" << std::endl;
   bustub->ExecuteSql(schema, writer);
 